@@ -12,16 +12,20 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
 #include <cstring>
 #include <fstream>
 #include <iostream>
+#include <thread>
 #include <vector>
 #if defined(_MSC_VER)
 #include <Windows.h>
+#include <Psapi.h>
 #undef min
 #undef max
 #else
 #include <sys/time.h>
+#include <sys/resource.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <dirent.h>
@@ -42,6 +46,20 @@ struct Model {
     std::string model_file;
 };
 
+struct BenchResult {
+    /** steady state latency of each loop, in ms */
+    std::vector<float> costs;
+    /** createSession (schedule + resize + weight transform) cost, in ms */
+    float createCost = 0.0f;
+    /** first runSession after createSession, in ms */
+    float firstRunCost = 0.0f;
+    /** inference per second with `concurrency` sessions running on separate threads */
+    float throughput = 0.0f;
+    int concurrency  = 1;
+    /** peak resident memory while benchmarking the model, in KB. 0 if unknown */
+    long peakMemory = 0;
+};
+
 #if !defined(_MSC_VER)
 inline bool file_exist(const char* file) {
     struct stat buffer;
@@ -115,8 +133,58 @@ static inline uint64_t getTimeInUs() {
     return time;
 }
 
-std::vector<float> doBench(Model& model, int loop, int forward = MNN_FORWARD_CPU, bool only_inference = true,
-                           int numberThread = 4, int precision = 2) {
+/** reset the peak RSS counter if the system supports it, so that each model reports its own peak */
+static void resetPeakMemory() {
+#if defined(__linux__)
+    FILE* file = fopen("/proc/self/clear_refs", "w");
+    if (nullptr != file) {
+        fputs("5", file);
+        fclose(file);
+    }
+#endif
+}
+
+static long getPeakMemoryInKB() {
+#if defined(_MSC_VER)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return (long)(counters.PeakWorkingSetSize / 1024);
+    }
+    return 0;
+#else
+#if defined(__linux__)
+    FILE* file = fopen("/proc/self/status", "r");
+    if (nullptr != file) {
+        char line[256];
+        long peak = 0;
+        while (fgets(line, sizeof(line), file) != nullptr) {
+            if (strncmp(line, "VmHWM:", 6) == 0) {
+                peak = atol(line + 6);
+                break;
+            }
+        }
+        fclose(file);
+        if (peak > 0) {
+            return peak;
+        }
+    }
+#endif
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#if defined(__APPLE__)
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+BenchResult doBench(Model& model, int loop, int forward = MNN_FORWARD_CPU, bool only_inference = true,
+                    int numberThread = 4, int precision = 2, int concurrency = 1) {
+    BenchResult result;
+    resetPeakMemory();
     auto revertor = std::unique_ptr<Revert>(new Revert(model.model_file.c_str()));
     revertor->initialize();
     auto modelBuffer      = revertor->getBuffer();
@@ -130,8 +198,17 @@ std::vector<float> doBench(Model& model, int loop, int forward = MNN_FORWARD_CPU
     backendConfig.precision = (MNN::BackendConfig::PrecisionMode)precision;
     config.backendConfig = &backendConfig;
 
-    std::vector<float> costs;
+    // Cold start: createSession schedules, resizes and transforms weights, then the first inference
+    auto createBegin      = getTimeInUs();
     MNN::Session* session = net->createSession(config);
+    auto createEnd        = getTimeInUs();
+    result.createCost     = (createEnd - createBegin) / 1000.0f;
+
+    // sessions used for throughput test must be created before the model is released
+    std::vector<MNN::Session*> concurrentSessions;
+    for (int i = 1; i < concurrency; ++i) {
+        concurrentSessions.push_back(net->createSession(config));
+    }
     net->releaseModel();
     MNN::Tensor* input    = net->getSessionInput(session, NULL);
 
@@ -146,6 +223,14 @@ std::vector<float> doBench(Model& model, int loop, int forward = MNN_FORWARD_CPU
 
     auto outputTensor = net->getSessionOutput(session, NULL);
     std::shared_ptr<MNN::Tensor> expectTensor(MNN::Tensor::createHostTensorFromDevice(outputTensor, false));
+    {
+        auto timeBegin = getTimeInUs();
+        input->copyFromHostTensor(givenTensor.get());
+        net->runSession(session);
+        outputTensor->copyToHostTensor(expectTensor.get());
+        auto timeEnd        = getTimeInUs();
+        result.firstRunCost = (timeEnd - timeBegin) / 1000.0f;
+    }
     // Warming up...
     for (int i = 0; i < 3; ++i) {
         input->copyFromHostTensor(givenTensor.get());
@@ -161,12 +246,56 @@ std::vector<float> doBench(Model& model, int loop, int forward = MNN_FORWARD_CPU
         outputTensor->copyToHostTensor(expectTensor.get());
 
         auto timeEnd = getTimeInUs();
-        costs.push_back((timeEnd - timeBegin) / 1000.0);
+        result.costs.push_back((timeEnd - timeBegin) / 1000.0);
     }
-    return costs;
+
+    // Steady state throughput: every session runs `loop` times on its own thread
+    concurrentSessions.insert(concurrentSessions.begin(), session);
+    result.concurrency = (int)concurrentSessions.size();
+    auto runLoops      = [&](MNN::Session* s, MNN::Tensor* sInput, MNN::Tensor* sOutput) {
+        std::shared_ptr<MNN::Tensor> sOutputHost(MNN::Tensor::createHostTensorFromDevice(sOutput, false));
+        for (int round = 0; round < loop; round++) {
+            sInput->copyFromHostTensor(givenTensor.get());
+            net->runSession(s);
+            sOutput->copyToHostTensor(sOutputHost.get());
+        }
+    };
+    if (result.concurrency > 1) {
+        auto timeBegin = getTimeInUs();
+        std::vector<std::thread> threads;
+        for (auto s : concurrentSessions) {
+            // getSessionInput / getSessionOutput modify the interpreter, so they are called on this thread
+            auto sInput  = net->getSessionInput(s, NULL);
+            auto sOutput = net->getSessionOutput(s, NULL);
+            threads.emplace_back(std::thread(runLoops, s, sInput, sOutput));
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        auto timeEnd      = getTimeInUs();
+        result.throughput = (float)loop * result.concurrency * 1000000.0f / (float)(timeEnd - timeBegin);
+    } else {
+        float sum = 0.0f;
+        for (auto v : result.costs) {
+            sum += v;
+        }
+        result.throughput = sum > 0.0f ? result.costs.size() * 1000.0f / sum : 0.0f;
+    }
+    result.peakMemory = getPeakMemoryInKB();
+    return result;
 }
 
-void displayStats(const std::string& name, const std::vector<float>& costs) {
+static float percentile(const std::vector<float>& sorted, float p) {
+    if (sorted.empty()) {
+        return 0.0f;
+    }
+    int index = (int)ceil(sorted.size() * p / 100.0f) - 1;
+    index     = std::max(0, std::min((int)sorted.size() - 1, index));
+    return sorted[index];
+}
+
+void displayStats(const std::string& name, const BenchResult& result) {
+    auto& costs = result.costs;
     float max = 0, min = FLT_MAX, sum = 0, avg;
     for (auto v : costs) {
         max = fmax(max, v);
@@ -175,6 +304,65 @@ void displayStats(const std::string& name, const std::vector<float>& costs) {
     }
     avg = costs.size() > 0 ? sum / costs.size() : 0;
     printf("[ - ] %-24s    max = %8.3fms  min = %8.3fms  avg = %8.3fms\n", name.c_str(), max, avg == 0 ? 0 : min, avg);
+    std::vector<float> sorted(costs);
+    std::sort(sorted.begin(), sorted.end());
+    printf("      %-24s    p50 = %8.3fms  p90 = %8.3fms  p99 = %8.3fms  p99.9 = %8.3fms\n", "", percentile(sorted, 50),
+           percentile(sorted, 90), percentile(sorted, 99), percentile(sorted, 99.9f));
+    printf("      %-24s    create = %8.3fms  first run = %8.3fms  throughput = %8.3f/s (x%d)  peak memory = %.2fMB\n",
+           "", result.createCost, result.firstRunCost, result.throughput, result.concurrency,
+           result.peakMemory / 1024.0f);
+}
+
+/** write results of all models as json or csv, determined by the extension of file */
+static void writeResults(const char* file, const std::vector<std::pair<std::string, BenchResult>>& results,
+                         const std::string& forward, int numberThread) {
+    std::ofstream output(file);
+    if (!output.good()) {
+        std::cout << "open " << file << " failed" << std::endl;
+        return;
+    }
+    const std::string fileName = file;
+    const bool json = fileName.size() >= 5 && fileName.substr(fileName.size() - 5) == ".json";
+    char line[1024];
+    if (!json) {
+        output << "model,forward,threads,loop,min_ms,avg_ms,max_ms,p50_ms,p90_ms,p99_ms,p999_ms,create_ms,first_run_ms,"
+                  "concurrency,throughput,peak_memory_kb\n";
+    } else {
+        output << "[\n";
+    }
+    for (int i = 0; i < results.size(); ++i) {
+        auto& name = results[i].first;
+        auto& r    = results[i].second;
+        std::vector<float> sorted(r.costs);
+        std::sort(sorted.begin(), sorted.end());
+        float sum = 0.0f;
+        for (auto v : sorted) {
+            sum += v;
+        }
+        const float avg = sorted.empty() ? 0.0f : sum / sorted.size();
+        const float min = sorted.empty() ? 0.0f : sorted.front();
+        const float max = sorted.empty() ? 0.0f : sorted.back();
+        if (json) {
+            snprintf(line, sizeof(line),
+                     "{\"model\": \"%s\", \"forward\": \"%s\", \"threads\": %d, \"loop\": %d, \"min_ms\": %.3f, "
+                     "\"avg_ms\": %.3f, \"max_ms\": %.3f, \"p50_ms\": %.3f, \"p90_ms\": %.3f, \"p99_ms\": %.3f, "
+                     "\"p999_ms\": %.3f, \"create_ms\": %.3f, \"first_run_ms\": %.3f, \"concurrency\": %d, "
+                     "\"throughput\": %.3f, \"peak_memory_kb\": %ld}%s\n",
+                     name.c_str(), forward.c_str(), numberThread, (int)sorted.size(), min, avg, max,
+                     percentile(sorted, 50), percentile(sorted, 90), percentile(sorted, 99), percentile(sorted, 99.9f),
+                     r.createCost, r.firstRunCost, r.concurrency, r.throughput, r.peakMemory,
+                     i + 1 < results.size() ? "," : "");
+        } else {
+            snprintf(line, sizeof(line), "%s,%s,%d,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%d,%.3f,%ld\n",
+                     name.c_str(), forward.c_str(), numberThread, (int)sorted.size(), min, avg, max,
+                     percentile(sorted, 50), percentile(sorted, 90), percentile(sorted, 99), percentile(sorted, 99.9f),
+                     r.createCost, r.firstRunCost, r.concurrency, r.throughput, r.peakMemory);
+        }
+        output << line;
+    }
+    if (json) {
+        output << "]\n";
+    }
 }
 static inline std::string forwardType(MNNForwardType type) {
     switch (type) {
@@ -197,7 +385,9 @@ int main(int argc, const char* argv[]) {
     MNNForwardType forward = MNN_FORWARD_CPU;
     int numberThread       = 4;
     if (argc <= 2) {
-        std::cout << "Usage: " << argv[0] << " models_folder [loop_count] [forwardtype]" << std::endl;
+        std::cout << "Usage: " << argv[0]
+                  << " models_folder [loop_count] [forwardtype] [thread] [precision] [concurrency] [result.json|.csv]"
+                  << std::endl;
         return 1;
     }
     if (argc >= 3) {
@@ -213,12 +403,26 @@ int main(int argc, const char* argv[]) {
     if (argc >= 6) {
         precision = atoi(argv[5]);
     }
-    std::cout << "Forward type: **" << forwardType(forward) << "** thread=" << numberThread << "** precision=" <<precision << std::endl;
+    int concurrency = 1;
+    if (argc >= 7) {
+        concurrency = std::max(1, atoi(argv[6]));
+    }
+    const char* resultFile = nullptr;
+    if (argc >= 8) {
+        resultFile = argv[7];
+    }
+    std::cout << "Forward type: **" << forwardType(forward) << "** thread=" << numberThread << "** precision=" <<precision
+              << "** concurrency=" << concurrency << std::endl;
     std::vector<Model> models = findModelFiles(argv[1]);
 
     std::cout << "--------> Benchmarking... loop = " << argv[2] << std::endl;
+    std::vector<std::pair<std::string, BenchResult>> results;
     for (auto& m : models) {
-        std::vector<float> costs = doBench(m, loop, forward, false, numberThread, precision);
-        displayStats(m.name, costs);
+        auto result = doBench(m, loop, forward, false, numberThread, precision, concurrency);
+        displayStats(m.name, result);
+        results.emplace_back(std::make_pair(m.name, std::move(result)));
+    }
+    if (nullptr != resultFile) {
+        writeResults(resultFile, results, forwardType(forward), numberThread);
     }
 }
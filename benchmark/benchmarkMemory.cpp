@@ -0,0 +1,169 @@
+//
+//  benchmarkMemory.cpp
+//  MNN
+//
+//  Created by MNN on 2019/08/22.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#if defined(__linux__)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "Interpreter.hpp"
+#include "MNNDefine.h"
+#include "Tensor.hpp"
+#include "revertMNNModel.hpp"
+
+/**
+ Peak resident memory of loading a model, creating a session, releasing the model and running once, compared between
+ createFromFile and createFromFileMapped. Each mode runs in its own process so that they don't affect each other.
+ */
+
+#if defined(__linux__)
+struct MemoryResult {
+    /** peak resident memory above the one before loading, in KB */
+    long peak = 0;
+    /** transformed weights held by executions, in KB */
+    long weight = 0;
+    /** tensors and scratch held by session, in KB */
+    long dynamic = 0;
+};
+
+static long readStatus(const char* key) {
+    FILE* file = fopen("/proc/self/status", "r");
+    if (nullptr == file) {
+        return 0;
+    }
+    char line[256];
+    long value     = 0;
+    const auto len = strlen(key);
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        if (strncmp(line, key, len) == 0) {
+            value = atol(line + len);
+            break;
+        }
+    }
+    fclose(file);
+    return value;
+}
+
+static void resetPeakMemory() {
+    FILE* file = fopen("/proc/self/clear_refs", "w");
+    if (nullptr != file) {
+        fputs("5", file);
+        fclose(file);
+    }
+}
+
+static MemoryResult measure(const char* file, bool mapped, int numberThread) {
+    MemoryResult result;
+    resetPeakMemory();
+    auto origin = readStatus("VmRSS:");
+    std::shared_ptr<MNN::Interpreter> net(mapped ? MNN::Interpreter::createFromFileMapped(file)
+                                                 : MNN::Interpreter::createFromFile(file));
+    if (nullptr == net) {
+        return result;
+    }
+    MNN::ScheduleConfig config;
+    config.numThread = numberThread;
+    auto session     = net->createSession(config);
+    net->releaseModel();
+    MNN::SessionMemoryInfo info;
+    net->getSessionInfo(session, MNN::Interpreter::MEMORY, &info);
+    result.weight  = (long)(info.weight / 1024);
+    result.dynamic = (long)(info.dynamic / 1024);
+
+    auto input = net->getSessionInput(session, nullptr);
+    std::shared_ptr<MNN::Tensor> inputHost(MNN::Tensor::createHostTensorFromDevice(input, false));
+    ::memset(inputHost->host<void>(), 0, inputHost->size());
+    input->copyFromHostTensor(inputHost.get());
+    net->runSession(session);
+    result.peak = readStatus("VmHWM:") - origin;
+    return result;
+}
+
+static bool measureInProcess(const char* file, bool mapped, int numberThread, MemoryResult& result) {
+    int fds[2];
+    if (0 != pipe(fds)) {
+        return false;
+    }
+    auto pid = fork();
+    if (pid < 0) {
+        return false;
+    }
+    if (0 == pid) {
+        close(fds[0]);
+        auto childResult = measure(file, mapped, numberThread);
+        auto size        = write(fds[1], &childResult, sizeof(childResult));
+        close(fds[1]);
+        _exit(size == sizeof(childResult) ? 0 : 1);
+    }
+    close(fds[1]);
+    auto size = read(fds[0], &result, sizeof(result));
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return size == sizeof(result) && WIFEXITED(status) && 0 == WEXITSTATUS(status) && result.peak > 0;
+}
+#endif
+
+int main(int argc, const char* argv[]) {
+    if (argc < 2) {
+        std::cout << "Usage: " << argv[0] << " model.mnn [thread]" << std::endl;
+        return 1;
+    }
+#if !defined(__linux__)
+    std::cout << "Peak memory measurement is only supported on linux" << std::endl;
+    return 0;
+#else
+    int numberThread = 4;
+    if (argc >= 3) {
+        numberThread = atoi(argv[2]);
+    }
+    // benchmark models have no weights, fill them and save as a real model file
+    const std::string tempFile = std::string(argv[1]) + ".memory.tmp";
+    long fileSize              = 0;
+    {
+        std::unique_ptr<Revert> revertor(new Revert(argv[1]));
+        revertor->initialize();
+        std::ofstream output(tempFile.c_str(), std::ios::binary);
+        output.write((const char*)revertor->getBuffer(), revertor->getBufferSize());
+        if (!output.good()) {
+            std::cout << "write " << tempFile << " failed" << std::endl;
+            return 1;
+        }
+        fileSize = (long)(revertor->getBufferSize() / 1024);
+    }
+
+    MemoryResult readResult, mapResult;
+    bool success = measureInProcess(tempFile.c_str(), false, numberThread, readResult) &&
+                   measureInProcess(tempFile.c_str(), true, numberThread, mapResult);
+    remove(tempFile.c_str());
+    if (!success) {
+        std::cout << "measure " << argv[1] << " failed" << std::endl;
+        return 1;
+    }
+    printf("model = %.2fMB, weight = %.2fMB, dynamic = %.2fMB\n", fileSize / 1024.0f, mapResult.weight / 1024.0f,
+           mapResult.dynamic / 1024.0f);
+    printf("createFromFile       peak = %.2fMB\n", readResult.peak / 1024.0f);
+    printf("createFromFileMapped peak = %.2fMB\n", mapResult.peak / 1024.0f);
+
+    // in mapped mode raw weights should never be resident along with transformed ones: the peak could exceed what
+    // session holds by the weights of a single op and runtime overhead, far less than the whole model
+    const long limit = mapResult.weight + mapResult.dynamic + fileSize / 4;
+    if (mapResult.peak > limit) {
+        printf("FAILED: mapped peak exceeds %.2fMB\n", limit / 1024.0f);
+        return 1;
+    }
+    printf("PASSED\n");
+    return 0;
+#endif
+}
@@ -0,0 +1,938 @@
+//
+//  benchmarkOp.cpp
+//  MNN
+//
+//  Created by MNN on 2019/06/10.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Interpreter.hpp"
+#include "MNNDefine.h"
+#include "Tensor.hpp"
+#include "converter/source/IR/MNN_generated.h"
+
+/**
+ Op level benchmark. Each case is a net holding one op fed by Input ( and Const ) ops, so that a regression in one
+ kernel is not hidden by the rest of a model. Results are keyed by (case, threads) and can be diffed with -c.
+ */
+using namespace MNN;
+
+struct OpCase {
+    std::string name;
+    std::string type;
+    /** floating point operations of one run, multiply-add counts as 2 */
+    double flops;
+    std::function<std::unique_ptr<NetT>()> build;
+};
+
+struct OpResult {
+    std::string name;
+    std::string type;
+    int threads     = 0;
+    int loops       = 0;
+    double minMs    = 0.0;
+    double medianMs = 0.0;
+    double avgMs    = 0.0;
+    double p99Ms    = 0.0;
+    double gflops   = 0.0;
+};
+
+class NetMaker {
+public:
+    NetMaker(NetSource source = NetSource_CAFFE) : mNet(new NetT) {
+        mNet->sourceType = source;
+        mNet->bizCode    = "benchmark";
+    }
+
+    int input(const std::vector<int>& dims, MNN_DATA_FORMAT format = MNN_DATA_FORMAT_NC4HW4) {
+        auto param     = new InputT;
+        param->dims    = dims;
+        param->dformat = format;
+        param->dtype   = DataType_DT_FLOAT;
+        std::unique_ptr<OpT> op(new OpT);
+        op->type       = OpType_Input;
+        op->main.type  = OpParameter_Input;
+        op->main.value = param;
+        return add(std::move(op), {}, format);
+    }
+
+    int constInt(const std::vector<int>& values, const std::vector<int>& dims = {}) {
+        auto blob      = new BlobT;
+        blob->dims     = dims.empty() ? std::vector<int>({(int)values.size()}) : dims;
+        blob->dataType = DataType_DT_INT32;
+        blob->int32s   = values;
+        std::unique_ptr<OpT> op(new OpT);
+        op->type       = OpType_Const;
+        op->main.type  = OpParameter_Blob;
+        op->main.value = blob;
+        return add(std::move(op), {}, MNN_DATA_FORMAT_NCHW, DataType_DT_INT32);
+    }
+
+    int constScalar(int value) {
+        auto blob      = new BlobT;
+        blob->dataType = DataType_DT_INT32;
+        blob->int32s   = {value};
+        std::unique_ptr<OpT> op(new OpT);
+        op->type       = OpType_Const;
+        op->main.type  = OpParameter_Blob;
+        op->main.value = blob;
+        return add(std::move(op), {}, MNN_DATA_FORMAT_NCHW, DataType_DT_INT32);
+    }
+
+    int constFloat(const std::vector<int>& dims, MNN_DATA_FORMAT format = MNN_DATA_FORMAT_NCHW) {
+        auto blob        = new BlobT;
+        blob->dims       = dims;
+        blob->dataType   = DataType_DT_FLOAT;
+        blob->dataFormat = format;
+        int size         = 1;
+        for (auto d : dims) {
+            size *= d;
+        }
+        blob->float32s = randomVector(size);
+        std::unique_ptr<OpT> op(new OpT);
+        op->type       = OpType_Const;
+        op->main.type  = OpParameter_Blob;
+        op->main.value = blob;
+        return add(std::move(op), {}, format);
+    }
+
+    /** returns index of the first output, the others follow it */
+    int op(OpType type, OpParameter paramType, void* param, const std::vector<int>& inputs,
+           MNN_DATA_FORMAT format = MNN_DATA_FORMAT_NC4HW4, int outputCount = 1) {
+        std::unique_ptr<OpT> op(new OpT);
+        op->type       = type;
+        op->main.type  = paramType;
+        op->main.value = param;
+        return add(std::move(op), inputs, format, DataType_DT_FLOAT, outputCount);
+    }
+
+    std::unique_ptr<NetT> finish() {
+        return std::move(mNet);
+    }
+
+    static std::vector<float> randomVector(int size) {
+        std::vector<float> result(size);
+        for (int i = 0; i < size; ++i) {
+            result[i] = (float)(rand() % 2000 - 1000) / 1000.0f;
+        }
+        return result;
+    }
+
+private:
+    int add(std::unique_ptr<OpT> op, const std::vector<int>& inputs, MNN_DATA_FORMAT format,
+            DataType dataType = DataType_DT_FLOAT, int outputCount = 1) {
+        int index        = (int)mNet->tensorName.size();
+        op->name         = std::string(EnumNameOpType(op->type)) + std::to_string(index);
+        op->inputIndexes = inputs;
+        for (int i = 0; i < outputCount; ++i) {
+            auto name = op->name + (i > 0 ? ":" + std::to_string(i) : "");
+            op->outputIndexes.emplace_back(index + i);
+            mNet->tensorName.emplace_back(name);
+            if (NetSource_CAFFE != mNet->sourceType) {
+                std::unique_ptr<TensorDescribeT> describe(new TensorDescribeT);
+                describe->index            = index + i;
+                describe->name             = name;
+                describe->blob.reset(new BlobT);
+                describe->blob->dataFormat = format;
+                describe->blob->dataType   = dataType;
+                mNet->extraTensorDescribe.emplace_back(std::move(describe));
+            }
+        }
+        mNet->oplists.emplace_back(std::move(op));
+        return index;
+    }
+
+    std::unique_ptr<NetT> mNet;
+};
+
+static int _outputLength(int input, int kernel, int stride, int pad) {
+    return (input + 2 * pad - kernel) / stride + 1;
+}
+
+static OpCase _conv(int batch, int ic, int oc, int h, int w, int kernel, int stride, int group) {
+    const int pad  = kernel / 2;
+    const bool dw  = group == ic && group == oc && group > 1;
+    const int oh   = _outputLength(h, kernel, stride, pad);
+    const int ow   = _outputLength(w, kernel, stride, pad);
+    OpCase c;
+    std::ostringstream name;
+    name << (dw ? "depthwise_" : "conv_") << kernel << "x" << kernel << "_s" << stride;
+    if (!dw && group > 1) {
+        name << "_g" << group;
+    }
+    name << "_" << batch << "x" << ic << "x" << h << "x" << w << "_o" << oc;
+    c.name  = name.str();
+    c.type  = dw ? "ConvolutionDepthwise" : "Convolution";
+    c.flops = 2.0 * batch * oh * ow * oc * (ic / group) * kernel * kernel;
+    c.build = [=]() {
+        NetMaker maker;
+        auto input     = maker.input({batch, ic, h, w});
+        auto param     = new Convolution2DT;
+        param->common.reset(new Convolution2DCommonT);
+        auto common         = param->common.get();
+        common->kernelX     = kernel;
+        common->kernelY     = kernel;
+        common->strideX     = stride;
+        common->strideY     = stride;
+        common->padX        = pad;
+        common->padY        = pad;
+        common->dilateX     = 1;
+        common->dilateY     = 1;
+        common->group       = group;
+        common->inputCount  = ic;
+        common->outputCount = oc;
+        param->weight       = NetMaker::randomVector(kernel * kernel * oc * ic / group);
+        param->bias         = NetMaker::randomVector(oc);
+        maker.op(dw ? OpType_ConvolutionDepthwise : OpType_Convolution, OpParameter_Convolution2D, param, {input});
+        return maker.finish();
+    };
+    return c;
+}
+
+static OpCase _deconv(int ic, int oc, int h, int w, int kernel, int stride) {
+    // pad so that output is input * stride where it divides
+    const int pad = std::max(kernel - stride, 0) / 2;
+    OpCase c;
+    std::ostringstream name;
+    name << "deconv_" << kernel << "x" << kernel << "_s" << stride << "_1x" << ic << "x" << h << "x" << w << "_o"
+         << oc;
+    c.name  = name.str();
+    c.type  = "Deconvolution";
+    c.flops = 2.0 * h * w * oc * ic * kernel * kernel;
+    c.build = [=]() {
+        NetMaker maker;
+        auto input = maker.input({1, ic, h, w});
+        auto param = new Convolution2DT;
+        param->common.reset(new Convolution2DCommonT);
+        auto common         = param->common.get();
+        common->kernelX     = kernel;
+        common->kernelY     = kernel;
+        common->strideX     = stride;
+        common->strideY     = stride;
+        common->padX        = pad;
+        common->padY        = pad;
+        common->dilateX     = 1;
+        common->dilateY     = 1;
+        common->group       = 1;
+        common->inputCount  = ic;
+        common->outputCount = oc;
+        param->weight       = NetMaker::randomVector(kernel * kernel * oc * ic);
+        param->bias         = NetMaker::randomVector(oc);
+        maker.op(OpType_Deconvolution, OpParameter_Convolution2D, param, {input});
+        return maker.finish();
+    };
+    return c;
+}
+
+static OpCase _pool(int ic, int h, int w, int kernel, int stride, PoolType type, bool global) {
+    OpCase c;
+    std::ostringstream name;
+    name << (type == PoolType_MAXPOOL ? "maxpool_" : "avgpool_");
+    if (global) {
+        name << "global";
+    } else {
+        name << kernel << "x" << kernel << "_s" << stride;
+    }
+    name << "_1x" << ic << "x" << h << "x" << w;
+    const int oh = global ? 1 : _outputLength(h, kernel, stride, 0);
+    const int ow = global ? 1 : _outputLength(w, kernel, stride, 0);
+    c.name       = name.str();
+    c.type       = "Pooling";
+    c.flops      = global ? (double)ic * h * w : (double)ic * oh * ow * kernel * kernel;
+    c.build      = [=]() {
+        NetMaker maker;
+        auto input      = maker.input({1, ic, h, w});
+        auto param      = new PoolT;
+        param->isGlobal = global;
+        param->kernelX  = kernel;
+        param->kernelY  = kernel;
+        param->strideX  = stride;
+        param->strideY  = stride;
+        param->type     = type;
+        param->padType  = PoolPadType_VALID;
+        maker.op(OpType_Pooling, OpParameter_Pool, param, {input});
+        return maker.finish();
+    };
+    return c;
+}
+
+static OpCase _softmax(int c_, int h, int w, OpType type = OpType_Softmax) {
+    OpCase c;
+    c.type  = EnumNameOpType(type);
+    c.name  = (OpType_Softmax == type ? "softmax" : "log_softmax") + std::string("_c_1x") + std::to_string(c_) + "x" +
+             std::to_string(h) + "x" + std::to_string(w);
+    c.flops = 4.0 * c_ * h * w;
+    c.build = [=]() {
+        NetMaker maker;
+        auto input  = maker.input({1, c_, h, w});
+        auto param  = new AxisT;
+        param->axis = 1;
+        maker.op(type, OpParameter_Axis, param, {input});
+        return maker.finish();
+    };
+    return c;
+}
+
+// softmax over the last axis of plain rows, as logits of language models are
+static OpCase _softmaxRows(int rows, int classes) {
+    OpCase c;
+    c.name  = "softmax_rows_" + std::to_string(rows) + "x" + std::to_string(classes);
+    c.type  = "Softmax";
+    c.flops = 4.0 * rows * classes;
+    c.build = [=]() {
+        NetMaker maker;
+        auto input  = maker.input({rows, classes}, MNN_DATA_FORMAT_NHWC);
+        auto param  = new AxisT;
+        param->axis = -1;
+        maker.op(OpType_Softmax, OpParameter_Axis, param, {input}, MNN_DATA_FORMAT_NHWC);
+        return maker.finish();
+    };
+    return c;
+}
+
+// elementwise transcendental ops, flops counts one per element
+static OpCase _activation(int c_, int h, int w, OpType type, UnaryOpOperation unary = UnaryOpOperation_EXP) {
+    OpCase c;
+    c.type = EnumNameOpType(type);
+    c.name = (OpType_UnaryOp == type ? std::string("unary_") + EnumNameUnaryOpOperation(unary) : c.type) + "_1x" +
+             std::to_string(c_) + "x" + std::to_string(h) + "x" + std::to_string(w);
+    c.flops = (double)c_ * h * w;
+    c.build = [=]() {
+        NetMaker maker;
+        auto input = maker.input({1, c_, h, w});
+        if (OpType_Selu == type) {
+            auto param   = new SeluT;
+            param->scale = 1.0507f;
+            param->alpha = 1.6733f;
+            maker.op(type, OpParameter_Selu, param, {input});
+        } else if (OpType_UnaryOp == type) {
+            auto param    = new UnaryOpT;
+            param->opType = unary;
+            param->T      = DataType_DT_FLOAT;
+            maker.op(type, OpParameter_UnaryOp, param, {input});
+        } else {
+            maker.op(type, OpParameter_NONE, nullptr, {input});
+        }
+        return maker.finish();
+    };
+    return c;
+}
+
+static OpCase _gemm(int m, int k, int n) {
+    OpCase c;
+    c.name  = "gemm_" + std::to_string(m) + "x" + std::to_string(k) + "x" + std::to_string(n);
+    c.type  = "MatMul";
+    c.flops = 2.0 * m * k * n;
+    c.build = [=]() {
+        NetMaker maker(NetSource_TENSORFLOW);
+        auto a     = maker.input({m, k}, MNN_DATA_FORMAT_NHWC);
+        auto b     = maker.constFloat({k, n}, MNN_DATA_FORMAT_NHWC);
+        auto param = new MatMulT;
+        param->T   = DataType_DT_FLOAT;
+        maker.op(OpType_MatMul, OpParameter_MatMul, param, {a, b}, MNN_DATA_FORMAT_NHWC);
+        return maker.finish();
+    };
+    return c;
+}
+
+static OpCase _eltwise(int ic, int h, int w, EltwiseType type) {
+    OpCase c;
+    c.name  = std::string("eltwise_") + EnumNameEltwiseType(type) + "_1x" + std::to_string(ic) + "x" +
+             std::to_string(h) + "x" + std::to_string(w);
+    c.type  = "Eltwise";
+    c.flops = (double)ic * h * w;
+    c.build = [=]() {
+        NetMaker maker;
+        auto a      = maker.input({1, ic, h, w});
+        auto b      = maker.input({1, ic, h, w});
+        auto param  = new EltwiseT;
+        param->type = type;
+        maker.op(OpType_Eltwise, OpParameter_Eltwise, param, {a, b});
+        return maker.finish();
+    };
+    return c;
+}
+
+static OpCase _interp(int ic, int h, int w, int scale, int resizeType) {
+    OpCase c;
+    c.name  = std::string(resizeType == 1 ? "interp_nearest_" : "interp_bilinear_") + std::to_string(scale) + "x_1x" +
+             std::to_string(ic) + "x" + std::to_string(h) + "x" + std::to_string(w);
+    c.type  = "Interp";
+    c.flops = (resizeType == 1 ? 1.0 : 4.0) * ic * h * w * scale * scale;
+    c.build = [=]() {
+        NetMaker maker;
+        auto input          = maker.input({1, ic, h, w});
+        auto param          = new InterpT;
+        param->outputHeight = h * scale;
+        param->outputWidth  = w * scale;
+        param->widthScale   = (float)scale;
+        param->heightScale  = (float)scale;
+        param->resizeType   = resizeType;
+        param->alignCorners = false;
+        maker.op(OpType_Interp, OpParameter_Interp, param, {input});
+        return maker.finish();
+    };
+    return c;
+}
+
+static OpCase _resize(int ic, int h, int w, int scale) {
+    OpCase c;
+    c.name  = "resize_" + std::to_string(scale) + "x_1x" + std::to_string(ic) + "x" + std::to_string(h) + "x" +
+             std::to_string(w);
+    c.type  = "Resize";
+    c.flops = 4.0 * ic * h * w * scale * scale;
+    c.build = [=]() {
+        NetMaker maker;
+        auto input    = maker.input({1, ic, h, w});
+        auto param    = new ResizeT;
+        param->xScale = (float)scale;
+        param->yScale = (float)scale;
+        maker.op(OpType_Resize, OpParameter_Resize, param, {input});
+        return maker.finish();
+    };
+    return c;
+}
+
+static OpCase _transpose(const std::vector<int>& dims, const std::vector<int>& perm) {
+    OpCase c;
+    std::ostringstream name;
+    name << "transpose_";
+    int size = 1;
+    for (int i = 0; i < dims.size(); ++i) {
+        name << (i > 0 ? "x" : "") << dims[i];
+        size *= dims[i];
+    }
+    name << "_p";
+    for (auto p : perm) {
+        name << p;
+    }
+    c.name  = name.str();
+    c.type  = "Transpose";
+    c.flops = (double)size;
+    c.build = [=]() {
+        NetMaker maker(NetSource_TENSORFLOW);
+        auto input   = maker.input(dims, MNN_DATA_FORMAT_NHWC);
+        auto permute = maker.constInt(perm);
+        auto param   = new TransposeT;
+        param->Tperm = DataType_DT_INT32;
+        maker.op(OpType_Transpose, OpParameter_Transpose, param, {input, permute}, MNN_DATA_FORMAT_NHWC);
+        return maker.finish();
+    };
+    return c;
+}
+
+// permute of NC4HW4 as caffe models do, channel moves to a spatial axis
+static OpCase _permute(int c_, int h, int w, const std::vector<int>& dims) {
+    OpCase c;
+    c.name = "permute_1x" + std::to_string(c_) + "x" + std::to_string(h) + "x" + std::to_string(w) + "_p";
+    for (auto d : dims) {
+        c.name += std::to_string(d);
+    }
+    c.type  = "Permute";
+    c.flops = (double)c_ * h * w;
+    c.build = [=]() {
+        NetMaker maker;
+        auto input  = maker.input({1, c_, h, w});
+        auto param  = new PermuteT;
+        param->dims = dims;
+        maker.op(OpType_Permute, OpParameter_Permute, param, {input});
+        return maker.finish();
+    };
+    return c;
+}
+
+static std::unique_ptr<BlobT> _randomBlob(const std::vector<int>& dims) {
+    std::unique_ptr<BlobT> blob(new BlobT);
+    blob->dims     = dims;
+    blob->dataType = DataType_DT_FLOAT;
+    int size       = 1;
+    for (auto d : dims) {
+        size *= d;
+    }
+    blob->float32s = NetMaker::randomVector(size);
+    return blob;
+}
+
+static OpCase _lstm(int batch, int timeSteps, int inputLength, int numUnits) {
+    OpCase c;
+    c.name  = "lstm_" + std::to_string(batch) + "x" + std::to_string(timeSteps) + "x" + std::to_string(inputLength) +
+             "_u" + std::to_string(numUnits);
+    c.type  = "LSTM";
+    c.flops = 2.0 * batch * timeSteps * (inputLength + numUnits) * 4 * numUnits;
+    c.build = [=]() {
+        NetMaker maker;
+        auto input         = maker.input({batch, timeSteps, 1, inputLength});
+        auto param         = new LSTMT;
+        param->outputCount = numUnits;
+        param->weightI     = _randomBlob({1, 1, 4 * numUnits, inputLength});
+        param->weightH     = _randomBlob({1, 1, 4 * numUnits, numUnits});
+        param->bias        = _randomBlob({1, 1, 4 * numUnits, 1});
+        maker.op(OpType_LSTM, OpParameter_LSTM, param, {input});
+        return maker.finish();
+    };
+    return c;
+}
+
+static OpCase _gru(int batch, int sequence, int inputLength, int numUnits) {
+    OpCase c;
+    c.name  = "gru_" + std::to_string(batch) + "x" + std::to_string(sequence) + "x" + std::to_string(inputLength) +
+             "_u" + std::to_string(numUnits);
+    c.type  = "RNNSequenceGRU";
+    c.flops = 2.0 * batch * sequence * (inputLength + numUnits) * 3 * numUnits;
+    c.build = [=]() {
+        NetMaker maker(NetSource_TENSORFLOW);
+        auto input                = maker.input({batch, sequence, inputLength}, MNN_DATA_FORMAT_NHWC);
+        auto param                = new RNNParamT;
+        param->numUnits           = numUnits;
+        param->isBidirectionalRNN = false;
+        param->keepAllOutputs     = true;
+        param->fwGateWeight       = _randomBlob({inputLength + numUnits, 2 * numUnits});
+        param->fwGateBias         = _randomBlob({2 * numUnits});
+        param->fwCandidateWeight  = _randomBlob({inputLength + numUnits, numUnits});
+        param->fwCandidateBias    = _randomBlob({numUnits});
+        maker.op(OpType_RNNSequenceGRU, OpParameter_RNNParam, param, {input}, MNN_DATA_FORMAT_NHWC);
+        return maker.finish();
+    };
+    return c;
+}
+
+static OpCase _detectionOutput(int priorCount, int classCount) {
+    OpCase c;
+    c.name  = "detection_output_" + std::to_string(priorCount) + "x" + std::to_string(classCount);
+    c.type  = "DetectionOutput";
+    c.flops = 0.0;
+    c.build = [=]() {
+        NetMaker maker;
+        auto location              = maker.input({1, 4 * priorCount, 1, 1});
+        auto confidence            = maker.input({1, priorCount * classCount, 1, 1});
+        auto priorbox              = maker.input({1, 2, 4 * priorCount, 1});
+        auto param                 = new DetectionOutputT;
+        param->classCount          = classCount;
+        param->nmsThresholdold     = 0.45f;
+        param->nmsTopK             = 400;
+        param->keepTopK            = 200;
+        param->confidenceThreshold = 0.01f;
+        maker.op(OpType_DetectionOutput, OpParameter_DetectionOutput, param, {location, confidence, priorbox});
+        return maker.finish();
+    };
+    return c;
+}
+
+static OpCase _topk(int rows, int rowSize, int k) {
+    OpCase c;
+    c.name  = "topk_" + std::to_string(rows) + "x" + std::to_string(rowSize) + "_k" + std::to_string(k);
+    c.type  = "TopKV2";
+    c.flops = 0.0;
+    c.build = [=]() {
+        NetMaker maker(NetSource_TENSORFLOW);
+        auto input  = maker.input({rows, rowSize}, MNN_DATA_FORMAT_NHWC);
+        auto kIndex = maker.constScalar(k);
+        auto param  = new TopKV2T;
+        param->T    = DataType_DT_FLOAT;
+        maker.op(OpType_TopKV2, OpParameter_TopKV2, param, {input, kIndex}, MNN_DATA_FORMAT_NHWC, 2);
+        return maker.finish();
+    };
+    return c;
+}
+
+// lookup of count rows of a table, pooled by bags of bag rows if bag > 1
+static OpCase _gather(int rows, int dim, int count, int bag) {
+    OpCase c;
+    c.type  = "GatherV2";
+    c.name  = (bag > 1 ? "embedding_bag_" : "gather_") + std::to_string(rows) + "x" + std::to_string(dim) + "_n" +
+             std::to_string(count) + (bag > 1 ? "_b" + std::to_string(bag) : std::string());
+    c.flops = bag > 1 ? (double)count * dim : 0.0;
+    c.build = [=]() {
+        NetMaker maker(NetSource_TENSORFLOW);
+        auto table = maker.input({rows, dim}, MNN_DATA_FORMAT_NHWC);
+        std::vector<int> values(count);
+        for (int i = 0; i < count; ++i) {
+            values[i] = rand() % rows;
+        }
+        auto indices      = maker.constInt(values, bag > 1 ? std::vector<int>({count / bag, bag}) : std::vector<int>());
+        auto param        = new GatherV2T;
+        param->Taxis      = DataType_DT_INT32;
+        param->Tindices   = DataType_DT_INT32;
+        param->Tparams    = DataType_DT_FLOAT;
+        param->combiner   = bag > 1 ? GatherCombiner_SUM : GatherCombiner_NONE;
+        maker.op(OpType_GatherV2, OpParameter_GatherV2, param, {table, indices}, MNN_DATA_FORMAT_NHWC);
+        return maker.finish();
+    };
+    return c;
+}
+
+static std::vector<OpCase> _allCases() {
+    std::vector<OpCase> cases;
+    // convolution: first layer, 1x1 / 3x3 of mobilenet & resnet, strided and grouped variants
+    cases.emplace_back(_conv(1, 3, 32, 224, 224, 3, 2, 1));
+    cases.emplace_back(_conv(1, 3, 64, 224, 224, 7, 2, 1));
+    cases.emplace_back(_conv(1, 32, 64, 112, 112, 1, 1, 1));
+    cases.emplace_back(_conv(1, 256, 256, 14, 14, 1, 1, 1));
+    cases.emplace_back(_conv(1, 1024, 1024, 7, 7, 1, 1, 1));
+    cases.emplace_back(_conv(1, 64, 64, 56, 56, 3, 1, 1));
+    cases.emplace_back(_conv(1, 128, 128, 28, 28, 3, 1, 1));
+    cases.emplace_back(_conv(1, 256, 256, 14, 14, 3, 1, 1));
+    cases.emplace_back(_conv(1, 128, 256, 28, 28, 3, 2, 1));
+    cases.emplace_back(_conv(4, 64, 64, 56, 56, 3, 1, 1));
+    cases.emplace_back(_conv(1, 128, 128, 28, 28, 3, 1, 4));
+    cases.emplace_back(_conv(1, 256, 256, 14, 14, 3, 1, 32));
+    // depthwise
+    cases.emplace_back(_conv(1, 32, 32, 112, 112, 3, 1, 32));
+    cases.emplace_back(_conv(1, 64, 64, 112, 112, 3, 2, 64));
+    cases.emplace_back(_conv(1, 512, 512, 14, 14, 3, 1, 512));
+    cases.emplace_back(_conv(1, 144, 144, 56, 56, 5, 1, 144));
+    // deconvolution
+    cases.emplace_back(_deconv(64, 32, 56, 56, 4, 2));
+    cases.emplace_back(_deconv(128, 64, 28, 28, 3, 2));
+    cases.emplace_back(_deconv(128, 64, 28, 28, 2, 2));
+    cases.emplace_back(_deconv(64, 64, 28, 28, 3, 1));
+    // pooling
+    cases.emplace_back(_pool(64, 112, 112, 3, 2, PoolType_MAXPOOL, false));
+    cases.emplace_back(_pool(256, 28, 28, 2, 2, PoolType_AVEPOOL, false));
+    cases.emplace_back(_pool(256, 28, 28, 7, 1, PoolType_AVEPOOL, false));
+    cases.emplace_back(_pool(2048, 7, 7, 7, 1, PoolType_AVEPOOL, true));
+    cases.emplace_back(_pool(1024, 7, 7, 7, 1, PoolType_MAXPOOL, true));
+    // softmax
+    cases.emplace_back(_softmax(1000, 1, 1));
+    cases.emplace_back(_softmax(21, 128, 128));
+    cases.emplace_back(_softmax(21, 128, 128, OpType_LogSoftmax));
+    cases.emplace_back(_softmaxRows(16, 32000));
+
+    cases.emplace_back(_activation(64, 112, 112, OpType_Sigmoid));
+    cases.emplace_back(_activation(64, 112, 112, OpType_TanH));
+    cases.emplace_back(_activation(64, 112, 112, OpType_Selu));
+    cases.emplace_back(_activation(64, 112, 112, OpType_UnaryOp, UnaryOpOperation_EXP));
+    cases.emplace_back(_activation(64, 112, 112, OpType_UnaryOp, UnaryOpOperation_LOG));
+    // gemm
+    cases.emplace_back(_gemm(1, 1024, 1000));
+    cases.emplace_back(_gemm(64, 256, 256));
+    cases.emplace_back(_gemm(256, 256, 256));
+    cases.emplace_back(_gemm(512, 512, 512));
+    // eltwise
+    cases.emplace_back(_eltwise(64, 56, 56, EltwiseType_SUM));
+    cases.emplace_back(_eltwise(256, 56, 56, EltwiseType_SUM));
+    cases.emplace_back(_eltwise(256, 56, 56, EltwiseType_PROD));
+    cases.emplace_back(_eltwise(256, 56, 56, EltwiseType_MAXIMUM));
+    // resize
+    cases.emplace_back(_interp(256, 32, 32, 2, 2));
+    cases.emplace_back(_interp(21, 64, 64, 4, 2));
+    cases.emplace_back(_interp(256, 32, 32, 2, 1));
+    cases.emplace_back(_resize(64, 64, 64, 2));
+    // transpose
+    cases.emplace_back(_transpose({1, 64, 112, 112}, {0, 2, 3, 1}));
+    cases.emplace_back(_transpose({1, 112, 112, 64}, {0, 3, 1, 2}));
+    cases.emplace_back(_transpose({1024, 1024}, {1, 0}));
+    cases.emplace_back(_transpose({8, 128, 12, 64}, {0, 2, 1, 3}));
+    cases.emplace_back(_permute(64, 112, 112, {0, 2, 3, 1}));
+    // embedding lookup
+    cases.emplace_back(_gather(200000, 64, 4096, 1));
+    cases.emplace_back(_gather(200000, 64, 4096, 32));
+    // rnn
+    cases.emplace_back(_lstm(1, 64, 128, 256));
+    cases.emplace_back(_lstm(8, 64, 128, 256));
+    cases.emplace_back(_lstm(1, 256, 64, 64));
+    cases.emplace_back(_gru(1, 64, 128, 256));
+    cases.emplace_back(_gru(8, 64, 128, 256));
+    cases.emplace_back(_gru(32, 64, 128, 256));
+    // detection post process of ssd
+    cases.emplace_back(_detectionOutput(1917, 91));
+    cases.emplace_back(_detectionOutput(8732, 21));
+    // topk of recommendation scores
+    cases.emplace_back(_topk(1, 100000, 1));
+    cases.emplace_back(_topk(1, 100000, 100));
+    cases.emplace_back(_topk(64, 1000, 5));
+    return cases;
+}
+
+static std::vector<double> _runCase(const OpCase& opCase, int threads, int loops, int warmup) {
+    std::vector<double> costs;
+    auto netT = opCase.build();
+    flatbuffers::FlatBufferBuilder builder(1024);
+    builder.Finish(Net::Pack(builder, netT.get()));
+    netT.reset();
+    std::unique_ptr<Interpreter> net(Interpreter::createFromBuffer(builder.GetBufferPointer(), builder.GetSize()));
+    if (nullptr == net) {
+        return costs;
+    }
+    ScheduleConfig config;
+    config.numThread = threads;
+    config.type      = MNN_FORWARD_CPU;
+    auto session     = net->createSession(config);
+    if (nullptr == session) {
+        return costs;
+    }
+    net->releaseModel();
+    for (auto& iter : net->getSessionInputAll(session)) {
+        auto input = iter.second;
+        std::unique_ptr<Tensor> host(Tensor::createHostTensorFromDevice(input, false));
+        auto data = host->host<float>();
+        for (int i = 0; i < host->elementSize(); ++i) {
+            data[i] = (float)(rand() % 2000 - 1000) / 1000.0f;
+        }
+        input->copyFromHostTensor(host.get());
+    }
+    for (int i = 0; i < warmup; ++i) {
+        net->runSession(session);
+    }
+    costs.reserve(loops);
+    for (int i = 0; i < loops; ++i) {
+        auto begin = std::chrono::steady_clock::now();
+        net->runSession(session);
+        auto end = std::chrono::steady_clock::now();
+        costs.push_back(std::chrono::duration<double, std::milli>(end - begin).count());
+    }
+    return costs;
+}
+
+static OpResult _summary(const OpCase& opCase, int threads, std::vector<double> costs) {
+    OpResult result;
+    result.name    = opCase.name;
+    result.type    = opCase.type;
+    result.threads = threads;
+    result.loops   = (int)costs.size();
+    if (costs.empty()) {
+        return result;
+    }
+    std::sort(costs.begin(), costs.end());
+    double sum = 0.0;
+    for (auto v : costs) {
+        sum += v;
+    }
+    const int size  = (int)costs.size();
+    result.minMs    = costs[0];
+    result.medianMs = (size % 2) ? costs[size / 2] : (costs[size / 2 - 1] + costs[size / 2]) / 2.0;
+    result.avgMs    = sum / size;
+    result.p99Ms    = costs[std::min(size - 1, (int)ceil(size * 0.99) - 1)];
+    result.gflops   = result.medianMs > 0.0 ? opCase.flops / result.medianMs / 1.0e6 : 0.0;
+    return result;
+}
+
+static void _writeResults(const std::vector<OpResult>& results, const std::string& file, bool json) {
+    std::ofstream output(file.c_str());
+    if (!output.good()) {
+        MNN_ERROR("Can't open %s for write\n", file.c_str());
+        return;
+    }
+    char line[512];
+    if (json) {
+        output << "[\n";
+        for (int i = 0; i < results.size(); ++i) {
+            auto& r = results[i];
+            snprintf(line, sizeof(line),
+                     "{\"case\": \"%s\", \"type\": \"%s\", \"threads\": %d, \"loops\": %d, \"min_ms\": %.4f, "
+                     "\"median_ms\": %.4f, \"avg_ms\": %.4f, \"p99_ms\": %.4f, \"gflops\": %.3f}%s\n",
+                     r.name.c_str(), r.type.c_str(), r.threads, r.loops, r.minMs, r.medianMs, r.avgMs, r.p99Ms,
+                     r.gflops, i + 1 < results.size() ? "," : "");
+            output << line;
+        }
+        output << "]\n";
+        return;
+    }
+    output << "case,type,threads,loops,min_ms,median_ms,avg_ms,p99_ms,gflops\n";
+    for (auto& r : results) {
+        snprintf(line, sizeof(line), "%s,%s,%d,%d,%.4f,%.4f,%.4f,%.4f,%.3f\n", r.name.c_str(), r.type.c_str(),
+                 r.threads, r.loops, r.minMs, r.medianMs, r.avgMs, r.p99Ms, r.gflops);
+        output << line;
+    }
+}
+
+static bool _jsonValue(const std::string& line, const char* key, std::string& value) {
+    auto pattern = std::string("\"") + key + "\": ";
+    auto pos     = line.find(pattern);
+    if (std::string::npos == pos) {
+        return false;
+    }
+    pos += pattern.size();
+    if (line[pos] == '"') {
+        auto end = line.find('"', pos + 1);
+        value    = line.substr(pos + 1, end - pos - 1);
+    } else {
+        auto end = line.find_first_of(",}", pos);
+        value    = line.substr(pos, end - pos);
+    }
+    return true;
+}
+
+/** read back a result file written by _writeResults, csv or json detected by the first character */
+static std::map<std::string, OpResult> _readResults(const char* file) {
+    std::map<std::string, OpResult> results;
+    std::ifstream input(file);
+    if (!input.good()) {
+        MNN_ERROR("Can't open %s\n", file);
+        return results;
+    }
+    std::string line;
+    while (std::getline(input, line)) {
+        OpResult r;
+        if (line.find('{') != std::string::npos) {
+            std::string threads, median, p99, gflops;
+            if (!_jsonValue(line, "case", r.name) || !_jsonValue(line, "threads", threads) ||
+                !_jsonValue(line, "median_ms", median) || !_jsonValue(line, "p99_ms", p99) ||
+                !_jsonValue(line, "gflops", gflops)) {
+                continue;
+            }
+            r.threads  = atoi(threads.c_str());
+            r.medianMs = atof(median.c_str());
+            r.p99Ms    = atof(p99.c_str());
+            r.gflops   = atof(gflops.c_str());
+        } else {
+            std::vector<std::string> fields;
+            std::istringstream stream(line);
+            std::string field;
+            while (std::getline(stream, field, ',')) {
+                fields.emplace_back(field);
+            }
+            if (fields.size() < 9 || fields[0] == "case") {
+                continue;
+            }
+            r.name     = fields[0];
+            r.type     = fields[1];
+            r.threads  = atoi(fields[2].c_str());
+            r.medianMs = atof(fields[5].c_str());
+            r.p99Ms    = atof(fields[7].c_str());
+            r.gflops   = atof(fields[8].c_str());
+        }
+        results[r.name + "@" + std::to_string(r.threads)] = r;
+    }
+    return results;
+}
+
+static int _compare(const char* baseFile, const char* newFile, double threshold) {
+    auto base       = _readResults(baseFile);
+    auto current    = _readResults(newFile);
+    int regressions = 0;
+    printf("%-48s %4s %12s %12s %9s %9s\n", "case", "thr", "base(ms)", "new(ms)", "median", "p99");
+    for (auto& iter : current) {
+        auto baseIter = base.find(iter.first);
+        if (baseIter == base.end()) {
+            printf("%-48s %4d %12s %12.4f %9s %9s\n", iter.second.name.c_str(), iter.second.threads, "-",
+                   iter.second.medianMs, "new", "");
+            continue;
+        }
+        auto& b         = baseIter->second;
+        auto& n         = iter.second;
+        double median   = b.medianMs > 0.0 ? (n.medianMs - b.medianMs) / b.medianMs * 100.0 : 0.0;
+        double p99      = b.p99Ms > 0.0 ? (n.p99Ms - b.p99Ms) / b.p99Ms * 100.0 : 0.0;
+        const bool slow = median > threshold;
+        if (slow) {
+            regressions++;
+        }
+        printf("%-48s %4d %12.4f %12.4f %+8.1f%% %+8.1f%%%s\n", n.name.c_str(), n.threads, b.medianMs, n.medianMs,
+               median, p99, slow ? "  <-- regression" : "");
+    }
+    for (auto& iter : base) {
+        if (current.find(iter.first) == current.end()) {
+            printf("%-48s %4d %12.4f %12s %9s %9s\n", iter.second.name.c_str(), iter.second.threads,
+                   iter.second.medianMs, "-", "removed", "");
+        }
+    }
+    printf("%d regression(s) above %.1f%%\n", regressions, threshold);
+    return regressions > 0 ? 1 : 0;
+}
+
+static std::vector<int> _parseList(const char* str) {
+    std::vector<int> values;
+    std::istringstream stream(str);
+    std::string field;
+    while (std::getline(stream, field, ',')) {
+        auto value = atoi(field.c_str());
+        if (value > 0) {
+            values.push_back(value);
+        }
+    }
+    return values;
+}
+
+static void _usage(const char* exe) {
+    printf("Usage: %s [-l loop_count] [-w warmup] [-t thread_list] [-k case_filter] [-f csv|json] [-o output]\n", exe);
+    printf("       %s -c base_result new_result [threshold_percent]\n", exe);
+    printf("  -t   comma separated thread numbers to sweep, default 1,2,4\n");
+    printf("  -k   only run cases whose name contains the given string\n");
+    printf("  -c   compare two result files by median latency, exit 1 if any case is slower than threshold\n");
+}
+
+int main(int argc, const char* argv[]) {
+    int loop                 = 50;
+    int warmup               = 5;
+    std::vector<int> threads = {1, 2, 4};
+    std::string filter;
+    std::string output;
+    bool json = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-c") {
+            if (i + 2 >= argc) {
+                _usage(argv[0]);
+                return 1;
+            }
+            double threshold = (i + 3 < argc) ? atof(argv[i + 3]) : 5.0;
+            return _compare(argv[i + 1], argv[i + 2], threshold);
+        }
+        if (arg == "-h" || i + 1 >= argc) {
+            _usage(argv[0]);
+            return 1;
+        }
+        const char* value = argv[++i];
+        if (arg == "-l") {
+            loop = std::max(1, atoi(value));
+        } else if (arg == "-w") {
+            warmup = std::max(0, atoi(value));
+        } else if (arg == "-t") {
+            threads = _parseList(value);
+        } else if (arg == "-k") {
+            filter = value;
+        } else if (arg == "-f") {
+            json = std::string(value) == "json";
+        } else if (arg == "-o") {
+            output = value;
+        } else {
+            _usage(argv[0]);
+            return 1;
+        }
+    }
+    if (threads.empty()) {
+        _usage(argv[0]);
+        return 1;
+    }
+
+    std::cout << "MNN op benchmark, loop = " << loop << ", warmup = " << warmup << std::endl;
+    std::vector<OpResult> results;
+    printf("%-48s %4s %10s %10s %10s %10s\n", "case", "thr", "min(ms)", "median(ms)", "p99(ms)", "GFLOP/s");
+    for (auto& opCase : _allCases()) {
+        if (!filter.empty() && opCase.name.find(filter) == std::string::npos) {
+            continue;
+        }
+        for (auto t : threads) {
+            // fixed seed so weights and inputs are identical between runs being compared
+            srand(0);
+            auto costs = _runCase(opCase, t, loop, warmup);
+            if (costs.empty()) {
+                MNN_ERROR("Run %s failed\n", opCase.name.c_str());
+                continue;
+            }
+            auto r = _summary(opCase, t, costs);
+            printf("%-48s %4d %10.4f %10.4f %10.4f %10.3f\n", r.name.c_str(), t, r.minMs, r.medianMs, r.p99Ms,
+                   r.gflops);
+            results.emplace_back(r);
+        }
+    }
+    if (!output.empty()) {
+        _writeResults(results, output, json);
+    }
+    return 0;
+}
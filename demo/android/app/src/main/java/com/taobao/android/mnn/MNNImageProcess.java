@@ -54,7 +54,11 @@ public class MNNImageProcess {
         /**
          * BICUBIC
          */
-        BICUBIC(2);
+        BICUBIC(2),
+        /**
+         * AREA
+         */
+        AREA(3);
 
         public int type;
 
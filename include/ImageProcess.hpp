@@ -22,9 +22,12 @@ enum ImageFormat {
     GRAY,
     BGRA,
     YUV_NV21 = 11,
+    YUV_NV12 = 12,
+    YUV_I420 = 13,
 };
 
-enum Filter { NEAREST = 0, BILINEAR = 1, BICUBIC = 2 };
+/** AREA averages source covered by each dest pixel, for downscale without aliasing */
+enum Filter { NEAREST = 0, BILINEAR = 1, BICUBIC = 2, AREA = 3 };
 
 enum Wrap { CLAMP_TO_EDGE = 0, ZERO = 1, REPEAT = 2 };
 
@@ -52,6 +55,9 @@ public:
 
         /** edge wrapper */
         Wrap wrap = CLAMP_TO_EDGE;
+
+        /** number of threads converting bands of rows */
+        int numThread = 1;
     };
 
 public:
@@ -100,6 +106,43 @@ public:
      */
     ErrorCode convert(const uint8_t* source, int iw, int ih, int stride, Tensor* dest);
 
+    /** source image of batched convert */
+    struct Image {
+        /** source data */
+        const uint8_t* source = nullptr;
+        /** source width */
+        int width = 0;
+        /** source height */
+        int height = 0;
+        /** number of elements per row, 0 for packed rows */
+        int stride = 0;
+        /** transform from destination to source, as set by setMatrix */
+        Matrix matrix;
+    };
+    /**
+     * @brief convert each source image into batch of given tensor at same index, with its own transform. rows of
+     *        all images are converted in parallel.
+     * @param images    source images, no more than batch of tensor.
+     * @param dest      given tensor.
+     * @return result code.
+     */
+    ErrorCode convert(const std::vector<Image>& images, Tensor* dest);
+
+    /**
+     * @brief crop regions of one source into batch of given tensor, region i into batch i. each region is given by
+     *        transform from destination to source, eg. by Matrix::setRectToRect or Matrix::setPolyToPoly for rotated
+     *        regions. rows of all regions are converted in parallel.
+     * @param source    source data.
+     * @param iw        source width.
+     * @param ih        source height.
+     * @param stride    number of elements per row, 0 for packed rows.
+     * @param matrices  transform of each region, no more than batch of tensor.
+     * @param dest      given tensor.
+     * @return result code.
+     */
+    ErrorCode convert(const uint8_t* source, int iw, int ih, int stride, const std::vector<Matrix>& matrices,
+                      Tensor* dest);
+
     /**
      * @brief create tensor with given data.
      * @param w     image width.
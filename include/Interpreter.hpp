@@ -61,6 +61,34 @@ struct ScheduleConfig {
 
     /** extra backend config */
     BackendConfig* backendConfig = nullptr;
+
+    /**
+     * create execution and transform weights of an op on its first execution rather than in resize, so that ops
+     * skipped by callbacks of `runSessionWithCallBack` cost nothing. CPU only, model should not be released unless
+     * it is created by `createFromFileMapped`.
+     */
+    bool lazyExecution = false;
+
+    /**
+     * memory budget of weights of lazily created executions in bytes, least recently executed ones are evicted once
+     * it is exceeded, and created again on their next execution. 0 for unlimited.
+     */
+    size_t lazyMemoryBudget = 0;
+
+    /** input fed with uint8 image rather than normalized float */
+    struct ImageInput {
+        /** name of input tensor, empty for the only input */
+        std::string name;
+        /** normalized as (image - mean) * normal per channel, as CV::ImageProcess::Config does */
+        float mean[4]   = {0.0f, 0.0f, 0.0f, 0.0f};
+        float normal[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    };
+    /**
+     * inputs whose tensors stay uint8 NC4HW4 so that images are converted into them without turning float. normal
+     * is folded into weights of convolutions reading them, and mean is subtracted as they read the image. an input is
+     * left float if it is read by anything else than CPU convolutions of at most 4 input channels.
+     */
+    std::vector<ImageInput> imageInputs;
 };
 
 class Session;
@@ -87,6 +115,33 @@ protected:
     Info* mContent;
 };
 
+/** memory footprint of session, in bytes */
+struct SessionMemoryInfo {
+    /** memory attributed to one op */
+    struct OpMemory {
+        /** op name */
+        std::string name;
+        /** op type */
+        std::string type;
+        /** memory allocated while creating execution, e.g. transformed weights */
+        size_t weight = 0;
+        /** memory newly acquired while resizing execution, e.g. caches and temporary buffers */
+        size_t scratch = 0;
+        /** execution is created on first execution, see `ScheduleConfig::lazyExecution` */
+        bool lazy = false;
+    };
+    /** model buffer held by interpreter, shared by all sessions. 0 after `releaseModel` or if model is mapped */
+    size_t modelBuffer = 0;
+    /** sum of weight of all ops */
+    size_t weight = 0;
+    /** tensors, buffer pools and scratch held by session, scratch of lazy executions excluded */
+    size_t dynamic = 0;
+    /** modelBuffer + weight + dynamic */
+    size_t total = 0;
+    /** per op memory in execution order */
+    std::vector<OpMemory> ops;
+};
+
 typedef std::function<bool(const std::vector<Tensor*>&, const std::string& /*opName*/)> TensorCallBack;
 typedef std::function<bool(const std::vector<Tensor*>&, const OperatorInfo*)> TensorCallBackWithInfo;
 
@@ -106,6 +161,15 @@ public:
      * @return created net if success, NULL otherwise.
      */
     static Interpreter* createFromBuffer(const void* buffer, size_t size);
+    /**
+     * @brief create net from file in low memory mode. the file is mapped rather than read into memory, and each
+     *        weight is transformed by its execution straight from the mapping, whose pages are dropped once consumed.
+     *        so raw weights are never resident along with transformed ones. call `releaseModel` once all sessions
+     *        are created. fall back to `createFromFile` if mapping is not supported.
+     * @param file  given file.
+     * @return created net if success, NULL otherwise.
+     */
+    static Interpreter* createFromFileMapped(const char* file);
     ~Interpreter();
 
 public:
@@ -200,6 +264,58 @@ public:
      */
     const std::map<std::string, Tensor*>& getSessionInputAll(const Session* session) const;
 
+    enum SessionInfoCode {
+        /** memory footprint, ptr should be SessionMemoryInfo* */
+        MEMORY = 0,
+
+        /** sum of flops of all ops in M, ptr should be float* */
+        FLOPS = 1,
+
+        ALL
+    };
+
+    /**
+     * @brief get session info. memory is counted from allocations made by MNN on host, buffers held by
+     *        device backends are not included. memory created by other threads while resizing may be
+     *        counted in.
+     * @param session   given session.
+     * @param code      info code.
+     * @param ptr       output pointer, type depends on code.
+     * @return true if code is supported, false otherwise.
+     */
+    bool getSessionInfo(const Session* session, SessionInfoCode code, void* ptr) const;
+
+    /**
+     * @brief keep hidden and cell state of recurrent ops (LSTM, RNNSequenceGRU) between runs of session, so that a
+     *        stream could be fed chunk by chunk, each run starting from state left by last one. state starts from
+     *        zero, and is reset when stateful mode changes or session is resized.
+     * @param session   given session.
+     * @param stateful  stateful or not.
+     */
+    void setSessionStateful(Session* session, bool stateful);
+    /**
+     * @brief reset state of all recurrent ops in session to zero, e.g. at start of a new stream.
+     * @param session   given session.
+     */
+    void resetSessionState(Session* session);
+    /**
+     * @brief get state tensors of given recurrent op. LSTM keeps {hidden, cell}, RNNSequenceGRU keeps {hidden} or
+     *        {forward hidden, backward hidden} if bidirectional, each in shape of [batch, numUnits]. state tensors
+     *        may be on device, use copyToHostTensor / copyFromHostTensor to access them like session inputs.
+     * @param session   given session.
+     * @param name      given op name.
+     * @return state tensors, empty if op is not found, keeps no state or is lazy and not run yet.
+     */
+    std::vector<Tensor*> getSessionState(const Session* session, const char* name) const;
+    /**
+     * @brief set state of given recurrent op from host tensors, in the order of `getSessionState`.
+     * @param session   given session.
+     * @param name      given op name.
+     * @param states    host tensors of state.
+     * @return false if op keeps no state or states mismatch, true otherwise.
+     */
+    bool setSessionState(Session* session, const char* name, const std::vector<Tensor*>& states);
+
 public:
     /**
      * @brief resize given tensor.
@@ -233,6 +349,7 @@ public:
 
 private:
     static Interpreter* createFromBufferInternal(Content* net);
+    void _resizeNewSession(Session* session);
 
     Content* mNet = nullptr;
     Interpreter(Content* net);
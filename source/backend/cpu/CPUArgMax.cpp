@@ -10,6 +10,7 @@
 #include <float.h>
 #include "CPUBackend.hpp"
 #include "CommonOptFunction.h"
+#include "TopKFunction.hpp"
 
 namespace MNN {
 
@@ -70,10 +71,24 @@ ErrorCode CPUArgMax::onExecute(const std::vector<Tensor *> &inputs, const std::v
 
     float *srcOrigin = mInputBuffer.host<float>(); // used as NCHW input
     float *dstOrigin = mBuffer.host<float>();
+    std::vector<int32_t> topIndexes(mTopk);
     for (int i = 0; i < num; ++i) {
         float *iptr = srcOrigin + i * dim;
         float *optr = dstOrigin + i * keyExtent;
 
+        // without threshold, or only the max one is needed which passes threshold if any one does
+        if (mTopk <= dim && (1 == mTopk || !mSoftmaxThreshold)) {
+            TopKFunction::selectTopK(iptr, dim, mTopk, topIndexes.data());
+            bool passed = iptr[topIndexes[0]] >= softmaxThreshold;
+            for (int j = 0; j < mTopk; ++j) {
+                optr[j] = passed ? topIndexes[j] : 0.f;
+                if (mOutMaxVal) {
+                    optr[mTopk + j] = passed ? iptr[topIndexes[j]] : 0.f;
+                }
+            }
+            continue;
+        }
+
         using sortElementT = std::tuple<int, float>;
 #define element_index(ele) (std::get<0>(ele))
 #define element_value(ele) (std::get<1>(ele))
@@ -179,7 +179,7 @@ void CPUBackend::onCopyBuffer(const Tensor* srcTensor, const Tensor* dstTensor)
     }
 
     if (srcTensor->getDimensionType() == Tensor::TENSORFLOW || dstTensor->getDimensionType() == Tensor::TENSORFLOW) {
-        CPUTensorConverter::convert(srcTensor, dstTensor);
+        CPUTensorConverter::convert(srcTensor, dstTensor, threadNumber());
         return;
     }
 
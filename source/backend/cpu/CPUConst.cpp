@@ -23,6 +23,7 @@ static void *_blobData(const Blob *b) {
             result = (void *)b->int32s()->Data();
             break;
         case DataType_DT_QUINT8:
+        case DataType_DT_UINT8:
             return (void *)b->uint8s()->Data();
             break;
         default:
@@ -41,7 +42,11 @@ ErrorCode CPUConst::onResize(const std::vector<Tensor *> &inputs, const std::vec
 
     auto output    = outputs[0];
     auto parameter = mOp->main_as_Blob();
-    memcpy(output->host<float>(), MNN::_blobData(parameter), output->size());
+    auto data      = MNN::_blobData(parameter);
+    // output may be left in model
+    if (output->host<void>() != data) {
+        memcpy(output->host<float>(), data, output->size());
+    }
     return NO_ERROR;
 }
 
@@ -13,7 +13,7 @@
 #include "Matrix.hpp"
 #include "TensorUtils.hpp"
 #include "compute/ConvOpt.h"
-#include "compute/DeconvolutionWithStride.hpp"
+#include "compute/DeconvolutionSubPixel.hpp"
 
 #ifdef MNN_USE_NEON
 #include <arm_neon.h>
@@ -245,10 +245,8 @@ public:
                                 const MNN::Op* op, Backend* backend) const {
         auto convOp = op->main_as_Convolution2D();
         auto common = convOp->common();
-        if (common->strideY() > 1 || common->strideX() > 1) {
-            if (common->dilateX() == 1 && common->dilateY() == 1) {
-                return new DeconvolutionWithStride(op, backend);
-            }
+        if (common->dilateX() == 1 && common->dilateY() == 1) {
+            return new DeconvolutionSubPixel(op, backend);
         }
 
         return new CPUDeconvolution(op, backend);
@@ -8,78 +8,27 @@
 
 #include "CPUDetectionOutput.hpp"
 #include <math.h>
-#include <list>
+#include <algorithm>
 #include "AutoTime.hpp"
 #include "CPUBackend.hpp"
 #include "CommonOptFunction.h"
+#include "Concurrency.h"
+#include "TensorUtils.hpp"
 
 namespace MNN {
 
 CPUDetectionOutput::CPUDetectionOutput(Backend *backend, int classCount, float nmsThreshold, int keepTopK,
-                                       float confidenceThreshold, float objectnessScore)
+                                       int nmsTopK, float confidenceThreshold, float objectnessScore)
     : Execution(backend),
       mClassCount(classCount),
       mNMSThreshold(nmsThreshold),
+      mNMSTopK(nmsTopK),
       mKeepTopK(keepTopK),
       mConfidenceThreshold(confidenceThreshold),
       mObjectnessScoreThreshold(objectnessScore) {
     // nothing to do
 }
 
-using score_box_t = std::tuple<float, float, float, float, int, float>;
-#define box_rect(xmin, ymin, xmax, ymax, label, score) std::make_tuple((xmin), (ymin), (xmax), (ymax), (label), (score))
-#define box_rect_xmin(rect) (std::get<0>(rect))
-#define box_rect_ymin(rect) (std::get<1>(rect))
-#define box_rect_xmax(rect) (std::get<2>(rect))
-#define box_rect_ymax(rect) (std::get<3>(rect))
-#define box_label(rect) (std::get<4>(rect))
-#define box_score(rect) (std::get<5>(rect))
-
-static inline float intersectionArea(score_box_t a, score_box_t b) {
-    float axmin = box_rect_xmin(a), bxmin = box_rect_xmin(b);
-    float axmax = box_rect_xmax(a), bxmax = box_rect_xmax(b);
-    float aymin = box_rect_ymin(a), bymin = box_rect_ymin(b);
-    float aymax = box_rect_ymax(a), bymax = box_rect_ymax(b);
-    if (axmin > bxmax || axmax < bxmin || aymin > bymax || aymax < bymin)
-        return 0.f;
-
-    float interWidth  = fmin(axmax, bxmax) - fmax(axmin, bxmin);
-    float interHeight = fmin(aymax, bymax) - fmax(aymin, bymin);
-    return interWidth * interHeight;
-}
-
-static void pickBoxes(const std::vector<score_box_t> &boxes, std::list<long> &picked, float nmsThreshold) {
-    long n = boxes.size();
-    std::vector<float> areas;
-    areas.resize(n);
-    for (int i = 0; i < n; i++) {
-        auto box     = boxes[i];
-        float width  = box_rect_xmax(box) - box_rect_xmin(box);
-        float height = box_rect_ymax(box) - box_rect_ymin(box);
-        areas[i]     = width * height;
-    }
-
-    for (int i = 0; i < n; i++) {
-        auto a = boxes[i];
-
-        bool keep = true;
-        for (auto pick : picked) {
-            auto b = boxes[pick];
-
-            // intersection over union
-            float interArea = intersectionArea(a, b);
-            float unionArea = areas[i] + areas[pick] - interArea;
-            if (interArea / unionArea > nmsThreshold) {
-                keep = false;
-                break;
-            }
-        }
-        if (keep) {
-            picked.push_back(i);
-        }
-    }
-}
-
 ErrorCode CPUDetectionOutput::onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) {
     // location transform space
     auto &location = inputs[0]->buffer();
@@ -91,11 +40,6 @@ ErrorCode CPUDetectionOutput::onResize(const std::vector<Tensor *> &inputs, cons
     memcpy(mConfidence.buffer().dim, confidence.dim, sizeof(halide_dimension_t) * confidence.dimensions);
     backend()->onAcquireBuffer(&mConfidence, Backend::DYNAMIC);
 
-    // priorbox transform space
-    auto &priorbox = inputs[2]->buffer();
-    memcpy(mPriorbox.buffer().dim, priorbox.dim, sizeof(halide_dimension_t) * priorbox.dimensions);
-    backend()->onAcquireBuffer(&mPriorbox, Backend::DYNAMIC);
-
     // refine
     if (inputs.size() >= 5) {
         auto &armconfidence = inputs[3]->buffer();
@@ -112,7 +56,6 @@ ErrorCode CPUDetectionOutput::onResize(const std::vector<Tensor *> &inputs, cons
     // release temp buffer space
     backend()->onReleaseBuffer(&mLocation, Backend::DYNAMIC);
     backend()->onReleaseBuffer(&mConfidence, Backend::DYNAMIC);
-    backend()->onReleaseBuffer(&mPriorbox, Backend::DYNAMIC);
     return NO_ERROR;
 }
 
@@ -127,9 +70,6 @@ ErrorCode CPUDetectionOutput::onExecute(const std::vector<Tensor *> &inputs, con
                 location->channel());
     MNNUnpackC4(mConfidence.host<float>(), confidence->host<float>(), confidence->width() * confidence->height(),
                 confidence->channel());
-    MNNUnpackC4(mPriorbox.host<float>(), priorbox->host<float>(), priorbox->width() * priorbox->height(),
-                priorbox->channel());
-
     bool refineDet = inputs.size() >= 5;
     if (refineDet) {
         Tensor *armconfidence = inputs[3];
@@ -140,96 +80,89 @@ ErrorCode CPUDetectionOutput::onExecute(const std::vector<Tensor *> &inputs, con
                     armlocation->width() * armlocation->height(), armlocation->channel());
     }
 
-    auto priorCount       = priorbox->height() / 4;
-    auto locationPtr      = mLocation.host<const float>();
-    auto confidencePtr    = mConfidence.host<const float>();
-    auto priorboxPtr      = mPriorbox.host<const float>();
-    auto variancePtr      = mPriorbox.host<const float>() + priorbox->height() * 1;
-    auto armlocationPtr   = refineDet ? mArmLocation.host<const float>() : NULL;
-    auto armconfidencePtr = refineDet ? mArmConfidence.host<const float>() : NULL;
-
-    auto boxes      = std::shared_ptr<float>(new float[4 * priorCount], [](float *p) { delete[] p; });
-    auto decodeBoxs = [&boxes, priorCount, variancePtr](const float *priorboxPtr, const float *locationPtr) {
-        for (int i = 0; i < priorCount; i++) {
-            auto loc = locationPtr + i * 4;
-            auto pb  = priorboxPtr + i * 4;
-            auto var = variancePtr + i * 4;
-            auto box = boxes.get() + i * 4;
-
-            float pbW  = pb[2] - pb[0];
-            float pbH  = pb[3] - pb[1];
-            float pbCX = (pb[0] + pb[2]) * 0.5f;
-            float pbCY = (pb[1] + pb[3]) * 0.5f;
-
-            float boxCX = var[0] * loc[0] * pbW + pbCX;
-            float boxCY = var[1] * loc[1] * pbH + pbCY;
-            float boxW  = exp(var[2] * loc[2]) * pbW;
-            float boxH  = exp(var[3] * loc[3]) * pbH;
-
-            box[0] = boxCX - boxW * 0.5f;
-            box[1] = boxCY - boxH * 0.5f;
-            box[2] = boxCX + boxW * 0.5f;
-            box[3] = boxCY + boxH * 0.5f;
-        }
-    };
+    // priors and variances are read from output of PriorBox in place
+    auto priorCount    = priorbox->height() / 4;
+    auto priorboxPtr   = priorbox->host<float>();
+    auto variancePtr   = priorboxPtr + priorbox->height() * priorbox->width();
+    int priorStride    = 1;
+    auto locationPtr   = mLocation.host<const float>();
+    auto confidencePtr = mConfidence.host<const float>();
+    if (TensorUtils::getDescribe(priorbox)->dimensionFormat == MNN_DATA_FORMAT_NC4HW4) {
+        variancePtr = priorboxPtr + 1;
+        priorStride = 4;
+    }
+
     if (refineDet) {
-        decodeBoxs(priorboxPtr, armlocationPtr);
-        decodeBoxs(boxes.get(), locationPtr);
+        DetectionPostProcess::decodeBoxes(mArmBoxes, priorboxPtr, variancePtr, priorStride,
+                                          mArmLocation.host<const float>(), priorCount);
+        DetectionPostProcess::decodeBoxes(mBoxes, mArmBoxes, variancePtr, priorStride, locationPtr);
     } else {
-        decodeBoxs(priorboxPtr, locationPtr);
+        DetectionPostProcess::decodeBoxes(mBoxes, priorboxPtr, variancePtr, priorStride, locationPtr, priorCount);
     }
 
-    // sort and nms for each class
-    std::vector<score_box_t> allClassBoxes;
-    auto compareFunction = [](const score_box_t &a, const score_box_t &b) { return box_score(a) > box_score(b); };
-    for (int i = 1; i < mClassCount; i++) { // start from 1 to ignore background class
-        std::vector<score_box_t> classBoxes;
-
-        // filter by confidenceThreshold
+    // filter, sort and nms for each class, start from 1 to ignore background class
+    const float *scorePtr = confidencePtr;
+    if (refineDet) {
+        auto armconfidencePtr = mArmConfidence.host<const float>();
+        mRefinedScores.resize(priorCount * mClassCount);
         for (int j = 0; j < priorCount; j++) {
-            float score = confidencePtr[j * mClassCount + i];
-            if (refineDet && (armconfidencePtr[j * 2 + 1] < mObjectnessScoreThreshold)) {
-                score = 0.0;
-            }
-            if (score > mConfidenceThreshold) {
-                const float *box = boxes.get() + 4 * j;
-                classBoxes.push_back(box_rect(box[0], box[1], box[2], box[3], i, score));
+            bool ignore = armconfidencePtr[j * 2 + 1] < mObjectnessScoreThreshold;
+            for (int i = 0; i < mClassCount; i++) {
+                mRefinedScores[j * mClassCount + i] = ignore ? 0.0f : confidencePtr[j * mClassCount + i];
             }
         }
-
-        // sort inplace
-        std::sort(classBoxes.begin(), classBoxes.end(), compareFunction);
-
-        // apply nms
-        std::list<long> picked;
-        pickBoxes(classBoxes, picked, mNMSThreshold);
-
-        // select
-        for (auto index : picked) {
-            allClassBoxes.push_back(classBoxes[index]);
+        scorePtr = mRefinedScores.data();
+    }
+    mPicked.resize(mClassCount);
+    auto threadNumber = std::max(1, std::min(static_cast<CPUBackend *>(backend())->threadNumber(), mClassCount - 1));
+    auto boxes        = &mBoxes;
+    auto picked       = mPicked.data();
+    auto classCount   = mClassCount;
+    auto threshold    = mConfidenceThreshold;
+    auto nmsThreshold = mNMSThreshold;
+    auto nmsTopK      = mNMSTopK;
+    MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+        std::vector<int> candidates;
+        for (int i = (int)tId + 1; i < classCount; i += threadNumber) {
+            DetectionPostProcess::filterByScore(candidates, scorePtr + i, classCount, priorCount, threshold, nmsTopK);
+            DetectionPostProcess::nonMaxSuppression(picked[i], candidates, *boxes, scorePtr + i, classCount,
+                                                    nmsThreshold, 0);
         }
     }
+    MNN_CONCURRENCY_END();
 
-    // global sort inplace
-    std::sort(allClassBoxes.begin(), allClassBoxes.end(), compareFunction);
-
-    // set width
-    int numDetected = (int)allClassBoxes.size();
-    if (numDetected > mKeepTopK) {
+    // global sort, only keepTopK of them are needed
+    std::vector<std::pair<int, int>> allClassBoxes; // (class, prior)
+    for (int i = 1; i < mClassCount; i++) {
+        for (auto index : mPicked[i]) {
+            allClassBoxes.emplace_back(std::make_pair(i, index));
+        }
+    }
+    int numDetected = std::min((int)allClassBoxes.size(), priorCount);
+    if (mKeepTopK >= 0 && numDetected > mKeepTopK) {
         numDetected = mKeepTopK;
     }
+    std::partial_sort(allClassBoxes.begin(), allClassBoxes.begin() + numDetected, allClassBoxes.end(),
+                      [scorePtr, classCount](const std::pair<int, int> &a, const std::pair<int, int> &b) {
+                          auto scoreA = scorePtr[a.second * classCount + a.first];
+                          auto scoreB = scorePtr[b.second * classCount + b.first];
+                          return scoreA > scoreB || (scoreA == scoreB && a < b);
+                      });
+
+    // set width
     output->buffer().dim[2].extent = numDetected;
 
     // write data
     auto outPtr = output->host<float>();
     for (int i = 0; i < numDetected; i++, outPtr += 6 * 4) {
-        auto box      = allClassBoxes[i];
-        outPtr[0 * 4] = box_label(box);
-        outPtr[1 * 4] = box_score(box);
-        outPtr[2 * 4] = box_rect_xmin(box);
-        outPtr[3 * 4] = box_rect_ymin(box);
-        outPtr[4 * 4] = box_rect_xmax(box);
-        outPtr[5 * 4] = box_rect_ymax(box);
+        auto label    = allClassBoxes[i].first;
+        auto index    = allClassBoxes[i].second;
+        outPtr[0 * 4] = label;
+        outPtr[1 * 4] = scorePtr[index * classCount + label];
+        outPtr[2 * 4] = mBoxes.xmin()[index];
+        outPtr[3 * 4] = mBoxes.ymin()[index];
+        outPtr[4 * 4] = mBoxes.xmax()[index];
+        outPtr[5 * 4] = mBoxes.ymax()[index];
     }
 
     return NO_ERROR;
@@ -240,7 +173,7 @@ public:
     virtual Execution *onCreate(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs,
                                 const MNN::Op *op, Backend *backend) const {
         auto d = op->main_as_DetectionOutput();
-        return new CPUDetectionOutput(backend, d->classCount(), d->nmsThresholdold(), d->keepTopK(),
+        return new CPUDetectionOutput(backend, d->classCount(), d->nmsThresholdold(), d->keepTopK(), d->nmsTopK(),
                                       d->confidenceThreshold(), d->objectnessScore());
     }
 };
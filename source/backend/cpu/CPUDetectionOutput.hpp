@@ -9,14 +9,15 @@
 #ifndef CPUDetectionOutput_hpp
 #define CPUDetectionOutput_hpp
 
+#include "DetectionPostProcess.hpp"
 #include "Execution.hpp"
 
 namespace MNN {
 
 class CPUDetectionOutput : public Execution {
 public:
-    CPUDetectionOutput(Backend *backend, int classCount, float nmsThreshold, int keepTopK, float confidenceThreshold,
-                       float objectnessScore);
+    CPUDetectionOutput(Backend *backend, int classCount, float nmsThreshold, int keepTopK, int nmsTopK,
+                       float confidenceThreshold, float objectnessScore);
     virtual ~CPUDetectionOutput() = default;
     virtual ErrorCode onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
     virtual ErrorCode onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
@@ -24,11 +25,15 @@ public:
 private:
     Tensor mLocation;
     Tensor mConfidence;
-    Tensor mPriorbox;
     Tensor mArmLocation;
     Tensor mArmConfidence;
+    DetectionBoxes mBoxes;
+    DetectionBoxes mArmBoxes;
+    std::vector<float> mRefinedScores;
+    std::vector<std::vector<int>> mPicked;
     int mClassCount;
     float mNMSThreshold;
+    int mNMSTopK;
     int mKeepTopK;
     float mConfidenceThreshold;
     float mObjectnessScoreThreshold;
@@ -9,17 +9,82 @@
 #include "CPUGatherV2.hpp"
 #include "CPUBackend.hpp"
 #include "CommonOptFunction.h"
+#include "Concurrency.h"
 #include "Macro.h"
 
+#if defined(__GNUC__) || defined(__clang__)
+#define GATHER_PREFETCH(p) __builtin_prefetch(p)
+#else
+#define GATHER_PREFETCH(p)
+#endif
+
 namespace MNN {
+// rows looked up ahead of the one copied, rows of a large table are rarely in cache
+static const int gPrefetchDistance = 4;
+// bytes of a row to prefetch, hardware prefetcher follows along the rest
+static const int gPrefetchBytes = 256;
+
+static inline void _prefetchRow(const void *row, int bytes) {
+    auto start = (const uint8_t *)row;
+    for (int i = 0; i < bytes && i < gPrefetchBytes; i += 64) {
+        GATHER_PREFETCH(start + i);
+    }
+}
+
+// rows [start, end) of output [outside][bags][inside], each of bag rows of [outside][limit][inside] pooled
+template <typename T>
+static void _gatherRows(T *dst, const T *src, const int32_t *indices, int start, int end, int bags, int bag, int limit,
+                        int inside, GatherCombiner combiner) {
+    const int rowBytes = inside * sizeof(T);
+    for (int u = start; u < end; ++u) {
+        const int o         = u / bags;
+        const int b         = u % bags;
+        const T *table      = src + (size_t)o * limit * inside;
+        const int32_t *bagI = indices + b * bag;
+        auto dstRow         = dst + (size_t)u * inside;
+        // the rows of next bags
+        const int ahead = (b + gPrefetchDistance) * bag;
+        if (ahead < bags * bag) {
+            for (int j = 0; j < bag; ++j) {
+                _prefetchRow(table + (size_t)indices[ahead + j] * inside, rowBytes);
+            }
+        }
+        ::memcpy(dstRow, table + (size_t)bagI[0] * inside, rowBytes);
+        if (GatherCombiner_NONE == combiner) {
+            continue;
+        }
+        for (int j = 1; j < bag; ++j) {
+            auto row = table + (size_t)bagI[j] * inside;
+            for (int i = 0; i < inside; ++i) {
+                dstRow[i] += row[i];
+            }
+        }
+        if (GatherCombiner_MEAN == combiner) {
+            for (int i = 0; i < inside; ++i) {
+                dstRow[i] = dstRow[i] / (T)bag;
+            }
+        }
+    }
+}
 
 template <typename T>
-CPUGatherV2<T>::CPUGatherV2(Backend *b, const MNN::Op *op) : MNN::Execution(b), mOp(op) {
-    // nothing to do
+CPUGatherV2<T>::CPUGatherV2(Backend *b, const MNN::Op *op) : MNN::Execution(b) {
+    if (nullptr != op->main_as_GatherV2()) {
+        mCombiner = op->main_as_GatherV2()->combiner();
+    }
 }
 
 template <typename T>
 ErrorCode CPUGatherV2<T>::onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) {
+    // int64 indices are narrowed into mIndices, which is only filled in onExecute
+    auto indices = inputs[1];
+    const int N  = indices->elementSize();
+    if (64 == indices->getType().bits && mIndices.size() != N) {
+        mIndices.reset(N);
+        if (N > 0 && nullptr == mIndices.get()) {
+            return OUT_OF_MEMORY;
+        }
+    }
     return NO_ERROR;
 }
 
@@ -42,20 +107,61 @@ ErrorCode CPUGatherV2<T>::onExecute(const std::vector<Tensor *> &inputs, const s
     const int N             = indices->elementSize();
     MNN_ASSERT(gatherDimSize <= std::numeric_limits<int32_t>::max());
 
-    // TODO : CURRUNT ONLY SUPPORT AXIS == 0
-    MNN_ASSERT(0 == axis);
-    const int limit          = params->length(0);
-    const int firstDimStride = params->buffer().dim[0].stride;
-    const int *indicesPtr    = indices->host<int32_t>();
-    const auto inputPtr      = params->host<T>();
-    auto outputPtr           = output->host<T>();
-    for (int i = 0; i < N; i++) {
-        if (indicesPtr[i] < 0 || indicesPtr[i] > limit) {
-            return INPUT_DATA_ERROR;
+    int outside = 1;
+    for (int i = 0; i < axis; ++i) {
+        outside *= params->length(i);
+    }
+    int inside = 1;
+    for (int i = axis + 1; i < params->dimensions(); ++i) {
+        inside *= params->length(i);
+    }
+    const auto combiner = mCombiner;
+    int bag = 1;
+    if (GatherCombiner_NONE != combiner) {
+        bag = indices->dimensions() > 0 ? indices->length(indices->dimensions() - 1) : 0;
+    }
+    if (0 == N || 0 == inside || bag <= 0) {
+        return NO_ERROR;
+    }
+
+    // check all indices before any thread starts
+    const int limit         = gatherDimSize;
+    const int32_t *indexPtr = nullptr;
+    if (64 == indices->getType().bits) {
+        MNN_ASSERT(mIndices.size() == N);
+        auto src = indices->host<int64_t>();
+        for (int i = 0; i < N; ++i) {
+            if (src[i] < 0 || src[i] >= limit) {
+                return INPUT_DATA_ERROR;
+            }
+            mIndices.get()[i] = (int32_t)src[i];
+        }
+        indexPtr = mIndices.get();
+    } else {
+        indexPtr = indices->host<int32_t>();
+        for (int i = 0; i < N; ++i) {
+            if (indexPtr[i] < 0 || indexPtr[i] >= limit) {
+                return INPUT_DATA_ERROR;
+            }
         }
-        memcpy(outputPtr + i * firstDimStride, inputPtr + firstDimStride * indicesPtr[i], sizeof(T) * firstDimStride);
     }
 
+    const int bags    = N / bag;
+    const int total   = outside * bags;
+    const auto srcPtr = params->host<T>();
+    auto dstPtr       = output->host<T>();
+    int threadNumber  = ((CPUBackend *)backend())->threadNumber();
+    // not worth waking threads for a few short rows
+    if ((int64_t)total * bag * inside < 16384) {
+        threadNumber = 1;
+    }
+    threadNumber = ALIMAX(1, ALIMIN(threadNumber, total));
+    MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+        const int start = (int)(((int64_t)total * tId) / threadNumber);
+        const int end   = (int)(((int64_t)total * (tId + 1)) / threadNumber);
+        _gatherRows<T>(dstPtr, srcPtr, indexPtr, start, end, bags, bag, limit, inside, combiner);
+    }
+    MNN_CONCURRENCY_END();
     return NO_ERROR;
 }
 
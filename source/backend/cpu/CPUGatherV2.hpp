@@ -9,7 +9,9 @@
 #ifndef CPUGatherV2_hpp
 #define CPUGatherV2_hpp
 
+#include "AutoStorage.h"
 #include "Execution.hpp"
+#include "MNN_generated.h"
 
 namespace MNN {
 template <typename T>
@@ -21,7 +23,10 @@ public:
     virtual ErrorCode onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
 
 private:
-    const MNN::Op *mOp;
+    // model may be released after resize
+    GatherCombiner mCombiner = GatherCombiner_NONE;
+    // int64 indices narrowed after range check
+    AutoStorage<int32_t> mIndices;
 };
 } // namespace MNN
 #endif /* CPUGatherV2_hpp */
@@ -40,7 +40,8 @@ ErrorCode CPUInterp::onExecute(const std::vector<Tensor *> &inputs, const std::v
 
     if (mResizeType == 1) {
         // Nearstneighbor
-        CPUReiseNearstneighborC4(input, output, mWidthScale, mHeightScale);
+        CPUReiseNearstneighborC4(input, output, mWidthPosition.host<int>(), mHeightPosition.host<int>(),
+                                 ((CPUBackend*)backend())->threadNumber());
     } else if (mResizeType == 2) {
         // bilinear
         CPUResizeBilinearC4(input, output, mWidthPosition.host<int>(), mWidthFactor.host<float>(),
@@ -70,8 +71,11 @@ ErrorCode CPUInterp::onResize(const std::vector<Tensor *> &inputs, const std::ve
         mWidthScale  = (float)(inW) / (float)(outW);
     }
     
-    const float xScaling      = mWidthScale;
-    const float yScaling      = mHeightScale;
+    // source x of x is x * xNumerator / xDenominator, kept in integers so that integer scales are exact
+    const int xNumerator   = mAlignCorners ? inW - 1 : inW;
+    const int xDenominator = mAlignCorners ? outW - 1 : outW;
+    const int yNumerator   = mAlignCorners ? inH - 1 : inH;
+    const int yDenominator = mAlignCorners ? outH - 1 : outH;
     
     mWidthPosition.buffer().dim[0].extent = 2 * outW;
     mWidthPosition.buffer().dimensions    = 1;
@@ -86,12 +90,19 @@ ErrorCode CPUInterp::onResize(const std::vector<Tensor *> &inputs, const std::ve
     auto _wPosition = mWidthPosition.host<int>();
     auto _wFactor   = mWidthFactor.host<float>();
     
-    // Compute Line Position
+    // Compute Line Position, one position per line for nearest
     for (int x = 0; x < outW; ++x) {
-        float srcX     = x * xScaling;
-        int x1         = floor(srcX);
-        float x2Factor = srcX - x1;
+        int x1         = 0;
+        float x2Factor = 0.0f;
+        if (xDenominator > 0) {
+            x1       = (int)((int64_t)x * xNumerator / xDenominator);
+            x2Factor = (float)((int64_t)x * xNumerator % xDenominator) / xDenominator;
+        }
         
+        if (mResizeType == 1) {
+            _wPosition[x] = CLAMP(x1, 0, inW - 1);
+            continue;
+        }
         _wFactor[x]           = x2Factor;
         _wPosition[2 * x + 0] = CLAMP(x1, 0, inW - 1);
         _wPosition[2 * x + 1] = CLAMP(x1 + 1, 0, inW - 1);
@@ -111,10 +122,17 @@ ErrorCode CPUInterp::onResize(const std::vector<Tensor *> &inputs, const std::ve
     auto _hFactor   = mHeightFactor.host<float>();
     
     for (int y = 0; y < outH; ++y) {
-        float srcY     = y * yScaling;
-        int y1         = floor(srcY);
-        float y2Factor = srcY - y1;
+        int y1         = 0;
+        float y2Factor = 0.0f;
+        if (yDenominator > 0) {
+            y1       = (int)((int64_t)y * yNumerator / yDenominator);
+            y2Factor = (float)((int64_t)y * yNumerator % yDenominator) / yDenominator;
+        }
         
+        if (mResizeType == 1) {
+            _hPosition[y] = CLAMP(y1, 0, inH - 1);
+            continue;
+        }
         _hFactor[y]           = y2Factor;
         _hPosition[2 * y + 0] = CLAMP(y1, 0, inH - 1);
         _hPosition[2 * y + 1] = CLAMP(y1 + 1, 0, inH - 1);
@@ -12,20 +12,15 @@
 #include "BufferAllocator.hpp"
 #include "CommonOptFunction.h"
 #include "Concurrency.h"
+#include "ConvOpt.h"
 #include "Macro.h"
 #include "TensorUtils.hpp"
 #include "StrassenMatmulComputor.hpp"
-
-#ifdef MNN_USE_NEON
-#include <arm_neon.h>
-#endif
+#include "Vec4.hpp"
+#include "compute/MathFunction.hpp"
 
 namespace MNN {
 
-static inline float sigmoid(float x) {
-    return 1. / (1. + expf(-x));
-}
-
 // copy data from src matrix to dst matrix, and align up to 4x4
 static void copyWeightAlignUp4x4(float* dst, const float* src, int numUnits, int numFeatures, int devide) {
     int permuteIndex[] = {0, 1, 2, 3};
@@ -46,7 +41,7 @@ static void copyWeightAlignUp4x4(float* dst, const float* src, int numUnits, int
             }
         }
         if (w < numFeatures) {
-            for (int h = 0, inputIndex = w, ww; h < numUnits; ++h, inputIndex += numUnits) {
+            for (int h = 0, inputIndex = w, ww; h < numUnits; ++h, inputIndex += numFeatures) {
                 for (ww = 0; ww < numFeatures - w; ++ww) {
                     dstData[outputIndex++] = srcData[inputIndex + ww];
                 }
@@ -58,6 +53,22 @@ static void copyWeightAlignUp4x4(float* dst, const float* src, int numUnits, int
     }
 }
     
+// pack recurrent weight [4 gates][numUnits][numUnits] for MNNGemmFloatCommon_4, gates of 4 units are adjacent
+// output quads so that one thread owns whole cells: [UP_DIV(numUnits, 4) * 4 gates][UP_DIV(numUnits, 4)][4][4]
+static void packRecurrentWeight(float* dst, const float* src, int numUnits) {
+    const int unitQuad = UP_DIV(numUnits, 4);
+    ::memset(dst, 0, unitQuad * 4 * unitQuad * 16 * sizeof(float));
+    for (int g = 0; g < 4; ++g) {
+        for (int oc = 0; oc < numUnits; ++oc) {
+            auto dstZ = dst + ((oc / 4) * 4 + g) * unitQuad * 16 + oc % 4;
+            auto srcZ = src + (g * numUnits + oc) * numUnits;
+            for (int i = 0; i < numUnits; ++i) {
+                dstZ[(i / 4) * 16 + (i % 4) * 4] = srcZ[i];
+            }
+        }
+    }
+}
+
 CPULSTM::CPULSTM(Backend *backend, const LSTM *LSTM) : Execution(backend), mLSTM(LSTM) {
     // nothing to do
 }
@@ -68,6 +79,30 @@ CPULSTM::~CPULSTM() {
         backend()->onReleaseBuffer(mWeightI.get(), Backend::STATIC);
         backend()->onReleaseBuffer(mBiasC.get(), Backend::STATIC);
     }
+    if (nullptr != mHiddenState) {
+        backend()->onReleaseBuffer(mHiddenState.get(), Backend::STATIC);
+        backend()->onReleaseBuffer(mCellState.get(), Backend::STATIC);
+    }
+}
+
+bool CPULSTM::onSetStateful(bool stateful) {
+    mStateful = stateful;
+    onResetState();
+    return true;
+}
+
+void CPULSTM::onResetState() {
+    if (nullptr != mHiddenState) {
+        ::memset(mHiddenState->host<float>(), 0, mHiddenState->size());
+        ::memset(mCellState->host<float>(), 0, mCellState->size());
+    }
+}
+
+std::vector<Tensor *> CPULSTM::onGetState() {
+    if (nullptr == mHiddenState) {
+        return {};
+    }
+    return {mHiddenState.get(), mCellState.get()};
 }
 
 ErrorCode CPULSTM::onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) {
@@ -107,9 +142,14 @@ ErrorCode CPULSTM::onResize(const std::vector<Tensor *> &inputs, const std::vect
         success                     = success && backend()->onAcquireBuffer(&mCont, Backend::DYNAMIC);
     }
 
-    mOutput.buffer().dim[0].extent = timeSteps * numUnits;
-    mOutput.buffer().dimensions = 1;
-    success                       = success && backend()->onAcquireBuffer(&mOutput, Backend::DYNAMIC);
+    // hidden of last and current step, cell, and gates of one step, all in [UP_DIV(numUnits, 4), (4,) batch, 4]
+    const int unitQuad             = UP_DIV(numUnits, 4);
+    mHidden.buffer().dim[0].extent = 2 * unitQuad * batch * 4;
+    mHidden.buffer().dimensions    = 1;
+    success                        = success && backend()->onAcquireBuffer(&mHidden, Backend::DYNAMIC);
+    mStepGates.buffer().dim[0].extent = unitQuad * 4 * batch * 4;
+    mStepGates.buffer().dimensions    = 1;
+    success = success && backend()->onAcquireBuffer(&mStepGates, Backend::DYNAMIC);
 
     // divide weight & bias if needed
     auto weightI   = mLSTM->weightI();
@@ -122,18 +162,36 @@ ErrorCode CPULSTM::onResize(const std::vector<Tensor *> &inputs, const std::vect
     success                       = success && backend()->onAcquireBuffer(&mGates, Backend::DYNAMIC);
     //MNN_PRINT("%d, %d\n", batch * ALIGN_UP4(timeSteps) * numUnits * 4, mGates.elementSize());
     // cell space
-    mCell.buffer().dim[0].extent = numUnits;
+    mCell.buffer().dim[0].extent = unitQuad * batch * 4;
     mCell.buffer().dimensions    = 1;
     success                      = success && backend()->onAcquireBuffer(&mCell, Backend::DYNAMIC);
     if (!success) {
         return OUT_OF_MEMORY;
     }
-    
+
+    // state lives across executions, so it is static and reset on resize
+    if (nullptr != mHiddenState) {
+        backend()->onReleaseBuffer(mHiddenState.get(), Backend::STATIC);
+        backend()->onReleaseBuffer(mCellState.get(), Backend::STATIC);
+    }
+    mHiddenState.reset(Tensor::createDevice<float>(std::vector<int>{batch, numUnits}));
+    mCellState.reset(Tensor::createDevice<float>(std::vector<int>{batch, numUnits}));
+    success = backend()->onAcquireBuffer(mHiddenState.get(), Backend::STATIC) &&
+              backend()->onAcquireBuffer(mCellState.get(), Backend::STATIC);
+    if (!success) {
+        mHiddenState = nullptr;
+        mCellState   = nullptr;
+        return OUT_OF_MEMORY;
+    }
+    TensorUtils::getDescribe(mHiddenState.get())->backend = backend();
+    TensorUtils::getDescribe(mCellState.get())->backend   = backend();
+    onResetState();
+
     if (!mInit) {
         mInit       = true;
         auto devide = weightI && !weightH && weightSize == 4 * numUnits * (numFeatures + numUnits + 2);
         mWeightI.reset(Tensor::createDevice<float>(std::vector<int>{4, UP_DIV(numFeatures, 4), numUnits, 4}));
-        mWeightH.reset(Tensor::createDevice<float>(std::vector<int>{numUnits * numUnits * 4}));
+        mWeightH.reset(Tensor::createDevice<float>(std::vector<int>{unitQuad * 4, unitQuad, 16}));
         mBiasC.reset(Tensor::createDevice<float>(std::vector<int>{numUnits * 4}));
         success = success && backend()->onAcquireBuffer(mWeightH.get(), Backend::STATIC);
         success = success && backend()->onAcquireBuffer(mWeightI.get(), Backend::STATIC);
@@ -142,10 +200,11 @@ ErrorCode CPULSTM::onResize(const std::vector<Tensor *> &inputs, const std::vect
             return OUT_OF_MEMORY;
         }
         copyWeightAlignUp4x4(mWeightI->host<float>(), mLSTM->weightI()->float32s()->data(), numUnits, numFeatures, devide);
+        std::vector<float> weightHData(4 * numUnits * numUnits);
         if (devide) {
             auto data = weightI->float32s()->data() + 4 * numUnits * numFeatures;
             {
-                float *to = mWeightH->host<float>();
+                float *to = weightHData.data();
                 int step  = numUnits * numUnits;
                 memcpy(to, data, 2 * step * sizeof(float));
                 to += 2 * step;
@@ -166,17 +225,19 @@ ErrorCode CPULSTM::onResize(const std::vector<Tensor *> &inputs, const std::vect
             }
         } else {
             ::memcpy(mBiasC->host<float>(), mLSTM->bias()->float32s()->data(), mBiasC->size());
-            ::memcpy(mWeightH->host<float>(), mLSTM->weightH()->float32s()->data(), mWeightH->size());
+            ::memcpy(weightHData.data(), mLSTM->weightH()->float32s()->data(), weightHData.size() * sizeof(float));
         }
+        packRecurrentWeight(mWeightH->host<float>(), weightHData.data(), numUnits);
     }
     
     if (inputs.size() > 1) {
         backend()->onReleaseBuffer(&mCont, Backend::DYNAMIC);
     }
-    backend()->onReleaseBuffer(&mOutput, Backend::DYNAMIC);
+    backend()->onReleaseBuffer(&mHidden, Backend::DYNAMIC);
+    backend()->onReleaseBuffer(&mStepGates, Backend::DYNAMIC);
     backend()->onReleaseBuffer(&mCell, Backend::DYNAMIC);
     
-    const int maxDepth = 5;
+    const int maxDepth = 3;
     const bool cacheB = false;
     BufferAllocator* memoryPool = ((CPUBackend *)backend())->getBufferAllocator();
     memoryPool->barrierBegin();
@@ -246,76 +307,116 @@ ErrorCode CPULSTM::onExecute(const std::vector<Tensor *> &inputs, const std::vec
         contData = mCont.host<float>();
     }
     
-    // calc weightHC
-    auto cellData     = mCell.host<float>();
-    memset(cellData, 0, numUnits * sizeof(float));
-    const auto hcStep = batch * numUnits * numUnits;
-    for (int batchIndex = 0; batchIndex < batch; ++batchIndex) {
-        for (int ic = 0; ic < timeSteps; ic++) {
-            // clip hidden by continuation indicator
-            auto cont       = ic > 0 && (!contData || contData[ic]);
-            auto outChannel = mOutput.host<float>() + ic * numUnits;
-            MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
-                auto gatesPtr   = mGates.host<const float>() + ic * numUnits * 4 + tId * 4 + batchIndex * timeSteps * numUnits * 4;
-                auto weightHCI  = mWeightH->host<const float>() + numUnits * tId;
-                for (int oc = (int)tId; oc < numUnits; oc += threadNumber, gatesPtr += 4 * threadNumber, weightHCI += numUnits * threadNumber) {
-                    float I = gatesPtr[0], F = gatesPtr[1], O = gatesPtr[2], G = gatesPtr[3];
-                    // hidden
-                    if (cont) {
-                        auto weightHCF = weightHCI + hcStep;
-                        auto weightHCO = weightHCF + hcStep;
-                        auto weightHCG = weightHCO + hcStep;
-                        auto hiddenPtr = mOutput.host<float>() + (ic - 1) * numUnits;
-                        
-                        int i = 0;
-#ifdef MNN_USE_NEON
-                        float32x4_t Ix4 = vdupq_n_f32(0);
-                        float32x4_t Fx4 = vdupq_n_f32(0);
-                        float32x4_t Ox4 = vdupq_n_f32(0);
-                        float32x4_t Gx4 = vdupq_n_f32(0);
-                        for (; i + 3 < numUnits; i += 4) {
-                            const float32x4_t hiddenData = vld1q_f32(hiddenPtr + i);
-                            Ix4 += vld1q_f32(weightHCI + i) * hiddenData;
-                            Fx4 += vld1q_f32(weightHCF + i) * hiddenData;
-                            Ox4 += vld1q_f32(weightHCO + i) * hiddenData;
-                            Gx4 += vld1q_f32(weightHCG + i) * hiddenData;
-                        }
-#if !(defined(__ARM_FEATURE_FMA) && defined(__aarch64__))
-#define vaddvq_f32(__v4) (__v4[0] + __v4[1] + __v4[2] + __v4[3]) // support A64 only
-#endif
-                        I += vaddvq_f32(Ix4);
-                        F += vaddvq_f32(Fx4);
-                        O += vaddvq_f32(Ox4);
-                        G += vaddvq_f32(Gx4);
-#endif
-                        for (; i < numUnits; i++) {
-                            const float hiddenData = hiddenPtr[i];
-                            I += weightHCI[i] * hiddenData;
-                            F += weightHCF[i] * hiddenData;
-                            O += weightHCO[i] * hiddenData;
-                            G += weightHCG[i] * hiddenData;
+    // recurrence, all batches of a step are computed together: gates of step = hidden of last step * weightH as a
+    // small gemm, followed by gating of the same cells in the same thread
+    const int unitQuad     = UP_DIV(numUnits, 4);
+    const int batchStep    = batch * 4;
+    const int gateStep     = 4 * batchStep;
+    const int timeStepsC4  = ALIGN_UP4(timeSteps);
+    const bool stateful    = mStateful;
+    const float *inputGate = mGates.host<float>();
+    const float *weightH   = mWeightH->host<float>();
+    const float *bias      = mBiasC->host<float>();
+    float *stepGates       = mStepGates.host<float>();
+    float *cell            = mCell.host<float>();
+    float *hiddenBuffer    = mHidden.host<float>();
+    float *outputPtr       = output->host<float>();
+    const int outputStride = output->stride(0);
+    auto sigmoidFunction   = MathFunction::functions().sigmoid;
+    auto tanhFunction      = MathFunction::functions().tanh;
+
+    if (stateful) {
+        auto hiddenState = mHiddenState->host<float>();
+        auto cellState   = mCellState->host<float>();
+        for (int b = 0; b < batch; ++b) {
+            for (int oc = 0; oc < unitQuad * 4; ++oc) {
+                auto index          = (oc / 4) * batchStep + b * 4 + oc % 4;
+                bool valid          = oc < numUnits;
+                hiddenBuffer[index] = valid ? hiddenState[b * numUnits + oc] : 0.0f;
+                cell[index]         = valid ? cellState[b * numUnits + oc] : 0.0f;
+            }
+        }
+    } else {
+        ::memset(cell, 0, unitQuad * batchStep * sizeof(float));
+    }
+
+    // tiny recurrences are cheaper without forking threads every step
+    int threadNum = ALIMIN(threadNumber, unitQuad);
+    if (batch * numUnits * numUnits * 4 < 64 * 64) {
+        threadNum = 1;
+    }
+    for (int ic = 0; ic < timeSteps; ic++) {
+        // clip hidden by continuation indicator
+        const bool cont     = (ic > 0 || stateful) && (!contData || contData[ic]);
+        const float *hidden = hiddenBuffer + (ic % 2) * unitQuad * batchStep;
+        float *newHidden    = hiddenBuffer + ((ic + 1) % 2) * unitQuad * batchStep;
+        auto stepFunction   = [=](int tId) {
+            const int start = tId * unitQuad / threadNum;
+            const int end   = (tId + 1) * unitQuad / threadNum;
+            if (cont) {
+                MNNGemmFloatCommon_4(stepGates + start * gateStep, hidden, weightH + start * 4 * unitQuad * 16,
+                                     unitQuad, batchStep, (end - start) * 4, batch, 0);
+            } else {
+                ::memset(stepGates + start * gateStep, 0, (end - start) * gateStep * sizeof(float));
+            }
+            for (int z = start; z < end; ++z) {
+                const int count = ALIMIN(4, numUnits - 4 * z);
+                auto gates      = stepGates + z * gateStep;
+                auto cellZ      = cell + z * batchStep;
+                auto hiddenZ    = newHidden + z * batchStep;
+                // input part of gates is interleaved by unit, so it is added lane by lane
+                for (int b = 0; b < batch; ++b) {
+                    auto x = inputGate + ((b * timeStepsC4 + ic) * numUnits + 4 * z) * 4;
+                    for (int k = 0; k < count; ++k) {
+                        for (int g = 0; g < 4; ++g) {
+                            gates[g * batchStep + 4 * b + k] += x[4 * k + g] + bias[g * numUnits + 4 * z + k];
                         }
                     }
-                    
-                    // add bias
-                    auto biasPtr = mBiasC->host<float>() + oc;
-                    I            = sigmoid(*biasPtr + I);
-                    biasPtr      = biasPtr + numUnits;
-                    F            = cont ? sigmoid(*biasPtr + F) : 0.f;
-                    biasPtr      = biasPtr + numUnits;
-                    O            = sigmoid(*biasPtr + O);
-                    biasPtr      = biasPtr + numUnits;
-                    G            = tanhf(*biasPtr + G);
-                    
-                    auto newCell   = F * cellData[oc] + I * G;
-                    cellData[oc]   = newCell;
-                    auto H         = O * tanhf(newCell);
-                    outChannel[oc] = H;
+                }
+                // I, F, O are contiguous, then G. padded cells have zero weight and input, so they stay zero
+                sigmoidFunction(gates, gates, 3 * batchStep);
+                tanhFunction(gates + 3 * batchStep, gates + 3 * batchStep, batchStep);
+                for (int i = 0; i < batchStep; i += 4) {
+                    auto newCell = Math::Vec4::load(gates + i) * Math::Vec4::load(gates + 3 * batchStep + i);
+                    if (cont) {
+                        newCell = newCell + Math::Vec4::load(gates + batchStep + i) * Math::Vec4::load(cellZ + i);
+                    }
+                    Math::Vec4::save(cellZ + i, newCell);
+                }
+                tanhFunction(hiddenZ, cellZ, batchStep);
+                for (int i = 0; i < batchStep; i += 4) {
+                    Math::Vec4::save(hiddenZ + i,
+                                     Math::Vec4::load(gates + 2 * batchStep + i) * Math::Vec4::load(hiddenZ + i));
+                }
+                for (int b = 0; b < batch; ++b) {
+                    auto outputZ = outputPtr + b * outputStride + (ic / 4) * numUnits * 4 + ic % 4;
+                    for (int k = 0; k < count; ++k) {
+                        outputZ[(4 * z + k) * 4] = hiddenZ[4 * b + k];
+                    }
                 }
             }
+        };
+        if (1 == threadNum) {
+            stepFunction(0);
+        } else {
+            MNN_CONCURRENCY_BEGIN(tId, threadNum) {
+                stepFunction((int)tId);
+            }
             MNN_CONCURRENCY_END();
         }
-        MNNPackC4(output->host<float>() + batchIndex * output->stride(0), mOutput.host<float>(), output->width() * output->height(), output->channel());
+    }
+
+    if (stateful) {
+        const float *hidden = hiddenBuffer + (timeSteps % 2) * unitQuad * batchStep;
+        auto hiddenState    = mHiddenState->host<float>();
+        auto cellState      = mCellState->host<float>();
+        for (int b = 0; b < batch; ++b) {
+            for (int oc = 0; oc < numUnits; ++oc) {
+                auto index                     = (oc / 4) * batchStep + b * 4 + oc % 4;
+                hiddenState[b * numUnits + oc] = hidden[index];
+                cellState[b * numUnits + oc]   = cell[index];
+            }
+        }
     }
     return NO_ERROR;
 }
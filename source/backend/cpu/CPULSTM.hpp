@@ -23,6 +23,9 @@ public:
     virtual ErrorCode onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
 
     virtual ErrorCode onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+    virtual bool onSetStateful(bool stateful) override;
+    virtual void onResetState() override;
+    virtual std::vector<Tensor *> onGetState() override;
 
 private:
     const LSTM *mLSTM;
@@ -36,7 +39,13 @@ private:
     Tensor mCont;
     Tensor mGates;
     Tensor mCell;
-    Tensor mOutput;
+    Tensor mHidden;
+    Tensor mStepGates;
+
+    // hidden and cell state of each batch, kept between executions in stateful mode
+    bool mStateful = false;
+    std::shared_ptr<Tensor> mHiddenState;
+    std::shared_ptr<Tensor> mCellState;
     
     struct Unit {
         std::shared_ptr<Tensor> mTempWeight;
@@ -14,7 +14,7 @@
 
 #include "CPUNonMaxSuppressionV2.hpp"
 #include <math.h>
-#include <queue>
+#include <algorithm>
 #include "CPUBackend.hpp"
 #include "Macro.h"
 
@@ -25,29 +25,6 @@ CPUNonMaxSuppressionV2<T>::CPUNonMaxSuppressionV2(Backend* backend, const Op* op
     // nothing to do
 }
 
-// Return intersection-over-union overlap between boxes i and j
-static inline float IOU(float* boxes, int i, int j) {
-    const float yMinI = std::min<float>(boxes[i * 4 + 0], boxes[i * 4 + 2]);
-    const float xMinI = std::min<float>(boxes[i * 4 + 1], boxes[i * 4 + 3]);
-    const float yMaxI = std::max<float>(boxes[i * 4 + 0], boxes[i * 4 + 2]);
-    const float xMaxI = std::max<float>(boxes[i * 4 + 1], boxes[i * 4 + 3]);
-    const float yMinJ = std::min<float>(boxes[j * 4 + 0], boxes[j * 4 + 2]);
-    const float xMinJ = std::min<float>(boxes[j * 4 + 1], boxes[j * 4 + 3]);
-    const float yMaxJ = std::max<float>(boxes[j * 4 + 0], boxes[j * 4 + 2]);
-    const float xMaxJ = std::max<float>(boxes[j * 4 + 1], boxes[j * 4 + 3]);
-    const float areaI = (yMaxI - yMinI) * (xMaxI - xMinI);
-    const float areaJ = (yMaxJ - yMinJ) * (xMaxJ - xMinJ);
-    if (areaI <= 0 || areaJ <= 0)
-        return 0.0;
-    const float intersectionYMin = std::max<float>(yMinI, yMinJ);
-    const float intersectionXMin = std::max<float>(xMinI, xMinJ);
-    const float intersectionYMax = std::min<float>(yMaxI, yMaxJ);
-    const float intersectionXMax = std::min<float>(xMaxI, xMaxJ);
-    const float intersectionArea = std::max<float>(intersectionYMax - intersectionYMin, 0.0) *
-                                   std::max<float>(intersectionXMax - intersectionXMin, 0.0);
-    return intersectionArea / (areaI + areaJ - intersectionArea);
-}
-
 template <typename T>
 ErrorCode CPUNonMaxSuppressionV2<T>::onExecute(const std::vector<Tensor*>& inputs,
                                                const std::vector<Tensor*>& outputs) {
@@ -72,55 +49,22 @@ ErrorCode CPUNonMaxSuppressionV2<T>::onExecute(const std::vector<Tensor*>& input
 
     const int outputSize = std::min(maxOutputSize->host<int32_t>()[0], numBoxes);
 
-    std::vector<float> scoresData(numBoxes);
-
-    std::copy_n(scores->host<float>(), numBoxes, scoresData.begin());
-
-    struct Candidate {
-        int boxIndex;
-        float score;
-    };
-
-    auto cmp = [](const Candidate bsI, const Candidate bsJ) { return bsI.score < bsJ.score; };
-
-    std::priority_queue<Candidate, std::deque<Candidate>, decltype(cmp)> candidatePriorityQueue(cmp);
-
-    for (int i = 0; i < scoresData.size(); ++i) {
-        if (scoresData[i] > scoreThresholdVal) {
-            candidatePriorityQueue.emplace(Candidate({i, scoresData[i]}));
-        }
+    // corners may be given in any order, normalize them so that empty or flipped boxes never suppress others
+    auto boxesPtr = boxes->host<float>();
+    mBoxes.reset(numBoxes);
+    for (int i = 0; i < numBoxes; ++i) {
+        auto box = boxesPtr + i * 4;
+        mBoxes.set(i, std::min(box[0], box[2]), std::min(box[1], box[3]), std::max(box[0], box[2]),
+                   std::max(box[1], box[3]));
     }
 
+    std::vector<int> candidates;
     std::vector<int> selected;
-    std::vector<float> selectedScores;
-    Candidate nextCandidate;
-    float iou, originalScore;
-
-    while (selected.size() < outputSize && !candidatePriorityQueue.empty()) {
-        nextCandidate = candidatePriorityQueue.top();
-        originalScore = nextCandidate.score;
-        candidatePriorityQueue.pop();
-
-        // Overlapping boxes are likely to have similar scores,
-        // therefore we iterate through the previously selected boxes backwards
-        // in order to see if `next_candidate` should be suppressed.
-        bool shouldSelect = true;
-        for (int j = (int)selected.size() - 1; j >= 0; --j) {
-            iou = IOU(boxes->host<float>(), nextCandidate.boxIndex, selected[j]);
-            if (iou == 0.0) {
-                continue;
-            }
-            if (iou > iouThresholdVal) {
-                shouldSelect = false;
-            }
-        }
-
-        if (shouldSelect) {
-            selected.push_back(nextCandidate.boxIndex);
-            selectedScores.push_back(nextCandidate.score);
-        }
+    if (outputSize > 0) {
+        DetectionPostProcess::filterByScore(candidates, scores->host<float>(), 1, numBoxes, scoreThresholdVal, 0);
+        DetectionPostProcess::nonMaxSuppression(selected, candidates, mBoxes, scores->host<float>(), 1,
+                                                iouThresholdVal, outputSize);
     }
-
     std::copy_n(selected.begin(), selected.size(), outputs[0]->host<int32_t>());
 
     return NO_ERROR;
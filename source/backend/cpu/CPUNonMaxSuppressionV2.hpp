@@ -9,6 +9,7 @@
 #ifndef CPUNonMaxSuppressionV2_hpp
 #define CPUNonMaxSuppressionV2_hpp
 
+#include "DetectionPostProcess.hpp"
 #include "Execution.hpp"
 
 namespace MNN {
@@ -18,6 +19,9 @@ public:
     CPUNonMaxSuppressionV2(Backend *backend, const Op *op);
     virtual ~CPUNonMaxSuppressionV2() = default;
     virtual ErrorCode onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+
+private:
+    DetectionBoxes mBoxes;
 };
 
 } // namespace MNN
@@ -63,6 +63,7 @@ extern void ___CPUSizeCreator__OpType_Size__();
 extern void ___CPUSliceCreator__OpType_Slice__();
 extern void ___CPUSliceTfCreator__OpType_SliceTf__();
 extern void ___CPUSoftmaxCreator__OpType_Softmax__();
+extern void ___CPUSoftmaxCreator__OpType_LogSoftmax__();
 extern void ___SpaceBatchCreator__OpType_SpaceToBatchND__();
 extern void ___CPUSpatialProductCreator__OpType_SpatialProduct__();
 extern void ___CPUSqueezeCreator__OpType_Squeeze__();
@@ -141,6 +142,7 @@ ___CPUSizeCreator__OpType_Size__();
 ___CPUSliceCreator__OpType_Slice__();
 ___CPUSliceTfCreator__OpType_SliceTf__();
 ___CPUSoftmaxCreator__OpType_Softmax__();
+___CPUSoftmaxCreator__OpType_LogSoftmax__();
 ___SpaceBatchCreator__OpType_SpaceToBatchND__();
 ___CPUSpatialProductCreator__OpType_SpatialProduct__();
 ___CPUSqueezeCreator__OpType_Squeeze__();
@@ -9,332 +9,176 @@
 #include "CPUPool.hpp"
 #include <float.h>
 #include <math.h>
-#include "Macro.h"
-
-#ifdef MNN_USE_NEON
-#include <arm_neon.h>
-#endif
+#include <string.h>
 #include "Concurrency.h"
+#include "Macro.h"
+#include "Vec4.hpp"
 
-static void pooling_max_pad(const float *channelInput, float *offsetOutput, int inputWidth, int inputHeight,
-                            int inputStep4, int inputSize4, int kernelWidth, int kernelHeight, int iw, int ih) {
-#ifdef MNN_USE_NEON
-    float32x4_t max = vdupq_n_f32(-FLT_MAX);
-#else
-    float max0 = -FLT_MAX;
-    float max1 = -FLT_MAX;
-    float max2 = -FLT_MAX;
-    float max3 = -FLT_MAX;
-#endif
-
-    const float *bottomLine = channelInput + inputSize4 - inputStep4;
-    for (int kh = 0; kh < kernelHeight; kh++) {
-        const int h                  = ih + kh;
-        const float *paddedLineInput = nullptr;
-        if (h < 0) { // top replicate
-            paddedLineInput = channelInput;
-        } else if (h >= inputHeight) { // bottom replicate
-            paddedLineInput = bottomLine;
-        } else {
-            paddedLineInput = channelInput + h * inputStep4;
-        }
+using Vec4 = MNN::Math::Vec4;
 
-        const float *rightEdge = paddedLineInput + inputStep4 - 4;
-        for (int kw = 0; kw < kernelWidth; kw++) {
-            const int w              = iw + kw;
-            const float *cursorInput = nullptr;
-            if (w < 0) { // left replicate
-                cursorInput = paddedLineInput;
-            } else if (w >= inputWidth) { // right replicate
-                cursorInput = rightEdge;
+// input range [start, end) of each output along one axis, clipped to the image. max pooling replicates edges, so
+// a window lying all in padding takes the nearest edge; average pooling counts valid cells only and gets an
+// empty range there
+static void _computeWindows(int *windows, int outputLength, int inputLength, int kernel, int stride, int pad,
+                            bool replicate) {
+    for (int o = 0; o < outputLength; ++o) {
+        const int origin = o * stride - pad;
+        int start        = ALIMAX(origin, 0);
+        int end          = ALIMIN(origin + kernel, inputLength);
+        if (start >= end) {
+            if (replicate) {
+                start = origin < 0 ? 0 : inputLength - 1;
+                end   = start + 1;
             } else {
-                cursorInput = paddedLineInput + 4 * w;
+                end = start;
             }
-#ifdef MNN_USE_NEON
-            max = vmaxq_f32(max, vld1q_f32(cursorInput));
-#else
-            max0 = std::max(max0, cursorInput[0]);
-            max1 = std::max(max1, cursorInput[1]);
-            max2 = std::max(max2, cursorInput[2]);
-            max3 = std::max(max3, cursorInput[3]);
-#endif
         }
+        windows[2 * o + 0] = start;
+        windows[2 * o + 1] = end;
     }
-
-#ifdef MNN_USE_NEON
-    vst1q_f32(offsetOutput, max);
-#else
-    offsetOutput[0] = max0;
-    offsetOutput[1] = max1;
-    offsetOutput[2] = max2;
-    offsetOutput[3] = max3;
-#endif
 }
 
-static void poolingMax(const float *channelInput, int inputWidth, int inputHeight, float *channelOutput,
-                       int outputWidth, int outputHeight, int kernelWidth, int kernelHeight, int strideWidth,
-                       int strideHeight, int padWidth, int padHeight) {
-    int padTop    = padHeight <= 0 ? 0 : (padHeight + strideHeight - 1) / strideHeight;
-    int padBottom = (padHeight + inputHeight - kernelHeight) / strideHeight + 1;
-    int padLeft   = padWidth <= 0 ? 0 : (padWidth + strideWidth - 1) / strideWidth;
-    int padRight  = (padWidth + inputWidth - kernelWidth) / strideWidth + 1;
-
-    const int inputStep4       = 4 * inputWidth;
-    const int inputSize4       = inputStep4 * inputHeight;
-    const int strideInputStep4 = strideHeight * inputStep4;
-    const int outputStep4      = 4 * outputWidth;
-    const int strideWidth4     = 4 * strideWidth;
-
-    { // handle paddings top
-        float *lineOutput = channelOutput;
-        for (int oh = 0, ih = -padHeight; oh < padTop; oh++, ih += strideHeight, lineOutput += outputStep4) {
-            float *offsetOutput = lineOutput;
-            for (int ow = 0, iw = -padWidth; ow < outputWidth; ow++, iw += strideWidth, offsetOutput += 4) {
-                pooling_max_pad(channelInput, offsetOutput, inputWidth, inputHeight, inputStep4, inputSize4,
-                                kernelWidth, kernelHeight, iw, ih);
-            }
-        }
-        for (int oh = padTop, ih = -padHeight + oh * strideHeight; oh < padBottom;
-             oh++, ih += strideHeight, lineOutput += outputStep4) {
-            float *offsetOutput = lineOutput;
-            for (int ow = 0, iw = -padWidth; ow < padLeft; ow++, iw += strideWidth, offsetOutput += 4) {
-                pooling_max_pad(channelInput, offsetOutput, inputWidth, inputHeight, inputStep4, inputSize4,
-                                kernelWidth, kernelHeight, iw, ih);
-            }
-            offsetOutput = lineOutput + padRight * 4;
-            for (int ow = padRight, iw = -padWidth + ow * strideWidth; ow < outputWidth;
-                 ow++, iw += strideWidth, offsetOutput += 4) {
-                pooling_max_pad(channelInput, offsetOutput, inputWidth, inputHeight, inputStep4, inputSize4,
-                                kernelWidth, kernelHeight, iw, ih);
-            }
-        }
-        for (int oh = padBottom, ih = -padHeight + oh * strideHeight; oh < outputHeight;
-             oh++, ih += strideHeight, lineOutput += outputStep4) {
-            float *offsetOutput = lineOutput;
-            for (int ow = 0, iw = -padWidth; ow < outputWidth; ow++, iw += strideWidth, offsetOutput += 4) {
-                pooling_max_pad(channelInput, offsetOutput, inputWidth, inputHeight, inputStep4, inputSize4,
-                                kernelWidth, kernelHeight, iw, ih);
-            }
+// the common 2x2 and 3x3 windows unrolled
+template <int KW, int KH>
+static inline Vec4 _maxWindow(const float *corner, int lineStride) {
+    Vec4 result = Vec4::load(corner);
+    for (int y = 0; y < KH; ++y) {
+        for (int x = 0; x < KW; ++x) {
+            result = Vec4::max(result, Vec4::load(corner + y * lineStride + 4 * x));
         }
     }
+    return result;
+}
 
-    { // handle no paddings
-        const float *lineInput =
-            channelInput + (padTop * strideHeight - padHeight) * inputStep4 + (padLeft * strideWidth - padWidth) * 4;
-        float *lineOutput = channelOutput + padTop * outputStep4 + padLeft * 4;
+template <int KW, int KH>
+static inline Vec4 _sumWindow(const float *corner, int lineStride) {
+    Vec4 result(0.0f);
+    for (int y = 0; y < KH; ++y) {
+        for (int x = 0; x < KW; ++x) {
+            result = result + Vec4::load(corner + y * lineStride + 4 * x);
+        }
+    }
+    return result;
+}
 
-        for (int oh = padTop, ih = -padHeight + oh * strideHeight; oh < padBottom;
-             oh++, ih += strideHeight, lineOutput += outputStep4, lineInput += strideInputStep4) {
-            const float *offsetInput = lineInput;
-            float *offsetOutput      = lineOutput;
-            for (int ow = padLeft, iw = -padWidth + ow * strideWidth; ow < padRight;
-                 ow++, iw += strideWidth, offsetOutput += 4, offsetInput += strideWidth4) {
-#ifdef MNN_USE_NEON
-                float32x4_t max = vdupq_n_f32(-FLT_MAX);
-#else
-                float max0 = -FLT_MAX;
-                float max1 = -FLT_MAX;
-                float max2 = -FLT_MAX;
-                float max3 = -FLT_MAX;
-#endif
-                const float *kernelInput = offsetInput;
-                for (int kh = 0; kh < kernelHeight; kh++, kernelInput += inputStep4) {
-                    const float *cursorInput = kernelInput;
-                    for (int kw = 0; kw < kernelWidth; kw++, cursorInput += 4) {
-#ifdef MNN_USE_NEON
-                        max = vmaxq_f32(max, vld1q_f32(cursorInput));
-#else
-                        max0 = std::max(max0, cursorInput[0]);
-                        max1 = std::max(max1, cursorInput[1]);
-                        max2 = std::max(max2, cursorInput[2]);
-                        max3 = std::max(max3, cursorInput[3]);
-#endif
-                    }
+static void _poolMaxRows(const float *src, float *dst, int inputWidth, int outputWidth, const int *xWindows,
+                         const int *yWindows, int oyStart, int oyEnd) {
+    for (int oy = oyStart; oy < oyEnd; ++oy) {
+        const int ys   = yWindows[2 * oy + 0];
+        const int ye   = yWindows[2 * oy + 1];
+        float *dstLine = dst + oy * outputWidth * 4;
+        for (int ox = 0; ox < outputWidth; ++ox) {
+            const int xs = xWindows[2 * ox + 0];
+            const int xe = xWindows[2 * ox + 1];
+            const float *corner = src + (ys * inputWidth + xs) * 4;
+            if (3 == xe - xs && 3 == ye - ys) {
+                Vec4::save(dstLine + 4 * ox, _maxWindow<3, 3>(corner, inputWidth * 4));
+                continue;
+            }
+            if (2 == xe - xs && 2 == ye - ys) {
+                Vec4::save(dstLine + 4 * ox, _maxWindow<2, 2>(corner, inputWidth * 4));
+                continue;
+            }
+            Vec4 result(-FLT_MAX);
+            for (int y = ys; y < ye; ++y) {
+                const float *line = src + y * inputWidth * 4;
+                for (int x = xs; x < xe; ++x) {
+                    result = Vec4::max(result, Vec4::load(line + 4 * x));
                 }
-
-#ifdef MNN_USE_NEON
-                vst1q_f32(offsetOutput, max);
-#else
-                offsetOutput[0] = max0;
-                offsetOutput[1] = max1;
-                offsetOutput[2] = max2;
-                offsetOutput[3] = max3;
-#endif
             }
+            Vec4::save(dstLine + 4 * ox, result);
         }
     }
 }
 
-static void poolingAvgPad(const float *offsetInput, float *offsetOutput, int inputWidth, int inputHeight,
-                          int kernelWidth, int kernelHeight, int inputStep4, int iw, int ih) {
-#ifdef MNN_USE_NEON
-    float32x4_t sum = vdupq_n_f32(0);
-#else
-    float sum0 = 0;
-    float sum1 = 0;
-    float sum2 = 0;
-    float sum3 = 0;
-#endif
-    // sum
-    int count = 0;
-
-    const int khs            = 0 < -ih ? -ih : 0;                                                 // max
-    const int khe            = kernelHeight < inputHeight - ih ? kernelHeight : inputHeight - ih; // min
-    const float *kernelInput = offsetInput + khs * inputStep4;
-    for (int kh = khs; kh < khe; kh++, kernelInput += inputStep4) {
-        const int kws            = 0 < -iw ? -iw : 0;                                             // max
-        const int kwe            = kernelWidth < inputWidth - iw ? kernelWidth : inputWidth - iw; // min
-        const float *cursorInput = kernelInput + kws * 4;
-        for (int kw = kws; kw < kwe; kw++, cursorInput += 4) {
-#ifdef MNN_USE_NEON
-            sum += vld1q_f32(cursorInput);
-#else
-            sum0 += cursorInput[0];
-            sum1 += cursorInput[1];
-            sum2 += cursorInput[2];
-            sum3 += cursorInput[3];
-#endif
-            count++;
+static void _poolAvgRows(const float *src, float *dst, int inputWidth, int outputWidth, const int *xWindows,
+                         const int *yWindows, int oyStart, int oyEnd) {
+    for (int oy = oyStart; oy < oyEnd; ++oy) {
+        const int ys   = yWindows[2 * oy + 0];
+        const int ye   = yWindows[2 * oy + 1];
+        float *dstLine = dst + oy * outputWidth * 4;
+        for (int ox = 0; ox < outputWidth; ++ox) {
+            const int xs    = xWindows[2 * ox + 0];
+            const int xe    = xWindows[2 * ox + 1];
+            const int count = (ye - ys) * (xe - xs);
+            const float *corner = src + (ys * inputWidth + xs) * 4;
+            if (3 == xe - xs && 3 == ye - ys) {
+                Vec4::save(dstLine + 4 * ox, _sumWindow<3, 3>(corner, inputWidth * 4) * (1.0f / 9.0f));
+                continue;
+            }
+            if (2 == xe - xs && 2 == ye - ys) {
+                Vec4::save(dstLine + 4 * ox, _sumWindow<2, 2>(corner, inputWidth * 4) * 0.25f);
+                continue;
+            }
+            Vec4 sum(0.0f);
+            for (int y = ys; y < ye; ++y) {
+                const float *line = src + y * inputWidth * 4;
+                for (int x = xs; x < xe; ++x) {
+                    sum = sum + Vec4::load(line + 4 * x);
+                }
+            }
+            Vec4::save(dstLine + 4 * ox, count > 0 ? sum * (1.0f / count) : Vec4(0.0f));
         }
     }
-
-    // avg
-    if (count > 0) {
-#ifdef MNN_USE_NEON
-        vst1q_f32(offsetOutput, sum / vdupq_n_f32(count));
-#else
-        offsetOutput[0] = sum0 / (float)count;
-        offsetOutput[1] = sum1 / (float)count;
-        offsetOutput[2] = sum2 / (float)count;
-        offsetOutput[3] = sum3 / (float)count;
-#endif
-    } else {
-#ifdef MNN_USE_NEON
-        vst1q_f32(offsetOutput, vdupq_n_f32(0));
-#else
-        offsetOutput[0] = 0;
-        offsetOutput[1] = 0;
-        offsetOutput[2] = 0;
-        offsetOutput[3] = 0;
-#endif
-    }
 }
 
-static void poolingAvg(const float *channelInput, int inputWidth, int inputHeight, float *channelOutput,
-                       int outputWidth, int outputHeight, int kernelWidth, int kernelHeight, int strideWidth,
-                       int strideHeight, int padWidth, int padHeight) {
-    int padTop    = padHeight <= 0 ? 0 : (padHeight + strideHeight - 1) / strideHeight;
-    int padBottom = (padHeight + inputHeight - kernelHeight) / strideHeight + 1;
-    int padLeft   = padWidth <= 0 ? 0 : (padWidth + strideWidth - 1) / strideWidth;
-    int padRight  = (padWidth + inputWidth - kernelWidth) / strideWidth + 1;
-
-    const int inputStep4       = 4 * inputWidth;
-    const int strideInputStep4 = strideHeight * inputStep4;
-    const int outputStep4      = 4 * outputWidth;
-    const int strideWidth4     = 4 * strideWidth;
-
-    { // handle paddings
-        const float *lineInput = channelInput - padHeight * inputStep4 - padWidth * 4;
-        float *lineOutput      = channelOutput;
-        for (int oh = 0, ih = -padHeight; oh < padTop;
-             oh++, ih += strideHeight, lineOutput += outputStep4, lineInput += strideInputStep4) {
-            const float *offsetInput = lineInput;
-            float *offsetOutput      = lineOutput;
-            for (int ow = 0, iw = -padWidth; ow < outputWidth;
-                 ow++, iw += strideWidth, offsetOutput += 4, offsetInput += strideWidth4) {
-                poolingAvgPad(offsetInput, offsetOutput, inputWidth, inputHeight, kernelWidth, kernelHeight, inputStep4,
-                              iw, ih);
+// for windows much wider than the stride: sum the window rows of each column, then take every output as the
+// difference of two running sums over columns. prefix holds inputWidth + 1 units of 4
+static void _poolAvgRowsSeparable(const float *src, float *dst, int inputWidth, int outputWidth, const int *xWindows,
+                                  const int *yWindows, int oyStart, int oyEnd, float *prefix) {
+    for (int oy = oyStart; oy < oyEnd; ++oy) {
+        const int ys = yWindows[2 * oy + 0];
+        const int ye = yWindows[2 * oy + 1];
+        ::memset(prefix, 0, (inputWidth + 1) * 4 * sizeof(float));
+        for (int y = ys; y < ye; ++y) {
+            const float *line = src + y * inputWidth * 4;
+            for (int x = 0; x < inputWidth; ++x) {
+                Vec4::save(prefix + 4 * (x + 1), Vec4::load(prefix + 4 * (x + 1)) + Vec4::load(line + 4 * x));
             }
         }
-        for (int oh = padTop, ih = -padHeight + oh * strideHeight; oh < padBottom;
-             oh++, ih += strideHeight, lineOutput += outputStep4, lineInput += strideInputStep4) {
-            const float *offsetInput = lineInput;
-            float *offsetOutput      = lineOutput;
-            for (int ow = 0, iw = -padWidth; ow < padLeft;
-                 ow++, iw += strideWidth, offsetOutput += 4, offsetInput += strideWidth4) {
-                poolingAvgPad(offsetInput, offsetOutput, inputWidth, inputHeight, kernelWidth, kernelHeight, inputStep4,
-                              iw, ih);
-            }
-            offsetInput  = lineInput + padRight * strideWidth * 4;
-            offsetOutput = lineOutput + padRight * 4;
-            for (int ow = padRight, iw = -padWidth + ow * strideWidth; ow < outputWidth;
-                 ow++, iw += strideWidth, offsetOutput += 4, offsetInput += strideWidth4) {
-                poolingAvgPad(offsetInput, offsetOutput, inputWidth, inputHeight, kernelWidth, kernelHeight, inputStep4,
-                              iw, ih);
-            }
+        for (int x = 1; x <= inputWidth; ++x) {
+            Vec4::save(prefix + 4 * x, Vec4::load(prefix + 4 * x) + Vec4::load(prefix + 4 * (x - 1)));
         }
-        for (int oh = padBottom, ih = -padHeight + oh * strideHeight; oh < outputHeight;
-             oh++, ih += strideHeight, lineOutput += outputStep4, lineInput += strideInputStep4) {
-            const float *offsetInput = lineInput;
-            float *offsetOutput      = lineOutput;
-            for (int ow = 0, iw = -padWidth; ow < outputWidth;
-                 ow++, iw += strideWidth, offsetOutput += 4, offsetInput += strideWidth4) {
-                poolingAvgPad(offsetInput, offsetOutput, inputWidth, inputHeight, kernelWidth, kernelHeight, inputStep4,
-                              iw, ih);
-            }
+        float *dstLine = dst + oy * outputWidth * 4;
+        for (int ox = 0; ox < outputWidth; ++ox) {
+            const int xs    = xWindows[2 * ox + 0];
+            const int xe    = xWindows[2 * ox + 1];
+            const int count = (ye - ys) * (xe - xs);
+            auto sum        = Vec4::load(prefix + 4 * xe) - Vec4::load(prefix + 4 * xs);
+            Vec4::save(dstLine + 4 * ox, count > 0 ? sum * (1.0f / count) : Vec4(0.0f));
         }
     }
+}
 
-    { // handle no paddings
-        const float *lineInput =
-            channelInput + (padTop * strideHeight - padHeight) * inputStep4 + (padLeft * strideWidth - padWidth) * 4;
-        float *lineOutput = channelOutput + padTop * outputStep4 + padLeft * 4;
-
-        for (int oh = padTop, ih = -padHeight + oh * strideHeight; oh < padBottom;
-             oh++, ih += strideHeight, lineOutput += outputStep4, lineInput += strideInputStep4) {
-            const float *offsetInput = lineInput;
-            float *offsetOutput      = lineOutput;
-            for (int ow = padLeft, iw = -padWidth + ow * strideWidth; ow < padRight;
-                 ow++, iw += strideWidth, offsetOutput += 4, offsetInput += strideWidth4) {
-#ifdef MNN_USE_NEON
-                float32x4_t sum = vdupq_n_f32(0);
-#else
-                float sum0 = 0;
-                float sum1 = 0;
-                float sum2 = 0;
-                float sum3 = 0;
-#endif
-                // sum
-                int count                = 0;
-                const float *kernelInput = offsetInput;
-                for (int kh = 0; kh < kernelHeight; kh++, kernelInput += inputStep4) {
-                    const float *cursorInput = kernelInput;
-                    for (int kw = 0; kw < kernelWidth; kw++, cursorInput += 4) {
-#ifdef MNN_USE_NEON
-                        sum += vld1q_f32(cursorInput);
-#else
-                        sum0 += cursorInput[0];
-                        sum1 += cursorInput[1];
-                        sum2 += cursorInput[2];
-                        sum3 += cursorInput[3];
-#endif
-                        count++;
-                    }
-                }
+// max or sum of count units of 4, four accumulators hide the latency of add
+static void _reduceMax(const float *src, float *dst, int count) {
+    Vec4 m0(-FLT_MAX), m1(-FLT_MAX), m2(-FLT_MAX), m3(-FLT_MAX);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        m0 = Vec4::max(m0, Vec4::load(src + 4 * i + 0));
+        m1 = Vec4::max(m1, Vec4::load(src + 4 * i + 4));
+        m2 = Vec4::max(m2, Vec4::load(src + 4 * i + 8));
+        m3 = Vec4::max(m3, Vec4::load(src + 4 * i + 12));
+    }
+    for (; i < count; ++i) {
+        m0 = Vec4::max(m0, Vec4::load(src + 4 * i));
+    }
+    Vec4::save(dst, Vec4::max(Vec4::max(m0, m1), Vec4::max(m2, m3)));
+}
 
-                // avg
-                if (count > 0) {
-#ifdef MNN_USE_NEON
-                    vst1q_f32(offsetOutput, sum / vdupq_n_f32(count));
-#else
-                    offsetOutput[0] = sum0 / (float)count;
-                    offsetOutput[1] = sum1 / (float)count;
-                    offsetOutput[2] = sum2 / (float)count;
-                    offsetOutput[3] = sum3 / (float)count;
-#endif
-                } else {
-#ifdef MNN_USE_NEON
-                    vst1q_f32(offsetOutput, vdupq_n_f32(0));
-#else
-                    offsetOutput[0] = 0;
-                    offsetOutput[1] = 0;
-                    offsetOutput[2] = 0;
-                    offsetOutput[3] = 0;
-#endif
-                }
-            }
-        }
+static void _reduceSum(const float *src, float *dst, int count) {
+    Vec4 s0(0.0f), s1(0.0f), s2(0.0f), s3(0.0f);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        s0 = s0 + Vec4::load(src + 4 * i + 0);
+        s1 = s1 + Vec4::load(src + 4 * i + 4);
+        s2 = s2 + Vec4::load(src + 4 * i + 8);
+        s3 = s3 + Vec4::load(src + 4 * i + 12);
     }
+    for (; i < count; ++i) {
+        s0 = s0 + Vec4::load(src + 4 * i);
+    }
+    Vec4::save(dst, (s0 + s1) + (s2 + s3));
 }
 
 namespace MNN {
@@ -369,24 +213,101 @@ ErrorCode CPUPool::onResize(const std::vector<Tensor *> &inputs, const std::vect
         padWidth            = padNeededWidth > 0 ? padNeededWidth / 2 : 0;
         padHeight           = padNeededHeight > 0 ? padNeededHeight / 2 : 0;
     }
-    auto poolType      = layer->type();
-    auto planeFunction = poolingMax;
-    if (poolType == PoolType_AVEPOOL) {
-        planeFunction = poolingAvg;
+    const bool isMax        = layer->type() != PoolType_AVEPOOL;
+    const int inputWidth    = input->width();
+    const int inputHeight   = input->height();
+    const int outputWidth   = output->width();
+    const int outputHeight  = output->height();
+    mWindows.resize(2 * (outputWidth + outputHeight));
+    const int *xWindows = mWindows.data();
+    const int *yWindows = xWindows + 2 * outputWidth;
+    _computeWindows(mWindows.data(), outputWidth, inputWidth, kernelWidth, strideWidth, padWidth, isMax);
+    _computeWindows(mWindows.data() + 2 * outputWidth, outputHeight, inputHeight, kernelHeight, strideHeight,
+                    padHeight, isMax);
+
+    const int planes            = input->batch() * UP_DIV(input->channel(), 4);
+    const int inputPlaneStride  = 4 * inputWidth * inputHeight;
+    const int outputPlaneStride = 4 * outputWidth * outputHeight;
+    auto inputData              = input->host<float>();
+    auto outputData             = output->host<float>();
+    int threadNumber            = ((CPUBackend *)backend())->threadNumber();
+
+    // one output taking the whole plane: reduce planes as flat arrays
+    if (1 == outputWidth && 1 == outputHeight && 0 == xWindows[0] && inputWidth == xWindows[1] && 0 == yWindows[0] &&
+        inputHeight == yWindows[1]) {
+        const int area   = inputWidth * inputHeight;
+        auto reduce      = isMax ? _reduceMax : _reduceSum;
+        const float mean = 1.0f / area;
+        if (planes >= threadNumber || area < 1024) {
+            mFunction = [=]() {
+                MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+                    const int start = (int)tId * planes / threadNumber;
+                    const int end   = ((int)tId + 1) * planes / threadNumber;
+                    for (int p = start; p < end; ++p) {
+                        float *dst = outputData + 4 * p;
+                        reduce(inputData + p * inputPlaneStride, dst, area);
+                        if (!isMax) {
+                            Vec4::save(dst, Vec4::load(dst) * mean);
+                        }
+                    }
+                }
+                MNN_CONCURRENCY_END();
+            };
+            return NO_ERROR;
+        }
+        // few large planes: every thread takes a part of all planes, then merge
+        mCache.reset(threadNumber * planes * 4);
+        auto cache = mCache.get();
+        mFunction  = [=]() {
+            MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+                const int start = (int)tId * area / threadNumber;
+                const int end   = ((int)tId + 1) * area / threadNumber;
+                for (int p = 0; p < planes; ++p) {
+                    reduce(inputData + p * inputPlaneStride + 4 * start, cache + ((int)tId * planes + p) * 4,
+                           end - start);
+                }
+            }
+            MNN_CONCURRENCY_END();
+            for (int p = 0; p < planes; ++p) {
+                auto result = Vec4::load(cache + 4 * p);
+                for (int t = 1; t < threadNumber; ++t) {
+                    auto part = Vec4::load(cache + (t * planes + p) * 4);
+                    result    = isMax ? Vec4::max(result, part) : result + part;
+                }
+                Vec4::save(outputData + 4 * p, isMax ? result : result * mean);
+            }
+        };
+        return NO_ERROR;
+    }
+
+    // direct sums cost kernelWidth per output, running sums about strideWidth + 2
+    const bool separable = !isMax && kernelWidth > 2 * strideWidth;
+    if (separable) {
+        mCache.reset(threadNumber * (inputWidth + 1) * 4);
     }
-    auto totalDepth        = input->batch() * UP_DIV(input->channel(), 4);
-    auto inputData         = input->host<float>();
-    auto outputData        = output->host<float>();
-    auto inputPlaneStride  = 4 * input->width() * input->height();
-    auto outputPlaneStride = 4 * output->width() * output->height();
-    int threadNumber       = ((CPUBackend *)backend())->threadNumber();
-    mFunction              = [=]() {
+    auto cache = mCache.get();
+
+    // split planes into blocks of rows when there are too few planes to balance threads
+    const int rowBlocks = planes >= 4 * threadNumber ? 1 : ALIMIN(outputHeight, UP_DIV(4 * threadNumber, planes));
+    const int units     = planes * rowBlocks;
+    mFunction           = [=]() {
         MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
-            for (int channel = (int)tId; channel < totalDepth; channel += threadNumber) {
-                // run
-                planeFunction(inputData + channel * inputPlaneStride, input->width(), input->height(),
-                              outputData + outputPlaneStride * channel, output->width(), output->height(), kernelWidth,
-                              kernelHeight, strideWidth, strideHeight, padWidth, padHeight);
+            float *prefix = separable ? cache + (int)tId * (inputWidth + 1) * 4 : nullptr;
+            for (int u = (int)tId; u < units; u += threadNumber) {
+                const int p       = u / rowBlocks;
+                const int block   = u % rowBlocks;
+                const int oyStart = block * outputHeight / rowBlocks;
+                const int oyEnd   = (block + 1) * outputHeight / rowBlocks;
+                auto src          = inputData + p * inputPlaneStride;
+                auto dst          = outputData + p * outputPlaneStride;
+                if (isMax) {
+                    _poolMaxRows(src, dst, inputWidth, outputWidth, xWindows, yWindows, oyStart, oyEnd);
+                } else if (separable) {
+                    _poolAvgRowsSeparable(src, dst, inputWidth, outputWidth, xWindows, yWindows, oyStart, oyEnd,
+                                          prefix);
+                } else {
+                    _poolAvgRows(src, dst, inputWidth, outputWidth, xWindows, yWindows, oyStart, oyEnd);
+                }
             }
         }
         MNN_CONCURRENCY_END();
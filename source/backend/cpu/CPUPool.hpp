@@ -9,6 +9,7 @@
 #ifndef CPUPool_hpp
 #define CPUPool_hpp
 
+#include "AutoStorage.h"
 #include "CPUBackend.hpp"
 
 namespace MNN {
@@ -22,6 +23,10 @@ public:
 private:
     const Pool *mParameter;
     std::function<void()> mFunction;
+    // input range [start, end) of every output column, then of every output row
+    std::vector<int> mWindows;
+    // running sums of threads, or partial results of threads for global pooling
+    AutoStorage<float> mCache;
 };
 } // namespace MNN
 
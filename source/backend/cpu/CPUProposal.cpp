@@ -8,6 +8,8 @@
 
 #include "CPUProposal.hpp"
 #include <math.h>
+#include <algorithm>
+#include <limits>
 #include "CPUBackend.hpp"
 #include "CommonOptFunction.h"
 #include "Concurrency.h"
@@ -45,61 +47,6 @@ CPUProposal::CPUProposal(Backend *backend, const Proposal *proposal) : Execution
     }
 }
 
-using score_box_t = std::tuple<float, float, float, float, float>;
-#define box_rect(xmin, ymin, xmax, ymax, score) std::make_tuple((xmin), (ymin), (xmax), (ymax), (score))
-#define box_rect_xmin(box) (std::get<0>(box))
-#define box_rect_ymin(box) (std::get<1>(box))
-#define box_rect_xmax(box) (std::get<2>(box))
-#define box_rect_ymax(box) (std::get<3>(box))
-#define box_score(box) (std::get<4>(box))
-
-static void pickBoxes(const std::vector<score_box_t> &boxes, std::vector<long> &picked, float nmsThreshold, int size) {
-    long n = boxes.size();
-    std::vector<float> areas;
-    {
-        areas.resize(n);
-        for (int i = 0; i < n; i++) {
-            auto box     = boxes[i];
-            float width  = box_rect_xmax(box) - box_rect_xmin(box);
-            float height = box_rect_ymax(box) - box_rect_ymin(box);
-            areas[i]     = width * height;
-        }
-    }
-
-    for (int i = 0; i < n; i++) {
-        auto a = boxes[i];
-
-        int keep = 1;
-        for (int j = 0; j < picked.size(); j++) {
-            auto b = boxes[picked[j]];
-
-            // intersection over union
-            float axmin = box_rect_xmin(a), bxmin = box_rect_xmin(b);
-            float axmax = box_rect_xmax(a), bxmax = box_rect_xmax(b);
-            float aymin = box_rect_ymin(a), bymin = box_rect_ymin(b);
-            float aymax = box_rect_ymax(a), bymax = box_rect_ymax(b);
-            if (axmin > bxmax || axmax < bxmin || aymin > bymax || aymax < bymin) {
-                continue;
-            }
-
-            float interWidth  = fmin(axmax, bxmax) - fmax(axmin, bxmin);
-            float interHeight = fmin(aymax, bymax) - fmax(aymin, bymin);
-            float interArea   = interWidth * interHeight;
-            float unionArea   = areas[i] + areas[picked[j]] - interArea;
-            if (interArea / unionArea > nmsThreshold) {
-                keep = 0;
-                break;
-            }
-        }
-        if (keep) {
-            picked.emplace_back(i);
-            if (picked.size() >= size) {
-                break;
-            }
-        }
-    }
-}
-
 ErrorCode CPUProposal::onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) {
     // score transform space
     auto &score = inputs[0];
@@ -128,22 +75,28 @@ ErrorCode CPUProposal::onResize(const std::vector<Tensor *> &inputs, const std::
         auto imW = imInfo->host<float>()[1]; // NC/4HW4
 
         // generate proposals from box deltas and shifted anchors
-        // remove predicted boxes with either height or width < threshold
+        // remove predicted boxes with either height or width < threshold by lowest score
         auto anchorWidth  = 4;
         auto anchorHeight = mAnchors.size() / 4;
-        std::vector<score_box_t> proposalBoxes;
-        float imScale    = imInfo->host<float>()[2]; // NC/4HW4
-        float minBoxSize = minSize * imScale;
-        proposalBoxes.reserve(boxSize * anchorHeight);
+        float imScale     = imInfo->host<float>()[2]; // NC/4HW4
+        float minBoxSize  = minSize * imScale;
+        mBoxes.reset(anchorHeight * scrSize);
+        mScores.resize(anchorHeight * scrSize);
 
         {
             AUTOTIME;
-            for (int ah = 0; ah < anchorHeight; ++ah) {
-                auto boxPtr   = boxes->host<float>() + ah * 4 * boxSize;
-                auto scorePtr = mScore.host<float>() + (ah + anchorHeight) * scrSize;
+            auto proposalBoxes  = &mBoxes;
+            auto proposalScores = mScores.data();
+            auto anchors        = mAnchors.get();
+            auto boxesPtr       = boxes->host<float>();
+            auto scoresPtr      = mScore.host<float>();
+            MNN_CONCURRENCY_BEGIN(ah, anchorHeight) {
+                auto boxPtr   = boxesPtr + ah * 4 * boxSize;
+                auto scorePtr = scoresPtr + (ah + anchorHeight) * scrSize;
+                auto dstIndex = (int)ah * scrSize;
 
                 // shifted anchor
-                const auto anchor = mAnchors.get() + ah * anchorWidth;
+                const auto anchor = anchors + ah * anchorWidth;
                 float anchorY     = anchor[1];
                 float anchorW     = anchor[2] - anchor[0];
                 float anchorH     = anchor[3] - anchor[1];
@@ -152,53 +105,45 @@ ErrorCode CPUProposal::onResize(const std::vector<Tensor *> &inputs, const std::
                     float anchorX = anchor[0];
                     auto boxPtrH  = boxPtr + sh * 4 * boxWidth;
 
-                    for (int sw = 0; sw < scrWidth; sw++) {
+                    for (int sw = 0; sw < scrWidth; sw++, dstIndex++) {
                         auto box = boxPtrH + 4 * sw;
                         // apply center size
                         float cx = anchorX + anchorW * 0.5f + anchorW * box[0];
                         float cy = anchorY + anchorH * 0.5f + anchorH * box[1];
-                        float w  = anchorW * exp(box[2]);
-                        float h  = anchorH * exp(box[3]);
+                        float w  = anchorW * expf(box[2]);
+                        float h  = anchorH * expf(box[3]);
 
                         float minX = std::max(std::min(cx - w * 0.5f, imW - 1), 0.f);
                         float minY = std::max(std::min(cy - h * 0.5f, imH - 1), 0.f);
                         float maxX = std::max(std::min(cx + w * 0.5f, imW - 1), 0.f);
                         float maxY = std::max(std::min(cy + h * 0.5f, imH - 1), 0.f);
+                        proposalBoxes->set(dstIndex, minX, minY, maxX, maxY);
                         if (maxX - minX + 1 >= minBoxSize && maxY - minY + 1 >= minBoxSize) {
-                            proposalBoxes.emplace_back(box_rect(minX, minY, maxX, maxY, scorePtr[sh * scrWidth + sw]));
+                            proposalScores[dstIndex] = scorePtr[sh * scrWidth + sw];
+                        } else {
+                            proposalScores[dstIndex] = std::numeric_limits<float>::lowest();
                         }
                         anchorX += featStride;
                     }
                     anchorY += featStride;
                 }
             }
+            MNN_CONCURRENCY_END();
         }
 
+        // take top preNmsTopN of (proposal, score) pairs, then apply nms with nmsThreshold and take afterNmsTopN
+        std::vector<int> candidates;
+        std::vector<int> picked;
         {
-            // sort all (proposal, score) pairs by score from highest to lowest
-            // take top preNmsTopN
             AUTOTIME;
-            auto compareFunction = [](const score_box_t &a, const score_box_t &b) {
-                return box_score(a) > box_score(b);
-            };
-            if (0 < preNmsTopN && preNmsTopN < (int)proposalBoxes.size()) {
-                std::partial_sort(proposalBoxes.begin(), proposalBoxes.begin() + preNmsTopN, proposalBoxes.end(),
-                                  compareFunction);
-                proposalBoxes.resize(preNmsTopN);
-            } else {
-                std::sort(proposalBoxes.begin(), proposalBoxes.end(), compareFunction);
+            DetectionPostProcess::filterByScore(candidates, mScores.data(), 1, (int)mScores.size(),
+                                                std::numeric_limits<float>::lowest(), preNmsTopN);
+            if (afterNmsTopN > 0) {
+                DetectionPostProcess::nonMaxSuppression(picked, candidates, mBoxes, mScores.data(), 1, nmsThreshold,
+                                                        afterNmsTopN);
             }
         }
 
-        // apply nms with nmsThreshold
-        // take afterNmsTopN
-        std::vector<long> picked;
-        picked.reserve(afterNmsTopN);
-        {
-            AUTOTIME;
-            pickBoxes(proposalBoxes, picked, nmsThreshold, afterNmsTopN);
-        }
-
         int pickedCount = std::min((int)picked.size(), afterNmsTopN);
 
         // return the top proposals
@@ -213,14 +158,14 @@ ErrorCode CPUProposal::onResize(const std::vector<Tensor *> &inputs, const std::
         }
 
         for (int i = 0; i < pickedCount; i++, roiPtr += roiStep, scoresPtr += scoreStep) {
-            auto box  = proposalBoxes[picked[i]];
-            roiPtr[0] = 0;
-            roiPtr[1] = box_rect_xmin(box);
-            roiPtr[2] = box_rect_ymin(box);
-            roiPtr[3] = box_rect_xmax(box);
-            roiPtr[4] = box_rect_ymax(box);
+            auto index = picked[i];
+            roiPtr[0]  = 0;
+            roiPtr[1]  = mBoxes.xmin()[index];
+            roiPtr[2]  = mBoxes.ymin()[index];
+            roiPtr[3]  = mBoxes.xmax()[index];
+            roiPtr[4]  = mBoxes.ymax()[index];
             if (scoresPtr) {
-                scoresPtr[0] = box_score(box);
+                scoresPtr[0] = mScores[index];
             }
         }
     };
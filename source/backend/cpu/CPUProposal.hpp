@@ -11,6 +11,7 @@
 
 #include <functional>
 #include "AutoStorage.h"
+#include "DetectionPostProcess.hpp"
 #include "Execution.hpp"
 #include "MNN_generated.h"
 
@@ -27,6 +28,8 @@ private:
     const Proposal *mProposal;
     AutoStorage<float> mAnchors;
     Tensor mScore;
+    DetectionBoxes mBoxes;
+    std::vector<float> mScores;
     std::function<void()> mRun;
 };
 
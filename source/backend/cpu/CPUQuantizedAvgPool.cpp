@@ -10,6 +10,7 @@
 #include "CPUBackend.hpp"
 #include "CPUQuantizationUtils.hpp"
 #include "CommonOptFunction.h"
+#include "Concurrency.h"
 #include "Macro.h"
 #include "OptimizedComputer.hpp"
 
@@ -72,13 +73,41 @@ ErrorCode CPUQuantizedAvgPool::onResize(const std::vector<Tensor*>& inputs, cons
 
         
 ErrorCode CPUQuantizedAvgPool::onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) {
-    
-    
-    uint8_t *inputPtr  = inputs[0]->host<uint8_t>();
-    uint8_t *outputPtr = outputs[0]->host<uint8_t>();
-    
-    Optimized::AveragePool(inputPtr, mInputDims, mStrideWidth, mStrideHeight, mPadWidth, mPadHeight, mKernelWidth,
-                               mKernelHeight, mOutputActivationMin, mOutputActivationMax, outputPtr, mOutputDims);
+    const uint8_t *inputPtr = inputs[0]->host<uint8_t>();
+    uint8_t *outputPtr      = outputs[0]->host<uint8_t>();
+
+    // NC4HW4, every plane of 4 channels is pooled alone, split into blocks of rows when planes are too few for
+    // threads. a block starting at output row oyStart is the same pool with pad shrunk by oyStart * stride
+    const int inRows       = mInputDims[1];
+    const int inCols       = mInputDims[2];
+    const int outRows      = mOutputDims[1];
+    const int outCols      = mOutputDims[2];
+    const int planes       = mInputDims[0] * UP_DIV(mInputDims[3], 4);
+    const int threadNumber = ((CPUBackend *)backend())->threadNumber();
+    const int rowBlocks    = planes >= 4 * threadNumber ? 1 : ALIMIN(outRows, UP_DIV(4 * threadNumber, planes));
+    const int units        = planes * rowBlocks;
+    const int strideWidth = mStrideWidth, strideHeight = mStrideHeight, padWidth = mPadWidth, padHeight = mPadHeight;
+    const int kernelWidth = mKernelWidth, kernelHeight = mKernelHeight;
+    const int activationMin = mOutputActivationMin, activationMax = mOutputActivationMax;
+
+    MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+        std::vector<int> inputDims  = {1, inRows, inCols, 4};
+        std::vector<int> outputDims = {1, 0, outCols, 4};
+        for (int u = (int)tId; u < units; u += threadNumber) {
+            const int p       = u / rowBlocks;
+            const int block   = u % rowBlocks;
+            const int oyStart = block * outRows / rowBlocks;
+            const int oyEnd   = (block + 1) * outRows / rowBlocks;
+            if (oyEnd <= oyStart) {
+                continue;
+            }
+            outputDims[1] = oyEnd - oyStart;
+            Optimized::AveragePool(inputPtr + p * inRows * inCols * 4, inputDims, strideWidth, strideHeight, padWidth,
+                                   padHeight - oyStart * strideHeight, kernelWidth, kernelHeight, activationMin,
+                                   activationMax, outputPtr + (p * outRows + oyStart) * outCols * 4, outputDims);
+        }
+    }
+    MNN_CONCURRENCY_END();
 
     return NO_ERROR;
 }
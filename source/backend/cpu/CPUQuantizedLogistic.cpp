@@ -10,6 +10,7 @@
 #include "CPUBackend.hpp"
 #include "CPUFixedPoint.hpp"
 #include "CPUQuantizationUtils.hpp"
+#include "Concurrency.h"
 #include "Macro.h"
 #include "OptimizedComputer.hpp"
 
@@ -29,22 +30,33 @@ ErrorCode CPUQuantizedLogistic::onResize(const std::vector<Tensor *> &inputs, co
         mLogisticParam->inputQuantizedParam()->scale() * static_cast<double>(1 << (31 - kInputIntegerBits));
     QuantizeMultiplierGreaterThanOne(inputRealMultiplier, &mInputMultiplier, &mInputLeftShift);
     mInputRangeRadius = CalculateInputRadius(kInputIntegerBits, mInputLeftShift);
+
+    uint8_t values[256];
+    for (int i = 0; i < 256; ++i) {
+        values[i] = i;
+    }
+    std::vector<int> dims = {256};
+    Optimized::Logistic(values, dims, mLogisticParam->inputQuantizedParam()->zeroPoint(), mInputRangeRadius,
+                        mInputMultiplier, mInputLeftShift, mTable, dims);
     return NO_ERROR;
 }
 
 ErrorCode CPUQuantizedLogistic::onExecute(const std::vector<MNN::Tensor *> &inputs,
                                           const std::vector<MNN::Tensor *> &outputs) {
-    auto input = inputs[0], output = outputs[0];
-    std::vector<int> inputDims, outputDims;
-    for (int i = 0; i < input->buffer().dimensions; i++) {
-        inputDims.push_back(input->buffer().dim[i].extent);
+    auto inputData      = inputs[0]->host<uint8_t>();
+    auto outputData     = outputs[0]->host<uint8_t>();
+    const int size      = inputs[0]->elementSize();
+    auto table          = mTable;
+    int threadNumber    = ALIMAX(1, ALIMIN(((CPUBackend *)backend())->threadNumber(), size / 16384));
+    const int countUnit = UP_DIV(size, threadNumber);
+    MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+        const int start = (int)tId * countUnit;
+        const int end   = ALIMIN(size, start + countUnit);
+        for (int i = start; i < end; ++i) {
+            outputData[i] = table[inputData[i]];
+        }
     }
-    for (int i = 0; i < output->buffer().dimensions; i++) {
-        outputDims.push_back(output->buffer().dim[i].extent);
-    }
-
-    Optimized::Logistic(input->host<uint8_t>(), inputDims, mLogisticParam->inputQuantizedParam()->zeroPoint(),
-                        mInputRangeRadius, mInputMultiplier, mInputLeftShift, output->host<uint8_t>(), outputDims);
+    MNN_CONCURRENCY_END();
 
     return NO_ERROR;
 }
@@ -26,6 +26,8 @@ private:
     int mInputMultiplier;
     int mInputLeftShift;
     int mInputRangeRadius;
+    // output of each uint8 input, made by the fixed point kernel so results keep bit exact
+    uint8_t mTable[256];
 };
 
 } // namespace MNN
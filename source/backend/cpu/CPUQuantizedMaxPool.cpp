@@ -7,9 +7,11 @@
 //
 
 #include "CPUQuantizedMaxPool.hpp"
+#include <string.h>
 #include "CPUBackend.hpp"
 #include "CPUQuantizationUtils.hpp"
 #include "CommonOptFunction.h"
+#include "Concurrency.h"
 #include "Macro.h"
 
 namespace MNN {
@@ -63,8 +65,8 @@ ErrorCode CPUQuantizedMaxPool::onExecute(const std::vector<Tensor *> &inputs, co
         case PoolPadType_SAME: {
             auto widthNeeded  = (outWidth - 1) * colStride + windowCols - inCols;
             auto heightNeeded = (outHeight - 1) * rowStride + windowRows - inRows;
-            mPadWidth         = widthNeeded > 0 ? widthNeeded / 2 : 0;
-            mPadHeight        = heightNeeded > 0 ? heightNeeded / 2 : 0;
+            padCols           = widthNeeded > 0 ? widthNeeded / 2 : 0;
+            padRows           = heightNeeded > 0 ? heightNeeded / 2 : 0;
             break;
         }
         default:
@@ -72,42 +74,40 @@ ErrorCode CPUQuantizedMaxPool::onExecute(const std::vector<Tensor *> &inputs, co
             break;
     }
 
-    uint8_t *inputPtr            = (uint8_t *)input->buffer().host;
-    uint8_t *outputPtr           = (uint8_t *)output->buffer().host;
-    const uint8_t minAsQuantized = 0;
+    const uint8_t *inputPtr = (const uint8_t *)input->buffer().host;
+    uint8_t *outputPtr      = (uint8_t *)output->buffer().host;
+    const int threadNumber  = ((CPUBackend *)backend())->threadNumber();
+    const int totalRows     = inBatch * outHeight;
 
-    for (int batchIndex = 0; batchIndex < inBatch; batchIndex++) {
-        uint8_t *outputBatchPtr = outputPtr + batchIndex * outWidth * outHeight * inChannel;
-        uint8_t *inputBatchPtr  = inputPtr + batchIndex * inCols * inRows * inChannel;
-
-        for (int channelIndex = 0; channelIndex < inChannel; channelIndex++) {
-            for (int outHeightIndex = 0; outHeightIndex < outHeight; outHeightIndex++) {
-                for (int outWidthIndex = 0; outWidthIndex < outWidth; outWidthIndex++) {
-                    uint8_t maxTemp          = std::numeric_limits<uint8_t>::min();
-                    int32_t inputHeightIndex = outHeightIndex * rowStride - padRows;
-                    int32_t inputWidthIndex  = outWidthIndex * colStride - padCols;
-                    uint8_t *outputTemp      = (uint8_t *)(outputBatchPtr + outHeightIndex * outWidth * inChannel +
-                                                      outWidthIndex * inChannel + channelIndex);
-                    for (int windowRowsIndex = 0; windowRowsIndex < windowRows; windowRowsIndex++) {
-                        for (int windowColsIndex = 0; windowColsIndex < windowCols; windowColsIndex++) {
-                            if (((inputWidthIndex + windowColsIndex) < 0) ||
-                                ((inputWidthIndex + windowColsIndex) >= inCols) ||
-                                ((inputHeightIndex + windowRowsIndex) < 0) ||
-                                ((inputHeightIndex + windowRowsIndex) >= inRows)) {
-                                maxTemp = std::max(minAsQuantized, maxTemp);
-                            } else {
-                                maxTemp = std::max(
-                                    inputBatchPtr[(inputHeightIndex + windowRowsIndex) * inCols * inChannel +
-                                                  (inputWidthIndex + windowColsIndex) * inChannel + channelIndex],
-                                    maxTemp);
-                            }
+    // padding counts as the quantized 0, the least value, so the max of the valid cells is the same. rows of
+    // output are split over threads, channels are contiguous and taken in one pass for every window cell
+    MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+        for (int row = (int)tId; row < totalRows; row += threadNumber) {
+            const int batchIndex     = row / outHeight;
+            const int outHeightIndex = row % outHeight;
+            const int hStart         = outHeightIndex * rowStride - padRows;
+            const int hs             = ALIMAX(hStart, 0);
+            const int he             = ALIMIN(hStart + windowRows, inRows);
+            const uint8_t *inputBatchPtr = inputPtr + batchIndex * inRows * inCols * inChannel;
+            uint8_t *outputLine          = outputPtr + row * outWidth * inChannel;
+            for (int outWidthIndex = 0; outWidthIndex < outWidth; outWidthIndex++) {
+                const int wStart = outWidthIndex * colStride - padCols;
+                const int ws     = ALIMAX(wStart, 0);
+                const int we     = ALIMAX(ALIMIN(wStart + windowCols, inCols), ws);
+                uint8_t *dst     = outputLine + outWidthIndex * inChannel;
+                ::memset(dst, 0, inChannel);
+                for (int h = hs; h < he; ++h) {
+                    const uint8_t *src = inputBatchPtr + (h * inCols + ws) * inChannel;
+                    for (int w = ws; w < we; ++w, src += inChannel) {
+                        for (int c = 0; c < inChannel; ++c) {
+                            dst[c] = std::max(dst[c], src[c]);
                         }
                     }
-                    *outputTemp = maxTemp;
                 }
             }
         }
     }
+    MNN_CONCURRENCY_END();
 
     return NO_ERROR;
 }
@@ -9,11 +9,11 @@
 #include "CPURNNSequenceGRU.hpp"
 #include <math.h>
 #include "CPUBackend.hpp"
-#include "Matrix.hpp"
-
-#ifdef MNN_USE_NEON
-#include <arm_neon.h>
-#endif
+#include "Concurrency.h"
+#include "ConvOpt.h"
+#include "Macro.h"
+#include "TensorUtils.hpp"
+#include "Vec4.hpp"
 
 namespace MNN {
 
@@ -21,183 +21,318 @@ static inline float sigmoid(float x) {
     return 1. / (1. + expf(-x));
 }
 
-// implement GRU cell function
-// Ref: tensorflow/python/ops/rnn_cell_impl.py
-static void runRNNStep(const float* input, const int inputLength, std::shared_ptr<Tensor>& hiddenState,
-                       const int numUnits, std::shared_ptr<Tensor>& gateWeight, std::shared_ptr<Tensor>& gateBias,
-                       std::shared_ptr<Tensor>& candidateWeight, std::shared_ptr<Tensor>& candidateBias,
-                       std::shared_ptr<Tensor>& inputAndState, std::shared_ptr<Tensor>& gate) {
-    // gate is (r_t, z_t)
-    auto inputAndStatePtr = inputAndState->host<float>();
-    auto hiddenStatePtr   = hiddenState->host<float>();
-    ::memcpy(inputAndStatePtr, input, inputLength * sizeof(float));
-    ::memcpy(inputAndStatePtr + inputLength, hiddenStatePtr, numUnits * sizeof(float));
-    Math::Matrix::multi(gate.get(), inputAndState.get(), gateWeight.get());
-    Math::Matrix::add(gate.get(), gate.get(), gateBias.get());
-    const int gateSize = gate->elementSize();
-    auto gatePtr       = gate->host<float>();
-    for (int i = 0; i < gateSize; ++i) {
-        gatePtr[i] = sigmoid(gatePtr[i]);
-    }
-
-    {
-        // reset gate
-        auto resetGatePtr = inputAndStatePtr + inputLength;
-        int k             = 0;
-#ifdef MNN_USE_NEON
-        for (; k <= numUnits - 16; k += 16) {
-            float32x4_t g0 = vld1q_f32(gatePtr + k);
-            float32x4_t g1 = vld1q_f32(gatePtr + k + 4);
-            float32x4_t g2 = vld1q_f32(gatePtr + k + 8);
-            float32x4_t g3 = vld1q_f32(gatePtr + k + 12);
-            float32x4_t h0 = vld1q_f32(hiddenStatePtr + k);
-            float32x4_t h1 = vld1q_f32(hiddenStatePtr + k + 4);
-            float32x4_t h2 = vld1q_f32(hiddenStatePtr + k + 8);
-            float32x4_t h3 = vld1q_f32(hiddenStatePtr + k + 12);
-            auto mul0      = vmulq_f32(g0, h0);
-            auto mul1      = vmulq_f32(g1, h1);
-            auto mul2      = vmulq_f32(g2, h2);
-            auto mul3      = vmulq_f32(g3, h3);
-            vst1q_f32(resetGatePtr + k, mul0);
-            vst1q_f32(resetGatePtr + k + 4, mul1);
-            vst1q_f32(resetGatePtr + k + 8, mul2);
-            vst1q_f32(resetGatePtr + k + 12, mul3);
-        }
-        for (; k <= numUnits - 4; k += 4) {
-            float32x4_t g = vld1q_f32(gatePtr + k);
-            float32x4_t h = vld1q_f32(hiddenStatePtr + k);
-            auto mul      = vmulq_f32(g0, h0);
-            vst1q_f32(resetGatePtr + k, mul);
+// copy a [rows, cols] block of row-major src into the packed [N/4, K/4, 4, 4] weight of MNNGemmFloatCommon_4,
+// starting from dst column dstCol
+static void _packWeight(float* dst, int depthQuad, const float* src, int srcStride, int rows, int cols, int dstCol) {
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < cols; ++x) {
+            const int dx = x + dstCol;
+            dst[(dx / 4) * depthQuad * 16 + (y / 4) * 16 + (y % 4) * 4 + dx % 4] = src[y * srcStride + x];
         }
-#endif
-        for (; k < numUnits; ++k) {
-            resetGatePtr[k] = gatePtr[k] * hiddenStatePtr[k];
-        }
-    }
-
-    // use r_t to apply Matrix multi and add
-    gate->setLength(1, numUnits);
-    Math::Matrix::multi(gate.get(), inputAndState.get(), candidateWeight.get());
-    Math::Matrix::add(gate.get(), gate.get(), candidateBias.get());
-
-    for (int i = 0; i < numUnits; ++i) {
-        hiddenStatePtr[i] =
-            gatePtr[numUnits + i] * hiddenStatePtr[i] + (1.0 - gatePtr[numUnits + i]) * tanhf(gatePtr[i]);
     }
-    // reset gate shape fot the next iteration
-    gate->setLength(1, 2 * numUnits);
 }
 
+// GRU cell of tensorflow/python/ops/rnn_cell_impl.py, gate is (r_t, z_t):
+//   [r_t, z_t] = sigmoid([x_t, h_t-1] * W_g + b_g)
+//   c_t = tanh([x_t, r_t * h_t-1] * W_c + b_c)
+//   h_t = z_t * h_t-1 + (1 - z_t) * c_t
+// W_g and W_c are split by rows, the x_t part of all steps is computed by one gemm before recurrence
+// as [r | z | c] columns, each aligned to 4, and the h_t-1 parts are applied to the whole batch in each step.
+// Padded units have zero weight and bias, so they keep zero as hidden state.
 CPURNNSequenceGRU::CPURNNSequenceGRU(const Op* op, Backend* backend) : MNN::Execution(backend) {
     auto rnnParam       = op->main_as_RNNParam();
     mKeepAllOutputs     = rnnParam->keepAllOutputs();
     mIsBidirectionalRNN = rnnParam->isBidirectionalRNN();
     mNumUnits           = rnnParam->numUnits();
+    mInputLength        = rnnParam->fwGateWeight()->dims()->data()[0] - mNumUnits;
+    mThreadNumber       = static_cast<CPUBackend*>(backend)->threadNumber();
+    MNN_ASSERT(rnnParam->fwCandidateBias()->float32s()->size() == mNumUnits);
 
-    auto copyData = [=](std::shared_ptr<Tensor>& tensor, const Blob* src) {
-        std::vector<int> shape;
-        for (int i = 0; i < src->dims()->size(); ++i) {
-            shape.push_back(src->dims()->data()[i]);
+    const int hiddenUnit = UP_DIV(mNumUnits, 4);
+    const int inputUnit  = UP_DIV(mInputLength, 4);
+    auto packData = [=](std::shared_ptr<Tensor>& inputWeight, std::shared_ptr<Tensor>& gateWeight,
+                        std::shared_ptr<Tensor>& candidateWeight, std::shared_ptr<Tensor>& bias,
+                        const Blob* srcGateWeight, const Blob* srcGateBias, const Blob* srcCandidateWeight,
+                        const Blob* srcCandidateBias) {
+        inputWeight.reset(Tensor::createDevice<float>({3 * hiddenUnit * inputUnit * 16}));
+        gateWeight.reset(Tensor::createDevice<float>({2 * hiddenUnit * hiddenUnit * 16}));
+        candidateWeight.reset(Tensor::createDevice<float>({hiddenUnit * hiddenUnit * 16}));
+        bias.reset(Tensor::createDevice<float>({3 * hiddenUnit * 4}));
+        for (auto t : {inputWeight.get(), gateWeight.get(), candidateWeight.get(), bias.get()}) {
+            if (!backend->onAcquireBuffer(t, Backend::STATIC)) {
+                mValid = false;
+                return;
+            }
+            ::memset(t->host<float>(), 0, t->size());
         }
-        tensor.reset(Tensor::createDevice<float>(shape));
-        backend->onAcquireBuffer(tensor.get(), Backend::STATIC);
-        ::memcpy(tensor->host<float>(), src->float32s()->data(), src->float32s()->size() * sizeof(float));
+        const int numUnits   = mNumUnits;
+        const int inputLen   = mInputLength;
+        const float* gateW   = srcGateWeight->float32s()->data();
+        const float* candW   = srcCandidateWeight->float32s()->data();
+        const int hiddenSize = hiddenUnit * 4;
+        // input part: rows [0, inputLen)
+        _packWeight(inputWeight->host<float>(), inputUnit, gateW, 2 * numUnits, inputLen, numUnits, 0);
+        _packWeight(inputWeight->host<float>(), inputUnit, gateW + numUnits, 2 * numUnits, inputLen, numUnits,
+                    hiddenSize);
+        _packWeight(inputWeight->host<float>(), inputUnit, candW, numUnits, inputLen, numUnits, 2 * hiddenSize);
+        // hidden part: rows [inputLen, inputLen + numUnits)
+        auto gateH = gateW + inputLen * 2 * numUnits;
+        _packWeight(gateWeight->host<float>(), hiddenUnit, gateH, 2 * numUnits, numUnits, numUnits, 0);
+        _packWeight(gateWeight->host<float>(), hiddenUnit, gateH + numUnits, 2 * numUnits, numUnits, numUnits,
+                    hiddenSize);
+        _packWeight(candidateWeight->host<float>(), hiddenUnit, candW + inputLen * numUnits, numUnits, numUnits,
+                    numUnits, 0);
+
+        auto biasPtr = bias->host<float>();
+        auto gateB   = srcGateBias->float32s()->data();
+        ::memcpy(biasPtr, gateB, numUnits * sizeof(float));
+        ::memcpy(biasPtr + hiddenSize, gateB + numUnits, numUnits * sizeof(float));
+        ::memcpy(biasPtr + 2 * hiddenSize, srcCandidateBias->float32s()->data(), numUnits * sizeof(float));
     };
-    copyData(mFwGateWeight, rnnParam->fwGateWeight());
-    copyData(mFwGateBias, rnnParam->fwGateBias());
-    copyData(mFwCandidateWeight, rnnParam->fwCandidateWeight());
-    copyData(mFwCandidateBias, rnnParam->fwCandidateBias());
-    MNN_ASSERT(mFwCandidateBias->length(0) == mNumUnits);
-    if (mIsBidirectionalRNN) {
-        copyData(mBwGateWeight, rnnParam->bwGateWeight());
-        copyData(mBwGateBias, rnnParam->bwGateBias());
-        copyData(mBwCandidateWeight, rnnParam->bwCandidateWeight());
-        copyData(mBwCandidateBias, rnnParam->bwCandidateBias());
+    packData(mFwInputWeight, mFwGateWeight, mFwCandidateWeight, mFwBias, rnnParam->fwGateWeight(),
+             rnnParam->fwGateBias(), rnnParam->fwCandidateWeight(), rnnParam->fwCandidateBias());
+    if (mValid && mIsBidirectionalRNN) {
+        packData(mBwInputWeight, mBwGateWeight, mBwCandidateWeight, mBwBias, rnnParam->bwGateWeight(),
+                 rnnParam->bwGateBias(), rnnParam->bwCandidateWeight(), rnnParam->bwCandidateBias());
     }
 }
 
 CPURNNSequenceGRU::~CPURNNSequenceGRU() {
-    backend()->onReleaseBuffer(mFwGateWeight.get(), Backend::STATIC);
-    backend()->onReleaseBuffer(mFwGateBias.get(), Backend::STATIC);
-    backend()->onReleaseBuffer(mFwCandidateWeight.get(), Backend::STATIC);
-    backend()->onReleaseBuffer(mFwCandidateBias.get(), Backend::STATIC);
-    if (mIsBidirectionalRNN) {
-        backend()->onReleaseBuffer(mBwGateWeight.get(), Backend::STATIC);
-        backend()->onReleaseBuffer(mBwGateBias.get(), Backend::STATIC);
-        backend()->onReleaseBuffer(mBwCandidateWeight.get(), Backend::STATIC);
-        backend()->onReleaseBuffer(mBwCandidateBias.get(), Backend::STATIC);
+    // weights are partly acquired when construction ran out of memory
+    for (auto t : {mFwInputWeight.get(), mFwGateWeight.get(), mFwCandidateWeight.get(), mFwBias.get(),
+                   mBwInputWeight.get(), mBwGateWeight.get(), mBwCandidateWeight.get(), mBwBias.get()}) {
+        if (nullptr != t) {
+            backend()->onReleaseBuffer(t, Backend::STATIC);
+        }
     }
+    _releaseState();
 }
 
-ErrorCode CPURNNSequenceGRU::onResize(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
-    auto input                 = inputs[0];
-    const int inputLastDimSize = input->length(2);
-    mHiddenState.reset(Tensor::createDevice<float>(std::vector<int>{1, mNumUnits}));
-    mInputAndState.reset(Tensor::createDevice<float>(std::vector<int>{1, inputLastDimSize + mNumUnits}));
-    mGate.reset(Tensor::createDevice<float>(std::vector<int>{1, 2 * mNumUnits}));
+void CPURNNSequenceGRU::_releaseState() {
+    for (auto t : {mFwState.get(), mBwState.get()}) {
+        if (nullptr != t) {
+            backend()->onReleaseBuffer(t, Backend::STATIC);
+        }
+    }
+    mFwState = nullptr;
+    mBwState = nullptr;
+}
 
-    backend()->onAcquireBuffer(mHiddenState.get(), Backend::DYNAMIC);
-    backend()->onAcquireBuffer(mInputAndState.get(), Backend::DYNAMIC);
-    backend()->onAcquireBuffer(mGate.get(), Backend::DYNAMIC);
+bool CPURNNSequenceGRU::onSetStateful(bool stateful) {
+    mStateful = stateful;
+    onResetState();
+    return true;
+}
+
+void CPURNNSequenceGRU::onResetState() {
+    for (auto t : onGetState()) {
+        ::memset(t->host<float>(), 0, t->size());
+    }
+}
+
+std::vector<Tensor*> CPURNNSequenceGRU::onGetState() {
+    std::vector<Tensor*> states;
+    for (auto t : {mFwState.get(), mBwState.get()}) {
+        if (nullptr != t) {
+            states.emplace_back(t);
+        }
+    }
+    return states;
+}
+
+ErrorCode CPURNNSequenceGRU::onResize(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
+    auto input = inputs[0];
+    MNN_ASSERT(input->length(2) == mInputLength);
+    const int batch      = input->length(0);
+    const int planes     = batch * input->length(1);
+    const int hiddenUnit = UP_DIV(mNumUnits, 4);
+    const int inputUnit  = UP_DIV(mInputLength, 4);
+    mInputPack.reset(Tensor::createDevice<float>({inputUnit, planes, 4}));
+    mInputProjection.reset(Tensor::createDevice<float>({3 * hiddenUnit, planes, 4}));
+    mHiddenState.reset(Tensor::createDevice<float>({hiddenUnit, batch, 4}));
+    mResetHidden.reset(Tensor::createDevice<float>({hiddenUnit, batch, 4}));
+    mGate.reset(Tensor::createDevice<float>({2 * hiddenUnit, batch, 4}));
 
-    backend()->onReleaseBuffer(mHiddenState.get(), Backend::DYNAMIC);
-    backend()->onReleaseBuffer(mInputAndState.get(), Backend::DYNAMIC);
-    backend()->onReleaseBuffer(mGate.get(), Backend::DYNAMIC);
+    std::vector<Tensor*> buffers = {mInputPack.get(), mInputProjection.get(), mHiddenState.get(), mResetHidden.get(),
+                                    mGate.get()};
+    for (auto t : buffers) {
+        if (!backend()->onAcquireBuffer(t, Backend::DYNAMIC)) {
+            return OUT_OF_MEMORY;
+        }
+    }
+    for (auto t : buffers) {
+        backend()->onReleaseBuffer(t, Backend::DYNAMIC);
+    }
 
+    // state lives across executions, so it is static and reset on resize
+    _releaseState();
+    mFwState.reset(Tensor::createDevice<float>({batch, mNumUnits}));
+    if (mIsBidirectionalRNN) {
+        mBwState.reset(Tensor::createDevice<float>({batch, mNumUnits}));
+    }
+    for (auto t : onGetState()) {
+        if (!backend()->onAcquireBuffer(t, Backend::STATIC)) {
+            return OUT_OF_MEMORY;
+        }
+        TensorUtils::getDescribe(t)->backend = backend();
+    }
+    onResetState();
     return NO_ERROR;
 }
 
-ErrorCode CPURNNSequenceGRU::onExecute(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
-    // firstly set the hidden state to zero
-    float* const hiddenStatePtr   = mHiddenState->host<float>();
-    const int hiddenStateDataSize = mHiddenState->size();
-    ::memset(hiddenStatePtr, 0, hiddenStateDataSize);
+void CPURNNSequenceGRU::_runDirection(const Tensor* inputWeight, const Tensor* gateWeight,
+                                      const Tensor* candidateWeight, const Tensor* bias, bool reverse,
+                                      Tensor* state, Tensor* output) {
+    const int numUnits   = mNumUnits;
+    const int hiddenUnit = UP_DIV(numUnits, 4);
+    const int inputUnit  = UP_DIV(mInputLength, 4);
+    const int batch      = mHiddenState->length(1);
+    const int planes     = mInputPack->length(1);
+    const int sequence   = planes / batch;
+    const bool keepAll   = mKeepAllOutputs;
+    const int planeStep  = planes * 4;
+    const int batchStep  = batch * 4;
 
-    auto input                    = inputs[0];
-    auto output                   = outputs[0];
-    float* const inputPtr         = input->host<float>();
-    float* const outputPtr        = output->host<float>();
-    const int batchSize           = input->length(0);
-    const int batchStride         = input->stride(0);
-    const int inputSequenceLength = input->length(1);
-    const int inputCodeLength     = input->length(2);
+    const float* inputPack = mInputPack->host<float>();
+    float* projection      = mInputProjection->host<float>();
+    float* hidden          = mHiddenState->host<float>();
+    float* resetHidden     = mResetHidden->host<float>();
+    float* gate            = mGate->host<float>();
+    float* outputPtr       = output->host<float>();
+    const float* biasPtr   = bias->host<float>();
+    const float* inputW    = inputWeight->host<float>();
+    const float* gateW     = gateWeight->host<float>();
+    const float* candW     = candidateWeight->host<float>();
 
-    for (int b = 0; b < batchSize; ++b) {
-        for (int i = 0; i < inputSequenceLength; ++i) {
-            const int inputOffset = b * batchStride + i * inputCodeLength;
-            runRNNStep(inputPtr + inputOffset, inputCodeLength, mHiddenState, mNumUnits, mFwGateWeight, mFwGateBias,
-                       mFwCandidateWeight, mFwCandidateBias, mInputAndState, mGate);
-            if (mKeepAllOutputs) {
-                ::memcpy(outputPtr + b * output->stride(0) + i * mNumUnits, hiddenStatePtr, hiddenStateDataSize);
+    // input projection of all steps
+    {
+        const int unit      = 3 * hiddenUnit;
+        const int threadNum = ALIMIN(mThreadNumber, unit);
+        MNN_CONCURRENCY_BEGIN(tId, threadNum) {
+            const int start = (int)tId * unit / threadNum;
+            const int end   = ((int)tId + 1) * unit / threadNum;
+            MNNGemmFloatCommon_4(projection + start * planeStep, inputPack, inputW + start * inputUnit * 16,
+                                 inputUnit, planeStep, end - start, planes, 0);
+            for (int z = start; z < end; ++z) {
+                auto biasZ = Math::Vec4::load(biasPtr + 4 * z);
+                auto dstZ  = projection + z * planeStep;
+                for (int p = 0; p < planes; ++p) {
+                    Math::Vec4::save(dstZ + 4 * p, Math::Vec4::load(dstZ + 4 * p) + biasZ);
+                }
             }
         }
+        MNN_CONCURRENCY_END();
     }
 
-    if (!mKeepAllOutputs) {
-        ::memcpy(outputPtr, hiddenStatePtr, hiddenStateDataSize);
+    // in stateful mode, the first step continues from state of last execution
+    float* statePtr = state->host<float>();
+    if (mStateful) {
+        for (int b = 0; b < batch; ++b) {
+            for (int j = 0; j < 4 * hiddenUnit; ++j) {
+                hidden[(j / 4) * batchStep + 4 * b + j % 4] = j < numUnits ? statePtr[b * numUnits + j] : 0.0f;
+            }
+        }
+    } else {
+        ::memset(hidden, 0, mHiddenState->size());
     }
-    // backward rnn
-    if (mIsBidirectionalRNN) {
-        ::memset(hiddenStatePtr, 0, hiddenStateDataSize);
-        auto outputBw            = outputs[1];
-        float* const outputBwPtr = outputBw->host<float>();
-        for (int b = 0; b < batchSize; ++b) {
-            for (int i = inputSequenceLength - 1; i >= 0; i--) {
-                const int inputOffset = b * batchStride + i * inputCodeLength;
-                runRNNStep(inputPtr + inputOffset, inputCodeLength, mHiddenState, mNumUnits, mBwGateWeight, mBwGateBias,
-                           mBwCandidateWeight, mBwCandidateBias, mInputAndState, mGate);
-                if (mKeepAllOutputs) {
-                    ::memcpy(outputBwPtr + b * outputBw->stride(0) + (inputSequenceLength - 1 - i) * mNumUnits,
-                             hiddenStatePtr, hiddenStateDataSize);
+    const int gateThread      = ALIMIN(mThreadNumber, 2 * hiddenUnit);
+    const int candidateThread = ALIMIN(mThreadNumber, hiddenUnit);
+    for (int step = 0; step < sequence; ++step) {
+        const int t            = reverse ? sequence - 1 - step : step;
+        const float* stepInput = projection + t * batchStep;
+
+        // r_t, z_t and r_t * h_t-1
+        MNN_CONCURRENCY_BEGIN(tId, gateThread) {
+            const int start = (int)tId * 2 * hiddenUnit / gateThread;
+            const int end   = ((int)tId + 1) * 2 * hiddenUnit / gateThread;
+            MNNGemmFloatCommon_4(gate + start * batchStep, hidden, gateW + start * hiddenUnit * 16, hiddenUnit,
+                                 batchStep, end - start, batch, 0);
+            for (int z = start; z < end; ++z) {
+                auto gateZ  = gate + z * batchStep;
+                auto inputZ = stepInput + z * planeStep;
+                for (int i = 0; i < batchStep; ++i) {
+                    gateZ[i] = sigmoid(gateZ[i] + inputZ[i]);
+                }
+                if (z < hiddenUnit) {
+                    auto hiddenZ = hidden + z * batchStep;
+                    auto resetZ  = resetHidden + z * batchStep;
+                    for (int i = 0; i < batchStep; i += 4) {
+                        Math::Vec4::save(resetZ + i, Math::Vec4::load(gateZ + i) * Math::Vec4::load(hiddenZ + i));
+                    }
                 }
             }
         }
+        MNN_CONCURRENCY_END();
 
-        if (!mKeepAllOutputs) {
-            ::memcpy(outputBwPtr, hiddenStatePtr, hiddenStateDataSize);
+        // c_t and h_t, c_t is stored in place of r_t
+        MNN_CONCURRENCY_BEGIN(tId, candidateThread) {
+            const int start = (int)tId * hiddenUnit / candidateThread;
+            const int end   = ((int)tId + 1) * hiddenUnit / candidateThread;
+            MNNGemmFloatCommon_4(gate + start * batchStep, resetHidden, candW + start * hiddenUnit * 16, hiddenUnit,
+                                 batchStep, end - start, batch, 0);
+            for (int z = start; z < end; ++z) {
+                auto candZ   = gate + z * batchStep;
+                auto updateZ = gate + (hiddenUnit + z) * batchStep;
+                auto inputZ  = stepInput + (2 * hiddenUnit + z) * planeStep;
+                auto hiddenZ = hidden + z * batchStep;
+                for (int i = 0; i < batchStep; ++i) {
+                    const float c = tanhf(candZ[i] + inputZ[i]);
+                    hiddenZ[i]    = updateZ[i] * hiddenZ[i] + (1.0f - updateZ[i]) * c;
+                }
+                if (keepAll) {
+                    const int count = ALIMIN(4, numUnits - 4 * z);
+                    for (int b = 0; b < batch; ++b) {
+                        auto dst = outputPtr + (b * sequence + step) * numUnits + 4 * z;
+                        for (int k = 0; k < count; ++k) {
+                            dst[k] = hiddenZ[4 * b + k];
+                        }
+                    }
+                }
+            }
         }
+        MNN_CONCURRENCY_END();
     }
 
+    for (int b = 0; b < batch; ++b) {
+        for (int j = 0; j < numUnits; ++j) {
+            statePtr[b * numUnits + j] = hidden[(j / 4) * batchStep + 4 * b + j % 4];
+        }
+    }
+    if (!keepAll) {
+        ::memcpy(outputPtr, statePtr, batch * numUnits * sizeof(float));
+    }
+}
+
+ErrorCode CPURNNSequenceGRU::onExecute(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
+    auto input                    = inputs[0];
+    const float* inputPtr         = input->host<float>();
+    const int batchSize           = input->length(0);
+    const int inputSequenceLength = input->length(1);
+    const int inputCodeLength     = input->length(2);
+
+    // [batch, sequence, code] -> [code / 4, sequence, batch, 4]
+    float* packPtr = mInputPack->host<float>();
+    if (inputCodeLength % 4 != 0) {
+        ::memset(packPtr, 0, mInputPack->size());
+    }
+    const int planes = batchSize * inputSequenceLength;
+    for (int b = 0; b < batchSize; ++b) {
+        for (int t = 0; t < inputSequenceLength; ++t) {
+            auto src = inputPtr + (b * inputSequenceLength + t) * inputCodeLength;
+            auto dst = packPtr + (t * batchSize + b) * 4;
+            for (int c = 0; c < inputCodeLength; ++c) {
+                dst[(c / 4) * planes * 4 + c % 4] = src[c];
+            }
+        }
+    }
+
+    _runDirection(mFwInputWeight.get(), mFwGateWeight.get(), mFwCandidateWeight.get(), mFwBias.get(), false,
+                  mFwState.get(), outputs[0]);
+    // backward rnn, its outputs are in processing order
+    if (mIsBidirectionalRNN) {
+        _runDirection(mBwInputWeight.get(), mBwGateWeight.get(), mBwCandidateWeight.get(), mBwBias.get(), true,
+                      mBwState.get(), outputs[1]);
+    }
     return NO_ERROR;
 }
 
@@ -205,7 +340,12 @@ class CPURNNSequenceGRUCreator : public CPUBackend::Creator {
 public:
     virtual Execution* onCreate(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs,
                                 const MNN::Op* op, Backend* backend) const override {
-        return new CPURNNSequenceGRU(op, backend);
+        auto execution = new CPURNNSequenceGRU(op, backend);
+        if (!execution->valid()) {
+            delete execution;
+            return nullptr;
+        }
+        return execution;
     }
 };
 
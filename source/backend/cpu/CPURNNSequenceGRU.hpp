@@ -19,25 +19,41 @@ public:
     virtual ~CPURNNSequenceGRU();
     virtual ErrorCode onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
     virtual ErrorCode onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+    virtual bool onSetStateful(bool stateful) override;
+    virtual void onResetState() override;
+    virtual std::vector<Tensor *> onGetState() override;
 
 private:
+    void _runDirection(const Tensor *inputWeight, const Tensor *gateWeight, const Tensor *candidateWeight,
+                       const Tensor *bias, bool reverse, Tensor *state, Tensor *output);
+    void _releaseState();
+
     bool mKeepAllOutputs;
     bool mIsBidirectionalRNN;
     int mNumUnits;
+    int mInputLength;
+    int mThreadNumber;
 
+    // all buffers are in C4 layout, input of every step and batch is a plane, ordered by step first
+    std::shared_ptr<Tensor> mInputPack;
+    std::shared_ptr<Tensor> mInputProjection;
     std::shared_ptr<Tensor> mHiddenState;
-    std::shared_ptr<Tensor> mInputAndState;
+    std::shared_ptr<Tensor> mResetHidden;
     std::shared_ptr<Tensor> mGate;
-    // forward weight and bias
+    // hidden state of each direction in [batch, numUnits], kept between executions in stateful mode
+    bool mStateful = false;
+    std::shared_ptr<Tensor> mFwState;
+    std::shared_ptr<Tensor> mBwState;
+    // forward weight and bias, split by input / hidden and packed for MNNGemmFloatCommon_4
+    std::shared_ptr<Tensor> mFwInputWeight;
     std::shared_ptr<Tensor> mFwGateWeight;
-    std::shared_ptr<Tensor> mFwGateBias;
     std::shared_ptr<Tensor> mFwCandidateWeight;
-    std::shared_ptr<Tensor> mFwCandidateBias;
+    std::shared_ptr<Tensor> mFwBias;
     // backward weight and bias
+    std::shared_ptr<Tensor> mBwInputWeight;
     std::shared_ptr<Tensor> mBwGateWeight;
-    std::shared_ptr<Tensor> mBwGateBias;
     std::shared_ptr<Tensor> mBwCandidateWeight;
-    std::shared_ptr<Tensor> mBwCandidateBias;
+    std::shared_ptr<Tensor> mBwBias;
 };
 
 } // namespace MNN
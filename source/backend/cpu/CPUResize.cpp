@@ -8,14 +8,14 @@
 
 #include "CPUResize.hpp"
 #include <math.h>
+#include <algorithm>
 #include "AutoStorage.h"
 #include "CPUBackend.hpp"
 #include "Concurrency.h"
 #include "Macro.h"
+#include "Vec4.hpp"
 
-#ifdef MNN_USE_NEON
-#include <arm_neon.h>
-#endif
+using namespace MNN::Math;
 
 extern "C" {
 void MNNCubicSampleC4(const float* src, float* dst, int32_t* position, const float* factor, size_t number);
@@ -29,39 +29,33 @@ static void CPUBilinearSampleC4(const float* src, float* dst, const int32_t* pos
                                 size_t number) {
     for (int i = 0; i < number; ++i) {
         float f = factor[i];
-#ifdef MNN_USE_NEON
-        float32x4_t df = vdupq_n_f32(f);
-        float32x4_t sf = vdupq_n_f32(1.0f - f);
-        float32x4_t A  = vld1q_f32(src + position[2 * i] * 4);
-        float32x4_t B  = vld1q_f32(src + position[2 * i + 1] * 4);
-        vst1q_f32(dst + 4 * i, B * df + A * sf);
-#else
-        for (int k = 0; k < 4; ++k) {
-            float A        = src[4 * position[2 * i + 0] + k];
-            float B        = src[4 * position[2 * i + 1] + k];
-            dst[4 * i + k] = B * f + A * (1 - f);
+        auto A  = Vec4::load(src + position[2 * i] * 4);
+        auto B  = Vec4::load(src + position[2 * i + 1] * 4);
+        Vec4::save(dst + 4 * i, B * f + A * (1.0f - f));
+    }
+}
+
+// output x of i * scale + j lies between input i and i + 1 at j / scale
+static void CPUBilinearSampleScaleC4(const float* src, float* dst, int inW, int scale) {
+    const float step = 1.0f / scale;
+    for (int i = 0; i < inW; ++i) {
+        auto A = Vec4::load(src + 4 * i);
+        auto B = Vec4::load(src + 4 * std::min(i + 1, inW - 1));
+        Vec4::save(dst, A);
+        auto delta = B - A;
+        for (int j = 1; j < scale; ++j) {
+            Vec4::save(dst + 4 * j, A + delta * (j * step));
         }
-#endif
+        dst += 4 * scale;
     }
 }
 
 static void CPUBilinearLineC4(float* dst, const float* A, const float* B, const float* t, size_t number) {
-#ifdef MNN_USE_NEON
-    float32x4_t df = vdupq_n_f32(*t);
-    float32x4_t sf = vdupq_n_f32(1.0f) - df;
-    for (int i = 0; i < number; ++i) {
-        float32x4_t value = vld1q_f32(A + 4 * i) * sf + vld1q_f32(B + 4 * i) * df;
-        vst1q_f32(dst + 4 * i, value);
-    }
-#else
     float f = *t;
     for (int i = 0; i < number; ++i) {
-        for (int j = 0; j < 4; ++j) {
-            int k = i * 4 + j;
-            dst[k] = A[k] * (1 - f) + B[k] * f;
-        }
+        auto value = Vec4::load(A + 4 * i) * (1.0f - f) + Vec4::load(B + 4 * i) * f;
+        Vec4::save(dst + 4 * i, value);
     }
-#endif
 }
 
 static int CLAMP(int v, int min, int max) {
@@ -164,6 +158,31 @@ void CPUResizeCubicC4(halide_buffer_t& input, halide_buffer_t& output) {
     }
 }
 
+// planes of all batches are split into bands of rows if there are too few of them to balance threads
+static int _bandCount(int planes, int outH, int threadNumber) {
+    if (threadNumber <= 1 || planes >= 4 * threadNumber) {
+        return 1;
+    }
+    return std::min(outH, UP_DIV(4 * threadNumber, planes));
+}
+
+// scale if output x of i * scale + j samples input i at j / scale, else 0
+static int _integerScale(const int* position, const float* factor, int positionStep, int inW, int outW) {
+    if (outW < 2 * inW || 0 != outW % inW) {
+        return 0;
+    }
+    const int scale = outW / inW;
+    for (int x = 0; x < outW; ++x) {
+        if (position[positionStep * x] != x / scale) {
+            return 0;
+        }
+        if (nullptr != factor && fabsf(factor[x] - (float)(x % scale) / scale) > 1e-6f) {
+            return 0;
+        }
+    }
+    return scale;
+}
+
 void CPUResizeBilinearC4(halide_buffer_t& input, halide_buffer_t& output, const int* widthPosition,
                          const float* widthFactor, const int* heightPosition, const float* heightFactor,
                          float* lineBuffer, int threadNumber) {
@@ -174,69 +193,52 @@ void CPUResizeBilinearC4(halide_buffer_t& input, halide_buffer_t& output, const
     const int inH             = input.dim[2].extent;
     const int outW            = output.dim[3].extent;
     const int outH            = output.dim[2].extent;
-
-    int depthQuad = UP_DIV(input.dim[1].extent, 4);
-
-    for (int b = 0; b < batches; ++b) {
-        auto threadFunction = [&](size_t tId) {
-            for (int n = (int)tId; n < depthQuad; n += threadNumber) {
-                auto _lineBuffer = lineBuffer + 2 * 4 * outW * tId;
-                auto _line0      = _lineBuffer + 4 * outW * 0;
-                auto _line1      = _lineBuffer + 4 * outW * 1;
-                int yUsed[2]     = {0, 0};
-                int yCache[2]    = {-1, -1};
-
-                float* yCacheLine[2]          = {_line0, _line1};
-                float* const yCacheStorage[2] = {_line0, _line1};
-
-                auto bottomData =
-                    reinterpret_cast<const float*>(input.host) + b * inputBatchSize + (int)n * 4 * inW * inH;
-                auto topData = reinterpret_cast<float*>(output.host) + b * outputBatchSize + (int)n * 4 * outW * outH;
-                for (int dy = 0; dy < outH; dy++) {
-                    int yp[2];
-                    yp[0] = heightPosition[2 * dy + 0];
-                    yp[1] = heightPosition[2 * dy + 1];
-                    // Search cache
-                    for (int j = 0; j < 2; ++j) {
-                        yUsed[j] = 0;
+    const int depthQuad       = UP_DIV(input.dim[1].extent, 4);
+    const int planes          = batches * depthQuad;
+    const int bands           = _bandCount(planes, outH, threadNumber);
+    const int xScale          = _integerScale(widthPosition, widthFactor, 2, inW, outW);
+
+    MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+        auto _lineBuffer = lineBuffer + 2 * 4 * outW * tId;
+        for (int u = (int)tId; u < planes * bands; u += threadNumber) {
+            const int b      = u / bands / depthQuad;
+            const int n      = u / bands % depthQuad;
+            const int yStart = (int)((int64_t)outH * (u % bands) / bands);
+            const int yEnd   = (int)((int64_t)outH * (u % bands + 1) / bands);
+            auto bottomData  = reinterpret_cast<const float*>(input.host) + b * inputBatchSize + n * 4 * inW * inH;
+            auto topData     = reinterpret_cast<float*>(output.host) + b * outputBatchSize + n * 4 * outW * outH;
+
+            // each input row is sampled in x once, kept while output rows move down
+            float* yCacheLine[2] = {_lineBuffer, _lineBuffer + 4 * outW};
+            int yCache[2]        = {-1, -1};
+            for (int dy = yStart; dy < yEnd; ++dy) {
+                const int yp[2] = {heightPosition[2 * dy + 0], heightPosition[2 * dy + 1]};
+                if (yCache[1] == yp[0]) {
+                    std::swap(yCacheLine[0], yCacheLine[1]);
+                    std::swap(yCache[0], yCache[1]);
+                }
+                for (int j = 0; j < 2; ++j) {
+                    if (yCache[j] == yp[j]) {
+                        continue;
                     }
-                    for (int j = 0; j < 2; ++j) {
-                        int find = 0;
-                        for (int k = 0; k < 2; ++k) {
-                            if (yp[j] == yCache[k]) {
-                                yUsed[k]      = 1;
-                                yCacheLine[j] = yCacheStorage[k];
-                                find          = 1;
-                                break;
-                            }
-                        }
-                        if (!find) {
-                            const float* bottomY0 = bottomData + yp[j] * inW * 4;
-                            for (int k = 0; k < 2; ++k) {
-                                if (!yUsed[k]) {
-                                    yCache[k]     = yp[j];
-                                    yUsed[k]      = 1;
-                                    yCacheLine[j] = yCacheStorage[k];
-                                    CPUBilinearSampleC4(bottomY0, yCacheLine[j], widthPosition, widthFactor, outW);
-                                    break;
-                                }
-                            }
-                        }
+                    const float* bottomY = bottomData + yp[j] * inW * 4;
+                    if (xScale > 0) {
+                        CPUBilinearSampleScaleC4(bottomY, yCacheLine[j], inW, xScale);
+                    } else {
+                        CPUBilinearSampleC4(bottomY, yCacheLine[j], widthPosition, widthFactor, outW);
                     }
-                    auto topY = topData + outW * 4 * dy;
-                    // Sample Input
-                    CPUBilinearLineC4(topY, yCacheLine[0], yCacheLine[1], &heightFactor[dy], outW);
+                    yCache[j] = yp[j];
                 }
+                auto topY = topData + outW * 4 * dy;
+                CPUBilinearLineC4(topY, yCacheLine[0], yCacheLine[1], &heightFactor[dy], outW);
             }
-        };
-        MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
-            threadFunction(tId);
         }
-        MNN_CONCURRENCY_END();
     }
+    MNN_CONCURRENCY_END();
 }
 
-void CPUReiseNearstneighborC4(halide_buffer_t& input, halide_buffer_t& output, float wScale, float hScale) {
+void CPUReiseNearstneighborC4(halide_buffer_t& input, halide_buffer_t& output, const int* widthPosition,
+                              const int* heightPosition, int threadNumber) {
     const int batches         = input.dim[0].extent;
     const int inputBatchSize  = input.dim[0].stride;
     const int outputBatchSize = output.dim[0].stride;
@@ -244,36 +246,40 @@ void CPUReiseNearstneighborC4(halide_buffer_t& input, halide_buffer_t& output, f
     const int inH             = input.dim[2].extent;
     const int outW            = output.dim[3].extent;
     const int outH            = output.dim[2].extent;
-    const float xScaling      = wScale;
-    const float yScaling      = hScale;
     const int depthQuad       = UP_DIV(input.dim[1].extent, 4);
-
-    AutoStorage<int> linePosition(outW);
-    auto _linePosition = linePosition.get();
-    for (int x = 0; x < outW; ++x) {
-        float src_x      = x * xScaling;
-        int x1           = static_cast<int>(floor(src_x));
-        _linePosition[x] = CLAMP(x1, 0, inW - 1);
-    }
-
-    for (int b = 0; b < batches; ++b) {
-        MNN_CONCURRENCY_BEGIN(n, depthQuad) {
-            auto srcData =
-                reinterpret_cast<const float*>(input.host) + b * inputBatchSize + static_cast<int>(n) * 4 * inW * inH;
-            auto dstData =
-                reinterpret_cast<float*>(output.host) + b * outputBatchSize + static_cast<int>(n) * 4 * outW * outH;
-            for (int dy = 0; dy < outH; ++dy) {
-                float srcY       = dy * yScaling;
-                const int y_     = CLAMP(static_cast<int>(floor(srcY)), 0, inH - 1);
-                auto srcDataLine = srcData + inW * 4 * y_;
+    const int planes          = batches * depthQuad;
+    const int bands           = _bandCount(planes, outH, threadNumber);
+    const int xScale          = _integerScale(widthPosition, nullptr, 1, inW, outW);
+
+    MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+        for (int u = (int)tId; u < planes * bands; u += threadNumber) {
+            const int b      = u / bands / depthQuad;
+            const int n      = u / bands % depthQuad;
+            const int yStart = (int)((int64_t)outH * (u % bands) / bands);
+            const int yEnd   = (int)((int64_t)outH * (u % bands + 1) / bands);
+            auto srcData     = reinterpret_cast<const float*>(input.host) + b * inputBatchSize + n * 4 * inW * inH;
+            auto dstData     = reinterpret_cast<float*>(output.host) + b * outputBatchSize + n * 4 * outW * outH;
+            for (int dy = yStart; dy < yEnd; ++dy) {
                 auto dstDataLine = dstData + outW * 4 * dy;
+                auto srcDataLine = srcData + inW * 4 * heightPosition[dy];
+                if (xScale > 0) {
+                    auto dst = dstDataLine;
+                    for (int sx = 0; sx < inW; ++sx) {
+                        auto value = Vec4::load(srcDataLine + 4 * sx);
+                        for (int j = 0; j < xScale; ++j) {
+                            Vec4::save(dst + 4 * j, value);
+                        }
+                        dst += 4 * xScale;
+                    }
+                    continue;
+                }
                 for (int dx = 0; dx < outW; ++dx) {
-                    ::memcpy(dstDataLine + dx * 4, srcDataLine + _linePosition[dx] * 4, sizeof(float) * 4);
+                    Vec4::save(dstDataLine + dx * 4, Vec4::load(srcDataLine + widthPosition[dx] * 4));
                 }
             }
         }
-        MNN_CONCURRENCY_END();
     }
+    MNN_CONCURRENCY_END();
 }
 
 CPUResize::CPUResize(Backend* backend, float xScale, float yScale)
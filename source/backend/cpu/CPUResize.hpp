@@ -19,7 +19,8 @@ void CPUResizeBilinearC4(halide_buffer_t &input, halide_buffer_t &output,
                          const int* widthPosition, const float* widthFactor,
                          const int* heightPosition, const float* heightFactor,
                          float* lineBuffer, int threadNumber);
-void CPUReiseNearstneighborC4(halide_buffer_t &input, halide_buffer_t &output, float wScale, float hScale);
+void CPUReiseNearstneighborC4(halide_buffer_t &input, halide_buffer_t &output, const int* widthPosition,
+                              const int* heightPosition, int threadNumber);
 
 class CPUResize : public Execution {
 public:
@@ -16,6 +16,8 @@
 #endif
 
 #if __APPLE__
+#include <stdint.h>
+#include <sys/sysctl.h>
 #if TARGET_OS_IPHONE
 #define __IOS__ 1
 #endif
@@ -228,3 +230,72 @@ int MNNSetCPUThreadsMode(MNNCPUThreadsMode mode) {
     return -1;
 #endif // arch
 }
+
+#if defined(__linux__) || defined(__ANDROID__)
+static int getCacheSizeBytes(int cpuID, int level) {
+    char path[256];
+    for (int index = 0;; ++index) {
+        sprintf(path, "/sys/devices/system/cpu/cpu%d/cache/index%d/level", cpuID, index);
+        FILE* fp = fopen(path, "rb");
+        if (!fp) {
+            return -1;
+        }
+        int cacheLevel = 0;
+        int count      = fscanf(fp, "%d", &cacheLevel);
+        fclose(fp);
+        if (count != 1 || cacheLevel != level) {
+            continue;
+        }
+        sprintf(path, "/sys/devices/system/cpu/cpu%d/cache/index%d/type", cpuID, index);
+        fp = fopen(path, "rb");
+        if (fp) {
+            char type[32] = {0};
+            int count     = fscanf(fp, "%31s", type);
+            fclose(fp);
+            if (count == 1 && strcmp(type, "Instruction") == 0) {
+                continue;
+            }
+        }
+        sprintf(path, "/sys/devices/system/cpu/cpu%d/cache/index%d/size", cpuID, index);
+        fp = fopen(path, "rb");
+        if (!fp) {
+            return -1;
+        }
+        int size  = -1;
+        char unit = 0;
+        count     = fscanf(fp, "%d%c", &size, &unit);
+        fclose(fp);
+        if (count < 1 || size <= 0) {
+            return -1;
+        }
+        if (unit == 'K') {
+            size *= 1024;
+        } else if (unit == 'M') {
+            size *= 1024 * 1024;
+        }
+        return size;
+    }
+}
+#endif
+
+static int detectL2CacheSize() {
+    int size = -1;
+#if defined(__linux__) || defined(__ANDROID__)
+    size = getCacheSizeBytes(0, 2);
+#elif __APPLE__
+    int64_t value    = 0;
+    size_t valueSize = sizeof(value);
+    if (0 == sysctlbyname("hw.l2cachesize", &value, &valueSize, nullptr, 0)) {
+        size = (int)value;
+    }
+#endif
+    if (size <= 0) {
+        size = 512 * 1024;
+    }
+    return size;
+}
+
+int MNNGetL2CacheSize() {
+    static int cacheSize = detectL2CacheSize();
+    return cacheSize;
+}
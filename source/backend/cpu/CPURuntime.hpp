@@ -25,4 +25,9 @@ typedef enum {
 } MNNCPUThreadsMode;
 int MNNSetCPUThreadsMode(MNNCPUThreadsMode mode);
 
+/*
+ Size in bytes of the L2 data cache of first CPU, read once from system and 512KB if unknown
+ */
+int MNNGetL2CacheSize();
+
 #endif /* CPUInfo_hpp */
@@ -7,9 +7,9 @@
 //
 
 #include "CPUSelu.hpp"
-#include <math.h>
 #include "CPUBackend.hpp"
 #include "Macro.h"
+#include "compute/MathFunction.hpp"
 
 namespace MNN {
 
@@ -23,17 +23,14 @@ ErrorCode CPUSelu::onExecute(const std::vector<Tensor *> &inputs, const std::vec
     MNN_ASSERT(1 == inputs.size());
     MNN_ASSERT(1 == outputs.size());
     MNN_ASSERT(inputs[0]->buffer().type.bytes() == 4);
-    auto scaleAlpha = mAlpha * mScale;
-    auto ptr        = inputs[0]->host<float>();
-    auto outptr     = outputs[0]->host<float>();
-    int size        = inputs[0]->size() / sizeof(float);
-    for (int i = 0; i < size; i++) {
-        if (ptr[i] < 0.f) {
-            outptr[i] = scaleAlpha * (::expf(ptr[i]) - 1.f);
-        } else {
-            outptr[i] = mScale * ptr[i];
-        }
-    }
+    auto ptr    = inputs[0]->host<float>();
+    auto outptr = outputs[0]->host<float>();
+    int size    = inputs[0]->size() / sizeof(float);
+    auto selu   = MathFunction::functions().selu;
+    auto scale  = mScale;
+    auto alpha  = mAlpha;
+    MathFunction::parallel([=](float *dst, const float *src, int count) { selu(dst, src, count, scale, alpha); },
+                           outptr, ptr, size, ((CPUBackend *)backend())->threadNumber());
 
     return NO_ERROR;
 }
@@ -8,7 +8,9 @@
 
 #include "CPUSoftmax.hpp"
 #include "Concurrency.h"
+#include <float.h>
 #include <math.h>
+#include <algorithm>
 #include "CPUBackend.hpp"
 #include "CommonOptFunction.h"
 #include "Macro.h"
@@ -51,16 +53,15 @@ static void elementwiseExp(float* dst, const float* src, int dataSize) {
         dst[i]  = expBasic * expRemain;
     }
 }
-    
-static int _softmax1(const float *srcData, float *dstData, int outside, int channel, int threadNum) {
-    MNN_CONCURRENCY_BEGIN(tId, threadNum);
-    {
-        const float *srcY = srcData + tId * channel;
-        float *dstY       = dstData + tId * channel;
-        for (int y = (int)tId; y < outside; y += threadNum, srcY += channel*threadNum, dstY += channel*threadNum) {
-            float maxValue = srcY[0];
-            {
-                int c = 1;
+
+// rows are visited by blocks, max and sum are tracked together so that input is read only once
+static const int gRowBlock = 256;
+// floats of a tile, tiles of strided softmax stay in cache between max, exp and normalize
+static const int gTileSize = 8192;
+
+static float _max(const float *src, int size) {
+    float maxValue = src[0];
+    int i          = 1;
 #ifdef MNN_USE_NEON
 #if !(defined(__ARM_FEATURE_FMA) && defined(__aarch64__))
 #define vmaxvq_f32(v)                 \
@@ -73,205 +74,331 @@ static int _softmax1(const float *srcData, float *dstData, int outside, int chan
         __m;                          \
     })
 #endif
-                if (c + 3 < channel) {
-                    float32x4_t maxx4 = vld1q_f32(srcY + c);
-                    c += 4;
-                    for (; c + 3 < channel; c += 4) {
-                        maxx4 = vmaxq_f32(maxx4, vld1q_f32(srcY + c));
-                    }
-                    float value = vmaxvq_f32(maxx4);
-                    if (value > maxValue)
-                        maxValue = value;
-                }
+    if (i + 3 < size) {
+        float32x4_t maxx4 = vld1q_f32(src + i);
+        i += 4;
+        for (; i + 3 < size; i += 4) {
+            maxx4 = vmaxq_f32(maxx4, vld1q_f32(src + i));
+        }
+        maxValue = std::max(maxValue, vmaxvq_f32(maxx4));
+    }
 #endif
-                for (; c < channel; ++c) {
-                    float value = srcY[c];
-                    if (value > maxValue)
-                        maxValue = value;
-                }
-            }
-            
-            for (int c = 0; c < channel; ++c) {
-                dstY[c] = -srcY[c] + maxValue;
-            }
-            
-            elementwiseExp(dstY, dstY, channel);
-            
-            // sum
-            float sumValue = 0;
+    for (; i < size; ++i) {
+        maxValue = std::max(maxValue, src[i]);
+    }
+    return maxValue;
+}
 
-            for (int c = 0; c < channel; ++c) {
-                sumValue += dstY[c];
-            }
-            
-            // div
-            {
-                int c = 0;
+static float _sum(const float *src, int size) {
+    float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    int i        = 0;
+    for (; i + 3 < size; i += 4) {
+        for (int j = 0; j < 4; ++j) {
+            sum[j] += src[i + j];
+        }
+    }
+    for (; i < size; ++i) {
+        sum[0] += src[i];
+    }
+    return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+}
+
+static void _scale(float *dst, int size, float scale) {
+    int i = 0;
 #ifdef MNN_USE_NEON
-                float div = 1.f / sumValue;
-                for (; c + 3 < channel; c += 4) {
-                    vst1q_f32(dstY + c, vmulq_n_f32(vld1q_f32(dstY + c), div));
-                }
+    for (; i + 3 < size; i += 4) {
+        vst1q_f32(dst + i, vmulq_n_f32(vld1q_f32(dst + i), scale));
+    }
 #endif
-                for (; c < channel; ++c) {
-                    dstY[c] /= sumValue;
-                }
-            }
+    for (; i < size; ++i) {
+        dst[i] *= scale;
+    }
+}
+
+// online normalizer: sum of exp(x - m) is rescaled by exp(m' - m) whenever the running max grows from m' to m.
+// softmax writes exp(x - m) of each block with m of that time, which is corrected by exp(m - max) / sum at last.
+static void _softmaxRow(const float *src, float *dst, int channel, bool isLog, float *blockMax, float *expBuffer) {
+    float maxValue = -FLT_MAX, sumValue = 0.0f;
+    const int blockCount = UP_DIV(channel, gRowBlock);
+    for (int b = 0; b < blockCount; ++b) {
+        const int start = b * gRowBlock;
+        const int size  = std::min(channel - start, gRowBlock);
+        auto srcBlock   = src + start;
+        auto value      = _max(srcBlock, size);
+        if (value > maxValue) {
+            sumValue *= expf(maxValue - value);
+            maxValue = value;
+        }
+        auto expBlock = isLog ? expBuffer : dst + start;
+        for (int i = 0; i < size; ++i) {
+            expBlock[i] = maxValue - srcBlock[i];
         }
+        elementwiseExp(expBlock, expBlock, size);
+        sumValue += _sum(expBlock, size);
+        blockMax[b] = maxValue;
     }
-    MNN_CONCURRENCY_END();
+    if (isLog) {
+        const float bias = maxValue + logf(sumValue);
+        for (int c = 0; c < channel; ++c) {
+            dst[c] = src[c] - bias;
+        }
+        return;
+    }
+    for (int b = 0; b < blockCount; ++b) {
+        const int start = b * gRowBlock;
+        _scale(dst + start, std::min(channel - start, gRowBlock), expf(blockMax[b] - maxValue) / sumValue);
+    }
+}
 
-    return 0;
+// softmax over channel of [channel, inside] for the first size of inside
+static void _softmaxTile(const float *src, float *dst, int channel, int inside, int size, bool isLog,
+                         float *maxValue, float *sumValue) {
+    ::memcpy(maxValue, src, size * sizeof(float));
+    for (int c = 1; c < channel; ++c) {
+        auto s = src + c * inside;
+        for (int x = 0; x < size; ++x) {
+            maxValue[x] = std::max(maxValue[x], s[x]);
+        }
+    }
+    ::memset(sumValue, 0, size * sizeof(float));
+    for (int c = 0; c < channel; ++c) {
+        auto s = src + c * inside;
+        auto d = dst + c * inside;
+        for (int x = 0; x < size; ++x) {
+            d[x] = maxValue[x] - s[x];
+        }
+        elementwiseExp(d, d, size);
+        for (int x = 0; x < size; ++x) {
+            sumValue[x] += d[x];
+        }
+    }
+    if (isLog) {
+        for (int x = 0; x < size; ++x) {
+            maxValue[x] += logf(sumValue[x]);
+        }
+        for (int c = 0; c < channel; ++c) {
+            auto s = src + c * inside;
+            auto d = dst + c * inside;
+            for (int x = 0; x < size; ++x) {
+                d[x] = s[x] - maxValue[x];
+            }
+        }
+        return;
+    }
+    for (int x = 0; x < size; ++x) {
+        sumValue[x] = 1.0f / sumValue[x];
+    }
+    for (int c = 0; c < channel; ++c) {
+        auto d = dst + c * inside;
+        for (int x = 0; x < size; ++x) {
+            d[x] *= sumValue[x];
+        }
+    }
 }
-static int _softmaxCommon(const float *srcData, float *dstData, int inside, int outside, int channel, float* maxValue, float* sumValue, int threadNum) {
-    if (inside == 1)
-        return _softmax1(srcData, dstData, outside, channel, threadNum);
-    
-    const int stepY   = inside * channel;
-    MNN_CONCURRENCY_BEGIN(tId, threadNum);
-    {
-        const float *srcY = srcData + tId * stepY;
-        float *dstY       = dstData + tId * stepY;
-        float* maxValueSub = maxValue + tId * inside;
-        float* sumValueSub = sumValue + tId * inside;
-        
-        for (int y = (int)tId; y < outside; y += threadNum, srcY += stepY * threadNum, dstY += stepY * threadNum) {
-            memcpy(maxValueSub, srcY, sizeof(float) * inside);
-            const float *src = srcY + inside;
-            for (int c = 1; c < channel; ++c, src += inside) {
-                for (int x = 0; x < inside; ++x) {
-                    if (src[x] > maxValueSub[x])
-                        maxValueSub[x] = src[x];
-                }
+
+// channel of NC4HW4 is laid out as quads of [area, 4], the 4 lanes of each position are merged after max and sum.
+// lanes beyond channel in the last quad are skipped and set to zero
+static void _softmaxC4Tile(const float *src, float *dst, int channel, int area, int size, bool isLog,
+                           float *maxValue, float *sumValue) {
+    const int quad   = channel / 4;
+    const int remain = channel % 4;
+    const int total  = UP_DIV(channel, 4);
+    const int stride = area * 4;
+    const int count  = size * 4;
+    for (int i = 0; i < count; ++i) {
+        maxValue[i] = -FLT_MAX;
+    }
+    for (int z = 0; z < quad; ++z) {
+        auto s = src + z * stride;
+        for (int i = 0; i < count; ++i) {
+            maxValue[i] = std::max(maxValue[i], s[i]);
+        }
+    }
+    if (remain > 0) {
+        auto s = src + quad * stride;
+        for (int p = 0; p < size; ++p) {
+            for (int l = 0; l < remain; ++l) {
+                maxValue[4 * p + l] = std::max(maxValue[4 * p + l], s[4 * p + l]);
             }
-            memset(sumValueSub, 0, sizeof(float) * inside);
-            src        = srcY;
-            float *dst = dstY;
-            for (int c = 0; c < channel; ++c, src += inside, dst += inside) {
-                for (int x = 0; x < inside; ++x) {
-                    dst[x] = -src[x] + maxValueSub[x];
-                }
+        }
+    }
+    for (int p = 0; p < size; ++p) {
+        auto m = maxValue + 4 * p;
+        m[0] = m[1] = m[2] = m[3] = std::max(std::max(m[0], m[1]), std::max(m[2], m[3]));
+    }
+    auto clearRemain = [=](float *d) {
+        for (int p = 0; p < size; ++p) {
+            for (int l = remain; l < 4; ++l) {
+                d[4 * p + l] = 0.0f;
             }
-            
-            dst = dstY;
-            elementwiseExp(dst, dst, inside*channel);
-            
-            for (int c = 0; c < channel; ++c, src += inside, dst += inside) {
-                for (int x = 0; x < inside; ++x) {
-                    sumValueSub[x] += dst[x];
-                }
+        }
+    };
+    ::memset(sumValue, 0, count * sizeof(float));
+    for (int z = 0; z < total; ++z) {
+        auto s = src + z * stride;
+        auto d = dst + z * stride;
+        for (int i = 0; i < count; ++i) {
+            d[i] = maxValue[i] - s[i];
+        }
+        elementwiseExp(d, d, count);
+        if (z == quad) {
+            clearRemain(d);
+        }
+        for (int i = 0; i < count; ++i) {
+            sumValue[i] += d[i];
+        }
+    }
+    for (int p = 0; p < size; ++p) {
+        auto v = sumValue + 4 * p;
+        v[0] = v[1] = v[2] = v[3] = (v[0] + v[1]) + (v[2] + v[3]);
+    }
+    if (isLog) {
+        for (int i = 0; i < count; ++i) {
+            maxValue[i] += logf(sumValue[i]);
+        }
+        for (int z = 0; z < total; ++z) {
+            auto s = src + z * stride;
+            auto d = dst + z * stride;
+            for (int i = 0; i < count; ++i) {
+                d[i] = s[i] - maxValue[i];
             }
-            
-            dst = dstY;
-            for (int c = 0; c < channel; ++c, dst += inside) {
-                for (int x = 0; x < inside; ++x) {
-                    dst[x] /= sumValueSub[x];
-                }
+            if (z == quad) {
+                clearRemain(d);
             }
         }
+        return;
+    }
+    for (int i = 0; i < count; ++i) {
+        sumValue[i] = 1.0f / sumValue[i];
+    }
+    for (int z = 0; z < total; ++z) {
+        auto d = dst + z * stride;
+        for (int i = 0; i < count; ++i) {
+            d[i] *= sumValue[i];
+        }
     }
-    MNN_CONCURRENCY_END();
-    return 0;
 }
 
 ErrorCode CPUSoftmax::onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) {
-    auto input           = inputs[0];
-    const int dimensions = input->buffer().dimensions;
-    
-    const auto layout = TensorUtils::getDescribe(input)->dimensionFormat;
-    mNeedUnpackC4     = layout == MNN_DATA_FORMAT_NC4HW4;
-    
-    if (mNeedUnpackC4) {
-        int totalSize = 1;
-        for (int i = 0; i < dimensions; ++i) {
-            totalSize *= input->length(i);
+    auto input     = inputs[0];
+    const int dims = input->buffer().dimensions;
+    const auto c4  = TensorUtils::getDescribe(input)->dimensionFormat == MNN_DATA_FORMAT_NC4HW4;
+    const int axis = mAxis;
+    int threadNum  = ((CPUBackend *)backend())->threadNumber();
+    mChannelC4     = c4 && 1 == axis;
+    mOutside       = 1;
+    mInside        = 1;
+    mChannel       = input->length(axis);
+    if (mChannelC4) {
+        // [batch, channel, area], quads of channel are reduced in place
+        mOutside = input->length(0);
+        for (int i = 2; i < dims; ++i) {
+            mInside *= input->length(i);
+        }
+    } else {
+        // other axis of NC4HW4 sees [batch, channel / 4, ..., 4] as plain data, padded lanes run as well
+        for (int i = 0; i < axis; ++i) {
+            mOutside *= (c4 && 1 == i) ? UP_DIV(input->length(i), 4) : input->length(i);
+        }
+        for (int i = axis + 1; i < dims; ++i) {
+            mInside *= (c4 && 1 == i) ? UP_DIV(input->length(i), 4) : input->length(i);
+        }
+        if (c4) {
+            mInside *= 4;
         }
-        mStorage.buffer().dim[0].extent = 1;
-        mStorage.buffer().dim[1].extent = totalSize;
-        mStorage.buffer().dim[1].flags  = 0;
-        mStorage.buffer().dimensions    = 2;
-        mStorage.buffer().type          = input->getType();
-        backend()->onAcquireBuffer(&mStorage, Backend::DYNAMIC);
-    }
-    
-    int inside = 1;
-    int dims = input->buffer().dimensions;
-    for (int i = mAxis + 1; i < dims; ++i) {
-        inside *= input->length(i);
     }
 
-    if (inside != 1) { // not run _softmax1, we need maxValue Tensor and sumValue Tensor.
-        int threadNum = ((CPUBackend*)backend())->threadNumber();
-        
-        mMaxValue.buffer().dim[0].extent = inside * threadNum;
-        mMaxValue.buffer().dimensions    = 1;
-        mMaxValue.setType(DataType_DT_FLOAT);
-        backend()->onAcquireBuffer(&mMaxValue, Backend::DYNAMIC);
-        
-        mSumValue.buffer().dim[0].extent = inside * threadNum;
-        mSumValue.buffer().dimensions    = 1;
-        mSumValue.setType(DataType_DT_FLOAT);
-        backend()->onAcquireBuffer(&mSumValue, Backend::DYNAMIC);
-        
-        backend()->onReleaseBuffer(&mMaxValue, Backend::DYNAMIC);
-        backend()->onReleaseBuffer(&mSumValue, Backend::DYNAMIC);
+    int maxSize = 0, sumSize = 0;
+    if (1 == mInside) {
+        // channel of NC4HW4 without area is a plain row padded to 4
+        mTile   = 1;
+        maxSize = UP_DIV(mChannel, gRowBlock);
+        sumSize = gRowBlock;
+    } else if (mChannelC4) {
+        mTile   = std::min(mInside, std::max(gTileSize / (UP_DIV(mChannel, 4) * 4), 4));
+        maxSize = mTile * 4;
+        sumSize = mTile * 4;
+    } else {
+        mTile   = std::min(mInside, std::max(gTileSize / mChannel, 16));
+        maxSize = mTile;
+        sumSize = mTile;
     }
-    
-    if (mNeedUnpackC4) {
-        backend()->onReleaseBuffer(&mStorage, Backend::DYNAMIC);
+    mMaxValue.buffer().dim[0].extent = maxSize * threadNum;
+    mMaxValue.buffer().dimensions    = 1;
+    mMaxValue.setType(DataType_DT_FLOAT);
+    mSumValue.buffer().dim[0].extent = sumSize * threadNum;
+    mSumValue.buffer().dimensions    = 1;
+    mSumValue.setType(DataType_DT_FLOAT);
+    bool success = backend()->onAcquireBuffer(&mMaxValue, Backend::DYNAMIC);
+    success      = success && backend()->onAcquireBuffer(&mSumValue, Backend::DYNAMIC);
+    if (!success) {
+        return OUT_OF_MEMORY;
     }
-    
+    backend()->onReleaseBuffer(&mMaxValue, Backend::DYNAMIC);
+    backend()->onReleaseBuffer(&mSumValue, Backend::DYNAMIC);
     return NO_ERROR;
 }
 
 ErrorCode CPUSoftmax::onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) {
     MNN_ASSERT(1 == inputs.size());
     MNN_ASSERT(1 == outputs.size());
-    auto inputTensor        = inputs[0];
-    auto outputTensor       = outputs[0];
-    const auto inputDataPtr = inputTensor->host<float>();
-    auto outputDataPtr      = outputTensor->host<float>();
-    const int batch         = inputTensor->batch();
-    const auto dims         = inputTensor->buffer().dimensions;
+    const auto src      = inputs[0]->host<float>();
+    auto dst            = outputs[0]->host<float>();
+    auto maxBuffer      = mMaxValue.host<float>();
+    auto sumBuffer      = mSumValue.host<float>();
+    const int threadNum = ((CPUBackend *)backend())->threadNumber();
+    const int outside   = mOutside;
+    const int channel   = mChannel;
+    const int inside    = mInside;
+    const int tile      = mTile;
+    const bool isLog    = mLog;
 
-    float *tempData = nullptr;
-    if (mNeedUnpackC4) {
-        tempData = mStorage.host<float>();
-    }
-    
-    int areaInput = 1;
-    for (int i = 2; i < dims; ++i) {
-        areaInput *= inputTensor->length(i);
-    }
-    int inside  = 1;
-    int outside = 1;
-    int channel = 1;
-    for (int i = 1; i < mAxis; ++i) {
-        outside *= inputTensor->length(i);
+    if (1 == inside) {
+        const int blockCount = UP_DIV(channel, gRowBlock);
+        const int stride     = mChannelC4 ? ALIGN_UP4(channel) : channel;
+        MNN_CONCURRENCY_BEGIN(tId, threadNum) {
+            for (int y = (int)tId; y < outside; y += threadNum) {
+                _softmaxRow(src + y * stride, dst + y * stride, channel, isLog, maxBuffer + tId * blockCount,
+                            sumBuffer + tId * gRowBlock);
+            }
+        }
+        MNN_CONCURRENCY_END();
+        return NO_ERROR;
     }
-    channel = inputTensor->length(mAxis);
-    for (int i = mAxis + 1; i < dims; ++i) {
-        inside *= inputTensor->length(i);
+    if (mChannelC4) {
+        const int tileCount   = UP_DIV(inside, tile);
+        const int tasks       = outside * tileCount;
+        const int batchStride = UP_DIV(channel, 4) * inside * 4;
+        MNN_CONCURRENCY_BEGIN(tId, threadNum) {
+            for (int t = (int)tId; t < tasks; t += threadNum) {
+                const int start  = (t % tileCount) * tile;
+                const int size   = std::min(inside - start, tile);
+                const int offset = (t / tileCount) * batchStride + start * 4;
+                _softmaxC4Tile(src + offset, dst + offset, channel, inside, size, isLog, maxBuffer + tId * tile * 4,
+                               sumBuffer + tId * tile * 4);
+            }
+        }
+        MNN_CONCURRENCY_END();
+        return NO_ERROR;
     }
-
-    int threadNum = ((CPUBackend*)backend())->threadNumber();
-    int batchSize = outputTensor->size() / sizeof(float) / batch;
-    for (int batchIndex = 0; batchIndex < batch; ++batchIndex) {
-        auto inputData  = inputDataPtr + batchIndex * batchSize;
-        auto outputData = outputDataPtr + batchIndex * batchSize;
-        if (1 == areaInput || !mNeedUnpackC4) {
-            _softmaxCommon(inputData, outputData, inside, outside, channel, mMaxValue.host<float>(), mSumValue.host<float>(), threadNum);
-            continue;
+    // tiles of inside run in parallel as well, so that few outside still keeps all threads busy
+    const int tileCount = UP_DIV(inside, tile);
+    const int tasks     = outside * tileCount;
+    MNN_CONCURRENCY_BEGIN(tId, threadNum) {
+        for (int t = (int)tId; t < tasks; t += threadNum) {
+            const int start  = (t % tileCount) * tile;
+            const int size   = std::min(inside - start, tile);
+            const int offset = (t / tileCount) * channel * inside + start;
+            _softmaxTile(src + offset, dst + offset, channel, inside, size, isLog, maxBuffer + tId * tile,
+                         sumBuffer + tId * tile);
         }
-        MNNUnpackC4(outputData, inputData, areaInput, inputTensor->channel());
-        _softmaxCommon(outputData, tempData, inside, outside, channel, mMaxValue.host<float>(), mSumValue.host<float>(), threadNum);
-        MNNPackC4(outputData, tempData, areaInput, outputTensor->channel());
     }
-
+    MNN_CONCURRENCY_END();
     return NO_ERROR;
 }
 
-CPUSoftmax::CPUSoftmax(Backend *b, int axis) : MNN::Execution(b), mAxis(axis), mStorage(2), mNeedUnpackC4(false) {
+CPUSoftmax::CPUSoftmax(Backend *b, int axis, bool isLog)
+    : MNN::Execution(b), mAxis(axis), mLog(isLog), mChannelC4(false), mOutside(1), mChannel(1), mInside(1), mTile(1) {
     // nothing to do
 }
 
@@ -279,14 +406,16 @@ class CPUSoftmaxCreator : public CPUBackend::Creator {
 public:
     virtual Execution *onCreate(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs,
                                 const MNN::Op *op, Backend *backend) const override {
-        auto axis = op->main_as_Axis()->axis();
+        // LogSoftmax from tensorflow has no axis, the last one is used
+        auto axis = nullptr != op->main_as_Axis() ? op->main_as_Axis()->axis() : -1;
         if (axis < 0) {
             axis = inputs[0]->dimensions() + axis;
         }
-        return new CPUSoftmax(backend, axis);
+        return new CPUSoftmax(backend, axis, OpType_LogSoftmax == op->type());
     }
 };
 
 REGISTER_CPU_OP_CREATOR(CPUSoftmaxCreator, OpType_Softmax);
+REGISTER_CPU_OP_CREATOR(CPUSoftmaxCreator, OpType_LogSoftmax);
 
 } // namespace MNN
@@ -14,17 +14,22 @@
 namespace MNN {
 class CPUSoftmax : public Execution {
 public:
-    CPUSoftmax(Backend *b, int axis);
+    CPUSoftmax(Backend *b, int axis, bool isLog = false);
     virtual ~CPUSoftmax() = default;
     virtual ErrorCode onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
     virtual ErrorCode onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
 
 private:
     int mAxis;
-    Tensor mStorage;
+    bool mLog;
+    // softmax over channel of [outside, channel, inside], channel of NC4HW4 is computed in place of its quads
+    bool mChannelC4;
+    int mOutside;
+    int mChannel;
+    int mInside;
+    int mTile;
     Tensor mMaxValue;
     Tensor mSumValue;
-    bool mNeedUnpackC4;
 };
 } // namespace MNN
 
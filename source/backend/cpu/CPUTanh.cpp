@@ -7,28 +7,12 @@
 //
 
 #include "CPUTanh.hpp"
-#include <math.h>
 #include "CPUBackend.hpp"
 #include "Macro.h"
+#include "compute/MathFunction.hpp"
 
 namespace MNN {
 
-// Lambert's series with 7 divisions
-// reference from
-// https://varietyofsound.wordpress.com/2011/02/14/efficient-tanh-computation-using-lamberts-continued-fraction/
-inline float tanhf_poly(float value) {
-    if (value > 5.0) {
-        return 1.0;
-    } else if (value <= -5.0) {
-        return -1.0;
-    } else {
-        float x2 = value * value;
-        float a  = value * (135135.0f + x2 * (17325.0f + x2 * (378.0f + x2)));
-        float b  = 135135.0f + x2 * (62370.0f + x2 * (3150.0f + x2 * 28.0f));
-        return a / b;
-    }
-}
-
 ErrorCode CPUTanh::onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) {
     MNN_ASSERT(1 == inputs.size());
     MNN_ASSERT(1 == outputs.size());
@@ -36,11 +20,8 @@ ErrorCode CPUTanh::onExecute(const std::vector<Tensor *> &inputs, const std::vec
     auto outputData = outputs[0]->host<float>();
 
     const int dataSize = outputs[0]->elementSize();
-
-    for (int i = 0; i < dataSize; i++) {
-        // outputData[i] = 1 - 2 / (expf(2 * inputData[i]) + 1);
-        outputData[i] = tanhf_poly(inputData[i]);
-    }
+    MathFunction::parallel(MathFunction::functions().tanh, outputData, inputData, dataSize,
+                           ((CPUBackend *)backend())->threadNumber());
 
     return NO_ERROR;
 }
@@ -10,147 +10,89 @@
 #include "CPUBackend.hpp"
 #include "Macro.h"
 #include "TensorUtils.hpp"
-#include "compute/CommonOptFunction.h"
+#include "compute/PermuteFunction.hpp"
 
 namespace MNN {
 
-static void _NC4HW42NHWCUint8(const uint8_t* dest, uint8_t* source, int b, int h, int w, int c) {
-    int sourceBatchsize = h * w * c;
-    int destBatchSize   = ALIGN_UP4(c) * w * h;
-    for (int bi = 0; bi < b; ++bi) {
-        auto srcBatch = source + bi * sourceBatchsize;
-        auto dstBatch = dest + bi * destBatchSize;
-        MNNTensorConvertNC4HW4ToNHWCUint8(srcBatch, dstBatch, w * h, c);
+// strides of n, c, h, w in elements, channel of NC4HW4 is the C4 one whose stride is that of planes
+static void _strides(MNN_DATA_FORMAT format, int c, int h, int w, PermuteFunction::Axis* axes, bool dst) {
+    int strides[4];
+    switch (format) {
+        case MNN_DATA_FORMAT_NHWC:
+            strides[0] = h * w * c;
+            strides[1] = 1;
+            strides[2] = w * c;
+            strides[3] = c;
+            break;
+        case MNN_DATA_FORMAT_NC4HW4:
+            strides[0] = UP_DIV(c, 4) * h * w * 4;
+            strides[1] = h * w * 4;
+            strides[2] = w * 4;
+            strides[3] = 4;
+            break;
+        default:
+            strides[0] = c * h * w;
+            strides[1] = h * w;
+            strides[2] = w;
+            strides[3] = 1;
+            break;
     }
-}
-
-static void _NHWC2NC4HW4Uint8(const uint8_t* source, uint8_t* dest, int b, int h, int w, int c) {
-    int sourceBatchsize = h * w * c;
-    int destBatchSize   = ALIGN_UP4(c) * w * h;
-    int area            = w * h;
-    for (int bi = 0; bi < b; ++bi) {
-        auto srcBatch = source + bi * sourceBatchsize;
-        auto dstBatch = dest + bi * destBatchSize;
-        MNNTensorConvertNHWCToNC4HW4Uint8(dstBatch, srcBatch, area, c);
-    }
-}
-
-void CPUTensorConverter::NC4HW42NHWC(const float* dest, float* source, int b, int h, int w, int c) {
-    int sourceBatchsize = h * w * c;
-    int destBatchSize   = ALIGN_UP4(c) * w * h;
-    for (int bi = 0; bi < b; ++bi) {
-        auto srcBatch = source + bi * sourceBatchsize;
-        auto dstBatch = dest + bi * destBatchSize;
-        MNNTensorConvertNC4HW4ToNHWC(srcBatch, dstBatch, w * h, c);
-    }
-}
-
-void CPUTensorConverter::NHWC2NC4HW4(const float* source, float* dest, int b, int h, int w, int c) {
-    int sourceBatchsize = h * w * c;
-    int destBatchSize   = ALIGN_UP4(c) * w * h;
-    int area            = w * h;
-    for (int bi = 0; bi < b; ++bi) {
-        auto srcBatch = source + bi * sourceBatchsize;
-        auto dstBatch = dest + bi * destBatchSize;
-        MNNTensorConvertNHWCToNC4HW4(dstBatch, srcBatch, area, c);
-    }
-}
-
-void CPUTensorConverter::NCHW2NHWC(const float* source, float* dest, int b, int h, int w, int c) {
-    int sourceBatchsize = h * w * c;
-    int destBatchSize   = sourceBatchsize;
-    for (int bi = 0; bi < b; ++bi) {
-        auto srcBatch = source + bi * sourceBatchsize;
-        auto dstBatch = dest + bi * destBatchSize;
-        for (int hi = 0; hi < h; ++hi) {
-            auto srcHeight = srcBatch + hi * w;
-            auto dstHeight = dstBatch + hi * w * c;
-            for (int wi = 0; wi < w; ++wi) {
-                auto srcWidth = srcHeight + wi;
-                auto dstWidth = dstHeight + wi * c;
-                for (int ci = 0; ci < c; ++ci) {
-                    dstWidth[ci] = srcWidth[ci * w * h];
-                }
-            }
+    for (int i = 0; i < 4; ++i) {
+        if (dst) {
+            axes[i].dstStride = strides[i];
+            axes[i].dstC4     = 1 == i && MNN_DATA_FORMAT_NC4HW4 == format;
+        } else {
+            axes[i].srcStride = strides[i];
+            axes[i].srcC4     = 1 == i && MNN_DATA_FORMAT_NC4HW4 == format;
         }
     }
 }
 
-void CPUTensorConverter::NHWC2NCHW(const float* source, float* dest, int b, int h, int w, int c) {
-    int sourceBatchsize = h * w * c;
-    int destBatchSize   = sourceBatchsize;
-    for (int bi = 0; bi < b; ++bi) {
-        auto srcBatch = source + bi * sourceBatchsize;
-        auto dstBatch = dest + bi * destBatchSize;
-        for (int hi = 0; hi < h; ++hi) {
-            auto srcHeight = srcBatch + hi * w * c;
-            auto dstHeight = dstBatch + hi * w;
-            for (int wi = 0; wi < w; ++wi) {
-                auto dstWidth = dstHeight + wi;
-                auto srcWidth = srcHeight + wi * c;
-                for (int ci = 0; ci < c; ++ci) {
-                    dstWidth[ci * w * h] = srcWidth[ci];
-                }
-            }
+void CPUTensorConverter::convert(const void* source, void* dest, MNN_DATA_FORMAT sourceFormat,
+                                 MNN_DATA_FORMAT destFormat, int b, int c, int h, int w, int bytes,
+                                 int threadNumber) {
+    std::vector<PermuteFunction::Axis> axes(4);
+    const int extents[4] = {b, c, h, w};
+    for (int i = 0; i < 4; ++i) {
+        axes[i].extent = extents[i];
+    }
+    _strides(sourceFormat, c, h, w, axes.data(), false);
+    _strides(destFormat, c, h, w, axes.data(), true);
+    // channels of the last quad beyond the real ones are kept zero
+    if (MNN_DATA_FORMAT_NC4HW4 == destFormat && c % 4 != 0) {
+        const int plane = h * w * 4 * bytes;
+        for (int bi = 0; bi < b; ++bi) {
+            ::memset((uint8_t*)dest + (int64_t)axes[0].dstStride * bytes * bi + c / 4 * plane, 0, plane);
         }
     }
+    PermuteFunction::copy(dest, source, axes, bytes, threadNumber);
 }
 
-ErrorCode CPUTensorConverter::convert(const Tensor* input, const Tensor* output) {
+ErrorCode CPUTensorConverter::convert(const Tensor* input, const Tensor* output, int threadNumber) {
     auto ib     = input->buffer();
     auto ob     = output->buffer();
     auto source = TensorUtils::getDescribe(input)->dimensionFormat;
     auto dest   = TensorUtils::getDescribe(output)->dimensionFormat;
-    if (ib.dimensions < 4) {
+    if (ib.dimensions < 4 || source == dest) {
         ::memcpy(ob.host, ib.host, input->size());
         return NO_ERROR;
     }
 
-    if (MNN_DATA_FORMAT_NHWC == source && MNN_DATA_FORMAT_NC4HW4 == dest) {
-        int b = ib.dim[0].extent;
-        int h = ib.dim[1].extent;
-        int w = ib.dim[2].extent;
-        int c = ib.dim[3].extent;
-        if (ib.type.code == halide_type_uint) {
-            _NHWC2NC4HW4Uint8((uint8_t*)ib.host, (uint8_t*)ob.host, b, h, w, c);
-            return NO_ERROR;
-        }
-        NHWC2NC4HW4((float*)ib.host, (float*)ob.host, b, h, w, c);
-        return NO_ERROR;
-    } else if (MNN_DATA_FORMAT_NC4HW4 == source && MNN_DATA_FORMAT_NHWC == dest) {
-        int b = ob.dim[0].extent;
-        int h = ob.dim[1].extent;
-        int w = ob.dim[2].extent;
-        int c = ob.dim[3].extent;
-        if (ib.type.code == halide_type_uint) {
-            _NC4HW42NHWCUint8((uint8_t*)ib.host, (uint8_t*)ob.host, b, h, w, c);
-            return NO_ERROR;
-        }
-        NC4HW42NHWC((float*)ib.host, (float*)ob.host, b, h, w, c);
-        return NO_ERROR;
-    } else if (MNN_DATA_FORMAT_NHWC == source && MNN_DATA_FORMAT_NCHW == dest) {
-        int b = ib.dim[0].extent;
-        int h = ib.dim[1].extent;
-        int w = ib.dim[2].extent;
-        int c = ib.dim[3].extent;
-        NHWC2NCHW((float*)ib.host, (float*)ob.host, b, h, w, c);
-        return NO_ERROR;
-    } else if (MNN_DATA_FORMAT_NCHW == source && MNN_DATA_FORMAT_NHWC == dest) {
-        int b = ob.dim[0].extent;
-        int h = ob.dim[1].extent;
-        int w = ob.dim[2].extent;
-        int c = ob.dim[3].extent;
-        NCHW2NHWC((float*)ib.host, (float*)ob.host, b, h, w, c);
-        return NO_ERROR;
+    int b = ib.dim[0].extent;
+    int c = ib.dim[1].extent;
+    int h = ib.dim[2].extent;
+    int w = ib.dim[3].extent;
+    if (MNN_DATA_FORMAT_NHWC == source) {
+        c = ib.dim[3].extent;
+        h = ib.dim[1].extent;
+        w = ib.dim[2].extent;
     }
-
-    MNN_ASSERT(false);
-
-    return NOT_SUPPORT;
+    convert(ib.host, ob.host, source, dest, b, c, h, w, ib.type.bytes(), threadNumber);
+    return NO_ERROR;
 }
 
 ErrorCode CPUTensorConverter::onExecute(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
-    return convert(inputs[0], outputs[0]);
+    return convert(inputs[0], outputs[0], ((CPUBackend*)backend())->threadNumber());
 }
 
 class CPUTensorConvertFactory : public CPUBackend::Creator {
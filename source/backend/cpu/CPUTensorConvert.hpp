@@ -22,12 +22,13 @@ public:
     }
     virtual ~CPUTensorConverter() = default;
 
-    static void NHWC2NC4HW4(const float* source, float* dest, int b, int h, int w, int c);
-    static void NC4HW42NHWC(const float* dest, float* source, int b, int h, int w, int c);
-    static void NHWC2NCHW(const float* dest, float* source, int b, int h, int w, int c);
-    static void NCHW2NHWC(const float* source, float* dest, int b, int h, int w, int c);
+    /**
+     * @brief convert between NCHW, NHWC and NC4HW4 of elements of bytes, padding channels of NC4HW4 dest are zeroed.
+     */
+    static void convert(const void* source, void* dest, MNN_DATA_FORMAT sourceFormat, MNN_DATA_FORMAT destFormat,
+                        int b, int c, int h, int w, int bytes, int threadNumber = 1);
 
-    static ErrorCode convert(const Tensor* input, const Tensor* output);
+    static ErrorCode convert(const Tensor* input, const Tensor* output, int threadNumber = 1);
     virtual ErrorCode onExecute(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) override;
 
 private:
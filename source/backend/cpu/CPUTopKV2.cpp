@@ -7,85 +7,64 @@
 //
 
 #include "CPUTopKV2.hpp"
+#include <algorithm>
+#include <vector>
 #include "CPUBackend.hpp"
+#include "Concurrency.h"
 #include "Macro.h"
+#include "TopKFunction.hpp"
 
 namespace MNN {
 
-template <typename T>
-class TopContainer {
-public:
-    TopContainer() = delete;
-    TopContainer(int32_t k, int32_t rowSize) : mK(k) {
-        mContainer.reserve(std::min(k, rowSize) + 1);
-    }
-
-    void startCollecting(const T* values) {
-        mValues = values;
-        mContainer.clear();
-    }
-    void push(int32_t a) {
-        auto comparator = [this](int32_t a, int32_t b) { return compareFunc(a, b); };
-        if (mContainer.size() <= mK) {
-            mContainer.push_back(a);
-            if (mContainer.size() == mK + 1) {
-                std::make_heap(mContainer.begin(), mContainer.end(), comparator);
-                std::pop_heap(mContainer.begin(), mContainer.end(), comparator);
-            }
-        } else if (comparator(a, mContainer.front())) {
-            mContainer.back() = a;
-            std::push_heap(mContainer.begin(), mContainer.end(), comparator);
-            std::pop_heap(mContainer.begin(), mContainer.end(), comparator);
-        }
-    }
+// wide rows are split into chunks when there are not enough rows for threads
+static const int gChunkMinSize = 4096;
 
-    const std::vector<int32_t>& sortedResult() {
-        auto comparator = [this](int32_t a, int32_t b) { return compareFunc(a, b); };
-        if (mContainer.size() <= mK) {
-            std::sort(mContainer.begin(), mContainer.end(), comparator);
-        } else {
-            std::sort_heap(mContainer.begin(), mContainer.end() - 1, comparator);
-            mContainer.resize(mK);
+template <typename T>
+static void _findTopK(int32_t rowSize, int32_t numRows, const T* data, int32_t k, int32_t* outputIndexes,
+                      T* outputValues, int threadNumber) {
+    auto writeRow = [k](const T* valuesRow, const int32_t* indexesRow, T* outputRow) {
+        for (int i = 0; i < k; ++i) {
+            outputRow[i] = valuesRow[indexesRow[i]];
         }
-        return mContainer;
-    }
-
-private:
-    int32_t mK;
-    std::vector<int32_t> mContainer;
-    const T* mValues = nullptr;
-
-    bool compareFunc(int32_t a, int32_t b) const {
-        if (mValues[b] < mValues[a]) {
-            return true;
-        } else if (mValues[b] > mValues[a]) {
-            return false;
-        } else {
-            return a < b;
+    };
+    const int chunkNumber = std::min(threadNumber, rowSize / std::max(gChunkMinSize, 4 * k));
+    if (numRows >= threadNumber || chunkNumber <= 1) {
+        threadNumber = std::min(threadNumber, numRows);
+        MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+            for (int row = (int)tId; row < numRows; row += threadNumber) {
+                const T* valuesRow  = data + row * rowSize;
+                int32_t* indexesRow = outputIndexes + row * k;
+                TopKFunction::selectTopK(valuesRow, rowSize, k, indexesRow);
+                writeRow(valuesRow, indexesRow, outputValues + row * k);
+            }
         }
+        MNN_CONCURRENCY_END();
+        return;
     }
-};
 
-template <typename T>
-void findTopK(int32_t rowSize, int32_t numRows, const T* data, int32_t k, int32_t* outputIndexes, T* outputValues) {
-    TopContainer<T> topc(k, rowSize);
-    for (int row = 0; row < numRows; row++) {
+    // top k of each chunk, then merge them
+    const int chunkSize = UP_DIV(rowSize, chunkNumber);
+    std::vector<int32_t> chunkIndexes(chunkNumber * k);
+    auto chunkIndexesPtr = chunkIndexes.data();
+    for (int row = 0; row < numRows; ++row) {
         const T* valuesRow = data + row * rowSize;
-        topc.startCollecting(valuesRow);
-        for (int c = 0; c < rowSize; c++) {
-            topc.push(c);
+        MNN_CONCURRENCY_BEGIN(tId, chunkNumber) {
+            const int start = (int)tId * chunkSize;
+            const int size  = std::min(chunkSize, rowSize - start);
+            auto dst        = chunkIndexesPtr + tId * k;
+            TopKFunction::selectTopK(valuesRow + start, size, k, dst);
+            for (int i = 0; i < k; ++i) {
+                dst[i] += start;
+            }
         }
-
+        MNN_CONCURRENCY_END();
         int32_t* indexesRow = outputIndexes + row * k;
-        T* ouputRow         = outputValues + row * k;
-
-        const auto& topK = topc.sortedResult();
-        std::copy(topK.begin(), topK.end(), indexesRow);
-        std::transform(topK.begin(), topK.end(), ouputRow, [valuesRow](const int32_t loc) { return valuesRow[loc]; });
+        TopKFunction::selectTopK(valuesRow, chunkIndexesPtr, chunkNumber * k, k, indexesRow);
+        writeRow(valuesRow, indexesRow, outputValues + row * k);
     }
 }
 
-CPUTopKV2::CPUTopKV2(Backend* b, const TopKV2* TopKV2Param) : MNN::Execution(b), mTopKV2Param(TopKV2Param) {
+CPUTopKV2::CPUTopKV2(Backend* b, const TopKV2* TopKV2Param) : MNN::Execution(b), mDataType(TopKV2Param->T()) {
     // nothing to do
 }
 
@@ -95,20 +74,33 @@ ErrorCode CPUTopKV2::onExecute(const std::vector<Tensor*>& inputs, const std::ve
     auto outputData    = outputs[0];
     auto outputIndices = outputs[1];
 
-    auto dType               = mTopKV2Param->T();
+    auto dType               = mDataType;
     const int inputDimension = inputTensor->buffer().dimensions;
 
     const int rowSize = inputTensor->buffer().dim[inputDimension - 1].extent;
     MNN_ASSERT(k <= rowSize);
     const int numRows = inputTensor->elementSize() / rowSize;
-    if (MNN::DataType_DT_FLOAT == dType) {
-        auto inputData   = inputTensor->host<float>();
-        auto topkData    = outputData->host<float>();
-        int* indicesData = outputIndices->host<int32_t>();
-        findTopK<float>(rowSize, numRows, inputData, k, indicesData, topkData);
-    } else {
-        MNN_PRINT("TODO\n");
-        MNN_ASSERT(false);
+    if (0 == k) {
+        return NO_ERROR;
+    }
+    const int threadNumber = static_cast<CPUBackend*>(backend())->threadNumber();
+    int* indicesData       = outputIndices->host<int32_t>();
+    switch (dType) {
+        case DataType_DT_FLOAT:
+            _findTopK<float>(rowSize, numRows, inputTensor->host<float>(), k, indicesData, outputData->host<float>(),
+                             threadNumber);
+            break;
+        case DataType_DT_INT32:
+            _findTopK<int32_t>(rowSize, numRows, inputTensor->host<int32_t>(), k, indicesData,
+                               outputData->host<int32_t>(), threadNumber);
+            break;
+        case DataType_DT_UINT8:
+            _findTopK<uint8_t>(rowSize, numRows, inputTensor->host<uint8_t>(), k, indicesData,
+                               outputData->host<uint8_t>(), threadNumber);
+            break;
+        default:
+            MNN_ERROR("TopKV2 don't support data type %d\n", dType);
+            return NOT_SUPPORT;
     }
     return NO_ERROR;
 }
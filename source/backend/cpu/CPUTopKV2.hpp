@@ -20,7 +20,8 @@ public:
     virtual ErrorCode onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
 
 private:
-    const TopKV2 *mTopKV2Param;
+    // kept from the op, which is gone once the model is released after resize
+    DataType mDataType;
 };
 } // namespace MNN
 
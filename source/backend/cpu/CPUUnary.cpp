@@ -10,6 +10,7 @@
 #include <cmath>
 #include "CPUBackend.hpp"
 #include "Macro.h"
+#include "compute/MathFunction.hpp"
 
 namespace MNN {
 CPUUnary::CPUUnary(Backend *b, UnaryOpOperation type) : MNN::Execution(b), mType(type) {
@@ -40,6 +41,12 @@ static ErrorCode _unaryOp(Tensor *input, Tensor *output) {
     return NO_ERROR;
 }
 
+template <typename Function>
+static ErrorCode _unaryMath(const Function &function, Tensor *input, Tensor *output, int threadNumber) {
+    MathFunction::parallel(function, output->host<float>(), input->host<float>(), input->elementSize(), threadNumber);
+    return NO_ERROR;
+}
+
 template <typename T>
 struct UnarySquare : std::unary_function<T, T> {
     T operator()(const T &x) const {
@@ -68,13 +75,6 @@ struct UnaryNeg {
     }
 };
 
-template <typename T>
-struct UnaryExp : std::unary_function<T, T> {
-    T operator()(const T &x) const {
-        return std::exp(x);
-    }
-};
-
 template <typename T>
 struct UnaryAbs : std::unary_function<T, T> {
     T operator()(const T &x) const {
@@ -90,8 +90,9 @@ struct UnaryCeil : std::unary_function<T, T> {
 };
 
 ErrorCode CPUUnary::onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) {
-    auto input  = inputs[0];
-    auto output = outputs[0];
+    auto input        = inputs[0];
+    auto output       = outputs[0];
+    auto threadNumber = ((CPUBackend *)backend())->threadNumber();
 
     switch (mType) {
         case UnaryOpOperation_SQUARE:
@@ -104,7 +105,10 @@ ErrorCode CPUUnary::onExecute(const std::vector<Tensor *> &inputs, const std::ve
             return _unaryOp<UnaryNeg<float>>(input, output);
 
         case UnaryOpOperation_EXP:
-            return _unaryOp<UnaryExp<float>>(input, output);
+            return _unaryMath(MathFunction::functions().exp, input, output, threadNumber);
+
+        case UnaryOpOperation_LOG:
+            return _unaryMath(MathFunction::functions().log, input, output, threadNumber);
 
         case UnaryOpOperation_SQRT:
             return _unaryOp<UnarySqrt<float>>(input, output);
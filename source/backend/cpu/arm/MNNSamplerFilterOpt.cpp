@@ -0,0 +1,153 @@
+//
+//  MNNSamplerFilterOpt.cpp
+//  MNN
+//
+//  Created by MNN on 2019/09/09.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifdef MNN_USE_NEON
+
+#include <arm_neon.h>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include "ImageFilter.hpp"
+
+// points: x, y of first sample, step of x, y, then width, height and left, top of box relative to sample
+extern "C" {
+void MNNSamplerC4BicubicOpt(const unsigned char* source, unsigned char* dest, float* points, size_t count, size_t iw,
+                            size_t ih, size_t yStride);
+void MNNSamplerC4AreaOpt(const unsigned char* source, unsigned char* dest, float* points, size_t count, size_t iw,
+                         size_t ih, size_t yStride);
+}
+
+static inline uint32x4_t _loadPixelU32(const unsigned char* p) {
+    uint32_t v;
+    ::memcpy(&v, p, sizeof(uint32_t));
+    auto c = vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(v)));
+    return vmovl_u16(vget_low_u16(c));
+}
+
+static inline float32x4_t _loadPixel(const unsigned char* p) {
+    return vcvtq_f32_u32(_loadPixelU32(p));
+}
+
+// v is rounded
+static inline void _savePixel(unsigned char* p, float32x4_t v) {
+    auto d          = vcvtq_u32_f32(vaddq_f32(v, vdupq_n_f32(0.5f)));
+    auto h          = vqmovn_u32(d);
+    auto b          = vqmovn_u16(vcombine_u16(h, h));
+    uint32_t result = vget_lane_u32(vreinterpret_u32_u8(b), 0);
+    ::memcpy(p, &result, sizeof(uint32_t));
+}
+
+void MNNSamplerC4BicubicOpt(const unsigned char* source, unsigned char* dest, float* points, size_t count, size_t iw,
+                            size_t ih, size_t yStride) {
+    float x           = points[0];
+    float y           = points[1];
+    const float dx    = points[2];
+    const float dy    = points[3];
+    const int w       = (int)iw;
+    const int h       = (int)ih;
+    const float xMaxF = (float)(w - 1);
+    const float yMaxF = (float)(h - 1);
+    const auto minV   = vdupq_n_f32(0.0f);
+    const auto maxV   = vdupq_n_f32(255.0f);
+    for (size_t i = 0; i < count; ++i) {
+        const float cx = std::max(std::min(x, xMaxF), 0.0f);
+        const float cy = std::max(std::min(y, yMaxF), 0.0f);
+        const int x0   = (int)cx;
+        const int y0   = (int)cy;
+        float wx[4], wy[4];
+        MNN::CV::bicubicWeights(cx - x0, wx);
+        MNN::CV::bicubicWeights(cy - y0, wy);
+        int cols[4];
+        for (int k = 0; k < 4; ++k) {
+            cols[k] = 4 * std::max(std::min(x0 - 1 + k, w - 1), 0);
+        }
+        auto sum = vdupq_n_f32(0.0f);
+        for (int j = 0; j < 4; ++j) {
+            auto row  = source + std::max(std::min(y0 - 1 + j, h - 1), 0) * yStride;
+            auto line = vmulq_n_f32(_loadPixel(row + cols[0]), wx[0]);
+            line      = vmlaq_n_f32(line, _loadPixel(row + cols[1]), wx[1]);
+            line      = vmlaq_n_f32(line, _loadPixel(row + cols[2]), wx[2]);
+            line      = vmlaq_n_f32(line, _loadPixel(row + cols[3]), wx[3]);
+            sum       = vmlaq_n_f32(sum, line, wy[j]);
+        }
+        _savePixel(dest + 4 * i, vminq_f32(vmaxq_f32(sum, minV), maxV));
+        x += dx;
+        y += dy;
+    }
+}
+
+// sum of whole pixels [x0, x1) of a row, and of pixels partly covered at x0 - 1 and x1
+static inline float32x4_t _areaLine(const unsigned char* row, int x0, int x1, float wl, float wr) {
+    auto sum = vdupq_n_u32(0);
+    int sx   = x0;
+    while (sx + 4 <= x1) {
+        // four pixels a time, two of them per 16 bits lane for at most 64 times
+        auto sum16      = vdupq_n_u16(0);
+        const int limit = std::min(x1, sx + 4 * 64);
+        for (; sx + 4 <= limit; sx += 4) {
+            auto v = vld1q_u8(row + 4 * sx);
+            sum16  = vaddw_u8(sum16, vget_low_u8(v));
+            sum16  = vaddw_u8(sum16, vget_high_u8(v));
+        }
+        sum = vaddq_u32(sum, vaddl_u16(vget_low_u16(sum16), vget_high_u16(sum16)));
+    }
+    for (; sx < x1; ++sx) {
+        sum = vaddq_u32(sum, _loadPixelU32(row + 4 * sx));
+    }
+    auto line = vcvtq_f32_u32(sum);
+    if (wl > 0.0f) {
+        line = vmlaq_n_f32(line, _loadPixel(row + 4 * (x0 - 1)), wl);
+    }
+    if (wr > 0.0f) {
+        line = vmlaq_n_f32(line, _loadPixel(row + 4 * x1), wr);
+    }
+    return line;
+}
+
+void MNNSamplerC4AreaOpt(const unsigned char* source, unsigned char* dest, float* points, size_t count, size_t iw,
+                         size_t ih, size_t yStride) {
+    const int w       = (int)iw;
+    const int h       = (int)ih;
+    const float boxW  = std::min(std::max(points[4], 1.0f), (float)w);
+    const float boxH  = std::min(std::max(points[5], 1.0f), (float)h);
+    float x           = points[0] + points[6];
+    float y           = points[1] + points[7];
+    const float dx    = points[2];
+    const float dy    = points[3];
+    const float scale = 1.0f / (boxW * boxH);
+    for (size_t i = 0; i < count; ++i) {
+        const float l  = std::max(std::min(x, w - boxW), 0.0f);
+        const float t  = std::max(std::min(y, h - boxH), 0.0f);
+        const float r  = l + boxW;
+        const float b  = t + boxH;
+        const int x0   = (int)ceilf(l);
+        const int y0   = (int)ceilf(t);
+        const int x1   = std::min((int)r, w);
+        const int y1   = std::min((int)b, h);
+        const float wl = x0 - l;
+        const float wr = x1 < w ? r - x1 : 0.0f;
+        const float wt = y0 - t;
+        const float wb = y1 < h ? b - y1 : 0.0f;
+        auto sum       = vdupq_n_f32(0.0f);
+        for (int sy = y0; sy < y1; ++sy) {
+            sum = vaddq_f32(sum, _areaLine(source + sy * yStride, x0, x1, wl, wr));
+        }
+        if (wt > 0.0f) {
+            sum = vmlaq_n_f32(sum, _areaLine(source + (y0 - 1) * yStride, x0, x1, wl, wr), wt);
+        }
+        if (wb > 0.0f) {
+            sum = vmlaq_n_f32(sum, _areaLine(source + y1 * yStride, x0, x1, wl, wr), wb);
+        }
+        _savePixel(dest + 4 * i, vmulq_n_f32(sum, scale));
+        x += dx;
+        y += dy;
+    }
+}
+
+#endif
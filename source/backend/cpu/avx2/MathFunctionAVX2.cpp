@@ -0,0 +1,83 @@
+//
+//  MathFunctionAVX2.cpp
+//  MNN
+//
+//  Created by MNN on 2019/08/28.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifdef MNN_USE_AVX2
+
+#include <immintrin.h>
+#include "MathFunctionKernel.hpp"
+
+// this file is compiled with -mavx2 -mfma, it is only called after the cpu is checked
+namespace MNN {
+namespace MathFunction {
+struct VecAVX2 {
+    using T = __m256;
+    using M = __m256;
+    static const int size = 8;
+    static T set1(float v) {
+        return _mm256_set1_ps(v);
+    }
+    static T load(const float* addr) {
+        return _mm256_loadu_ps(addr);
+    }
+    static void store(float* addr, T v) {
+        _mm256_storeu_ps(addr, v);
+    }
+    static T add(T a, T b) {
+        return _mm256_add_ps(a, b);
+    }
+    static T sub(T a, T b) {
+        return _mm256_sub_ps(a, b);
+    }
+    static T mul(T a, T b) {
+        return _mm256_mul_ps(a, b);
+    }
+    static T div(T a, T b) {
+        return _mm256_div_ps(a, b);
+    }
+    static T fma(T a, T b, T c) {
+        return _mm256_fmadd_ps(a, b, c);
+    }
+    static T min(T a, T b) {
+        return _mm256_min_ps(a, b);
+    }
+    static T max(T a, T b) {
+        return _mm256_max_ps(a, b);
+    }
+    static T floor(T x) {
+        return _mm256_floor_ps(x);
+    }
+    static M less(T a, T b) {
+        return _mm256_cmp_ps(a, b, _CMP_LT_OQ);
+    }
+    static M equal(T a, T b) {
+        return _mm256_cmp_ps(a, b, _CMP_EQ_OQ);
+    }
+    static T select(M mask, T a, T b) {
+        return _mm256_blendv_ps(b, a, mask);
+    }
+    static T pow2n(T n) {
+        return _mm256_castsi256_ps(
+            _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvttps_epi32(n), _mm256_set1_epi32(127)), 23));
+    }
+    static T frexp(T x, T& e) {
+        auto bits = _mm256_castps_si256(x);
+        e = _mm256_sub_ps(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(0xff))),
+                          _mm256_set1_ps(126.0f));
+        return _mm256_castsi256_ps(
+            _mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x807fffff)), _mm256_set1_epi32(0x3f000000)));
+    }
+};
+
+const Functions& functionsAVX2() {
+    static const Functions gFunctions = Kernel<VecAVX2>::functions();
+    return gFunctions;
+}
+} // namespace MathFunction
+} // namespace MNN
+
+#endif
@@ -255,6 +255,30 @@ void MNNPowC8(float* dest, const float* source, const float* powfParam, size_t b
 
 #endif
 
+#ifndef MNN_USE_SSE
+void MNNUInt8ToFloatWithOffsetC4(float* dst, const uint8_t* src, const float* offset, size_t sizeQuad) {
+#ifdef MNN_USE_NEON
+    auto offsetV  = vld1q_f32(offset);
+    size_t sizeC4 = sizeQuad / 4;
+    for (size_t i = 0; i < sizeC4; ++i, src += 16, dst += 16) {
+        uint8x16_t v = vld1q_u8(src);
+        uint16x8_t l = vmovl_u8(vget_low_u8(v));
+        uint16x8_t h = vmovl_u8(vget_high_u8(v));
+        vst1q_f32(dst + 0, vaddq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(l))), offsetV));
+        vst1q_f32(dst + 4, vaddq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(l))), offsetV));
+        vst1q_f32(dst + 8, vaddq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(h))), offsetV));
+        vst1q_f32(dst + 12, vaddq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(h))), offsetV));
+    }
+    sizeQuad = sizeQuad % 4;
+#endif
+    for (size_t i = 0; i < sizeQuad; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            dst[4 * i + j] = src[4 * i + j] + offset[j];
+        }
+    }
+}
+#endif
+
 void MNNTensorConvertNHWCToNC4HW4Uint8(uint8_t* dst, const uint8_t* src, size_t area, size_t depth) {
     if (depth == 4) {
         ::memcpy(dst, src, area * depth * sizeof(uint8_t));
@@ -51,6 +51,8 @@ void MNNUInt8ToInt16WithOffsetC4Common(int16_t* dst, const uint8_t* src, size_t
                                        size_t dstStride, size_t srcStride);
 void MNNUInt8ToInt16WithOffsetC4Fast(int16_t* dst, const uint8_t* src, size_t zeroPoint, size_t sizeQuad,
                                      size_t depthQuad, size_t dstZStep, size_t srcZStep);
+// dst[4 * i + j] = src[4 * i + j] + offset[j]
+void MNNUInt8ToFloatWithOffsetC4(float* dst, const uint8_t* src, const float* offset, size_t sizeQuad);
 void MNNMaxFloat(float* input, float* maxBuffer, int32_t inputCountUnit);
 void MNNMinFloat(float* input, float* maxBuffer, int32_t inputCountUnit);
 void MNNExpC8(float* dest, const float* source, const float* parameters, size_t countC8);
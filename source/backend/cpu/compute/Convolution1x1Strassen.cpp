@@ -151,7 +151,8 @@ ErrorCode Convolution1x1Strassen::onResize(const std::vector<Tensor *> &inputs,
     auto memoryPool = ((CPUBackend *)backend())->getBufferAllocator();
     memoryPool->barrierBegin();
     std::shared_ptr<void> __a(nullptr, [memoryPool](void *) { memoryPool->barrierEnd(); });
-    int maxDepth = 5;
+    // depth of Strassen tree, gains stop at 3 as sub matrices then fit in L2 and the cost model keeps them flat
+    int maxDepth = 3;
     if (outputPlane > CONVOLUTION_TILED_NUMBWR * 8 * numberThread && outputPlane > ocC4) {
         // Divide in plane, in this case the divide equal numberThread
         int divideStep = UP_DIV(outputPlane, numberThread);
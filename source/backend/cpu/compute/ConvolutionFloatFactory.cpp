@@ -12,10 +12,12 @@
 #include "Convolution1x1Strassen.hpp"
 #include "Convolution3x3.hpp"
 #include "ConvolutionGroup.hpp"
+#include "ConvolutionImageInput.hpp"
 #include "ConvolutionIntFactory.hpp"
 #include "ConvolutionTiledExecutor.hpp"
 #include "ConvolutionWinograd.hpp"
 #include "Macro.h"
+#include "TensorUtils.hpp"
 namespace MNN {
 
 static Execution* _createUnit(const Tensor* input, const Tensor* output, Backend* backend,
@@ -58,6 +60,10 @@ Execution* ConvolutionFloatFactory::create(const std::vector<Tensor*>& inputs, c
             return nullptr;
         }
         if (quanCommon->weightFloat.get() == nullptr) {
+            if (!TensorUtils::getDescribe(inputs[0])->imageNormal.empty()) {
+                MNN_ERROR("Image input can't be folded into int8 convolution %s\n", op->name()->c_str());
+                return nullptr;
+            }
             return ConvolutionIntFactory::create(inputs[0], outputs[0], op, backend, quanCommon.get());
         }
         // Back to float
@@ -70,6 +76,24 @@ Execution* ConvolutionFloatFactory::create(const std::vector<Tensor*>& inputs, c
         originWeightSize = op->main_as_Convolution2D()->weight()->size();
     }
 
+    auto& imageNormal = TensorUtils::getDescribe(inputs[0])->imageNormal;
+    if (!imageNormal.empty()) {
+        // scheduled only for single group of at most 4 channels, weights in [oc][ic][ky][kx]
+        const int plane = common->kernelX() * common->kernelY();
+        const int ic    = (int)originWeightSize / (common->outputCount() * plane);
+        if (1 != common->group() || ic > 4) {
+            MNN_ERROR("Image input can't be folded into convolution %s\n", op->name()->c_str());
+            return nullptr;
+        }
+        std::vector<float> weight(originWeight, originWeight + originWeightSize);
+        for (int i = 0; i < weight.size(); ++i) {
+            weight[i] *= imageNormal[(i / plane) % ic];
+        }
+        std::shared_ptr<Execution> unit(_createUnit(inputs[0], outputs[0], backend, common, weight.data(),
+                                                    weight.size(), conv2d->bias()->data(), conv2d->bias()->size()));
+        return new ConvolutionImageInput(backend, unit, TensorUtils::getDescribe(inputs[0])->imageMean);
+    }
+
     if (1 == common->group()) {
         return _createUnit(inputs[0], outputs[0], backend, common, originWeight, originWeightSize,
                            conv2d->bias()->data(), conv2d->bias()->size());
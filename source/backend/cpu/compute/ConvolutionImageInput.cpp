@@ -0,0 +1,54 @@
+//
+//  ConvolutionImageInput.cpp
+//  MNN
+//
+//  Created by MNN on 2019/09/11.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "ConvolutionImageInput.hpp"
+#include "CPUBackend.hpp"
+#include "CommonOptFunction.h"
+#include "Concurrency.h"
+#include "Macro.h"
+#include "TensorUtils.hpp"
+
+namespace MNN {
+ConvolutionImageInput::ConvolutionImageInput(Backend *b, std::shared_ptr<Execution> convolution,
+                                             const std::vector<float> &mean)
+    : MNN::Execution(b) {
+    mConvolution = convolution;
+    mInputFloat.reset(new Tensor(4));
+    for (int i = 0; i < 4; ++i) {
+        mOffset[i] = i < mean.size() ? -mean[i] : 0.0f;
+    }
+}
+
+ErrorCode ConvolutionImageInput::onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) {
+    TensorUtils::copyShape(inputs[0], mInputFloat.get(), true);
+    mInputFloat->buffer().type = halide_type_of<float>();
+    if (!backend()->onAcquireBuffer(mInputFloat.get(), Backend::DYNAMIC)) {
+        return OUT_OF_MEMORY;
+    }
+    auto code = mConvolution->onResize({mInputFloat.get()}, outputs);
+    backend()->onReleaseBuffer(mInputFloat.get(), Backend::DYNAMIC);
+    return code;
+}
+
+ErrorCode ConvolutionImageInput::onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) {
+    // at most 4 channels, image is a run of quads
+    auto input       = inputs[0];
+    const int count  = input->batch() * input->height() * input->width();
+    auto src         = input->host<uint8_t>();
+    auto dst         = mInputFloat->host<float>();
+    int threadNumber = ((CPUBackend *)backend())->threadNumber();
+    threadNumber     = std::max(1, std::min(threadNumber, count / 1024));
+    MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+        const int start = (int)((int64_t)count * tId / threadNumber);
+        const int end   = (int)((int64_t)count * (tId + 1) / threadNumber);
+        MNNUInt8ToFloatWithOffsetC4(dst + 4 * start, src + 4 * start, mOffset, end - start);
+    }
+    MNN_CONCURRENCY_END();
+    return mConvolution->onExecute({mInputFloat.get()}, outputs);
+}
+} // namespace MNN
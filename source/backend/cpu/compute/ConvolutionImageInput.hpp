@@ -0,0 +1,36 @@
+//
+//  ConvolutionImageInput.hpp
+//  MNN
+//
+//  Created by MNN on 2019/09/11.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef ConvolutionImageInput_hpp
+#define ConvolutionImageInput_hpp
+
+#include "Execution.hpp"
+
+namespace MNN {
+/** convolution reading uint8 image input, whose normal is folded into weights of wrapped float convolution */
+class ConvolutionImageInput : public Execution {
+public:
+    /**
+     * @param convolution   float convolution with normal folded into weights.
+     * @param mean          mean of each channel, subtracted as image turns float.
+     */
+    ConvolutionImageInput(Backend *b, std::shared_ptr<Execution> convolution, const std::vector<float> &mean);
+    virtual ~ConvolutionImageInput() = default;
+
+    virtual ErrorCode onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+
+    virtual ErrorCode onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+
+private:
+    std::shared_ptr<Execution> mConvolution;
+    std::unique_ptr<Tensor> mInputFloat;
+    float mOffset[4];
+};
+} // namespace MNN
+
+#endif /* ConvolutionImageInput_hpp */
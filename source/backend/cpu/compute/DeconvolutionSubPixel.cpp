@@ -0,0 +1,400 @@
+//
+//  DeconvolutionSubPixel.cpp
+//  MNN
+//
+//  Created by MNN on 2019/08/30.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "DeconvolutionSubPixel.hpp"
+#include <string.h>
+#include "CPUBackend.hpp"
+#include "CommonOptFunction.h"
+#include "Concurrency.h"
+#include "ConvOpt.h"
+#include "Macro.h"
+#include "TensorUtils.hpp"
+#include "WingoradGenerater.hpp"
+#include "WinogradOptFunction.hpp"
+
+namespace MNN {
+
+// rounds to minus infinity, pad may be negative for SAME
+static inline int _floorDiv(int a, int b) {
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+// Winograd output unit for a square phase, 0 when multiplying directly costs less. the cost is that of
+// ConvolutionWinograd::bestWinogradUnit without the waste on edges, as the output size is not known yet
+static int _winogradUnit(int taps, int ic, int oc) {
+    // taps and units having both transforms of 4x4 or 8x8
+    static const int candidates[][2] = {{2, 3}, {3, 2}, {3, 6}};
+    int best       = 0;
+    float bestRate = 1.0f;
+    for (auto& c : candidates) {
+        if (c[0] != taps) {
+            continue;
+        }
+        const int unit       = c[1];
+        const float su       = (float)(unit + taps - 1);
+        const float direct   = (float)taps * taps * ic * oc * unit * unit;
+        const float winograd = 2 * su * su * su * ic + su * su * ic * oc + 2 * su * unit * unit * oc;
+        const float rate     = direct / winograd - (su * su) / (float)(taps * taps) * 0.12f;
+        if (rate > bestRate) {
+            bestRate = rate;
+            best     = unit;
+        }
+    }
+    return best;
+}
+
+DeconvolutionSubPixel::DeconvolutionSubPixel(const Op* convOp, Backend* b) : CPUDeconvolutionCommon(convOp, b) {
+    if (!mValid) {
+        return;
+    }
+    auto conv2D             = convOp->main_as_Convolution2D();
+    auto common             = conv2D->common();
+    const int kx            = common->kernelX();
+    const int ky            = common->kernelY();
+    const int sx            = common->strideX();
+    const int sy            = common->strideY();
+    mStrideX                = sx;
+    mStrideY                = sy;
+    const int oc            = common->outputCount();
+    const int ic            = mSrcCount;
+    const int icDiv4        = UP_DIV(ic, 4);
+    const int ocDiv4        = UP_DIV(oc, 4);
+    const float* tempWeight = conv2D->weight()->data();
+
+    for (int y = 0; y < sy; ++y) {
+        for (int x = 0; x < sx; ++x) {
+            mPhases.emplace_back();
+            auto& phase    = mPhases.back();
+            phase.yResidue = y;
+            phase.xResidue = x;
+            phase.yTaps    = y < ky ? UP_DIV(ky - y, sy) : 0;
+            phase.xTaps    = x < kx ? UP_DIV(kx - x, sx) : 0;
+            const int taps = phase.yTaps * phase.xTaps;
+            if (0 == taps) {
+                continue;
+            }
+            if (phase.yTaps == phase.xTaps && _winogradUnit(phase.yTaps, ic, oc) > 0) {
+                if (!_setupWinograd(phase, tempWeight, kx, ky, sx, sy, ic, oc)) {
+                    mValid = false;
+                    return;
+                }
+                continue;
+            }
+            phase.weight.reset(Tensor::createDevice<float>({ocDiv4, taps * icDiv4, 16}));
+            if (!b->onAcquireBuffer(phase.weight.get(), Backend::STATIC)) {
+                mValid = false;
+                return;
+            }
+            // weight of deconvolution is [ic][oc][ky][kx], 16 is [ic % 4][oc % 4] for MNNGemmFloatUnit_4
+            auto dest = phase.weight->host<float>();
+            ::memset(dest, 0, phase.weight->size());
+            for (int o = 0; o < oc; ++o) {
+                for (int i = 0; i < ic; ++i) {
+                    for (int jy = 0; jy < phase.yTaps; ++jy) {
+                        for (int jx = 0; jx < phase.xTaps; ++jx) {
+                            const int tap = jy * phase.xTaps + jx;
+                            const int fy  = y + jy * sy;
+                            const int fx  = x + jx * sx;
+                            dest[((o / 4) * taps * icDiv4 + tap * icDiv4 + i / 4) * 16 + 4 * (i % 4) + o % 4] =
+                                tempWeight[((i * oc + o) * ky + fy) * kx + fx];
+                        }
+                    }
+                }
+            }
+        }
+    }
+    mTileBuffer.reset(new Tensor(2));
+    mMidBuffer.reset(new Tensor(2));
+}
+
+bool DeconvolutionSubPixel::_setupWinograd(Phase& phase, const float* weight, int kx, int ky, int sx, int sy, int ic,
+                                           int oc) {
+    const int taps = phase.yTaps;
+    phase.unit     = _winogradUnit(taps, ic, oc);
+    phase.alpha    = phase.unit + taps - 1;
+
+    // the phase is a correlation with the flipped sub kernel over input (o + pad) / stride - (taps - 1) + j
+    std::shared_ptr<Tensor> subKernel(Tensor::create<float>({oc, ic, taps, taps}, nullptr, Tensor::CAFFE));
+    auto dest = subKernel->host<float>();
+    for (int o = 0; o < oc; ++o) {
+        for (int i = 0; i < ic; ++i) {
+            for (int a = 0; a < taps; ++a) {
+                const int fy = phase.yResidue + (taps - 1 - a) * sy;
+                for (int c = 0; c < taps; ++c) {
+                    const int fx                            = phase.xResidue + (taps - 1 - c) * sx;
+                    dest[((o * ic + i) * taps + a) * taps + c] = weight[((i * oc + o) * ky + fy) * kx + fx];
+                }
+            }
+        }
+    }
+    Math::WinogradGenerater generator(phase.unit, taps);
+    phase.weight = generator.allocTransformWeight(subKernel.get(), 4, 4, false);
+    if (!backend()->onAcquireBuffer(phase.weight.get(), Backend::STATIC)) {
+        return false;
+    }
+    generator.transformWeight(phase.weight.get(), subKernel.get());
+    return true;
+}
+
+DeconvolutionSubPixel::~DeconvolutionSubPixel() {
+    for (auto& phase : mPhases) {
+        if (nullptr != phase.weight) {
+            backend()->onReleaseBuffer(phase.weight.get(), Backend::STATIC);
+        }
+    }
+}
+
+ErrorCode DeconvolutionSubPixel::onResize(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
+    CPUDeconvolutionCommon::onResize(inputs, outputs);
+    auto input       = inputs[0];
+    auto output      = outputs[0];
+    const int sx     = mStrideX;
+    const int sy     = mStrideY;
+    const int ow     = output->width();
+    const int oh     = output->height();
+    const int icDiv4 = UP_DIV(input->channel(), 4);
+    const int ocDiv4 = UP_DIV(output->channel(), 4);
+
+    int tileSize = ocDiv4 * CONVOLUTION_TILED_NUMBWR * 4;
+    mTileCount   = 0;
+    for (auto& phase : mPhases) {
+        // the least o >= 0 with (o + pad) % stride == residue
+        phase.oyStart   = phase.yResidue - mPadY - _floorDiv(phase.yResidue - mPadY, sy) * sy;
+        phase.oxStart   = phase.xResidue - mPadX - _floorDiv(phase.xResidue - mPadX, sx) * sx;
+        phase.iyStart   = _floorDiv(phase.oyStart + mPadY, sy);
+        phase.ixStart   = _floorDiv(phase.oxStart + mPadX, sx);
+        phase.height    = phase.oyStart < oh ? UP_DIV(oh - phase.oyStart, sy) : 0;
+        phase.width     = phase.oxStart < ow ? UP_DIV(ow - phase.oxStart, sx) : 0;
+        phase.tileStart = mTileCount;
+        if (phase.unit > 0) {
+            // a tile is of blocks unit x unit
+            const int blocks = UP_DIV(phase.width, phase.unit) * UP_DIV(phase.height, phase.unit);
+            mTileCount += UP_DIV(blocks, CONVOLUTION_TILED_NUMBWR);
+            tileSize = ALIMAX(tileSize, phase.alpha * phase.alpha * (icDiv4 + ocDiv4) * CONVOLUTION_TILED_NUMBWR * 4);
+        } else {
+            mTileCount += UP_DIV(phase.width * phase.height, CONVOLUTION_TILED_NUMBWR);
+            tileSize = ALIMAX(tileSize, (phase.yTaps * phase.xTaps * icDiv4 + ocDiv4) * CONVOLUTION_TILED_NUMBWR * 4);
+        }
+    }
+
+    mThreadNumber = ALIMAX(1, ALIMIN(((CPUBackend*)backend())->threadNumber(), mTileCount * input->batch()));
+    mTileBuffer->setLength(0, mThreadNumber);
+    mTileBuffer->setLength(1, tileSize);
+    // the largest transform is 8x8
+    mMidBuffer->setLength(0, mThreadNumber);
+    mMidBuffer->setLength(1, 2 * 64 * 4);
+    TensorUtils::setLinearLayout(mTileBuffer.get());
+    TensorUtils::setLinearLayout(mMidBuffer.get());
+    bool res = backend()->onAcquireBuffer(mTileBuffer.get(), Backend::DYNAMIC);
+    res      = res && backend()->onAcquireBuffer(mMidBuffer.get(), Backend::DYNAMIC);
+    if (!res) {
+        return OUT_OF_MEMORY;
+    }
+    backend()->onReleaseBuffer(mTileBuffer.get(), Backend::DYNAMIC);
+    backend()->onReleaseBuffer(mMidBuffer.get(), Backend::DYNAMIC);
+    return NO_ERROR;
+}
+
+void DeconvolutionSubPixel::_gemmTile(const Phase& phase, int xIndex, int xCount, const float* srcOrigin,
+                                      float* dstOrigin, const Tensor* input, const Tensor* output, float* buffer) {
+    const int iw     = input->width();
+    const int ih     = input->height();
+    const int ow     = output->width();
+    const int icDiv4 = UP_DIV(input->channel(), 4);
+    const int ocDiv4 = UP_DIV(output->channel(), 4);
+    const int taps   = phase.yTaps * phase.xTaps;
+    auto srcTile     = buffer;
+    auto dstTile     = buffer + taps * icDiv4 * CONVOLUTION_TILED_NUMBWR * 4;
+    if (taps > 0) {
+        // gather [taps][ic / 4][tile][4], zero outside the input
+        const int tapStride = icDiv4 * CONVOLUTION_TILED_NUMBWR * 4;
+        for (int i = 0; i < xCount; ++i) {
+            const int qy = phase.iyStart + (xIndex + i) / phase.width;
+            const int qx = phase.ixStart + (xIndex + i) % phase.width;
+            for (int jy = 0; jy < phase.yTaps; ++jy) {
+                const int iy = qy - jy;
+                for (int jx = 0; jx < phase.xTaps; ++jx) {
+                    const int ix = qx - jx;
+                    auto dst     = srcTile + (jy * phase.xTaps + jx) * tapStride + 4 * i;
+                    if (iy < 0 || iy >= ih || ix < 0 || ix >= iw) {
+                        for (int z = 0; z < icDiv4; ++z) {
+                            ::memset(dst + z * CONVOLUTION_TILED_NUMBWR * 4, 0, 4 * sizeof(float));
+                        }
+                        continue;
+                    }
+                    MNNCopyC4WithStride(srcOrigin + (iy * iw + ix) * 4, dst, iw * ih * 4,
+                                        CONVOLUTION_TILED_NUMBWR * 4, icDiv4);
+                }
+            }
+        }
+        MNNGemmFloatUnit_4(dstTile, srcTile, phase.weight->host<float>(), taps * icDiv4,
+                           CONVOLUTION_TILED_NUMBWR * 4, ocDiv4, 0);
+    } else {
+        ::memset(dstTile, 0, ocDiv4 * CONVOLUTION_TILED_NUMBWR * 4 * sizeof(float));
+    }
+    mPostFunction(dstTile, mBias->host<float>(), CONVOLUTION_TILED_NUMBWR, ocDiv4);
+
+    // outputs of a phase are stride apart
+    for (int i = 0; i < xCount; ++i) {
+        const int oy = phase.oyStart + (xIndex + i) / phase.width * mStrideY;
+        const int ox = phase.oxStart + (xIndex + i) % phase.width * mStrideX;
+        MNNCopyC4WithStride(dstTile + 4 * i, dstOrigin + (oy * ow + ox) * 4, CONVOLUTION_TILED_NUMBWR * 4,
+                            ow * output->height() * 4, ocDiv4);
+    }
+}
+
+void DeconvolutionSubPixel::_winogradTile(const Phase& phase, int xIndex, int xC, const float* srcOrigin,
+                                          float* dstOrigin, const Tensor* input, const Tensor* output, float* buffer,
+                                          float* midBuffer) {
+    const int iw       = input->width();
+    const int ih       = input->height();
+    const int ow       = output->width();
+    const int oh       = output->height();
+    const int ic_4     = UP_DIV(input->channel(), 4);
+    const int dc_4     = UP_DIV(output->channel(), 4);
+    const int dstUnit  = phase.unit;
+    const int srcUnit  = phase.alpha;
+    const int srcUnit2 = srcUnit * srcUnit;
+    const int taps     = phase.yTaps;
+    const int wUnit    = UP_DIV(phase.width, dstUnit);
+    auto sourceTransform = WinogradFunction::chooseSourceTransform(srcUnit, srcUnit);
+    auto destTransform   = WinogradFunction::chooseDestTransform(srcUnit, dstUnit);
+    auto midBuffer0      = midBuffer;
+    auto midBuffer1      = midBuffer + srcUnit2 * 4;
+    auto weight          = phase.weight->host<float>();
+
+    /*Source Transform Begin*/
+    {
+        int sourceZStep = iw * ih * 4;
+        int dstZStep    = xC * 4;
+        int unitStep    = ic_4 * xC * 4;
+        for (int xi = 0; xi < xC; ++xi) {
+            auto index = xIndex + xi;
+            int wIndex = index % wUnit;
+            int hIndex = index / wUnit;
+
+            int srcX  = phase.ixStart + wIndex * dstUnit - (taps - 1);
+            int srcY  = phase.iyStart + hIndex * dstUnit - (taps - 1);
+            int sy    = ALIMAX(0, srcY) - srcY;
+            int ey    = ALIMIN(srcY + srcUnit, ih) - srcY;
+            int sx    = ALIMAX(0, srcX) - srcX;
+            int ex    = ALIMIN(srcX + srcUnit, iw) - srcX;
+            int count = 4 * (ex - sx);
+
+            auto dst_x    = buffer + 4 * xi;
+            auto srcStart = srcOrigin + (srcX + srcY * iw) * 4;
+            for (int z = 0; z < ic_4; ++z) {
+                auto srcZ = srcStart + z * sourceZStep;
+                if (ex - sx == srcUnit && ey - sy == srcUnit) {
+                    for (int i = 0; i < srcUnit; ++i) {
+                        sourceTransform(srcZ + 4 * i * iw, midBuffer1 + 4 * i, 4, 4 * srcUnit);
+                    }
+                } else {
+                    // Extract
+                    ::memset(midBuffer0, 0, srcUnit2 * 4 * sizeof(float));
+                    if (count > 0) {
+                        for (int yy = sy; yy < ey; ++yy) {
+                            ::memcpy(midBuffer0 + (yy * srcUnit + sx) * 4, srcZ + 4 * (iw * yy + sx),
+                                     count * sizeof(float));
+                        }
+                    }
+                    for (int i = 0; i < srcUnit; ++i) {
+                        sourceTransform(midBuffer0 + 4 * i * srcUnit, midBuffer1 + 4 * i, 4, 4 * srcUnit);
+                    }
+                }
+                auto dstZ = dst_x + z * dstZStep;
+                for (int i = 0; i < srcUnit; ++i) {
+                    sourceTransform(midBuffer1 + 4 * i * srcUnit, dstZ + i * unitStep, 4, unitStep * srcUnit);
+                }
+            }
+        }
+    }
+    /*Source Transform End*/
+
+    // Multi
+    auto _dstOrigin = buffer + xC * srcUnit2 * ic_4 * 4;
+    if (xC == CONVOLUTION_TILED_NUMBWR) {
+        for (int i = 0; i < srcUnit2; ++i) {
+            MNNGemmFloatUnit_4(_dstOrigin + i * dc_4 * 4 * xC, buffer + i * ic_4 * 4 * xC,
+                               weight + i * 16 * ic_4 * dc_4, ic_4, xC * 4, dc_4, 0);
+        }
+    } else {
+        for (int i = 0; i < srcUnit2; ++i) {
+            MNNGemmFloatCommon_4(_dstOrigin + i * dc_4 * 4 * xC, buffer + i * ic_4 * 4 * xC,
+                                 weight + i * 16 * ic_4 * dc_4, ic_4, xC * 4, dc_4, xC, 0);
+        }
+    }
+
+    /* Dest Transform, Post Treat and Interleave Begin */
+    {
+        int dstZStep = ow * oh * 4;
+        int srcZStep = xC * 4;
+        int unitStep = dc_4 * xC * 4;
+        for (int xi = 0; xi < xC; ++xi) {
+            auto index = xIndex + xi;
+            auto srcXi = _dstOrigin + 4 * xi;
+            int tx     = index % wUnit * dstUnit;
+            int ty     = index / wUnit * dstUnit;
+            int ey     = ALIMIN(ty + dstUnit, phase.height) - ty;
+            int ex     = ALIMIN(tx + dstUnit, phase.width) - tx;
+            for (int z = 0; z < dc_4; ++z) {
+                auto srcZ = srcXi + z * srcZStep;
+                for (int i = 0; i < srcUnit; ++i) {
+                    destTransform(srcZ + i * unitStep, midBuffer0 + i * dstUnit * 4, srcUnit * unitStep, 4);
+                }
+                for (int i = 0; i < ey; ++i) {
+                    destTransform(midBuffer0 + i * 4, midBuffer1 + i * dstUnit * 4, 4 * dstUnit, 4);
+                }
+                mPostFunction(midBuffer1, mBias->host<float>() + 4 * z, dstUnit * ey, 1);
+                auto dstZ = dstOrigin + z * dstZStep;
+                for (int yy = 0; yy < ey; ++yy) {
+                    const int oy = phase.oyStart + (ty + yy) * mStrideY;
+                    for (int xx = 0; xx < ex; ++xx) {
+                        const int ox = phase.oxStart + (tx + xx) * mStrideX;
+                        ::memcpy(dstZ + (oy * ow + ox) * 4, midBuffer1 + (yy * dstUnit + xx) * 4, 4 * sizeof(float));
+                    }
+                }
+            }
+        }
+    }
+    /* Dest Transform, Post Treat and Interleave End */
+}
+
+ErrorCode DeconvolutionSubPixel::onExecute(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
+    auto input      = inputs[0];
+    auto output     = outputs[0];
+    const int units = mTileCount * input->batch();
+
+    MNN_CONCURRENCY_BEGIN(tId, mThreadNumber) {
+        auto buffer    = mTileBuffer->host<float>() + tId * mTileBuffer->stride(0);
+        auto midBuffer = mMidBuffer->host<float>() + tId * mMidBuffer->stride(0);
+        for (int u = (int)tId; u < units; u += mThreadNumber) {
+            const int batchIndex = u / mTileCount;
+            const int tile       = u % mTileCount;
+            int p                = (int)mPhases.size() - 1;
+            while (mPhases[p].tileStart > tile) {
+                --p;
+            }
+            const auto& phase = mPhases[p];
+            const int xIndex  = (tile - phase.tileStart) * CONVOLUTION_TILED_NUMBWR;
+            auto srcOrigin    = input->host<float>() + batchIndex * input->stride(0);
+            auto dstOrigin    = output->host<float>() + batchIndex * output->stride(0);
+            if (phase.unit > 0) {
+                const int blocks = UP_DIV(phase.width, phase.unit) * UP_DIV(phase.height, phase.unit);
+                _winogradTile(phase, xIndex, ALIMIN(CONVOLUTION_TILED_NUMBWR, blocks - xIndex), srcOrigin,
+                              dstOrigin, input, output, buffer, midBuffer);
+            } else {
+                _gemmTile(phase, xIndex, ALIMIN(CONVOLUTION_TILED_NUMBWR, phase.width * phase.height - xIndex),
+                          srcOrigin, dstOrigin, input, output, buffer);
+            }
+        }
+    }
+    MNN_CONCURRENCY_END();
+    return NO_ERROR;
+}
+} // namespace MNN
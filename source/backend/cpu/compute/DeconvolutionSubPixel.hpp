@@ -0,0 +1,71 @@
+//
+//  DeconvolutionSubPixel.hpp
+//  MNN
+//
+//  Created by MNN on 2019/08/30.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef DeconvolutionSubPixel_hpp
+#define DeconvolutionSubPixel_hpp
+
+#include "../CPUDeconvolution.hpp"
+
+namespace MNN {
+/**
+ * transposed convolution as stride * stride direct convolutions, one for each phase of the output.
+ * output row oy is reached by kernel rows ky = (oy + pad) % stride + j * stride from input rows
+ * (oy + pad) / stride - j, columns alike. each phase gathers a tile of its outputs from the input and multiplies
+ * it by its sub kernel, then writes the tile interleaved to the output, every output is written once.
+ * phases of 2x2 or 3x3 taps run as Winograd F(3, 2), F(2, 3) or F(6, 3) when it costs less.
+ */
+class DeconvolutionSubPixel : public CPUDeconvolutionCommon {
+public:
+    DeconvolutionSubPixel(const Op *convOp, Backend *b);
+    virtual ~DeconvolutionSubPixel();
+    virtual ErrorCode onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+    virtual ErrorCode onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+
+    struct Phase {
+        // kernel row / column residue of the phase and the taps of it
+        int yResidue = 0;
+        int xResidue = 0;
+        int yTaps    = 0;
+        int xTaps    = 0;
+        // [UP_DIV(oc, 4)][taps * UP_DIV(ic, 4)][16], or [alpha * alpha][UP_DIV(oc, 4)][UP_DIV(ic, 4)][16] for
+        // Winograd. null without taps
+        std::shared_ptr<Tensor> weight;
+        // output unit of Winograd, 0 to multiply directly
+        int unit  = 0;
+        int alpha = 0;
+
+        // set on resize: first output row / column, their input row / column and counts
+        int oyStart   = 0;
+        int oxStart   = 0;
+        int iyStart   = 0;
+        int ixStart   = 0;
+        int height    = 0;
+        int width     = 0;
+        int tileStart = 0;
+    };
+
+private:
+    bool _setupWinograd(Phase &phase, const float *weight, int kx, int ky, int sx, int sy, int ic, int oc);
+    void _gemmTile(const Phase &phase, int xIndex, int xCount, const float *srcOrigin, float *dstOrigin,
+                   const Tensor *input, const Tensor *output, float *buffer);
+    void _winogradTile(const Phase &phase, int xIndex, int xCount, const float *srcOrigin, float *dstOrigin,
+                       const Tensor *input, const Tensor *output, float *buffer, float *midBuffer);
+
+    std::vector<Phase> mPhases;
+    // [threads][gathered or transformed source, then product of a tile], [threads][2][alpha * alpha][4]
+    std::shared_ptr<Tensor> mTileBuffer;
+    std::shared_ptr<Tensor> mMidBuffer;
+    int mTileCount    = 0;
+    int mThreadNumber = 1;
+    // kept from the op, which is gone once the model is released after resize
+    int mStrideX = 1;
+    int mStrideY = 1;
+};
+} // namespace MNN
+
+#endif /* DeconvolutionSubPixel_hpp */
@@ -0,0 +1,144 @@
+//
+//  DetectionPostProcess.cpp
+//  MNN
+//
+//  Created by MNN on 2019/08/26.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "DetectionPostProcess.hpp"
+#include <math.h>
+#include <algorithm>
+#include "Macro.h"
+#include "Vec4.hpp"
+
+using namespace MNN::Math;
+
+namespace MNN {
+
+void DetectionBoxes::reset(int count) {
+    mCount  = count;
+    mStride = ALIGN_UP4(count);
+    mData.reset(5 * mStride);
+}
+
+namespace DetectionPostProcess {
+
+static inline void _decodeBox(DetectionBoxes& dst, int index, float pbXMin, float pbYMin, float pbXMax, float pbYMax,
+                              const float* variance, int varianceStride, const float* loc) {
+    float pbW  = pbXMax - pbXMin;
+    float pbH  = pbYMax - pbYMin;
+    float pbCX = (pbXMin + pbXMax) * 0.5f;
+    float pbCY = (pbYMin + pbYMax) * 0.5f;
+
+    float boxCX = variance[0] * loc[0] * pbW + pbCX;
+    float boxCY = variance[varianceStride] * loc[1] * pbH + pbCY;
+    float boxW  = expf(variance[2 * varianceStride] * loc[2]) * pbW;
+    float boxH  = expf(variance[3 * varianceStride] * loc[3]) * pbH;
+    dst.set(index, boxCX - boxW * 0.5f, boxCY - boxH * 0.5f, boxCX + boxW * 0.5f, boxCY + boxH * 0.5f);
+}
+
+void decodeBoxes(DetectionBoxes& dst, const float* prior, const float* variance, int priorStride,
+                 const float* location, int count) {
+    dst.reset(count);
+    for (int i = 0; i < count; ++i) {
+        auto pb = prior + 4 * i * priorStride;
+        _decodeBox(dst, i, pb[0], pb[priorStride], pb[2 * priorStride], pb[3 * priorStride],
+                   variance + 4 * i * priorStride, priorStride, location + 4 * i);
+    }
+}
+
+void decodeBoxes(DetectionBoxes& dst, const DetectionBoxes& prior, const float* variance, int priorStride,
+                 const float* location) {
+    MNN_ASSERT(&dst != &prior);
+    const int count = prior.count();
+    dst.reset(count);
+    for (int i = 0; i < count; ++i) {
+        _decodeBox(dst, i, prior.xmin()[i], prior.ymin()[i], prior.xmax()[i], prior.ymax()[i],
+                   variance + 4 * i * priorStride, priorStride, location + 4 * i);
+    }
+}
+
+void filterByScore(std::vector<int>& candidates, const float* scores, int scoreStride, int count, float threshold,
+                   int topK) {
+    candidates.clear();
+    for (int i = 0; i < count; ++i) {
+        if (scores[i * scoreStride] > threshold) {
+            candidates.emplace_back(i);
+        }
+    }
+    if (topK > 0 && topK < (int)candidates.size()) {
+        std::nth_element(candidates.begin(), candidates.begin() + topK, candidates.end(),
+                         [scores, scoreStride](int a, int b) {
+                             auto scoreA = scores[a * scoreStride], scoreB = scores[b * scoreStride];
+                             return scoreA > scoreB || (scoreA == scoreB && a < b);
+                         });
+        candidates.resize(topK);
+    }
+}
+
+void nonMaxSuppression(std::vector<int>& picked, std::vector<int>& candidates, const DetectionBoxes& boxes,
+                       const float* scores, int scoreStride, float threshold, int maxOutput) {
+    picked.clear();
+    const int number = (int)candidates.size();
+    if (maxOutput <= 0 || maxOutput > number) {
+        maxOutput = number;
+    }
+    if (0 == maxOutput) {
+        return;
+    }
+
+    // picked boxes, padded with empty boxes which never suppress, followed by 4 floats of scratch
+    const int capacity = ALIGN_UP4(maxOutput);
+    AutoStorage<float> pickedBoxes(5 * capacity + 4);
+    pickedBoxes.clear();
+    auto pickedXMin = pickedBoxes.get();
+    auto pickedYMin = pickedXMin + capacity;
+    auto pickedXMax = pickedYMin + capacity;
+    auto pickedYMax = pickedXMax + capacity;
+    auto pickedArea = pickedYMax + capacity;
+    auto scratch    = pickedArea + capacity;
+
+    auto compare = [scores, scoreStride](int a, int b) {
+        auto scoreA = scores[a * scoreStride], scoreB = scores[b * scoreStride];
+        return scoreA > scoreB || (scoreA == scoreB && a < b);
+    };
+    int sorted = 0, block = std::max(64, 2 * maxOutput);
+    Vec4 zero(0.0f);
+    for (int i = 0; i < number && (int)picked.size() < maxOutput; ++i) {
+        if (i == sorted) {
+            auto end = std::min(number, sorted + block);
+            std::partial_sort(candidates.begin() + sorted, candidates.begin() + end, candidates.end(), compare);
+            sorted = end;
+            block *= 2;
+        }
+        const int index = candidates[i];
+        Vec4 xmin(boxes.xmin()[index]), ymin(boxes.ymin()[index]);
+        Vec4 xmax(boxes.xmax()[index]), ymax(boxes.ymax()[index]);
+        Vec4 area(boxes.area()[index]);
+
+        // iou > threshold <=> inter > threshold * union, which needs no division and keeps box of empty union
+        const int pickedCount = (int)picked.size();
+        bool keep             = true;
+        for (int j = 0; j < pickedCount && keep; j += 4) {
+            auto interW    = Vec4::max(Vec4::min(xmax, Vec4::load(pickedXMax + j)) -
+                                        Vec4::max(xmin, Vec4::load(pickedXMin + j)), zero);
+            auto interH    = Vec4::max(Vec4::min(ymax, Vec4::load(pickedYMax + j)) -
+                                        Vec4::max(ymin, Vec4::load(pickedYMin + j)), zero);
+            auto inter     = interW * interH;
+            auto unionArea = area + Vec4::load(pickedArea + j) - inter;
+            Vec4::save(scratch, inter - unionArea * threshold);
+            keep = !(scratch[0] > 0.0f || scratch[1] > 0.0f || scratch[2] > 0.0f || scratch[3] > 0.0f);
+        }
+        if (keep) {
+            pickedXMin[pickedCount] = boxes.xmin()[index];
+            pickedYMin[pickedCount] = boxes.ymin()[index];
+            pickedXMax[pickedCount] = boxes.xmax()[index];
+            pickedYMax[pickedCount] = boxes.ymax()[index];
+            pickedArea[pickedCount] = boxes.area()[index];
+            picked.emplace_back(index);
+        }
+    }
+}
+} // namespace DetectionPostProcess
+} // namespace MNN
@@ -0,0 +1,99 @@
+//
+//  DetectionPostProcess.hpp
+//  MNN
+//
+//  Created by MNN on 2019/08/26.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef DetectionPostProcess_hpp
+#define DetectionPostProcess_hpp
+
+#include <vector>
+#include "AutoStorage.h"
+
+namespace MNN {
+
+/** boxes stored as separate planes of xmin, ymin, xmax, ymax and area, so that 4 boxes are handled at once */
+class DetectionBoxes {
+public:
+    /**
+     * @brief reallocate for given number of boxes, contents are undefined.
+     * @param count number of boxes.
+     */
+    void reset(int count);
+    /**
+     * @brief set box and compute its area.
+     */
+    inline void set(int index, float xmin, float ymin, float xmax, float ymax) {
+        auto base         = mData.get() + index;
+        base[0]           = xmin;
+        base[mStride]     = ymin;
+        base[2 * mStride] = xmax;
+        base[3 * mStride] = ymax;
+        base[4 * mStride] = (xmax - xmin) * (ymax - ymin);
+    }
+    inline int count() const {
+        return mCount;
+    }
+    inline const float* xmin() const {
+        return mData.get();
+    }
+    inline const float* ymin() const {
+        return mData.get() + mStride;
+    }
+    inline const float* xmax() const {
+        return mData.get() + 2 * mStride;
+    }
+    inline const float* ymax() const {
+        return mData.get() + 3 * mStride;
+    }
+    inline const float* area() const {
+        return mData.get() + 4 * mStride;
+    }
+
+private:
+    AutoStorage<float> mData;
+    int mCount  = 0;
+    int mStride = 0;
+};
+
+namespace DetectionPostProcess {
+/**
+ * @brief decode center-size encoded locations with prior boxes. coordinate k of prior i is read at
+ *        prior[(4 * i + k) * priorStride] and so is variance, so that NC4HW4 output of PriorBox is used in place.
+ * @param dst       decoded boxes, reset to count.
+ * @param location  encoded locations, 4 for each box.
+ */
+void decodeBoxes(DetectionBoxes& dst, const float* prior, const float* variance, int priorStride,
+                 const float* location, int count);
+/**
+ * @brief decode center-size encoded locations with decoded boxes of former stage, used by RefineDet.
+ */
+void decodeBoxes(DetectionBoxes& dst, const DetectionBoxes& prior, const float* variance, int priorStride,
+                 const float* location);
+
+/**
+ * @brief collect indexes of scores above threshold. if topK is positive, only topK of highest scores are kept, while
+ *        not sorted.
+ * @param candidates    indexes collected.
+ * @param scores        score of box i is scores[i * scoreStride].
+ */
+void filterByScore(std::vector<int>& candidates, const float* scores, int scoreStride, int count, float threshold,
+                   int topK);
+
+/**
+ * @brief greedy NMS, a candidate is picked if its IoU with any picked one is not above threshold. candidates are
+ *        visited by score descending, they are sorted block by block in place while visiting, so that only a few
+ *        more than picked ones are sorted when maxOutput is small.
+ * @param picked        indexes of picked boxes, sorted by score descending.
+ * @param candidates    indexes of candidate boxes, reordered.
+ * @param scores        score of box i is scores[i * scoreStride].
+ * @param maxOutput     max number of picked, not limited if not positive.
+ */
+void nonMaxSuppression(std::vector<int>& picked, std::vector<int>& candidates, const DetectionBoxes& boxes,
+                       const float* scores, int scoreStride, float threshold, int maxOutput);
+} // namespace DetectionPostProcess
+} // namespace MNN
+
+#endif /* DetectionPostProcess_hpp */
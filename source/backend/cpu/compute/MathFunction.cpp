@@ -0,0 +1,273 @@
+//
+//  MathFunction.cpp
+//  MNN
+//
+//  Created by MNN on 2019/08/28.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "MathFunction.hpp"
+#include <stdint.h>
+#include <string.h>
+#include "MathFunctionKernel.hpp"
+#ifdef MNN_USE_NEON
+#include <arm_neon.h>
+#elif defined(MNN_USE_SSE)
+#include <emmintrin.h>
+#endif
+
+namespace MNN {
+namespace MathFunction {
+#ifdef MNN_USE_NEON
+struct VecNEON {
+    using T = float32x4_t;
+    using M = uint32x4_t;
+    static const int size = 4;
+    static T set1(float v) {
+        return vdupq_n_f32(v);
+    }
+    static T load(const float* addr) {
+        return vld1q_f32(addr);
+    }
+    static void store(float* addr, T v) {
+        vst1q_f32(addr, v);
+    }
+    static T add(T a, T b) {
+        return vaddq_f32(a, b);
+    }
+    static T sub(T a, T b) {
+        return vsubq_f32(a, b);
+    }
+    static T mul(T a, T b) {
+        return vmulq_f32(a, b);
+    }
+    static T div(T a, T b) {
+#ifdef __aarch64__
+        return vdivq_f32(a, b);
+#else
+        // two newton steps on the estimate reach float precision
+        T r = vrecpeq_f32(b);
+        r   = vmulq_f32(vrecpsq_f32(b, r), r);
+        r   = vmulq_f32(vrecpsq_f32(b, r), r);
+        return vmulq_f32(a, r);
+#endif
+    }
+    static T fma(T a, T b, T c) {
+        return vmlaq_f32(c, a, b);
+    }
+    static T min(T a, T b) {
+        return vminq_f32(a, b);
+    }
+    static T max(T a, T b) {
+        return vmaxq_f32(a, b);
+    }
+    static T floor(T x) {
+        T t = vcvtq_f32_s32(vcvtq_s32_f32(x));
+        return vsubq_f32(t, vreinterpretq_f32_u32(vandq_u32(vcgtq_f32(t, x), vreinterpretq_u32_f32(vdupq_n_f32(1.0f)))));
+    }
+    static M less(T a, T b) {
+        return vcltq_f32(a, b);
+    }
+    static M equal(T a, T b) {
+        return vceqq_f32(a, b);
+    }
+    static T select(M mask, T a, T b) {
+        return vbslq_f32(mask, a, b);
+    }
+    static T pow2n(T n) {
+        return vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(n), vdupq_n_s32(127)), 23));
+    }
+    static T frexp(T x, T& e) {
+        auto bits = vreinterpretq_u32_f32(x);
+        e = vsubq_f32(vcvtq_f32_u32(vandq_u32(vshrq_n_u32(bits, 23), vdupq_n_u32(0xff))), vdupq_n_f32(126.0f));
+        return vreinterpretq_f32_u32(vorrq_u32(vandq_u32(bits, vdupq_n_u32(0x807fffff)), vdupq_n_u32(0x3f000000)));
+    }
+};
+using VecDefault = VecNEON;
+#elif defined(MNN_USE_SSE)
+struct VecSSE {
+    using T = __m128;
+    using M = __m128;
+    static const int size = 4;
+    static T set1(float v) {
+        return _mm_set1_ps(v);
+    }
+    static T load(const float* addr) {
+        return _mm_loadu_ps(addr);
+    }
+    static void store(float* addr, T v) {
+        _mm_storeu_ps(addr, v);
+    }
+    static T add(T a, T b) {
+        return _mm_add_ps(a, b);
+    }
+    static T sub(T a, T b) {
+        return _mm_sub_ps(a, b);
+    }
+    static T mul(T a, T b) {
+        return _mm_mul_ps(a, b);
+    }
+    static T div(T a, T b) {
+        return _mm_div_ps(a, b);
+    }
+    static T fma(T a, T b, T c) {
+        return _mm_add_ps(_mm_mul_ps(a, b), c);
+    }
+    static T min(T a, T b) {
+        return _mm_min_ps(a, b);
+    }
+    static T max(T a, T b) {
+        return _mm_max_ps(a, b);
+    }
+    static T floor(T x) {
+        T t = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+        return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, x), _mm_set1_ps(1.0f)));
+    }
+    static M less(T a, T b) {
+        return _mm_cmplt_ps(a, b);
+    }
+    static M equal(T a, T b) {
+        return _mm_cmpeq_ps(a, b);
+    }
+    static T select(M mask, T a, T b) {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+    static T pow2n(T n) {
+        return _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(n), _mm_set1_epi32(127)), 23));
+    }
+    static T frexp(T x, T& e) {
+        auto bits = _mm_castps_si128(x);
+        e = _mm_sub_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(bits, 23), _mm_set1_epi32(0xff))),
+                       _mm_set1_ps(126.0f));
+        return _mm_castsi128_ps(
+            _mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x807fffff)), _mm_set1_epi32(0x3f000000)));
+    }
+};
+using VecDefault = VecSSE;
+#else
+struct VecScalar {
+    using T = float;
+    using M = bool;
+    static const int size = 1;
+    static T set1(float v) {
+        return v;
+    }
+    static T load(const float* addr) {
+        return *addr;
+    }
+    static void store(float* addr, T v) {
+        *addr = v;
+    }
+    static T add(T a, T b) {
+        return a + b;
+    }
+    static T sub(T a, T b) {
+        return a - b;
+    }
+    static T mul(T a, T b) {
+        return a * b;
+    }
+    static T div(T a, T b) {
+        return a / b;
+    }
+    static T fma(T a, T b, T c) {
+        return a * b + c;
+    }
+    static T min(T a, T b) {
+        return a < b ? a : b;
+    }
+    static T max(T a, T b) {
+        return a > b ? a : b;
+    }
+    static T floor(T x) {
+        return ::floorf(x);
+    }
+    static M less(T a, T b) {
+        return a < b;
+    }
+    static M equal(T a, T b) {
+        return a == b;
+    }
+    static T select(M mask, T a, T b) {
+        return mask ? a : b;
+    }
+    static T pow2n(T n) {
+        int32_t bits = ((int32_t)n + 127) << 23;
+        float result;
+        ::memcpy(&result, &bits, sizeof(float));
+        return result;
+    }
+    static T frexp(T x, T& e) {
+        uint32_t bits;
+        ::memcpy(&bits, &x, sizeof(float));
+        e    = (float)((bits >> 23) & 0xff) - 126.0f;
+        bits = (bits & 0x807fffff) | 0x3f000000;
+        float result;
+        ::memcpy(&result, &bits, sizeof(float));
+        return result;
+    }
+};
+using VecDefault = VecScalar;
+#endif
+
+#ifdef MNN_USE_AVX2
+// compiled with avx2 and fma alone, see source/backend/cpu/avx2
+extern const Functions& functionsAVX2();
+#endif
+
+const Functions& functions(bool bestSIMD) {
+    static const Functions gDefault = Kernel<VecDefault>::functions();
+#ifdef MNN_USE_AVX2
+    static const bool gAVX2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    if (bestSIMD && gAVX2) {
+        return functionsAVX2();
+    }
+#endif
+    return gDefault;
+}
+
+void exp(float* dst, const float* src, int size) {
+    functions().exp(dst, src, size);
+}
+
+void log(float* dst, const float* src, int size) {
+    functions().log(dst, src, size);
+}
+
+void tanh(float* dst, const float* src, int size) {
+    functions().tanh(dst, src, size);
+}
+
+void sigmoid(float* dst, const float* src, int size) {
+    functions().sigmoid(dst, src, size);
+}
+
+void erf(float* dst, const float* src, int size) {
+    functions().erf(dst, src, size);
+}
+
+void gelu(float* dst, const float* src, int size) {
+    functions().gelu(dst, src, size);
+}
+
+void swish(float* dst, const float* src, int size) {
+    functions().swish(dst, src, size);
+}
+
+void hardSwish(float* dst, const float* src, int size) {
+    functions().hardSwish(dst, src, size);
+}
+
+void softplus(float* dst, const float* src, int size) {
+    functions().softplus(dst, src, size);
+}
+
+void elu(float* dst, const float* src, int size, float alpha) {
+    functions().elu(dst, src, size, alpha);
+}
+
+void selu(float* dst, const float* src, int size, float scale, float alpha) {
+    functions().selu(dst, src, size, scale, alpha);
+}
+} // namespace MathFunction
+} // namespace MNN
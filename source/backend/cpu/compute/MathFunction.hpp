@@ -0,0 +1,121 @@
+//
+//  MathFunction.hpp
+//  MNN
+//
+//  Created by MNN on 2019/08/28.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef MathFunction_hpp
+#define MathFunction_hpp
+
+#include "Concurrency.h"
+#include "Macro.h"
+
+namespace MNN {
+namespace MathFunction {
+/**
+ * vectorized transcendental functions on float arrays, dst may be the same as src.
+ * NEON or SSE is used, AVX2 and FMA are selected at runtime when the cpu has them.
+ * errors below are the max measured against double precision of libm, see test/op/MathFunctionTest.cpp.
+ */
+
+/**
+ * @brief exp, 2 ulp. results below FLT_MIN may be flushed to 0, inf above 88.72.
+ */
+void exp(float* dst, const float* src, int size);
+
+/**
+ * @brief natural log, 1 ulp, denormals included. NaN for negative, -inf for 0.
+ */
+void log(float* dst, const float* src, int size);
+
+/**
+ * @brief tanh, 2 ulp.
+ */
+void tanh(float* dst, const float* src, int size);
+
+/**
+ * @brief 1 / (1 + exp(-x)), 3 ulp.
+ */
+void sigmoid(float* dst, const float* src, int size);
+
+/**
+ * @brief erf, 8 ulp, or 1e-7 absolute around zero.
+ */
+void erf(float* dst, const float* src, int size);
+
+/**
+ * @brief x * (1 + erf(x / sqrt(2))) / 2, 4 ulp, or 1e-6 absolute for x < 0 where 1 + erf cancels.
+ */
+void gelu(float* dst, const float* src, int size);
+
+/**
+ * @brief x * sigmoid(x), 4 ulp.
+ */
+void swish(float* dst, const float* src, int size);
+
+/**
+ * @brief x * relu6(x + 3) / 6, 2 ulp.
+ */
+void hardSwish(float* dst, const float* src, int size);
+
+/**
+ * @brief log(1 + exp(x)), 3 ulp.
+ */
+void softplus(float* dst, const float* src, int size);
+
+/**
+ * @brief x for x > 0, alpha * (exp(x) - 1) otherwise, 2 ulp.
+ */
+void elu(float* dst, const float* src, int size, float alpha);
+
+/**
+ * @brief scale * elu(x, alpha), 2 ulp.
+ */
+void selu(float* dst, const float* src, int size, float scale, float alpha);
+
+/** functions of one instruction set */
+struct Functions {
+    void (*exp)(float* dst, const float* src, int size);
+    void (*log)(float* dst, const float* src, int size);
+    void (*tanh)(float* dst, const float* src, int size);
+    void (*sigmoid)(float* dst, const float* src, int size);
+    void (*erf)(float* dst, const float* src, int size);
+    void (*gelu)(float* dst, const float* src, int size);
+    void (*swish)(float* dst, const float* src, int size);
+    void (*hardSwish)(float* dst, const float* src, int size);
+    void (*softplus)(float* dst, const float* src, int size);
+    void (*elu)(float* dst, const float* src, int size, float alpha);
+    void (*selu)(float* dst, const float* src, int size, float scale, float alpha);
+};
+
+/**
+ * @brief functions in use.
+ * @param bestSIMD  false to get NEON / SSE ones even if AVX2 is there, used to verify them.
+ */
+const Functions& functions(bool bestSIMD = true);
+
+/**
+ * @brief run function(dst, src, count) over chunks of threads, chunks are whole 16 floats but the last.
+ * @param function      one of above, or a lambda binding their extra parameters.
+ * @param threadNumber  threads at most, fewer are used for small size.
+ */
+template <typename Function>
+void parallel(const Function& function, float* dst, const float* src, int size, int threadNumber) {
+    // under 4096 floats a thread costs more than it saves
+    threadNumber    = ALIMAX(1, ALIMIN(threadNumber, size / 4096));
+    const int chunk = UP_DIV(UP_DIV(size, threadNumber), 16) * 16;
+    MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+        const int start = (int)tId * chunk;
+        const int count = ALIMIN(size - start, chunk);
+        if (count > 0) {
+            function(dst + start, src + start, count);
+        }
+    }
+    MNN_CONCURRENCY_END();
+}
+} // namespace MathFunction
+} // namespace MNN
+
+#endif /* MathFunction_hpp */
@@ -0,0 +1,269 @@
+//
+//  MathFunctionKernel.hpp
+//  MNN
+//
+//  Created by MNN on 2019/08/28.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef MathFunctionKernel_hpp
+#define MathFunctionKernel_hpp
+
+#include <float.h>
+#include <math.h>
+#include "MathFunction.hpp"
+
+/**
+ * kernels are written once against a vector type V, which provides
+ *   T, size, set1, load, store (unaligned), add, sub, mul, div, fma(a, b, c) = a * b + c, min, max, floor,
+ *   less, equal, select(mask, a, b), pow2n (2^n of integral n in [-126, 127]) and frexp (mantissa in [0.5, 1)).
+ * the header is compiled by each instruction set alone, so nothing here may be a non template function.
+ */
+namespace MNN {
+namespace MathFunction {
+
+template <typename V>
+inline typename V::T vecAbs(typename V::T x) {
+    return V::max(x, V::sub(V::set1(0.0f), x));
+}
+
+// exp of cephes, n = round(x / ln2) and exp(r) of r = x - n * ln2 by polynomial.
+// 2^n is applied by two halves so that results below FLT_MIN keep denormal precision.
+template <typename V>
+inline typename V::T vecExp(typename V::T x) {
+    using T          = typename V::T;
+    const T origin   = x;
+    const T overflow = V::less(V::set1(88.72283905206835f), x);
+    x                = V::min(V::max(x, V::set1(-104.0f)), V::set1(88.72283905206835f));
+    T n              = V::floor(V::fma(x, V::set1(1.44269504088896341f), V::set1(0.5f)));
+    x                = V::sub(x, V::mul(n, V::set1(0.693359375f)));
+    x                = V::add(x, V::mul(n, V::set1(2.12194440e-4f)));
+    T z              = V::mul(x, x);
+    T y              = V::set1(1.9875691500e-4f);
+    y                = V::fma(y, x, V::set1(1.3981999507e-3f));
+    y                = V::fma(y, x, V::set1(8.3334519073e-3f));
+    y                = V::fma(y, x, V::set1(4.1665795894e-2f));
+    y                = V::fma(y, x, V::set1(1.6666665459e-1f));
+    y                = V::fma(y, x, V::set1(5.0000001201e-1f));
+    y                = V::fma(y, z, V::add(x, V::set1(1.0f)));
+    T half           = V::floor(V::mul(n, V::set1(0.5f)));
+    y                = V::mul(V::mul(y, V::pow2n(half)), V::pow2n(V::sub(n, half)));
+    y                = V::select(overflow, V::set1(INFINITY), y);
+    return V::select(V::equal(origin, origin), y, origin);
+}
+
+// log of cephes, x = m * 2^e with m in [sqrt(0.5), sqrt(2)) and log(m) by polynomial.
+// denormal x is scaled by 2^23 into normal range before frexp, and e is corrected afterwards.
+template <typename V>
+inline typename V::T vecLog(typename V::T x) {
+    using T          = typename V::T;
+    const T origin   = x;
+    const T one      = V::set1(1.0f);
+    const T denormal = V::less(x, V::set1(FLT_MIN));
+    x                = V::select(denormal, V::mul(x, V::set1(8388608.0f)), x);
+    T e;
+    T m              = V::frexp(V::max(x, V::set1(FLT_MIN)), e);
+    e                = V::sub(e, V::select(denormal, V::set1(23.0f), V::set1(0.0f)));
+    const T smallM   = V::less(m, V::set1(0.707106781186547524f));
+    m                = V::sub(V::add(m, V::select(smallM, m, V::set1(0.0f))), one);
+    e                = V::sub(e, V::select(smallM, one, V::set1(0.0f)));
+    T z              = V::mul(m, m);
+    T y              = V::set1(7.0376836292e-2f);
+    y                = V::fma(y, m, V::set1(-1.1514610310e-1f));
+    y                = V::fma(y, m, V::set1(1.1676998740e-1f));
+    y                = V::fma(y, m, V::set1(-1.2420140846e-1f));
+    y                = V::fma(y, m, V::set1(1.4249322787e-1f));
+    y                = V::fma(y, m, V::set1(-1.6668057665e-1f));
+    y                = V::fma(y, m, V::set1(2.0000714765e-1f));
+    y                = V::fma(y, m, V::set1(-2.4999993993e-1f));
+    y                = V::fma(y, m, V::set1(3.3333331174e-1f));
+    y                = V::mul(V::mul(y, m), z);
+    y                = V::fma(e, V::set1(-2.12194440e-4f), y);
+    y                = V::fma(z, V::set1(-0.5f), y);
+    T result         = V::fma(e, V::set1(0.693359375f), V::add(m, y));
+    result           = V::select(V::less(origin, V::set1(0.0f)), V::set1(NAN), result);
+    result           = V::select(V::equal(origin, V::set1(0.0f)), V::set1(-INFINITY), result);
+    result           = V::select(V::equal(origin, V::set1(INFINITY)), origin, result);
+    return V::select(V::equal(origin, origin), result, origin);
+}
+
+// exp(x) - 1, taylor series near zero where exp(x) - 1 cancels
+template <typename V>
+inline typename V::T vecExpm1(typename V::T x) {
+    using T = typename V::T;
+    T p     = V::set1(1.0f / 40320.0f);
+    p       = V::fma(p, x, V::set1(1.0f / 5040.0f));
+    p       = V::fma(p, x, V::set1(1.0f / 720.0f));
+    p       = V::fma(p, x, V::set1(1.0f / 120.0f));
+    p       = V::fma(p, x, V::set1(1.0f / 24.0f));
+    p       = V::fma(p, x, V::set1(1.0f / 6.0f));
+    p       = V::fma(p, x, V::set1(0.5f));
+    T small = V::fma(V::mul(p, x), x, x);
+    T large = V::sub(vecExp<V>(x), V::set1(1.0f));
+    return V::select(V::less(vecAbs<V>(x), V::set1(0.5f)), small, large);
+}
+
+// log(1 + x) with the correction of Goldberg, log(u) * x / (u - 1) of u = 1 + x
+template <typename V>
+inline typename V::T vecLog1p(typename V::T x) {
+    using T = typename V::T;
+    T u     = V::add(x, V::set1(1.0f));
+    T d     = V::sub(u, V::set1(1.0f));
+    T y     = V::div(V::mul(vecLog<V>(u), x), V::select(V::equal(d, V::set1(0.0f)), V::set1(1.0f), d));
+    return V::select(V::equal(d, V::set1(0.0f)), x, y);
+}
+
+// tanh of cephes, odd polynomial below 0.625, 1 - 2 / (exp(2x) + 1) above
+template <typename V>
+inline typename V::T vecTanh(typename V::T x) {
+    using T = typename V::T;
+    T ax    = vecAbs<V>(x);
+    T z     = V::mul(x, x);
+    T p     = V::set1(-5.70498872745e-3f);
+    p       = V::fma(p, z, V::set1(2.06390887954e-2f));
+    p       = V::fma(p, z, V::set1(-5.37397155531e-2f));
+    p       = V::fma(p, z, V::set1(1.33314422036e-1f));
+    p       = V::fma(p, z, V::set1(-3.33332819422e-1f));
+    T small = V::fma(V::mul(p, z), x, x);
+    T e     = vecExp<V>(V::add(ax, ax));
+    T large = V::sub(V::set1(1.0f), V::div(V::set1(2.0f), V::add(e, V::set1(1.0f))));
+    large   = V::select(V::less(x, V::set1(0.0f)), V::sub(V::set1(0.0f), large), large);
+    return V::select(V::less(ax, V::set1(0.625f)), small, large);
+}
+
+template <typename V>
+inline typename V::T vecSigmoid(typename V::T x) {
+    return V::div(V::set1(1.0f), V::add(V::set1(1.0f), vecExp<V>(V::sub(V::set1(0.0f), x))));
+}
+
+// rational approximation of erf on [-4, 4], erf is 1 within float precision outside
+template <typename V>
+inline typename V::T vecErf(typename V::T x) {
+    using T        = typename V::T;
+    const T origin = x;
+    x              = V::min(V::max(x, V::set1(-4.0f)), V::set1(4.0f));
+    T z            = V::mul(x, x);
+    T p            = V::set1(-2.72614225801306e-10f);
+    p              = V::fma(p, z, V::set1(2.77068142495902e-08f));
+    p              = V::fma(p, z, V::set1(-2.10102402082508e-06f));
+    p              = V::fma(p, z, V::set1(-5.69250639462346e-05f));
+    p              = V::fma(p, z, V::set1(-7.34990630326855e-04f));
+    p              = V::fma(p, z, V::set1(-2.95459980854025e-03f));
+    p              = V::fma(p, z, V::set1(-1.60960333262415e-02f));
+    p              = V::mul(p, x);
+    T q            = V::set1(-1.45660718464996e-05f);
+    q              = V::fma(q, z, V::set1(-2.13374055278905e-04f));
+    q              = V::fma(q, z, V::set1(-1.68282697438203e-03f));
+    q              = V::fma(q, z, V::set1(-7.37332916720468e-03f));
+    q              = V::fma(q, z, V::set1(-1.42647390514189e-02f));
+    return V::select(V::equal(origin, origin), V::div(p, q), origin);
+}
+
+template <typename V>
+inline typename V::T vecGelu(typename V::T x) {
+    auto erf = vecErf<V>(V::mul(x, V::set1(0.70710678118654752f)));
+    return V::mul(V::mul(x, V::set1(0.5f)), V::add(erf, V::set1(1.0f)));
+}
+
+template <typename V>
+inline typename V::T vecSwish(typename V::T x) {
+    return V::div(x, V::add(V::set1(1.0f), vecExp<V>(V::sub(V::set1(0.0f), x))));
+}
+
+template <typename V>
+inline typename V::T vecHardSwish(typename V::T x) {
+    auto relu6 = V::min(V::max(V::add(x, V::set1(3.0f)), V::set1(0.0f)), V::set1(6.0f));
+    return V::mul(V::mul(x, relu6), V::set1(1.0f / 6.0f));
+}
+
+// max(x, 0) + log(1 + exp(-|x|)) never overflows
+template <typename V>
+inline typename V::T vecSoftplus(typename V::T x) {
+    auto e = vecExp<V>(V::sub(V::set1(0.0f), vecAbs<V>(x)));
+    return V::add(V::max(x, V::set1(0.0f)), vecLog1p<V>(e));
+}
+
+template <typename V>
+inline typename V::T vecElu(typename V::T x, typename V::T alpha) {
+    return V::select(V::less(V::set1(0.0f), x), x, V::mul(alpha, vecExpm1<V>(x)));
+}
+
+// whole vectors are computed in place, the tail goes through a zero padded buffer by the same code
+template <typename V, typename Function>
+inline void vecApply(float* dst, const float* src, int size, const Function& function) {
+    int i = 0;
+    for (; i + V::size <= size; i += V::size) {
+        V::store(dst + i, function(V::load(src + i)));
+    }
+    if (i < size) {
+        float buffer[V::size];
+        for (int j = 0; j < V::size; ++j) {
+            buffer[j] = i + j < size ? src[i + j] : 0.0f;
+        }
+        V::store(buffer, function(V::load(buffer)));
+        for (int j = 0; i + j < size; ++j) {
+            dst[i + j] = buffer[j];
+        }
+    }
+}
+
+template <typename V>
+struct Kernel {
+    using T = typename V::T;
+    static void exp(float* dst, const float* src, int size) {
+        vecApply<V>(dst, src, size, [](T x) { return vecExp<V>(x); });
+    }
+    static void log(float* dst, const float* src, int size) {
+        vecApply<V>(dst, src, size, [](T x) { return vecLog<V>(x); });
+    }
+    static void tanh(float* dst, const float* src, int size) {
+        vecApply<V>(dst, src, size, [](T x) { return vecTanh<V>(x); });
+    }
+    static void sigmoid(float* dst, const float* src, int size) {
+        vecApply<V>(dst, src, size, [](T x) { return vecSigmoid<V>(x); });
+    }
+    static void erf(float* dst, const float* src, int size) {
+        vecApply<V>(dst, src, size, [](T x) { return vecErf<V>(x); });
+    }
+    static void gelu(float* dst, const float* src, int size) {
+        vecApply<V>(dst, src, size, [](T x) { return vecGelu<V>(x); });
+    }
+    static void swish(float* dst, const float* src, int size) {
+        vecApply<V>(dst, src, size, [](T x) { return vecSwish<V>(x); });
+    }
+    static void hardSwish(float* dst, const float* src, int size) {
+        vecApply<V>(dst, src, size, [](T x) { return vecHardSwish<V>(x); });
+    }
+    static void softplus(float* dst, const float* src, int size) {
+        vecApply<V>(dst, src, size, [](T x) { return vecSoftplus<V>(x); });
+    }
+    static void elu(float* dst, const float* src, int size, float alpha) {
+        const T alphaV = V::set1(alpha);
+        vecApply<V>(dst, src, size, [alphaV](T x) { return vecElu<V>(x, alphaV); });
+    }
+    static void selu(float* dst, const float* src, int size, float scale, float alpha) {
+        const T alphaV = V::set1(alpha);
+        const T scaleV = V::set1(scale);
+        vecApply<V>(dst, src, size, [alphaV, scaleV](T x) { return V::mul(scaleV, vecElu<V>(x, alphaV)); });
+    }
+    static Functions functions() {
+        Functions result;
+        result.exp       = exp;
+        result.log       = log;
+        result.tanh      = tanh;
+        result.sigmoid   = sigmoid;
+        result.erf       = erf;
+        result.gelu      = gelu;
+        result.swish     = swish;
+        result.hardSwish = hardSwish;
+        result.softplus  = softplus;
+        result.elu       = elu;
+        result.selu      = selu;
+        return result;
+    }
+};
+
+} // namespace MathFunction
+} // namespace MNN
+
+#endif /* MathFunctionKernel_hpp */
@@ -0,0 +1,364 @@
+//
+//  PermuteFunction.cpp
+//  MNN
+//
+//  Created by MNN on 2019/08/29.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "PermuteFunction.hpp"
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include "Concurrency.h"
+#include "Macro.h"
+#ifdef MNN_USE_NEON
+#include <arm_neon.h>
+#elif defined(MNN_USE_SSE)
+#include <emmintrin.h>
+#endif
+
+namespace MNN {
+namespace PermuteFunction {
+// axis of the plan, strides in bytes
+struct Stride {
+    int extent;
+    int64_t dst;
+    int64_t src;
+};
+
+enum Mode { MODE_ROW, MODE_TILE, MODE_GATHER };
+
+struct Plan {
+    uint8_t* dst;
+    const uint8_t* src;
+    int bytes;
+    Mode mode;
+    // iterated one by one, the last one is the fastest
+    std::vector<Stride> outer;
+    // axis of the inner loop, contiguous in dst for MODE_ROW and MODE_TILE
+    Stride inner;
+    // axis contiguous in src, MODE_TILE only. split into blocks of rowBlock, one block for a unit of work
+    Stride rows;
+    int rowBlock;
+    int blocks;
+};
+
+struct Bytes16 {
+    uint32_t value[4];
+};
+
+template <typename T>
+static void _gather(uint8_t* dst, const uint8_t* src, int count, int64_t dstStride, int64_t srcStride) {
+    for (int i = 0; i < count; ++i) {
+        *(T*)(dst + i * dstStride) = *(const T*)(src + i * srcStride);
+    }
+}
+
+// dst row r is column r of src
+template <typename T>
+static void _transposeScalar(uint8_t* dst, const uint8_t* src, int rows, int cols, int64_t dstStride,
+                             int64_t srcStride) {
+    for (int r = 0; r < rows; ++r) {
+        auto d = (T*)(dst + r * dstStride);
+        auto s = src + r * sizeof(T);
+        for (int c = 0; c < cols; ++c) {
+            d[c] = *(const T*)(s + c * srcStride);
+        }
+    }
+}
+
+// rows and cols are at most one tile
+template <typename T>
+static void _transposeBlock(uint8_t* dst, const uint8_t* src, int rows, int cols, int64_t dstStride,
+                            int64_t srcStride) {
+    _transposeScalar<T>(dst, src, rows, cols, dstStride, srcStride);
+}
+
+#if defined(MNN_USE_NEON) || defined(MNN_USE_SSE)
+static inline void _transpose4x4(uint8_t* dst, const uint8_t* src, int64_t dstStride, int64_t srcStride) {
+#ifdef MNN_USE_NEON
+    auto s0 = vld1q_u32((const uint32_t*)(src));
+    auto s1 = vld1q_u32((const uint32_t*)(src + srcStride));
+    auto s2 = vld1q_u32((const uint32_t*)(src + 2 * srcStride));
+    auto s3 = vld1q_u32((const uint32_t*)(src + 3 * srcStride));
+    auto t0 = vtrnq_u32(s0, s1);
+    auto t1 = vtrnq_u32(s2, s3);
+    vst1q_u32((uint32_t*)(dst), vcombine_u32(vget_low_u32(t0.val[0]), vget_low_u32(t1.val[0])));
+    vst1q_u32((uint32_t*)(dst + dstStride), vcombine_u32(vget_low_u32(t0.val[1]), vget_low_u32(t1.val[1])));
+    vst1q_u32((uint32_t*)(dst + 2 * dstStride), vcombine_u32(vget_high_u32(t0.val[0]), vget_high_u32(t1.val[0])));
+    vst1q_u32((uint32_t*)(dst + 3 * dstStride), vcombine_u32(vget_high_u32(t0.val[1]), vget_high_u32(t1.val[1])));
+#else
+    auto s0 = _mm_loadu_ps((const float*)(src));
+    auto s1 = _mm_loadu_ps((const float*)(src + srcStride));
+    auto s2 = _mm_loadu_ps((const float*)(src + 2 * srcStride));
+    auto s3 = _mm_loadu_ps((const float*)(src + 3 * srcStride));
+    _MM_TRANSPOSE4_PS(s0, s1, s2, s3);
+    _mm_storeu_ps((float*)(dst), s0);
+    _mm_storeu_ps((float*)(dst + dstStride), s1);
+    _mm_storeu_ps((float*)(dst + 2 * dstStride), s2);
+    _mm_storeu_ps((float*)(dst + 3 * dstStride), s3);
+#endif
+}
+
+template <>
+void _transposeBlock<uint32_t>(uint8_t* dst, const uint8_t* src, int rows, int cols, int64_t dstStride,
+                               int64_t srcStride) {
+    const int rowsC4 = rows / 4 * 4;
+    const int colsC4 = cols / 4 * 4;
+    for (int r = 0; r < rowsC4; r += 4) {
+        auto d = dst + r * dstStride;
+        auto s = src + r * sizeof(uint32_t);
+        for (int c = 0; c < colsC4; c += 4) {
+            _transpose4x4(d + c * sizeof(uint32_t), s + c * srcStride, dstStride, srcStride);
+        }
+    }
+    if (colsC4 < cols) {
+        _transposeScalar<uint32_t>(dst + colsC4 * sizeof(uint32_t), src + colsC4 * srcStride, rowsC4,
+                                   cols - colsC4, dstStride, srcStride);
+    }
+    if (rowsC4 < rows) {
+        _transposeScalar<uint32_t>(dst + rowsC4 * dstStride, src + rowsC4 * sizeof(uint32_t), rows - rowsC4, cols,
+                                   dstStride, srcStride);
+    }
+}
+#endif
+
+// tiles of 64 bytes a side, 16x16 for float and 64x64 for uint8, a tile row is one cache line
+template <typename T>
+static void _transpose(uint8_t* dst, const uint8_t* src, int rows, int cols, int64_t dstStride, int64_t srcStride) {
+    const int tile = std::max(64 / (int)sizeof(T), 4);
+    for (int c = 0; c < cols; c += tile) {
+        _transposeBlock<T>(dst + c * sizeof(T), src + c * srcStride, rows, std::min(tile, cols - c), dstStride,
+                           srcStride);
+    }
+}
+
+template <typename T>
+static void _run(const Plan* plan, int start, int end) {
+    const int outerCount = (int)plan->outer.size();
+    std::vector<int> index(outerCount);
+    int64_t dstOffset = 0;
+    int64_t srcOffset = 0;
+    int outerUnit     = start / plan->blocks;
+    int block         = start % plan->blocks;
+    for (int i = outerCount - 1; i >= 0; --i) {
+        auto& axis = plan->outer[i];
+        index[i]   = outerUnit % axis.extent;
+        outerUnit /= axis.extent;
+        dstOffset += index[i] * axis.dst;
+        srcOffset += index[i] * axis.src;
+    }
+    auto& inner = plan->inner;
+    auto& rows  = plan->rows;
+    for (int u = start; u < end; ++u) {
+        auto dst = plan->dst + dstOffset;
+        auto src = plan->src + srcOffset;
+        switch (plan->mode) {
+            case MODE_ROW:
+                ::memcpy(dst, src, inner.extent * plan->bytes);
+                break;
+            case MODE_GATHER:
+                _gather<T>(dst, src, inner.extent, inner.dst, inner.src);
+                break;
+            case MODE_TILE: {
+                const int rowStart = block * plan->rowBlock;
+                _transpose<T>(dst + rowStart * rows.dst, src + rowStart * rows.src,
+                              std::min(plan->rowBlock, rows.extent - rowStart), inner.extent, rows.dst, inner.src);
+                break;
+            }
+        }
+        if (++block < plan->blocks) {
+            continue;
+        }
+        block = 0;
+        for (int i = outerCount - 1; i >= 0; --i) {
+            auto& axis = plan->outer[i];
+            dstOffset += axis.dst;
+            srcOffset += axis.src;
+            if (++index[i] < axis.extent) {
+                break;
+            }
+            index[i] = 0;
+            dstOffset -= axis.extent * axis.dst;
+            srcOffset -= axis.extent * axis.src;
+        }
+    }
+}
+
+static void _copy(uint8_t* dst, const uint8_t* src, std::vector<Stride> axes, int bytes, int threadNumber) {
+    int64_t total = bytes;
+    for (auto& axis : axes) {
+        total *= axis.extent;
+    }
+    if (0 == total) {
+        return;
+    }
+    axes.erase(std::remove_if(axes.begin(), axes.end(), [](const Stride& axis) { return 1 == axis.extent; }),
+               axes.end());
+    // only elements of 1, 2, 4, 8 and 16 bytes have kernels, others are runs of bytes
+    if (bytes > 16 || 0 != (bytes & (bytes - 1))) {
+        axes.push_back({bytes, 1, 1});
+        bytes = 1;
+    }
+
+    // dst major order, then merge axes contiguous in both views
+    std::stable_sort(axes.begin(), axes.end(), [](const Stride& a, const Stride& b) { return a.dst > b.dst; });
+    std::vector<Stride> merged;
+    for (auto& axis : axes) {
+        if (!merged.empty()) {
+            auto& last = merged.back();
+            if (last.dst == axis.dst * axis.extent && last.src == axis.src * axis.extent) {
+                last = {last.extent * axis.extent, axis.dst, axis.src};
+                continue;
+            }
+        }
+        merged.push_back(axis);
+    }
+    // a contiguous inner run of up to 16 bytes becomes one element
+    if (!merged.empty()) {
+        auto& last        = merged.back();
+        const int runSize = last.extent * bytes;
+        if (last.dst == bytes && last.src == bytes && runSize <= 16 && 0 == (runSize & (runSize - 1))) {
+            bytes = runSize;
+            merged.pop_back();
+        }
+    }
+    if (merged.empty()) {
+        ::memcpy(dst, src, bytes);
+        return;
+    }
+
+    Plan plan;
+    plan.dst      = dst;
+    plan.src      = src;
+    plan.bytes    = bytes;
+    plan.inner    = merged.back();
+    plan.rows     = {1, 0, 0};
+    plan.rowBlock = 1;
+    plan.blocks   = 1;
+    merged.pop_back();
+    if (plan.inner.dst == bytes && plan.inner.src == bytes) {
+        plan.mode = MODE_ROW;
+    } else {
+        plan.mode = MODE_GATHER;
+        if (plan.inner.dst == bytes) {
+            auto rows = std::find_if(merged.begin(), merged.end(),
+                                     [bytes](const Stride& axis) { return axis.src == bytes; });
+            if (rows != merged.end()) {
+                plan.mode     = MODE_TILE;
+                plan.rows     = *rows;
+                plan.rowBlock = std::max(64 / bytes, 4);
+                plan.blocks   = UP_DIV(rows->extent, plan.rowBlock);
+                merged.erase(rows);
+            }
+        }
+    }
+    plan.outer = std::move(merged);
+
+    int units = plan.blocks;
+    for (auto& axis : plan.outer) {
+        units *= axis.extent;
+    }
+    // under 64KB a thread costs more than it saves
+    threadNumber = std::max(1, std::min(threadNumber, (int)std::min<int64_t>(units, total / 65536)));
+
+    void (*run)(const Plan*, int, int) = nullptr;
+    switch (bytes) {
+        case 1:
+            run = _run<uint8_t>;
+            break;
+        case 2:
+            run = _run<uint16_t>;
+            break;
+        case 4:
+            run = _run<uint32_t>;
+            break;
+        case 8:
+            run = _run<uint64_t>;
+            break;
+        default:
+            run = _run<Bytes16>;
+            break;
+    }
+    if (1 == threadNumber) {
+        run(&plan, 0, units);
+        return;
+    }
+    const int unitPerThread = UP_DIV(units, threadNumber);
+    const Plan* planPtr     = &plan;
+    MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+        const int start = (int)tId * unitPerThread;
+        const int end   = std::min(units, start + unitPerThread);
+        if (start < end) {
+            run(planPtr, start, end);
+        }
+    }
+    MNN_CONCURRENCY_END();
+}
+
+void copy(void* dst, const void* src, const std::vector<Axis>& axes, int bytes, int threadNumber) {
+    // C4 axes are split into whole quads and the remainder, one plain strided copy for each piece
+    struct Piece {
+        int64_t dstOffset;
+        int64_t srcOffset;
+        std::vector<Stride> axes;
+    };
+    std::vector<Piece> pieces(1, {0, 0, {}});
+    for (auto& axis : axes) {
+        if (!axis.dstC4 && !axis.srcC4) {
+            for (auto& piece : pieces) {
+                piece.axes.push_back(
+                    {axis.extent, (int64_t)axis.dstStride * bytes, (int64_t)axis.srcStride * bytes});
+            }
+            continue;
+        }
+        const int quad        = axis.extent / 4;
+        const int remain      = axis.extent % 4;
+        const int64_t dstQuad = (axis.dstC4 ? 1 : 4) * (int64_t)axis.dstStride * bytes;
+        const int64_t srcQuad = (axis.srcC4 ? 1 : 4) * (int64_t)axis.srcStride * bytes;
+        const int64_t dstLane = axis.dstC4 ? bytes : (int64_t)axis.dstStride * bytes;
+        const int64_t srcLane = axis.srcC4 ? bytes : (int64_t)axis.srcStride * bytes;
+        std::vector<Piece> splited;
+        for (auto& piece : pieces) {
+            if (quad > 0) {
+                Piece whole = piece;
+                whole.axes.push_back({quad, dstQuad, srcQuad});
+                whole.axes.push_back({4, dstLane, srcLane});
+                splited.emplace_back(std::move(whole));
+            }
+            if (remain > 0) {
+                Piece rest = piece;
+                rest.dstOffset += quad * dstQuad;
+                rest.srcOffset += quad * srcQuad;
+                rest.axes.push_back({remain, dstLane, srcLane});
+                splited.emplace_back(std::move(rest));
+            }
+        }
+        pieces = std::move(splited);
+    }
+    for (auto& piece : pieces) {
+        _copy((uint8_t*)dst + piece.dstOffset, (const uint8_t*)src + piece.srcOffset, piece.axes, bytes,
+              threadNumber);
+    }
+}
+
+void transpose(void* dst, const void* src, const std::vector<int>& shape, const std::vector<int>& perm, int bytes,
+               int threadNumber) {
+    const int dims = (int)shape.size();
+    std::vector<int> srcStride(dims, 1);
+    for (int i = dims - 2; i >= 0; --i) {
+        srcStride[i] = srcStride[i + 1] * shape[i + 1];
+    }
+    std::vector<Axis> axes(dims);
+    int dstStride = 1;
+    for (int i = dims - 1; i >= 0; --i) {
+        axes[i].extent    = shape[perm[i]];
+        axes[i].dstStride = dstStride;
+        axes[i].srcStride = srcStride[perm[i]];
+        dstStride *= axes[i].extent;
+    }
+    copy(dst, src, axes, bytes, threadNumber);
+}
+} // namespace PermuteFunction
+} // namespace MNN
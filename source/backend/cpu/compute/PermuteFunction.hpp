@@ -0,0 +1,49 @@
+//
+//  PermuteFunction.hpp
+//  MNN
+//
+//  Created by MNN on 2019/08/29.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef PermuteFunction_hpp
+#define PermuteFunction_hpp
+
+#include <vector>
+
+namespace MNN {
+namespace PermuteFunction {
+/**
+ * one axis of a strided view, strides are counted in elements.
+ * a C4 side is the channel of NC4HW4, index x of it lives at (x / 4) * stride + x % 4.
+ */
+struct Axis {
+    int extent;
+    int dstStride;
+    int srcStride;
+    bool dstC4 = false;
+    bool srcC4 = false;
+};
+
+/**
+ * @brief copy between two views of the same shape, element of indexes (i0, i1, ...) is at sum(ik * dstStride_k)
+ *        of dst and sum(ik * srcStride_k) of src.
+ * C4 axes are split into whole quads and the remainder, padding of quads in dst is not written. then axes of
+ * extent 1 are dropped, axes contiguous in both views are merged and contiguous runs of up to 16 bytes become one
+ * element. the copy runs by rows when the inner axis is contiguous on both sides, by cache blocked 2D transposes
+ * when another axis is contiguous in src, by strided gathers otherwise. work is split over outer axes and blocks.
+ * @param bytes         element size.
+ * @param threadNumber  threads at most, fewer are used for small copies.
+ */
+void copy(void* dst, const void* src, const std::vector<Axis>& axes, int bytes, int threadNumber);
+
+/**
+ * @brief transpose of dense tensors, axis i of dst is axis perm[i] of src.
+ * @param shape     shape of src.
+ */
+void transpose(void* dst, const void* src, const std::vector<int>& shape, const std::vector<int>& perm, int bytes,
+               int threadNumber);
+} // namespace PermuteFunction
+} // namespace MNN
+
+#endif /* PermuteFunction_hpp */
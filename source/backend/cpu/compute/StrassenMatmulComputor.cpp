@@ -8,6 +8,7 @@
 
 #include "StrassenMatmulComputor.hpp"
 #include <string.h>
+#include "CPURuntime.hpp"
 #include "ConvOpt.h"
 #include "Macro.h"
 //#define MNN_OPEN_TIME_TRACE
@@ -59,8 +60,9 @@ private:
     Backend::StorageType mStorageType;
 };
 StrassenMatrixComputor::StrassenMatrixComputor(Backend* bn, int maxDepth, bool cacheB) : Execution(bn) {
-    mMaxDepth = maxDepth;
-    mCacheB   = cacheB;
+    mMaxDepth  = maxDepth;
+    mCacheB    = cacheB;
+    mCacheSize = MNNGetL2CacheSize();
 };
 StrassenMatrixComputor::~StrassenMatrixComputor() {
     // Do nothing
@@ -75,6 +77,26 @@ static void _matrixCopy(float* C, const float* A, size_t widthC4, size_t cStride
     }
 }
 
+/*
+ Compute the cost saved by expand, counted in read / write of (4,1) vectors
+ Matrix Mul need eSub*lSub*hSub*4*(1+1.0/CONVOLUTION_TILED_NUMBWR), Matrix Add/Sub need x*y*3 (2 read 1 write)
+ Add/Sub of sub matrices staying in L2 cost one per vector, otherwise they stream from memory and cost four
+ */
+static float _expandSaveCost(int eSub, int lSub, int hSub, bool constB, int cacheSize) {
+    static const int aUnit = 4;
+    static const int bUnit = 16;
+    float mulCost          = (float)eSub * lSub * hSub * 4 * (1.0f + 1.0f / CONVOLUTION_TILED_NUMBWR);
+    float addCost          = 4.0f * eSub * lSub * 3 + 7.0f * eSub * hSub * 3;
+    if (!constB) {
+        addCost += 4.0f * (lSub * hSub * bUnit / aUnit) * 3;
+    }
+    float subBytes = ((float)eSub * lSub * aUnit + lSub * hSub * bUnit + eSub * hSub * aUnit) * sizeof(float);
+    if (subBytes > cacheSize) {
+        addCost *= 4.0f;
+    }
+    return mulCost - addCost;
+}
+
 ErrorCode StrassenMatrixComputor::_generateTrivalMatMul(const Tensor* AT, const Tensor* BT, const Tensor* CT) {
     // Generate Trival Matrix Multiply
     auto l       = AT->length(0);
@@ -164,12 +186,7 @@ ErrorCode StrassenMatrixComputor::_generateMatMulConstB(const Tensor* AT, const
     auto lSub = l / 2;
     auto hSub = h / 2;
 
-    /*
-     Compute the memory read / write cost for expand
-     Matrix Mul need eSub*lSub*hSub*(1+1.0/CONVOLUTION_TILED_NUMBWR), Matrix Add/Sub need x*y*UNIT*3 (2 read 1 write)
-     */
-    float saveCost =
-        (eSub * lSub * hSub) * (1.0f + 1.0f / CONVOLUTION_TILED_NUMBWR) - 4 * (eSub * lSub) * 3 - 7 * (eSub * hSub * 3);
+    float saveCost = _expandSaveCost(eSub, lSub, hSub, true, mCacheSize);
     if (mCurrentDepth >= mMaxDepth || e <= CONVOLUTION_TILED_NUMBWR || l % 2 != 0 || h % 2 != 0 || saveCost < 0.0f) {
         return _generateTrivalMatMul(AT, BT, CT);
     }
@@ -178,6 +195,7 @@ ErrorCode StrassenMatrixComputor::_generateMatMulConstB(const Tensor* AT, const
     // Strassen Construct
     auto bn = backend();
     mCurrentDepth += 1;
+    std::shared_ptr<void> __depth(nullptr, [this](void*) { mCurrentDepth -= 1; });
     static const int aUnit = 4;
     static const int bUnit = 16;
     auto AS                = std::vector<int>{lSub, eSub, aUnit};
@@ -349,12 +367,7 @@ ErrorCode StrassenMatrixComputor::_generateMatMul(const Tensor* AT, const Tensor
     auto lSub = l / 2;
     auto hSub = h / 2;
 
-    /*
-     Compute the memory read / write cost for expand
-     Matrix Mul need eSub*lSub*hSub*(1+1.0/CONVOLUTION_TILED_NUMBWR), Matrix Add/Sub need x*y*UNIT*3 (2 read 1 write)
-     */
-    float saveCost = (eSub * lSub * hSub) * (1.0f + 1.0f / CONVOLUTION_TILED_NUMBWR) - 4 * (eSub * lSub) * 3 -
-                     4 * (4 * lSub * hSub * 3) - 7 * (eSub * hSub * 3);
+    float saveCost = _expandSaveCost(eSub, lSub, hSub, false, mCacheSize);
     if (mCurrentDepth >= mMaxDepth || e <= CONVOLUTION_TILED_NUMBWR || l % 2 != 0 || h % 2 != 0 || saveCost < 0.0f) {
         return _generateTrivalMatMul(AT, BT, CT);
     }
@@ -363,6 +376,7 @@ ErrorCode StrassenMatrixComputor::_generateMatMul(const Tensor* AT, const Tensor
     // Strassen Construct
     auto bn = backend();
     mCurrentDepth += 1;
+    std::shared_ptr<void> __depth(nullptr, [this](void*) { mCurrentDepth -= 1; });
     static const int aUnit = 4;
     static const int bUnit = 16;
     auto AS                = std::vector<int>{lSub, eSub, aUnit};
@@ -15,7 +15,7 @@
 namespace MNN {
 class StrassenMatrixComputor : public Execution {
 public:
-    StrassenMatrixComputor(Backend* bn, int maxDepth = 5, bool cacheB = false);
+    StrassenMatrixComputor(Backend* bn, int maxDepth = 3, bool cacheB = false);
     virtual ~StrassenMatrixComputor();
     /*
      It's assume that:
@@ -42,6 +42,7 @@ private:
     int mMaxDepth;
     int mCurrentDepth = 0;
     bool mCacheB;
+    int mCacheSize;
 };
 } // namespace MNN
 
@@ -0,0 +1,177 @@
+//
+//  TopKFunction.cpp
+//  MNN
+//
+//  Created by MNN on 2019/08/27.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "TopKFunction.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace MNN {
+namespace TopKFunction {
+
+template <typename T>
+int32_t argMax(const T* values, int32_t size) {
+    if (size <= 0) {
+        return 0;
+    }
+    // 4 independent lanes break the dependency between compares, each lane keeps its first max
+    T maxValue[4]       = {values[0], values[0], values[0], values[0]};
+    int32_t maxIndex[4] = {0, 0, 0, 0};
+    int32_t i           = 0;
+    for (; i + 4 <= size; i += 4) {
+        for (int j = 0; j < 4; ++j) {
+            if (values[i + j] > maxValue[j]) {
+                maxValue[j] = values[i + j];
+                maxIndex[j] = i + j;
+            }
+        }
+    }
+    for (; i < size; ++i) {
+        if (values[i] > maxValue[0]) {
+            maxValue[0] = values[i];
+            maxIndex[0] = i;
+        }
+    }
+    int32_t result = maxIndex[0];
+    for (int j = 1; j < 4; ++j) {
+        if (maxValue[j] > values[result] || (maxValue[j] == values[result] && maxIndex[j] < result)) {
+            result = maxIndex[j];
+        }
+    }
+    return result;
+}
+
+template <typename T>
+struct Greater {
+    const T* values;
+    bool operator()(int32_t a, int32_t b) const {
+        return values[a] > values[b] || (values[a] == values[b] && a < b);
+    }
+};
+
+// keep k best in a heap whose front is the worst of them, most values are rejected by one compare with it
+template <typename T, typename Index>
+static void _heapSelect(const T* values, Index index, int32_t size, int32_t k, int32_t* indexes) {
+    Greater<T> greater{values};
+    std::vector<int32_t> heap(k);
+    for (int32_t i = 0; i < k; ++i) {
+        heap[i] = index(i);
+    }
+    std::make_heap(heap.begin(), heap.end(), greater);
+    auto worst = values[heap.front()];
+    for (int32_t i = k; i < size; ++i) {
+        const auto current = index(i);
+        if (values[current] < worst || !greater(current, heap.front())) {
+            continue;
+        }
+        std::pop_heap(heap.begin(), heap.end(), greater);
+        heap.back() = current;
+        std::push_heap(heap.begin(), heap.end(), greater);
+        worst = values[heap.front()];
+    }
+    std::sort_heap(heap.begin(), heap.end(), greater);
+    std::copy(heap.begin(), heap.end(), indexes);
+}
+
+template <typename T, typename Index>
+static void _partialSelect(const T* values, Index index, int32_t size, int32_t k, int32_t* indexes) {
+    Greater<T> greater{values};
+    std::vector<int32_t> order(size);
+    for (int32_t i = 0; i < size; ++i) {
+        order[i] = index(i);
+    }
+    std::nth_element(order.begin(), order.begin() + (k - 1), order.end(), greater);
+    std::sort(order.begin(), order.begin() + k, greater);
+    std::copy(order.begin(), order.begin() + k, indexes);
+}
+
+template <typename T, typename Index>
+static void _select(const T* values, Index index, int32_t size, int32_t k, int32_t* indexes) {
+    if (k <= 0) {
+        return;
+    }
+    if (1 == k) {
+        Greater<T> greater{values};
+        int32_t best = index(0);
+        for (int32_t i = 1; i < size; ++i) {
+            if (greater(index(i), best)) {
+                best = index(i);
+            }
+        }
+        indexes[0] = best;
+        return;
+    }
+    // heap costs n * log(k) in worst case while nth_element costs n, heap wins only when k is small
+    if (k * 8 < size) {
+        _heapSelect(values, index, size, k, indexes);
+    } else {
+        _partialSelect(values, index, size, k, indexes);
+    }
+}
+
+template <typename T>
+void selectTopK(const T* values, int32_t size, int32_t k, int32_t* indexes) {
+    if (1 == k) {
+        indexes[0] = argMax(values, size);
+        return;
+    }
+    _select(values, [](int32_t i) { return i; }, size, k, indexes);
+}
+
+// histogram of 256 values gives the k-th value in one pass, then indexes are placed by counting sort
+template <>
+void selectTopK<uint8_t>(const uint8_t* values, int32_t size, int32_t k, int32_t* indexes) {
+    if (1 == k) {
+        indexes[0] = argMax(values, size);
+        return;
+    }
+    if (k <= 0) {
+        return;
+    }
+    int32_t count[256] = {0};
+    for (int32_t i = 0; i < size; ++i) {
+        count[values[i]]++;
+    }
+    int32_t offset[256];
+    int32_t greater = 0, threshold = 255;
+    for (; threshold >= 0; --threshold) {
+        offset[threshold] = greater;
+        if (greater + count[threshold] >= k) {
+            break;
+        }
+        greater += count[threshold];
+    }
+    int32_t rest = k - greater;
+    for (int32_t i = 0; i < size; ++i) {
+        const int v = values[i];
+        if (v > threshold) {
+            indexes[offset[v]++] = i;
+        } else if (v == threshold && rest > 0) {
+            indexes[offset[v]++] = i;
+            rest--;
+        }
+    }
+}
+
+template <typename T>
+void selectTopK(const T* values, const int32_t* candidates, int32_t size, int32_t k, int32_t* indexes) {
+    _select(values, [candidates](int32_t i) { return candidates[i]; }, size, k, indexes);
+}
+
+template int32_t argMax<float>(const float* values, int32_t size);
+template int32_t argMax<int32_t>(const int32_t* values, int32_t size);
+template int32_t argMax<uint8_t>(const uint8_t* values, int32_t size);
+template void selectTopK<float>(const float* values, int32_t size, int32_t k, int32_t* indexes);
+template void selectTopK<int32_t>(const int32_t* values, int32_t size, int32_t k, int32_t* indexes);
+template void selectTopK<float>(const float* values, const int32_t* candidates, int32_t size, int32_t k,
+                                int32_t* indexes);
+template void selectTopK<int32_t>(const int32_t* values, const int32_t* candidates, int32_t size, int32_t k,
+                                  int32_t* indexes);
+template void selectTopK<uint8_t>(const uint8_t* values, const int32_t* candidates, int32_t size, int32_t k,
+                                  int32_t* indexes);
+} // namespace TopKFunction
+} // namespace MNN
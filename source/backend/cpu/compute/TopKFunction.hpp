@@ -0,0 +1,45 @@
+//
+//  TopKFunction.hpp
+//  MNN
+//
+//  Created by MNN on 2019/08/27.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef TopKFunction_hpp
+#define TopKFunction_hpp
+
+#include <stdint.h>
+
+namespace MNN {
+namespace TopKFunction {
+/**
+ * @brief index of max value, the first one if there are several. instantiated for float, int32_t and uint8_t.
+ */
+template <typename T>
+int32_t argMax(const T* values, int32_t size);
+
+/**
+ * @brief indexes of k largest values sorted by value descending, smaller index goes first for equal values.
+ *        heap is used for small k, partial sort for large k and histogram for uint8_t.
+ * @param indexes   k indexes written.
+ */
+template <typename T>
+void selectTopK(const T* values, int32_t size, int32_t k, int32_t* indexes);
+
+/**
+ * @brief selectTopK of uint8_t, histogram of 256 values gives the k-th value in one pass.
+ */
+template <>
+void selectTopK<uint8_t>(const uint8_t* values, int32_t size, int32_t k, int32_t* indexes);
+
+/**
+ * @brief like selectTopK, while only values of given candidates are considered. used to merge results of chunks.
+ * @param candidates    indexes of values, each one appears only once.
+ */
+template <typename T>
+void selectTopK(const T* values, const int32_t* candidates, int32_t size, int32_t k, int32_t* indexes);
+} // namespace TopKFunction
+} // namespace MNN
+
+#endif /* TopKFunction_hpp */
@@ -66,4 +66,24 @@ void MNNAddC4WithStride(const float* source, float* dest, size_t srcStride, size
     }
 }
 
+void MNNUInt8ToFloatWithOffsetC4(float* dst, const uint8_t* src, const float* offset, size_t sizeQuad) {
+    auto offsetV = _mm_loadu_ps(offset);
+    auto zero    = _mm_setzero_si128();
+    size_t i     = 0;
+    for (; i + 4 <= sizeQuad; i += 4) {
+        auto v = _mm_loadu_si128((const __m128i*)(src + 4 * i));
+        auto l = _mm_unpacklo_epi8(v, zero);
+        auto h = _mm_unpackhi_epi8(v, zero);
+        _mm_storeu_ps(dst + 4 * i + 0, _mm_add_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(l, zero)), offsetV));
+        _mm_storeu_ps(dst + 4 * i + 4, _mm_add_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(l, zero)), offsetV));
+        _mm_storeu_ps(dst + 4 * i + 8, _mm_add_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(h, zero)), offsetV));
+        _mm_storeu_ps(dst + 4 * i + 12, _mm_add_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(h, zero)), offsetV));
+    }
+    for (; i < sizeQuad; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            dst[4 * i + j] = src[4 * i + j] + offset[j];
+        }
+    }
+}
+
 #endif
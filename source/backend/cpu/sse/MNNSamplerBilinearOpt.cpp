@@ -0,0 +1,152 @@
+//
+//  MNNSamplerBilinearOpt.cpp
+//  MNN
+//
+//  Created by MNN on 2019/09/04.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifdef MNN_USE_SSE
+
+#include <emmintrin.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+
+// points: x, y of first sample then step of x, y. xMax / yMax: last column / row of source
+extern "C" {
+void MNNSamplerC4BilinearOpt(const unsigned char* source, unsigned char* dest, float* points, size_t count, size_t xMax,
+                             size_t yMax, size_t yStride);
+void MNNSamplerC1BilinearOpt(const unsigned char* source, unsigned char* dest, float* points, size_t count, size_t xMax,
+                             size_t yMax, size_t yStride);
+}
+
+static inline __m128 _loadPixel(const unsigned char* p) {
+    int32_t v;
+    ::memcpy(&v, p, sizeof(int32_t));
+    auto zero = _mm_setzero_si128();
+    auto c    = _mm_unpacklo_epi8(_mm_cvtsi32_si128(v), zero);
+    return _mm_cvtepi32_ps(_mm_unpacklo_epi16(c, zero));
+}
+
+void MNNSamplerC4BilinearOpt(const unsigned char* source, unsigned char* dest, float* points, size_t count, size_t xMax,
+                             size_t yMax, size_t yStride) {
+    float x           = points[0];
+    float y           = points[1];
+    const float dx    = points[2];
+    const float dy    = points[3];
+    const float xMaxF = (float)xMax;
+    const float yMaxF = (float)yMax;
+    const auto minV   = _mm_set1_ps(0.0f);
+    const auto maxV   = _mm_set1_ps(255.0f);
+    for (size_t i = 0; i < count; ++i) {
+        const float cx = std::max(std::min(x, xMaxF), 0.0f);
+        const float cy = std::max(std::min(y, yMaxF), 0.0f);
+        const int x0   = (int)cx;
+        const int y0   = (int)cy;
+        const int x1   = std::min(x0 + 1, (int)xMax);
+        const int y1   = std::min(y0 + 1, (int)yMax);
+        auto xF        = _mm_set1_ps(cx - (float)x0);
+        auto yF        = _mm_set1_ps(cy - (float)y0);
+
+        auto row0   = source + y0 * yStride;
+        auto row1   = source + y1 * yStride;
+        auto c00    = _loadPixel(row0 + 4 * x0);
+        auto c01    = _loadPixel(row0 + 4 * x1);
+        auto c10    = _loadPixel(row1 + 4 * x0);
+        auto c11    = _loadPixel(row1 + 4 * x1);
+        auto top    = _mm_add_ps(c00, _mm_mul_ps(_mm_sub_ps(c01, c00), xF));
+        auto bottom = _mm_add_ps(c10, _mm_mul_ps(_mm_sub_ps(c11, c10), xF));
+        auto v      = _mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), yF));
+        v           = _mm_min_ps(_mm_max_ps(v, minV), maxV);
+
+        auto d         = _mm_cvttps_epi32(v);
+        d              = _mm_packs_epi32(d, d);
+        d              = _mm_packus_epi16(d, d);
+        int32_t result = _mm_cvtsi128_si32(d);
+        ::memcpy(dest + 4 * i, &result, sizeof(int32_t));
+
+        x += dx;
+        y += dy;
+    }
+}
+
+void MNNSamplerC1BilinearOpt(const unsigned char* source, unsigned char* dest, float* points, size_t count, size_t xMax,
+                             size_t yMax, size_t yStride) {
+    float x          = points[0];
+    float y          = points[1];
+    const float dx   = points[2];
+    const float dy   = points[3];
+    const auto minV  = _mm_set1_ps(0.0f);
+    const auto maxV  = _mm_set1_ps(255.0f);
+    const auto xMaxV = _mm_set1_ps((float)xMax);
+    const auto yMaxV = _mm_set1_ps((float)yMax);
+    size_t i         = 0;
+    // four samples a time, coordinates stepped as scalar so that they match the tail
+    for (; i + 4 <= count; i += 4) {
+        float xs[4], ys[4];
+        for (int j = 0; j < 4; ++j) {
+            xs[j] = x;
+            ys[j] = y;
+            x += dx;
+            y += dy;
+        }
+        auto cx = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(xs), xMaxV), minV);
+        auto cy = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(ys), yMaxV), minV);
+        // non-negative after clamp, truncation is floor
+        auto x0 = _mm_cvttps_epi32(cx);
+        auto y0 = _mm_cvttps_epi32(cy);
+        auto xF = _mm_sub_ps(cx, _mm_cvtepi32_ps(x0));
+        auto yF = _mm_sub_ps(cy, _mm_cvtepi32_ps(y0));
+        int32_t xi[4], yi[4];
+        _mm_storeu_si128((__m128i*)xi, x0);
+        _mm_storeu_si128((__m128i*)yi, y0);
+        float c[4][4];
+        for (int j = 0; j < 4; ++j) {
+            const int x1 = std::min(xi[j] + 1, (int)xMax);
+            const int y1 = std::min(yi[j] + 1, (int)yMax);
+            auto row0    = source + yi[j] * yStride;
+            auto row1    = source + y1 * yStride;
+            c[0][j]      = row0[xi[j]];
+            c[1][j]      = row0[x1];
+            c[2][j]      = row1[xi[j]];
+            c[3][j]      = row1[x1];
+        }
+        auto c00    = _mm_loadu_ps(c[0]);
+        auto c01    = _mm_loadu_ps(c[1]);
+        auto c10    = _mm_loadu_ps(c[2]);
+        auto c11    = _mm_loadu_ps(c[3]);
+        auto top    = _mm_add_ps(c00, _mm_mul_ps(_mm_sub_ps(c01, c00), xF));
+        auto bottom = _mm_add_ps(c10, _mm_mul_ps(_mm_sub_ps(c11, c10), xF));
+        auto v      = _mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), yF));
+        v           = _mm_min_ps(_mm_max_ps(v, minV), maxV);
+
+        auto d         = _mm_cvttps_epi32(v);
+        d              = _mm_packs_epi32(d, d);
+        d              = _mm_packus_epi16(d, d);
+        int32_t result = _mm_cvtsi128_si32(d);
+        ::memcpy(dest + i, &result, sizeof(int32_t));
+    }
+    const float xMaxF = (float)xMax;
+    const float yMaxF = (float)yMax;
+    for (; i < count; ++i) {
+        const float cx = std::max(std::min(x, xMaxF), 0.0f);
+        const float cy = std::max(std::min(y, yMaxF), 0.0f);
+        const int x0   = (int)cx;
+        const int y0   = (int)cy;
+        const int x1   = std::min(x0 + 1, (int)xMax);
+        const int y1   = std::min(y0 + 1, (int)yMax);
+        const float xF = cx - (float)x0;
+        const float yF = cy - (float)y0;
+        auto row0      = source + y0 * yStride;
+        auto row1      = source + y1 * yStride;
+        float top      = row0[x0] + (row0[x1] - row0[x0]) * xF;
+        float bottom   = row1[x0] + (row1[x1] - row1[x0]) * xF;
+        float v        = top + (bottom - top) * yF;
+        dest[i]        = (unsigned char)std::max(std::min(v, 255.0f), 0.0f);
+        x += dx;
+        y += dy;
+    }
+}
+
+#endif
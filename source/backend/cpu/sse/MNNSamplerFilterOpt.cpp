@@ -0,0 +1,154 @@
+//
+//  MNNSamplerFilterOpt.cpp
+//  MNN
+//
+//  Created by MNN on 2019/09/09.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifdef MNN_USE_SSE
+
+#include <emmintrin.h>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include "ImageFilter.hpp"
+
+// points: x, y of first sample, step of x, y, then width, height and left, top of box relative to sample
+extern "C" {
+void MNNSamplerC4BicubicOpt(const unsigned char* source, unsigned char* dest, float* points, size_t count, size_t iw,
+                            size_t ih, size_t yStride);
+void MNNSamplerC4AreaOpt(const unsigned char* source, unsigned char* dest, float* points, size_t count, size_t iw,
+                         size_t ih, size_t yStride);
+}
+
+static inline __m128 _loadPixel(const unsigned char* p) {
+    int32_t v;
+    ::memcpy(&v, p, sizeof(int32_t));
+    auto zero = _mm_setzero_si128();
+    auto c    = _mm_unpacklo_epi8(_mm_cvtsi32_si128(v), zero);
+    return _mm_cvtepi32_ps(_mm_unpacklo_epi16(c, zero));
+}
+
+// v is rounded
+static inline void _savePixel(unsigned char* p, __m128 v) {
+    auto d         = _mm_cvttps_epi32(_mm_add_ps(v, _mm_set1_ps(0.5f)));
+    d              = _mm_packs_epi32(d, d);
+    d              = _mm_packus_epi16(d, d);
+    int32_t result = _mm_cvtsi128_si32(d);
+    ::memcpy(p, &result, sizeof(int32_t));
+}
+
+void MNNSamplerC4BicubicOpt(const unsigned char* source, unsigned char* dest, float* points, size_t count, size_t iw,
+                            size_t ih, size_t yStride) {
+    float x           = points[0];
+    float y           = points[1];
+    const float dx    = points[2];
+    const float dy    = points[3];
+    const int w       = (int)iw;
+    const int h       = (int)ih;
+    const float xMaxF = (float)(w - 1);
+    const float yMaxF = (float)(h - 1);
+    const auto minV   = _mm_set1_ps(0.0f);
+    const auto maxV   = _mm_set1_ps(255.0f);
+    for (size_t i = 0; i < count; ++i) {
+        const float cx = std::max(std::min(x, xMaxF), 0.0f);
+        const float cy = std::max(std::min(y, yMaxF), 0.0f);
+        const int x0   = (int)cx;
+        const int y0   = (int)cy;
+        float wx[4], wy[4];
+        MNN::CV::bicubicWeights(cx - x0, wx);
+        MNN::CV::bicubicWeights(cy - y0, wy);
+        int cols[4];
+        for (int k = 0; k < 4; ++k) {
+            cols[k] = 4 * std::max(std::min(x0 - 1 + k, w - 1), 0);
+        }
+        auto sum = _mm_setzero_ps();
+        for (int j = 0; j < 4; ++j) {
+            auto row  = source + std::max(std::min(y0 - 1 + j, h - 1), 0) * yStride;
+            auto line = _mm_mul_ps(_loadPixel(row + cols[0]), _mm_set1_ps(wx[0]));
+            line      = _mm_add_ps(line, _mm_mul_ps(_loadPixel(row + cols[1]), _mm_set1_ps(wx[1])));
+            line      = _mm_add_ps(line, _mm_mul_ps(_loadPixel(row + cols[2]), _mm_set1_ps(wx[2])));
+            line      = _mm_add_ps(line, _mm_mul_ps(_loadPixel(row + cols[3]), _mm_set1_ps(wx[3])));
+            sum       = _mm_add_ps(sum, _mm_mul_ps(line, _mm_set1_ps(wy[j])));
+        }
+        _savePixel(dest + 4 * i, _mm_min_ps(_mm_max_ps(sum, minV), maxV));
+        x += dx;
+        y += dy;
+    }
+}
+
+// sum of whole pixels [x0, x1) of a row, and of pixels partly covered at x0 - 1 and x1
+static inline __m128 _areaLine(const unsigned char* row, int x0, int x1, float wl, float wr) {
+    auto zero = _mm_setzero_si128();
+    auto sum  = _mm_setzero_si128();
+    int sx    = x0;
+    while (sx + 4 <= x1) {
+        // four pixels a time, summed in 16 bits for at most 64 times
+        auto sum16      = _mm_setzero_si128();
+        const int limit = std::min(x1, sx + 4 * 64);
+        for (; sx + 4 <= limit; sx += 4) {
+            auto v = _mm_loadu_si128((const __m128i*)(row + 4 * sx));
+            sum16  = _mm_add_epi16(sum16, _mm_add_epi16(_mm_unpacklo_epi8(v, zero), _mm_unpackhi_epi8(v, zero)));
+        }
+        sum = _mm_add_epi32(sum, _mm_add_epi32(_mm_unpacklo_epi16(sum16, zero), _mm_unpackhi_epi16(sum16, zero)));
+    }
+    for (; sx < x1; ++sx) {
+        int32_t v;
+        ::memcpy(&v, row + 4 * sx, sizeof(int32_t));
+        sum = _mm_add_epi32(sum, _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(v), zero), zero));
+    }
+    auto line = _mm_cvtepi32_ps(sum);
+    if (wl > 0.0f) {
+        line = _mm_add_ps(line, _mm_mul_ps(_loadPixel(row + 4 * (x0 - 1)), _mm_set1_ps(wl)));
+    }
+    if (wr > 0.0f) {
+        line = _mm_add_ps(line, _mm_mul_ps(_loadPixel(row + 4 * x1), _mm_set1_ps(wr)));
+    }
+    return line;
+}
+
+void MNNSamplerC4AreaOpt(const unsigned char* source, unsigned char* dest, float* points, size_t count, size_t iw,
+                         size_t ih, size_t yStride) {
+    const int w       = (int)iw;
+    const int h       = (int)ih;
+    const float boxW  = std::min(std::max(points[4], 1.0f), (float)w);
+    const float boxH  = std::min(std::max(points[5], 1.0f), (float)h);
+    float x           = points[0] + points[6];
+    float y           = points[1] + points[7];
+    const float dx    = points[2];
+    const float dy    = points[3];
+    const auto scaleV = _mm_set1_ps(1.0f / (boxW * boxH));
+    for (size_t i = 0; i < count; ++i) {
+        const float l  = std::max(std::min(x, w - boxW), 0.0f);
+        const float t  = std::max(std::min(y, h - boxH), 0.0f);
+        const float r  = l + boxW;
+        const float b  = t + boxH;
+        const int x0   = (int)ceilf(l);
+        const int y0   = (int)ceilf(t);
+        const int x1   = std::min((int)r, w);
+        const int y1   = std::min((int)b, h);
+        const float wl = x0 - l;
+        const float wr = x1 < w ? r - x1 : 0.0f;
+        const float wt = y0 - t;
+        const float wb = y1 < h ? b - y1 : 0.0f;
+        auto sum       = _mm_setzero_ps();
+        for (int sy = y0; sy < y1; ++sy) {
+            sum = _mm_add_ps(sum, _areaLine(source + sy * yStride, x0, x1, wl, wr));
+        }
+        if (wt > 0.0f) {
+            auto line = _areaLine(source + (y0 - 1) * yStride, x0, x1, wl, wr);
+            sum       = _mm_add_ps(sum, _mm_mul_ps(line, _mm_set1_ps(wt)));
+        }
+        if (wb > 0.0f) {
+            auto line = _areaLine(source + y1 * yStride, x0, x1, wl, wr);
+            sum       = _mm_add_ps(sum, _mm_mul_ps(line, _mm_set1_ps(wb)));
+        }
+        _savePixel(dest + 4 * i, _mm_mul_ps(sum, scaleV));
+        x += dx;
+        y += dy;
+    }
+}
+
+#endif
@@ -66,6 +66,9 @@ ErrorCode MetalGatherV2::onExecute(const std::vector<Tensor *> &inputs, const st
 class MetalGatherV2Creator : public MetalBackend::Creator {
 public:
     virtual Execution *onCreate(const std::vector<Tensor *> &inputs, const MNN::Op *op, Backend *backend) const {
+        if (GatherCombiner_NONE != op->main_as_GatherV2()->combiner()) {
+            return NULL; // embedding bag runs on CPU
+        }
         return new MetalGatherV2(backend, op->main_as_GatherV2()->Tparams());
     }
 };
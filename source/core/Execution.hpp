@@ -63,6 +63,30 @@ public:
      */
     virtual ErrorCode onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) = 0;
 
+    /**
+     * @brief recurrent executions in stateful mode start from state left by last execution rather than zero.
+     *        state is reset to zero when mode changes and on resize.
+     * @param stateful  stateful or not.
+     * @return false if execution keeps no state.
+     */
+    virtual bool onSetStateful(bool stateful) {
+        return false;
+    }
+    /**
+     * @brief reset state to zero.
+     */
+    virtual void onResetState() {
+        // nothing to do
+    }
+    /**
+     * @brief get state tensors used in stateful mode, valid after resize. they could be read or written between
+     *        executions.
+     * @return state tensors, empty if execution keeps no state.
+     */
+    virtual std::vector<Tensor *> onGetState() {
+        return {};
+    }
+
 public:
     /**
      * @brief designed for plugin system. not ready yet.
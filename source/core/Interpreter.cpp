@@ -14,13 +14,44 @@
 #include "AutoStorage.h"
 #include "MNN_generated.h"
 #include "Session.hpp"
+#if !defined(_MSC_VER)
+#include <sys/mman.h>
+#endif
 namespace MNN {
 
 struct Content {
     AutoStorage<uint8_t> buffer;
-    const Net* net = nullptr;
+    /** model file mapped by createFromFileMapped, buffer is left empty in this case */
+    void* mapBuffer = nullptr;
+    size_t mapSize  = 0;
+    bool released   = false;
+    const Net* net  = nullptr;
     std::vector<std::unique_ptr<Session>> sessions;
     std::map<const Tensor*, const Session*> tensorMap;
+
+    ~Content() {
+        // sessions may refer to the net, release them before unmap
+        sessions.clear();
+#if !defined(_MSC_VER)
+        if (nullptr != mapBuffer) {
+            munmap(mapBuffer, mapSize);
+        }
+#endif
+    }
+    const uint8_t* data() const {
+        return nullptr != mapBuffer ? (const uint8_t*)mapBuffer : buffer.get();
+    }
+    size_t size() const {
+        return nullptr != mapBuffer ? mapSize : buffer.size();
+    }
+    /** drop resident pages of mapped model, they are read from file again if touched later */
+    void dropPages() {
+#if !defined(_MSC_VER)
+        if (nullptr != mapBuffer) {
+            madvise(mapBuffer, mapSize, MADV_DONTNEED);
+        }
+#endif
+    }
 };
 
 class FileLoader {
@@ -38,6 +69,35 @@ public:
         }
     }
 
+    /**
+     * @brief read whole file into buffer directly if file size is known, so that model is not held twice while
+     *        loading.
+     * @return false if file size is unknown or read failed.
+     */
+    bool readDirect(AutoStorage<uint8_t>& buffer) {
+        if (0 != fseek(mFile, 0, SEEK_END)) {
+            return false;
+        }
+        auto size = ftell(mFile);
+        if (size <= 0 || 0 != fseek(mFile, 0, SEEK_SET)) {
+            fseek(mFile, 0, SEEK_SET);
+            return false;
+        }
+        buffer.reset((int)size);
+        if (nullptr == buffer.get()) {
+            MNN_PRINT("Memory Alloc Failed\n");
+            return false;
+        }
+        mTotalSize = fread(buffer.get(), 1, size, mFile);
+        if (mTotalSize != (size_t)size) {
+            buffer.release();
+            mTotalSize = 0;
+            fseek(mFile, 0, SEEK_SET);
+            return false;
+        }
+        return true;
+    }
+
     bool read() {
         auto block = MNNMemoryAllocAlign(gCacheSize, MNN_MEMORY_ALIGN_DEFAULT);
         if (nullptr == block) {
@@ -109,22 +169,65 @@ Interpreter* Interpreter::createFromFile(const char* file) {
         MNN_PRINT("Create interpreter failed, open %s error\n", file);
         return nullptr;
     }
-    bool result = loader->read();
-    if (!result) {
-        MNN_PRINT("Read file error\n");
+    auto net = new Content;
+    if (!loader->readDirect(net->buffer)) {
+        bool result = loader->read();
+        if (!result) {
+            MNN_PRINT("Read file error\n");
+            delete net;
+            return nullptr;
+        }
+        if (loader->size() == 0) {
+            MNN_PRINT("Create interpreter failed, %s is empty\n", file);
+            delete net;
+            return nullptr;
+        }
+        bool success = loader->merge(net->buffer);
+        if (!success) {
+            delete net;
+            return nullptr;
+        }
+    }
+    loader.reset();
+    return createFromBufferInternal(net);
+}
+
+Interpreter* Interpreter::createFromFileMapped(const char* file) {
+#if defined(_MSC_VER)
+    return createFromFile(file);
+#else
+    if (nullptr == file) {
+        MNN_PRINT("NULL file for create interpreter");
         return nullptr;
     }
-    if (loader->size() == 0) {
-        MNN_PRINT("Create interpreter failed, %s is empty\n", file);
+    FILE* f = fopen(file, "rb");
+    if (nullptr == f) {
+        MNN_PRINT("Create interpreter failed, open %s error\n", file);
         return nullptr;
     }
-    auto net     = new Content;
-    bool success = loader->merge(net->buffer);
-    if (!success) {
+    fseek(f, 0, SEEK_END);
+    auto size = ftell(f);
+    if (size <= 0) {
+        fclose(f);
+        MNN_PRINT("Create interpreter failed, %s is empty or not seekable\n", file);
         return nullptr;
     }
-    loader.reset();
-    return createFromBufferInternal(net);
+    auto mapBuffer = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileno(f), 0);
+    fclose(f);
+    if (MAP_FAILED == mapBuffer) {
+        MNN_PRINT("Map %s failed, read it into memory instead\n", file);
+        return createFromFile(file);
+    }
+    auto net       = new Content;
+    net->mapBuffer = mapBuffer;
+    net->mapSize   = size;
+    auto result    = createFromBufferInternal(net);
+    if (nullptr != result) {
+        // pages touched by verifier are not needed any more
+        net->dropPages();
+    }
+    return result;
+#endif
 }
 Interpreter* Interpreter::createFromBuffer(const void* buffer, size_t size) {
     if (nullptr == buffer) {
@@ -147,9 +250,10 @@ Interpreter* Interpreter::createFromBufferInternal(Content* net) {
         MNN_PRINT("Buffer is null for create interpreter\n");
         return nullptr;
     }
-    flatbuffers::Verifier verify((const uint8_t*)(net->buffer.get()), net->buffer.size());
+    flatbuffers::Verifier verify(net->data(), net->size());
     if (false == VerifyNetBuffer(verify)) {
         MNN_PRINT("Invalidate buffer to create interpreter\n");
+        delete net;
         return nullptr;
     }
     return new Interpreter(net);
@@ -158,13 +262,29 @@ Interpreter* Interpreter::createFromBufferInternal(Content* net) {
 Interpreter::Interpreter(Content* net) {
     MNN_ASSERT(nullptr != net);
     mNet      = net;
-    mNet->net = GetNet(mNet->buffer.get());
+    mNet->net = GetNet(mNet->data());
 }
 
 Interpreter::~Interpreter() {
     delete mNet;
 }
 
+void Interpreter::_resizeNewSession(Session* session) {
+    if (nullptr == mNet->mapBuffer) {
+        session->resize();
+        return;
+    }
+    // Each weight is transformed into its execution right from the mapped model, drop the consumed pages at once
+    // so that raw weights never stay resident along with transformed ones
+    // embedding tables are paged in from file as rows are looked up rather than copied
+    session->setTablesInModel(true);
+    auto net = mNet;
+    session->setExecutionCreatedCallBack([net]() { net->dropPages(); });
+    session->resize();
+    session->setExecutionCreatedCallBack(nullptr);
+    net->dropPages();
+}
+
 Session* Interpreter::createMultiPathSession(const std::vector<ScheduleConfig>& configs) {
     auto info       = Schedule::schedule(mNet->net, configs);
     auto newSession = std::unique_ptr<Session>(new Session(info));
@@ -173,13 +293,14 @@ Session* Interpreter::createMultiPathSession(const std::vector<ScheduleConfig>&
         return nullptr;
     }
     auto result = newSession.get();
-    result->resize();
+    result->setLazyExecution(configs);
+    _resizeNewSession(result);
     mNet->sessions.emplace_back(std::move(newSession));
     return result;
 }
 
 Session* Interpreter::createSession(const ScheduleConfig& config) {
-    if (nullptr == mNet->buffer.get()) {
+    if (mNet->released) {
         MNN_ERROR("The model buffer has been released. Can't create session\n");
         return nullptr;
     }
@@ -192,8 +313,9 @@ Session* Interpreter::createSession(const ScheduleConfig& config) {
         return nullptr;
     }
     auto result = newSession.get();
+    result->setLazyExecution(std::vector<ScheduleConfig>{config});
 
-    result->resize();
+    _resizeNewSession(result);
 
     mNet->sessions.emplace_back(std::move(newSession));
     return result;
@@ -248,7 +370,7 @@ const std::map<std::string, Tensor*>& Interpreter::getSessionOutputAll(const Ses
 }
 
 void Interpreter::resizeSession(Session* session) {
-    if (mNet->buffer.get() == nullptr) {
+    if (mNet->released) {
         MNN_ERROR("The model buffer has been released. Can't resize session\n");
         return;
     }
@@ -278,12 +400,76 @@ const Backend* Interpreter::getBackend(const Session* session, const Tensor* ten
 }
 
 void Interpreter::releaseModel() {
-    mNet->buffer.release();
+    // mapped model is kept mapped but not resident, so that pointers into ops held by executions keep valid
+    mNet->released  = true;
+    bool keepBuffer = false;
+    for (auto& iter : mNet->sessions) {
+        keepBuffer = keepBuffer || iter->hasLazyExecution();
+    }
+    if (keepBuffer && nullptr != mNet->buffer.get()) {
+        MNN_PRINT("Lazy executions need the model, keep the model buffer\n");
+    } else {
+        mNet->buffer.release();
+    }
+    mNet->dropPages();
     for (auto& iter : mNet->sessions) {
         iter->releaseCache();
     }
 }
 
+bool Interpreter::getSessionInfo(const Session* session, SessionInfoCode code, void* ptr) const {
+    MNN_ASSERT(nullptr != session);
+    if (nullptr == session || nullptr == ptr) {
+        return false;
+    }
+    switch (code) {
+        case MEMORY: {
+            auto info         = (SessionMemoryInfo*)ptr;
+            info->modelBuffer = mNet->buffer.size();
+            session->getMemoryInfo(*info);
+            return true;
+        }
+        case FLOPS:
+            *(float*)ptr = session->flops();
+            return true;
+        default:
+            break;
+    }
+    return false;
+}
+
+void Interpreter::setSessionStateful(Session* session, bool stateful) {
+    MNN_ASSERT(nullptr != session);
+    session->setStateful(stateful);
+}
+
+void Interpreter::resetSessionState(Session* session) {
+    MNN_ASSERT(nullptr != session);
+    session->resetState();
+}
+
+std::vector<Tensor*> Interpreter::getSessionState(const Session* session, const char* name) const {
+    MNN_ASSERT(nullptr != session);
+    return session->getState(name);
+}
+
+bool Interpreter::setSessionState(Session* session, const char* name, const std::vector<Tensor*>& states) {
+    MNN_ASSERT(nullptr != session);
+    auto dst = session->getState(name);
+    if (dst.empty() || dst.size() != states.size()) {
+        return false;
+    }
+    for (int i = 0; i < dst.size(); ++i) {
+        if (nullptr == states[i] || states[i]->elementSize() != dst[i]->elementSize()) {
+            return false;
+        }
+    }
+    for (int i = 0; i < dst.size(); ++i) {
+        dst[i]->copyFromHostTensor(states[i]);
+    }
+    return true;
+}
+
 void Interpreter::resizeTensor(Tensor* tensor, int batch, int channel, int height, int width) {
     if (tensor->getDimensionType() == Tensor::TENSORFLOW) {
         resizeTensor(tensor, {batch, height, width, channel});
@@ -10,6 +10,17 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include "Macro.h"
+#if defined(_MSC_VER)
+#include <Windows.h>
+#define MNN_ATOMIC_ADD(ptr, value) InterlockedExchangeAdd64((volatile LONG64 *)(ptr), (LONG64)(value))
+#else
+#define MNN_ATOMIC_ADD(ptr, value) __sync_fetch_and_add((ptr), (value))
+#endif
+
+// aligned[-1] keeps the origin pointer, aligned[-2] keeps the requested size
+#define MNN_MEMORY_HEADER_SIZE (2 * sizeof(void *))
+
+static volatile int64_t gAllocatedSize = 0;
 
 static inline void **alignPointer(void **ptr, size_t alignment) {
     return (void **)((intptr_t)((unsigned char *)ptr + alignment - 1) & -alignment);
@@ -21,14 +32,16 @@ void *MNNMemoryAllocAlign(size_t size, size_t alignment) {
 #ifdef MNN_DEBUG_MEMORY
     return malloc(size);
 #else
-    void **origin = (void **)malloc(size + sizeof(void *) + alignment);
+    void **origin = (void **)malloc(size + MNN_MEMORY_HEADER_SIZE + alignment);
     MNN_ASSERT(origin != NULL);
     if (!origin) {
         return NULL;
     }
 
-    void **aligned = alignPointer(origin + 1, alignment);
+    void **aligned = alignPointer(origin + 2, alignment);
     aligned[-1]    = origin;
+    aligned[-2]    = (void *)size;
+    MNN_ATOMIC_ADD(&gAllocatedSize, (int64_t)size);
     return aligned;
 #endif
 }
@@ -39,13 +52,15 @@ void *MNNMemoryCallocAlign(size_t size, size_t alignment) {
 #ifdef MNN_DEBUG_MEMORY
     return calloc(size, 1);
 #else
-    void **origin = (void **)calloc(size + sizeof(void *) + alignment, 1);
+    void **origin = (void **)calloc(size + MNN_MEMORY_HEADER_SIZE + alignment, 1);
     MNN_ASSERT(origin != NULL)
     if (!origin) {
         return NULL;
     }
-    void **aligned = alignPointer(origin + 1, alignment);
+    void **aligned = alignPointer(origin + 2, alignment);
     aligned[-1]    = origin;
+    aligned[-2]    = (void *)size;
+    MNN_ATOMIC_ADD(&gAllocatedSize, (int64_t)size);
     return aligned;
 #endif
 }
@@ -56,7 +71,16 @@ void MNNMemoryFreeAlign(void *aligned) {
 #else
     if (aligned) {
         void *origin = ((void **)aligned)[-1];
+        MNN_ATOMIC_ADD(&gAllocatedSize, -(int64_t)(size_t)((void **)aligned)[-2]);
         free(origin);
     }
 #endif
 }
+
+size_t MNNMemoryAllocatedSize(void) {
+#ifdef MNN_DEBUG_MEMORY
+    return 0;
+#else
+    return (size_t)MNN_ATOMIC_ADD(&gAllocatedSize, 0);
+#endif
+}
@@ -47,6 +47,12 @@ void* MNNMemoryCallocAlign(size_t size, size_t align);
  */
 void MNNMemoryFreeAlign(void* mem);
 
+/**
+ * @brief get size of memory allocated by `MNNMemoryAllocAlign` or `MNNMemoryCallocAlign` and not freed yet.
+ * @return allocated size in bytes, shared by all threads. always 0 if MNN_DEBUG_MEMORY is defined.
+ */
+size_t MNNMemoryAllocatedSize(void);
+
 #ifdef __cplusplus
 }
 #endif
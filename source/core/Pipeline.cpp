@@ -7,7 +7,10 @@
 //
 
 #include "Pipeline.hpp"
+#include <algorithm>
+#include <set>
 #include "Backend.hpp"
+#include "MNNMemoryUtils.h"
 #include "Macro.h"
 #include "SizeComputer.hpp"
 #include "TensorUtils.hpp"
@@ -74,6 +77,143 @@ bool Pipeline::Unit::_allocTensors(Backend* bn, const std::vector<Tensor*>& tens
     return true;
 }
 
+// byte offsets of concat inputs in its output if they lie there one after another, empty otherwise
+static std::vector<int> _concatOffsets(const Op* op, const std::vector<Tensor*>& inputs, const Tensor* output) {
+    if (nullptr == op->main_as_Axis() || output->dimensions() < 1) {
+        return {};
+    }
+    int axis = op->main_as_Axis()->axis();
+    if (axis < 0) {
+        axis += output->dimensions();
+    }
+    // nothing outside the axis, and channels of NC4HW4 whole quads but the last input's
+    for (int i = 0; i < axis; ++i) {
+        if (1 != output->length(i)) {
+            return {};
+        }
+    }
+    const bool c4 = output->dimensions() > 1 && output->buffer().dim[1].flags == Tensor::REORDER_4;
+    auto format   = TensorUtils::getDescribe(output)->dimensionFormat;
+    if (c4 && axis > 1) {
+        return {};
+    }
+    std::vector<int> offsets;
+    int offset = 0;
+    for (int i = 0; i < inputs.size(); ++i) {
+        auto t = inputs[i];
+        if (t->dimensions() != output->dimensions() || !(t->getType() == output->getType()) ||
+            TensorUtils::getDescribe(t)->dimensionFormat != format ||
+            c4 != (t->buffer().dim[1].flags == Tensor::REORDER_4)) {
+            return {};
+        }
+        if (c4 && 1 == axis && i + 1 < inputs.size() && t->length(1) % 4 != 0) {
+            return {};
+        }
+        // keep the alignment of allocator for SIMD of producers
+        if (offset % MNN_MEMORY_ALIGN_DEFAULT != 0) {
+            return {};
+        }
+        offsets.emplace_back(offset);
+        offset += t->size();
+    }
+    if (offset != output->size()) {
+        return {};
+    }
+    return offsets;
+}
+
+bool Pipeline::Unit::_allocOutputs(Backend* bn) {
+    for (int i = 0; i < mOutputViews.size(); ++i) {
+        auto plan = mOutputViews[i].first;
+        auto t    = mOutputs[i];
+        auto des  = TensorUtils::getDescribe(t);
+        if (nullptr == plan || nullptr != des->backend || des->isConst || bn != plan->backend) {
+            continue;
+        }
+        auto offset = plan->offsets[mOutputViews[i].second];
+        if (offset + t->size() > plan->size) {
+            continue;
+        }
+        if (nullptr == plan->buffer->host<uint8_t>()) {
+            if (!bn->onAcquireBuffer(plan->buffer.get(), Backend::DYNAMIC)) {
+                return false;
+            }
+        }
+        des->backend = bn;
+        des->isView  = true;
+        TensorUtils::setLinearLayout(t);
+        t->buffer().host = plan->buffer->host<uint8_t>() + offset;
+    }
+    return _allocTensors(bn, mOutputs);
+}
+
+bool Pipeline::Unit::_placeConcat(Backend* bn) {
+    auto plan   = mConcatPlan.get();
+    auto output = mOutputs[0];
+    auto host   = plan->buffer->host<uint8_t>();
+    if (nullptr == host || bn != plan->backend || TensorUtils::getDescribe(output)->isConst) {
+        return false;
+    }
+    // shapes may differ from those planned with, then inputs placed are copied
+    if (output->size() != plan->size || _concatOffsets(mOriginOp, mInputs, output) != plan->offsets) {
+        return false;
+    }
+    for (int i = 0; i < mInputs.size(); ++i) {
+        auto t = mInputs[i];
+        if (!TensorUtils::getDescribe(t)->isView || t->host<uint8_t>() != host + plan->offsets[i]) {
+            return false;
+        }
+    }
+    auto des     = TensorUtils::getDescribe(output);
+    des->backend = bn;
+    TensorUtils::setLinearLayout(output);
+    output->buffer().host = host;
+    return true;
+}
+
+bool Pipeline::Unit::_placeInModel(Backend* bn) {
+    auto output = mOutputs[0];
+    auto des    = TensorUtils::getDescribe(output);
+    auto blob   = mOriginOp->main_as_Blob();
+    if (nullptr == blob || nullptr != des->backend ||
+        (output->dimensions() > 1 && output->buffer().dim[1].flags == Tensor::REORDER_4)) {
+        return false;
+    }
+    const uint8_t* data = nullptr;
+    int size            = 0;
+    switch (blob->dataType()) {
+        case DataType_DT_FLOAT:
+            if (nullptr != blob->float32s()) {
+                data = (const uint8_t*)blob->float32s()->Data();
+                size = blob->float32s()->size() * sizeof(float);
+            }
+            break;
+        case DataType_DT_INT32:
+            if (nullptr != blob->int32s()) {
+                data = (const uint8_t*)blob->int32s()->Data();
+                size = blob->int32s()->size() * sizeof(int32_t);
+            }
+            break;
+        case DataType_DT_QUINT8:
+        case DataType_DT_UINT8:
+            if (nullptr != blob->uint8s()) {
+                data = blob->uint8s()->Data();
+                size = blob->uint8s()->size();
+            }
+            break;
+        default:
+            break;
+    }
+    if (nullptr == data || size != output->size()) {
+        return false;
+    }
+    des->backend = bn;
+    des->isView  = true;
+    TensorUtils::setLinearLayout(output);
+    output->buffer().host = (uint8_t*)data;
+    return true;
+}
+
 Pipeline::Unit::Unit(const Op* op, const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
     MNN_ASSERT(nullptr != op);
     mOriginOp = op;
@@ -109,7 +249,13 @@ static bool _OpNeedContent(OpType type, int index) {
     return true;
 }
 
+static size_t _memoryIncrease(size_t before) {
+    auto after = MNNMemoryAllocatedSize();
+    return after > before ? after - before : 0;
+}
+
 bool Pipeline::Unit::_createExecution(Backend* bn, Backend* cpuBn) {
+    auto memoryBefore = MNNMemoryAllocatedSize();
     mExecution.reset(bn->onCreate(mInputs, mOutputs, mOriginOp));
     if (nullptr == mExecution) {
         mExecution.reset(cpuBn->onCreate(mInputs, mOutputs, mOriginOp));
@@ -123,7 +269,8 @@ bool Pipeline::Unit::_createExecution(Backend* bn, Backend* cpuBn) {
     for (int i = 0; i < mInputs.size(); ++i) {
         auto t   = mInputs[i];
         auto des = TensorUtils::getDescribe(t);
-        if (des->backend != executionBackend && _OpNeedContent(mOriginOp->type(), i)) {
+        // backends of same type share memory, e.g. the one used to create lazy execution
+        if (des->backend->type() != executionBackend->type() && _OpNeedContent(mOriginOp->type(), i)) {
             needWrap = true;
         }
     }
@@ -132,14 +279,40 @@ bool Pipeline::Unit::_createExecution(Backend* bn, Backend* cpuBn) {
         auto tempExecution = mExecution;
         mExecution.reset(new WrapExecution(cpuBn, tempExecution));
     }
+    if (mStateful) {
+        mExecution->onSetStateful(true);
+    }
+    mWeightSize = _memoryIncrease(memoryBefore);
     return true;
 }
 
+ErrorCode Pipeline::Unit::_createLazyExecution() {
+    auto success = _createExecution(mLazyBackend, mLazyBackend);
+    if (!success || nullptr == mExecution) {
+        MNN_ERROR("Create execution error for %s\n", mContent->name.c_str());
+        return NOT_SUPPORT;
+    }
+    auto memoryBefore = MNNMemoryAllocatedSize();
+    auto code         = mExecution->onResize(mInputs, mOutputs);
+    mScratchSize      = _memoryIncrease(memoryBefore);
+    if (NO_ERROR != code) {
+        MNN_ERROR("Resize error for %s, code=%d\n", mContent->name.c_str(), code);
+        mExecution.reset();
+    }
+    return code;
+}
+
 ErrorCode Pipeline::Unit::execute() {
+    if (nullptr == mExecution && nullptr != mLazyBackend) {
+        auto code = _createLazyExecution();
+        if (NO_ERROR != code) {
+            return code;
+        }
+    }
     if (nullptr == mExecution) {
         return NO_EXECUTION;
     }
-    if (mConst) {
+    if (mConst || mInplace) {
         return NO_ERROR;
     }
     auto code = mExecution->onExecute(mInputs, mOutputs);
@@ -149,14 +322,20 @@ ErrorCode Pipeline::Unit::execute() {
     return code;
 }
 ErrorCode Pipeline::Unit::executeCallBack(const TensorCallBackWithInfo& before, const TensorCallBackWithInfo& after) {
-    if (nullptr == mExecution) {
+    if (nullptr == mExecution && nullptr == mLazyBackend) {
         return NO_EXECUTION;
     }
     if (mConst) {
         return NO_ERROR;
     }
     auto run = before(mInputs, this);
-    if (run) {
+    if (run && !mInplace) {
+        if (nullptr == mExecution) {
+            auto code = _createLazyExecution();
+            if (NO_ERROR != code) {
+                return code;
+            }
+        }
         auto code = mExecution->onExecute(mInputs, mOutputs);
         if (NO_ERROR != code) {
             MNN_ERROR("Execute Error for %s, code=%d\n", mContent->name.c_str(), code);
@@ -170,6 +349,16 @@ ErrorCode Pipeline::Unit::executeCallBack(const TensorCallBackWithInfo& before,
     return NO_ERROR;
 }
 
+static void _releaseInputs(const std::vector<Tensor*>& inputs) {
+    for (auto t : inputs) {
+        auto des = TensorUtils::getDescribe(t);
+        des->useCount -= 1;
+        if (0 == des->useCount && !des->isView) {
+            des->backend->onReleaseBuffer(t, _getTensorReleaseStorageType(t));
+        }
+    }
+}
+
 static bool _checkAllConst(const std::vector<Tensor*>& tensors) {
     for (auto tensor : tensors) {
         if (!(TensorUtils::getDescribe(tensor)->isConst)) {
@@ -178,7 +367,7 @@ static bool _checkAllConst(const std::vector<Tensor*>& tensors) {
     }
     return true;
 }
-ErrorCode Pipeline::Unit::prepare(Backend* bn, Backend* cpuBn) {
+ErrorCode Pipeline::Unit::prepare(Backend* bn, Backend* cpuBn, Backend* lazy) {
     for (auto t : mInputs) {
         bool valid = true;
         for (int i = 0; i < t->dimensions(); ++i) {
@@ -248,6 +437,24 @@ ErrorCode Pipeline::Unit::prepare(Backend* bn, Backend* cpuBn) {
         }
         bn = cpuBn;
     }
+    if (nullptr != mLazyBackend) {
+        // created lazily in last prepare, its buffers are not planned with others
+        mExecution.reset();
+        mLazyBackend = nullptr;
+    }
+    if (nullptr != lazy && !mConst) {
+        // Execution is created on first execution, only outputs are allocated here
+        mExecution.reset();
+        mWeightSize  = 0;
+        mScratchSize = 0;
+        mLazyBackend = lazy;
+        auto success = _allocOutputs(bn);
+        if (!success) {
+            return OUT_OF_MEMORY;
+        }
+        _releaseInputs(mInputs);
+        return NO_ERROR;
+    }
 
     // Create or Resize execution
     if (nullptr == mExecution) {
@@ -256,30 +463,41 @@ ErrorCode Pipeline::Unit::prepare(Backend* bn, Backend* cpuBn) {
             return NOT_SUPPORT;
         }
     }
-    bn = mExecution->backend();
+    bn       = mExecution->backend();
+    mInplace = nullptr != mConcatPlan && _placeConcat(bn);
+    if (mInModel) {
+        _placeInModel(bn);
+    }
     {
-        auto success = _allocTensors(bn, mOutputs);
+        auto success = _allocOutputs(bn);
         if (!success) {
             return OUT_OF_MEMORY;
         }
     }
-    auto code = mExecution->onResize(mInputs, mOutputs);
+    auto memoryBefore = MNNMemoryAllocatedSize();
+    auto code         = mExecution->onResize(mInputs, mOutputs);
     if (TENSOR_NOT_SUPPORT == code || TENSOR_NEED_DIVIDE == code) {
         // TODO
         mExecution.reset();
         for (auto t : mOutputs) {
             auto des = TensorUtils::getDescribe(t);
-            des->backend->onReleaseBuffer(t, _getTensorReleaseStorageType(t));
+            if (!des->isView) {
+                des->backend->onReleaseBuffer(t, _getTensorReleaseStorageType(t));
+            }
             des->backend = nullptr;
+            des->isView  = false;
         }
         auto sucess = _createExecution(cpuBn, cpuBn);
         MNN_ASSERT(NO_ERROR == sucess);
-        auto success = _allocTensors(mExecution->backend(), mOutputs);
+        mInplace     = nullptr != mConcatPlan && _placeConcat(mExecution->backend());
+        auto success = _allocOutputs(mExecution->backend());
         if (!success) {
             return OUT_OF_MEMORY;
         }
-        code = mExecution->onResize(mInputs, mOutputs);
+        memoryBefore = MNNMemoryAllocatedSize();
+        code         = mExecution->onResize(mInputs, mOutputs);
     }
+    mScratchSize = _memoryIncrease(memoryBefore);
     if (NO_ERROR != code) {
         return code;
     }
@@ -287,12 +505,10 @@ ErrorCode Pipeline::Unit::prepare(Backend* bn, Backend* cpuBn) {
         code = mExecution->onExecute(mInputs, mOutputs);
     }
 
-    for (auto t : mInputs) {
-        auto des = TensorUtils::getDescribe(t);
-        des->useCount -= 1;
-        if (0 == des->useCount) {
-            des->backend->onReleaseBuffer(t, _getTensorReleaseStorageType(t));
-        }
+    _releaseInputs(mInputs);
+    if (nullptr != mConcatPlan && !mInplace && nullptr != mConcatPlan->buffer->host<uint8_t>()) {
+        // inputs placed in the plan are copied to output allocated alone
+        mConcatPlan->backend->onReleaseBuffer(mConcatPlan->buffer.get(), Backend::DYNAMIC);
     }
     return code;
 }
@@ -309,10 +525,82 @@ Pipeline::Pipeline(const std::vector<Schedule::PipelineInfo>& infos, Backend* ba
     }
 }
 
-ErrorCode Pipeline::prepare() {
+void Pipeline::setLazy(Backend* backend, size_t budget) {
+    mLazyBackend = backend;
+    mLazyBudget  = budget;
+}
+
+void Pipeline::releaseLazy() {
+    for (auto& u : mUnits) {
+        if (nullptr != u->mLazyBackend && nullptr != u->mExecution) {
+            u->mExecution.reset();
+            u->mWeightSize  = 0;
+            u->mScratchSize = 0;
+        }
+    }
+    mLazyWeight = 0;
+}
+
+void Pipeline::setStateful(bool stateful) {
+    for (auto& u : mUnits) {
+        u->mStateful = stateful;
+        if (nullptr != u->mExecution) {
+            u->mExecution->onSetStateful(stateful);
+        }
+    }
+}
+
+void Pipeline::resetState() {
+    for (auto& u : mUnits) {
+        if (nullptr != u->mExecution) {
+            u->mExecution->onResetState();
+        }
+    }
+}
+
+std::vector<Tensor*> Pipeline::getState(const std::string& name) const {
+    for (auto& u : mUnits) {
+        if (u->name() == name && nullptr != u->mExecution) {
+            return u->mExecution->onGetState();
+        }
+    }
+    return {};
+}
+
+ErrorCode Pipeline::prepare(const std::function<void()>& created) {
     mBackend->onResizeBegin();
+    Backend* lazy = nullptr;
+    if (nullptr != mLazyBackend && MNN_FORWARD_CPU == mBackend->type()) {
+        lazy = mLazyBackend;
+    }
+    mLazyWeight = 0;
+    mConcatInputUses.clear();
+    // tables of gathers, read by nothing else
+    std::set<const Tensor*> tables, others;
+    for (auto& u : mUnits) {
+        for (int i = 0; i < u->mInputs.size(); ++i) {
+            (OpType_GatherV2 == u->mType && 0 == i ? tables : others).insert(u->mInputs[i]);
+        }
+    }
+    for (auto& u : mUnits) {
+        u->mInModel = mTablesInModel && OpType_Const == u->mType && 1 == u->mOutputs.size() &&
+                      tables.count(u->mOutputs[0]) > 0 && 0 == others.count(u->mOutputs[0]);
+        if (OpType_Concat == u->mType) {
+            for (auto t : u->mInputs) {
+                mConcatInputUses[t] = TensorUtils::getDescribe(t)->useCount;
+            }
+        }
+        if (nullptr != u->mConcatPlan) {
+            // memory of last prepare is cleared
+            u->mConcatPlan->buffer->buffer().host = nullptr;
+        }
+    }
     for (auto& u : mUnits) {
-        auto code = u->prepare(mBackend, mBackupBackend);
+        bool needCreate = nullptr == u->mExecution;
+        auto code       = u->prepare(mBackend, mBackupBackend, lazy);
+        if (needCreate && nullptr != u->mExecution && nullptr != created) {
+            created();
+        }
         if (NO_ERROR != code) {
             if (nullptr != u->mOriginOp->name()) {
                 MNN_ERROR("Resize error for %s, code=%d\n", u->mOriginOp->name()->c_str(), code);
@@ -324,14 +612,131 @@ ErrorCode Pipeline::prepare() {
     return NO_ERROR;
 }
 
+bool Pipeline::planConcat() {
+    std::map<const Tensor*, Unit*> producers;
+    for (auto& u : mUnits) {
+        for (auto t : u->mOutputs) {
+            producers[t] = u.get();
+        }
+    }
+    bool changed = false;
+    for (auto& u : mUnits) {
+        std::shared_ptr<ConcatPlan> plan;
+        do {
+            if (OpType_Concat != u->mType || MNN_FORWARD_CPU != mBackend->type() || nullptr != mLazyBackend ||
+                nullptr == u->mExecution || 1 != u->mOutputs.size()) {
+                break;
+            }
+            auto output = u->mOutputs[0];
+            auto des    = TensorUtils::getDescribe(output);
+            if (des->isConst || des->backend != mBackend) {
+                break;
+            }
+            auto offsets = _concatOffsets(u->mOriginOp, u->mInputs, output);
+            if (offsets.empty()) {
+                break;
+            }
+            // every input is written by an execution of this pipeline for this concat only
+            bool valid = true;
+            for (int i = 0; i < u->mInputs.size() && valid; ++i) {
+                auto t        = u->mInputs[i];
+                auto inputDes = TensorUtils::getDescribe(t);
+                auto producer = producers.find(t);
+                valid         = producer != producers.end() && OpType_Concat != producer->second->mType &&
+                        nullptr != producer->second->mExecution && 1 == mConcatInputUses[t] && !inputDes->isConst &&
+                        !inputDes->isInput && Tensor::HANDLE_NONE == inputDes->handleType &&
+                        inputDes->backend == mBackend;
+            }
+            if (!valid) {
+                break;
+            }
+            plan.reset(new ConcatPlan);
+            plan->offsets = std::move(offsets);
+            plan->size    = output->size();
+            plan->backend = mBackend;
+            plan->buffer.reset(Tensor::createDevice<uint8_t>({plan->size}));
+        } while (false);
+
+        auto& old = u->mConcatPlan;
+        if (nullptr == plan && nullptr == old) {
+            continue;
+        }
+        if (nullptr != plan && nullptr != old && plan->offsets == old->offsets && plan->size == old->size &&
+            plan->backend == old->backend) {
+            continue;
+        }
+        changed = true;
+        old     = plan;
+    }
+    if (!changed) {
+        return false;
+    }
+    for (auto& u : mUnits) {
+        u->mOutputViews.clear();
+    }
+    for (auto& u : mUnits) {
+        if (nullptr == u->mConcatPlan) {
+            continue;
+        }
+        for (int i = 0; i < u->mInputs.size(); ++i) {
+            auto producer = producers[u->mInputs[i]];
+            auto& views   = producer->mOutputViews;
+            views.resize(producer->mOutputs.size(), std::make_pair(nullptr, 0));
+            for (int j = 0; j < producer->mOutputs.size(); ++j) {
+                if (producer->mOutputs[j] == u->mInputs[i]) {
+                    views[j] = std::make_pair(u->mConcatPlan.get(), i);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void Pipeline::_updateLazy(Unit* unit, bool created) {
+    unit->mLastExecute = ++mExecuteCount;
+    if (!created || nullptr == unit->mExecution) {
+        return;
+    }
+    mLazyWeight += unit->mWeightSize;
+    if (0 == mLazyBudget) {
+        return;
+    }
+    // evict least recently executed ones, except the one just created
+    while (mLazyWeight > mLazyBudget) {
+        Unit* oldest = nullptr;
+        for (auto& u : mUnits) {
+            // state would be lost with execution
+            if (nullptr == u->mLazyBackend || nullptr == u->mExecution || u.get() == unit ||
+                (u->mStateful && !u->mExecution->onGetState().empty())) {
+                continue;
+            }
+            if (nullptr == oldest || u->mLastExecute < oldest->mLastExecute) {
+                oldest = u.get();
+            }
+        }
+        if (nullptr == oldest) {
+            break;
+        }
+        mLazyWeight -= std::min(mLazyWeight, oldest->mWeightSize);
+        oldest->mExecution.reset();
+        oldest->mWeightSize  = 0;
+        oldest->mScratchSize = 0;
+    }
+}
+
 ErrorCode Pipeline::execute() {
     mBackend->onExecuteBegin();
     for (auto& u : mUnits) {
-        auto code = u->execute();
+        bool lazy    = nullptr != u->mLazyBackend;
+        bool created = lazy && nullptr == u->mExecution;
+        auto code    = u->execute();
         if (code != NO_ERROR) {
             mBackend->onExecuteEnd();
             return code;
         }
+        if (lazy) {
+            _updateLazy(u.get(), created);
+        }
     }
     mBackend->onExecuteEnd();
     return NO_ERROR;
@@ -341,7 +746,12 @@ ErrorCode Pipeline::executeCallBack(const TensorCallBackWithInfo& before, const
     mBackend->onExecuteBegin();
     std::shared_ptr<char> __defer(nullptr, [this](void*) { mBackend->onExecuteEnd(); });
     for (auto& u : mUnits) {
-        auto code = u->executeCallBack(before, after);
+        bool lazy    = nullptr != u->mLazyBackend;
+        bool created = lazy && nullptr == u->mExecution;
+        auto code    = u->executeCallBack(before, after);
+        if (lazy && nullptr != u->mExecution) {
+            _updateLazy(u.get(), created);
+        }
         if (code != NO_ERROR) {
             return code;
         }
@@ -352,7 +762,13 @@ ErrorCode Pipeline::executeCallBack(const TensorCallBackWithInfo& before, const
 ErrorCode Pipeline::releaseCache() {
     for (auto& u : mUnits) {
         if (nullptr != u->mExecution) {
-            auto code = u->mExecution->onReleaseCache();
+            auto memoryBefore = MNNMemoryAllocatedSize();
+            auto code         = u->mExecution->onReleaseCache();
+            auto memoryAfter  = MNNMemoryAllocatedSize();
+            if (memoryAfter < memoryBefore) {
+                auto released   = memoryBefore - memoryAfter;
+                u->mScratchSize = u->mScratchSize > released ? u->mScratchSize - released : 0;
+            }
             if (NO_ERROR != code) {
                 MNN_ERROR("Error for release cache for %s\n", u->name().c_str());
                 return code;
@@ -362,4 +778,24 @@ ErrorCode Pipeline::releaseCache() {
     return NO_ERROR;
 }
 
+void Pipeline::getMemoryInfo(std::vector<SessionMemoryInfo::OpMemory>& ops) const {
+    for (auto& u : mUnits) {
+        SessionMemoryInfo::OpMemory op;
+        op.name    = u->name();
+        op.type    = u->type();
+        op.weight  = u->mWeightSize;
+        op.scratch = u->mScratchSize;
+        op.lazy    = nullptr != u->mLazyBackend;
+        ops.emplace_back(std::move(op));
+    }
+}
+
+float Pipeline::flops() const {
+    float sum = 0.0f;
+    for (auto& u : mUnits) {
+        sum += u->flops();
+    }
+    return sum;
+}
+
 } // namespace MNN
@@ -33,9 +33,10 @@ public:
 public:
     /**
      * @brief prepare all units.
+     * @param created   callback after any unit creates its execution, may be null.
      * @return result code.
      */
-    ErrorCode prepare();
+    ErrorCode prepare(const std::function<void()>& created = nullptr);
     /**
      * @brief execute all units.
      * @return result code.
@@ -53,6 +54,73 @@ public:
      * @return errorcode
      */
     ErrorCode releaseCache();
+    /**
+     * @brief append memory attributed to each unit.
+     * @param ops   output op memory list.
+     */
+    void getMemoryInfo(std::vector<SessionMemoryInfo::OpMemory>& ops) const;
+    /**
+     * @brief get sum of flops of all units.
+     * @return flops in M.
+     */
+    float flops() const;
+    /**
+     * @brief create executions on their first execution rather than in prepare. executions created so are evicted in
+     *        least recently used order once their weights exceed budget. takes effect on next prepare, and only if
+     *        major backend is CPU.
+     * @param backend   CPU backend used to create lazy executions, separated from major so that their buffers never
+     *                  share memory planned in prepare. NULL to disable.
+     * @param budget    memory budget of weights of lazy executions in bytes, 0 for unlimited.
+     */
+    void setLazy(Backend* backend, size_t budget);
+    /**
+     * @brief release all lazily created executions, they are created again on next execution.
+     */
+    void releaseLazy();
+    /**
+     * @brief keep state of recurrent executions between executions, see Execution::onSetStateful.
+     * @param stateful  stateful or not.
+     */
+    void setStateful(bool stateful);
+    /**
+     * @brief reset state of all recurrent executions to zero.
+     */
+    void resetState();
+    /**
+     * @brief get state tensors of given op.
+     * @param name  op name.
+     * @return state tensors, empty if op is not found, has no state or is not created yet.
+     */
+    std::vector<Tensor*> getState(const std::string& name) const;
+
+    /**
+     * @brief plan concats whose inputs can be placed one after another in their output, so that producers write
+     *        there and concat copies nothing. made of shapes of last prepare and applied on next one, a concat whose
+     *        shapes no longer match its plan copies as usual. only for CPU and without lazy execution.
+     * @return whether plans changed.
+     */
+    bool planConcat();
+    /**
+     * @brief leave const tensors read only as params of gathers in model rather than copying them, so that large
+     *        embedding tables of a mapped model are paged in from file as rows are looked up. takes effect on next
+     *        prepare.
+     * @param inModel   leave them in model or not.
+     */
+    void setTablesInModel(bool inModel) {
+        mTablesInModel = inModel;
+    }
+
+    /** output memory of a concat shared with its inputs */
+    struct ConcatPlan {
+        /** offset of each input in output, in bytes */
+        std::vector<int> offsets;
+        /** size of output in bytes */
+        int size = 0;
+        /** backend of output and inputs */
+        Backend* backend = nullptr;
+        /** memory of output, acquired once first input is allocated */
+        std::shared_ptr<Tensor> buffer;
+    };
 
     /** op unit in pipeline */
     class Unit : public NonCopyable, public OperatorInfo {
@@ -69,7 +137,7 @@ public:
          * @brief prepare unit.
          * @return result code.
          */
-        ErrorCode prepare(Backend* major, Backend* backup);
+        ErrorCode prepare(Backend* major, Backend* backup, Backend* lazy = nullptr);
         /**
          * @brief execute unit.
          * @return result code.
@@ -94,13 +162,34 @@ public:
         std::vector<Tensor*> mOutputs;
         /** op */
         const Op* mOriginOp;
+        /** memory allocated while creating execution, in bytes */
+        size_t mWeightSize = 0;
+        /** memory newly acquired while resizing execution, in bytes */
+        size_t mScratchSize = 0;
+        /** backend to create execution on first execution, NULL if execution is created in prepare */
+        Backend* mLazyBackend = nullptr;
+        /** sequence number of last execution, used to evict lazy execution */
+        int64_t mLastExecute = 0;
+        /** whether execution keeps state between executions */
+        bool mStateful = false;
+        /** plan of concat, null if it copies its inputs */
+        std::shared_ptr<ConcatPlan> mConcatPlan;
+        /** plan and input index of concat for outputs placed in one, empty or null if allocated alone */
+        std::vector<std::pair<ConcatPlan*, int>> mOutputViews;
+        /** whether output of const is left in model */
+        bool mInModel = false;
 
     private:
         bool _createExecution(Backend* bn, Backend* cpuBn);
+        ErrorCode _createLazyExecution();
         bool _allocTensors(Backend* bn, const std::vector<Tensor*>& tensors);
+        bool _allocOutputs(Backend* bn);
+        bool _placeConcat(Backend* bn);
+        bool _placeInModel(Backend* bn);
 
     private:
         bool mConst                   = false;
+        bool mInplace                 = false;
         const SizeComputer* mComputer = nullptr;
     };
 
@@ -111,9 +200,18 @@ protected:
     }
 
 private:
+    void _updateLazy(Unit* unit, bool created);
+
     Backend* mBackend;
     Backend* mBackupBackend;
     std::vector<std::shared_ptr<Unit>> mUnits;
+    Backend* mLazyBackend = nullptr;
+    size_t mLazyBudget    = 0;
+    size_t mLazyWeight    = 0;
+    int64_t mExecuteCount = 0;
+    // use count of concat inputs as prepare begins
+    std::map<const Tensor*, int> mConcatInputUses;
+    bool mTablesInModel = false;
 };
 } // namespace MNN
 
@@ -273,6 +273,56 @@ static vector<Schedule::PipelineInfo> _scheduleUnit(const Net* net, const Schedu
     return oplists;
 }
 
+// input channels of convolution, 0 if unknown
+static int _inputChannel(const Convolution2D* conv) {
+    auto common = conv->common();
+    if (nullptr != conv->weight() && conv->weight()->size() > 0) {
+        return conv->weight()->size() / std::max(1, common->outputCount() * common->kernelX() * common->kernelY());
+    }
+    return common->inputCount();
+}
+
+// keep image inputs uint8 if they are read by CPU convolutions only, which fold their normalization
+static void _setUpImageInputs(Schedule::ScheduleInfo& schedule, const std::vector<ScheduleConfig>& configs) {
+    for (auto& config : configs) {
+        for (auto& image : config.imageInputs) {
+            Tensor* tensor = nullptr;
+            if (image.name.empty() && 1 == schedule.inputTensors.size()) {
+                tensor = schedule.inputTensors.begin()->second;
+            } else if (schedule.inputTensors.find(image.name) != schedule.inputTensors.end()) {
+                tensor = schedule.inputTensors[image.name];
+            }
+            if (nullptr == tensor) {
+                MNN_ERROR("Can't find image input %s\n", image.name.c_str());
+                continue;
+            }
+            auto describe = TensorUtils::getDescribe(tensor);
+            bool valid    = MNN_DATA_FORMAT_NC4HW4 == describe->dimensionFormat &&
+                         tensor->getType() == halide_type_of<float>() && describe->imageNormal.empty();
+            for (auto& pipeline : schedule.pipelineInfo) {
+                for (auto& info : pipeline.second) {
+                    if (std::find(info.inputs.begin(), info.inputs.end(), tensor) == info.inputs.end()) {
+                        continue;
+                    }
+                    auto conv = OpType_Convolution == info.op->type() ? info.op->main_as_Convolution2D() : nullptr;
+                    valid     = valid && MNN_FORWARD_CPU == pipeline.first.type && nullptr != conv &&
+                            1 == conv->common()->group() && 1 == info.inputs.size() && _inputChannel(conv) > 0 &&
+                            _inputChannel(conv) <= 4;
+                }
+            }
+            if (!valid) {
+                MNN_ERROR("Image input %s is read by other than CPU convolutions of at most 4 channels, "
+                          "keep it float\n",
+                          image.name.c_str());
+                continue;
+            }
+            tensor->setType(DataType_DT_UINT8);
+            describe->imageMean.assign(image.mean, image.mean + 4);
+            describe->imageNormal.assign(image.normal, image.normal + 4);
+        }
+    }
+}
+
 Schedule::ScheduleInfo Schedule::schedule(const Net* net, const std::vector<ScheduleConfig>& configs) {
     std::vector<std::shared_ptr<Tensor>> allTensors;
     AUTOTIME;
@@ -365,6 +415,8 @@ Schedule::ScheduleInfo Schedule::schedule(const Net* net, const std::vector<Sche
             std::make_pair(net->tensorName()->GetAsString(index)->c_str(), allTensors[index].get()));
     }
 
+    _setUpImageInputs(schedule, configs);
+
     for (auto& t : allTensors) {
         schedule.allTensors.emplace_back(std::make_pair(0, std::move(t)));
     }
@@ -15,6 +15,7 @@
 #include "BackendFactory.hpp"
 #include "CPUBackend.hpp"
 #include "CommonOptFunction.h"
+#include "MNNMemoryUtils.h"
 #include "MNN_generated.h"
 #include "TensorUtils.hpp"
 #include "WrapExecution.hpp"
@@ -103,17 +104,72 @@ void Session::_clearCache() {
         TensorUtils::clearHandleData(t.second.get());
         describe->useCount = t.first;
         describe->backend  = nullptr;
+        describe->isView   = false;
     }
 }
 
-ErrorCode Session::resize() {
-    _clearCache();
-    for (auto& b : mBackends) {
-        b.second->onClearBuffer();
+static void _updateMemorySize(size_t& size, size_t before) {
+    auto after = MNNMemoryAllocatedSize();
+    if (after >= before) {
+        size += after - before;
+    } else {
+        size = size > before - after ? size - (before - after) : 0;
     }
+}
 
+void Session::setLazyExecution(const std::vector<ScheduleConfig>& configs) {
+    MNN_ASSERT(configs.size() == mPipelines.size());
+    for (int i = 0; i < configs.size() && i < mPipelines.size(); ++i) {
+        auto& config = configs[i];
+        if (!config.lazyExecution) {
+            mPipelines[i]->setLazy(nullptr, 0);
+            continue;
+        }
+        if (nullptr == mLazyBackend) {
+            Backend::Info info;
+            info.type      = MNN_FORWARD_CPU;
+            info.numThread = config.numThread;
+            info.user      = config.backendConfig;
+            mLazyBackend.reset(BackendFactory::create(info));
+        }
+        mPipelines[i]->setLazy(mLazyBackend.get(), config.lazyMemoryBudget);
+    }
+}
+
+ErrorCode Session::resize() {
+    // lazy executions are not counted in mMemorySize
     for (auto& iter : mPipelines) {
-        auto error = iter->prepare();
+        iter->releaseLazy();
+    }
+    if (nullptr != mLazyBackend) {
+        mLazyBackend->onClearBuffer();
+    }
+    auto memoryBefore = MNNMemoryAllocatedSize();
+    std::shared_ptr<char> __defer(nullptr, [this, memoryBefore](void*) { _updateMemorySize(mMemorySize, memoryBefore); });
+    auto prepare = [this]() {
+        _clearCache();
+        for (auto& b : mBackends) {
+            b.second->onClearBuffer();
+        }
+        for (auto& iter : mPipelines) {
+            auto error = iter->prepare(mExecutionCreated);
+            if (NO_ERROR != error) {
+                return error;
+            }
+        }
+        return NO_ERROR;
+    };
+    auto error = prepare();
+    if (NO_ERROR != error) {
+        return error;
+    }
+    // concat plans are made of shapes known after prepare and applied on next one
+    bool planChanged = false;
+    for (auto& iter : mPipelines) {
+        planChanged = iter->planConcat() || planChanged;
+    }
+    if (planChanged) {
+        error = prepare();
         if (NO_ERROR != error) {
             return error;
         }
@@ -166,6 +222,8 @@ const std::map<std::string, Tensor*>& Session::getOutputAll() const {
 }
 
 ErrorCode Session::releaseCache() {
+    auto memoryBefore = MNNMemoryAllocatedSize();
+    std::shared_ptr<char> __defer(nullptr, [this, memoryBefore](void*) { _updateMemorySize(mMemorySize, memoryBefore); });
     for (auto& p : mPipelines) {
         auto code = p->releaseCache();
         if (NO_ERROR != code) {
@@ -174,4 +232,54 @@ ErrorCode Session::releaseCache() {
     }
     return NO_ERROR;
 }
+
+void Session::getMemoryInfo(SessionMemoryInfo& info) const {
+    info.ops.clear();
+    for (auto& p : mPipelines) {
+        p->getMemoryInfo(info.ops);
+    }
+    info.weight        = 0;
+    size_t eagerWeight = 0;
+    for (auto& op : info.ops) {
+        info.weight += op.weight;
+        if (!op.lazy) {
+            eagerWeight += op.weight;
+        }
+    }
+    info.dynamic = mMemorySize > eagerWeight ? mMemorySize - eagerWeight : 0;
+    info.total   = info.modelBuffer + info.weight + info.dynamic;
+}
+
+void Session::setStateful(bool stateful) {
+    for (auto& p : mPipelines) {
+        p->setStateful(stateful);
+    }
+}
+
+void Session::resetState() {
+    for (auto& p : mPipelines) {
+        p->resetState();
+    }
+}
+
+std::vector<Tensor*> Session::getState(const char* name) const {
+    if (nullptr == name) {
+        return {};
+    }
+    for (auto& p : mPipelines) {
+        auto states = p->getState(name);
+        if (!states.empty()) {
+            return states;
+        }
+    }
+    return {};
+}
+
+float Session::flops() const {
+    float sum = 0.0f;
+    for (auto& p : mPipelines) {
+        sum += p->flops();
+    }
+    return sum;
+}
 } // namespace MNN
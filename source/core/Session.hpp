@@ -73,6 +73,48 @@ public:
     void setNeedResize(bool flag = true) {
         mNeedResize = flag;
     }
+    /**
+     * @brief set callback called after each execution is created in resize.
+     * @param callback  given callback, may be null.
+     */
+    void setExecutionCreatedCallBack(const std::function<void()>& callback) {
+        mExecutionCreated = callback;
+    }
+    /**
+     * @brief create executions lazily following `lazyExecution` of configs, takes effect on next resize.
+     * @param configs   schedule configs, one for each pipeline.
+     */
+    void setLazyExecution(const std::vector<ScheduleConfig>& configs);
+    /**
+     * @brief leave const tables of gathers in model rather than copying them, takes effect on next resize.
+     * @param inModel   leave them in model or not.
+     */
+    void setTablesInModel(bool inModel) {
+        for (auto& iter : mPipelines) {
+            iter->setTablesInModel(inModel);
+        }
+    }
+    /**
+     * @brief check if any pipeline creates executions lazily.
+     */
+    bool hasLazyExecution() const {
+        return nullptr != mLazyBackend;
+    }
+    /**
+     * @brief keep state of recurrent ops between runs.
+     * @param stateful  stateful or not.
+     */
+    void setStateful(bool stateful);
+    /**
+     * @brief reset state of recurrent ops to zero.
+     */
+    void resetState();
+    /**
+     * @brief get state tensors of given recurrent op.
+     * @param name  given op name.
+     * @return state tensors, empty if not found.
+     */
+    std::vector<Tensor*> getState(const char* name) const;
 
 public:
     /**
@@ -117,6 +159,18 @@ public:
      */
     ErrorCode releaseCache();
 
+    /**
+     * @brief get memory footprint of session, modelBuffer is left untouched.
+     * @param info  output memory info.
+     */
+    void getMemoryInfo(SessionMemoryInfo& info) const;
+
+    /**
+     * @brief get sum of flops of all ops.
+     * @return flops in M.
+     */
+    float flops() const;
+
 protected:
     const std::vector<std::unique_ptr<Pipeline>>& getPipelines() const {
         return this->mPipelines;
@@ -129,6 +183,8 @@ private:
 
 private:
     std::map<MNNForwardType, std::unique_ptr<Backend>> mBackends;
+    /** CPU backend used to create lazy executions, apart from mBackends so that their buffers are not planned */
+    std::unique_ptr<Backend> mLazyBackend;
     std::vector<std::unique_ptr<Pipeline>> mPipelines;
     std::vector<std::pair<int, std::shared_ptr<Tensor>>> mTensors;
     std::map<std::string, Tensor*> mInputs;
@@ -136,6 +192,9 @@ private:
     bool mNeedResize       = false;
     bool mValid            = true;
     Backend* mFirstBackend = nullptr;
+    /** memory held by session, weight included */
+    size_t mMemorySize = 0;
+    std::function<void()> mExecutionCreated;
 };
 } // namespace MNN
 
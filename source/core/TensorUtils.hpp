@@ -39,6 +39,11 @@ public:
     int useCount = 0;
     /** for DEVICE tensor only. */
     bool isInput = false;
+    /** for DEVICE tensor only. memory is not owned, it lies in output of a concat or in model */
+    bool isView = false;
+    /** for DEVICE input tensor only. normalization of uint8 image per channel, empty if tensor is not image */
+    std::vector<float> imageMean;
+    std::vector<float> imageNormal;
 };
 
 /** tensor utils */
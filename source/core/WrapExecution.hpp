@@ -32,6 +32,15 @@ public:
     virtual ~WrapExecution() = default;
     virtual ErrorCode onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
     virtual ErrorCode onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+    virtual bool onSetStateful(bool stateful) override {
+        return mExecution->onSetStateful(stateful);
+    }
+    virtual void onResetState() override {
+        mExecution->onResetState();
+    }
+    virtual std::vector<Tensor *> onGetState() override {
+        return mExecution->onGetState();
+    }
 
 private:
     Backend *mCPUBackend;
@@ -0,0 +1,153 @@
+//
+//  ImageFilter.hpp
+//  MNN
+//
+//  Created by MNN on 2019/09/09.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef ImageFilter_hpp
+#define ImageFilter_hpp
+
+#include <math.h>
+#include <stddef.h>
+#include <algorithm>
+
+namespace MNN {
+namespace CV {
+
+/**
+ * @brief weights of four taps around a sample, Keys' cubic kernel with a = -0.75.
+ * @param t         fraction of sample between second and third tap.
+ * @param weights   output weights.
+ */
+static inline void bicubicWeights(float t, float* weights) {
+    const float A = -0.75f;
+    float t0      = 1.0f + t;
+    float t1      = t;
+    float t2      = 1.0f - t;
+    weights[0]    = ((A * t0 - 5.0f * A) * t0 + 8.0f * A) * t0 - 4.0f * A;
+    weights[1]    = ((A + 2.0f) * t1 - (A + 3.0f)) * t1 * t1 + 1.0f;
+    weights[2]    = ((A + 2.0f) * t2 - (A + 3.0f)) * t2 * t2 + 1.0f;
+    weights[3]    = 1.0f - weights[0] - weights[1] - weights[2];
+}
+
+/**
+ * @brief bicubic sample of interleaved bytes, taps beyond edge are edge.
+ * @param plane     source, channel c of pixel (x, y) at plane[y * stride + x * step + c].
+ * @param w         width of source.
+ * @param h         height of source.
+ * @param x         x of sample.
+ * @param y         y of sample.
+ * @param out       BPP values in [0, 255].
+ */
+template <int BPP>
+static inline void sampleBicubic(const unsigned char* plane, size_t stride, int step, int w, int h, float x, float y,
+                                 float* out) {
+    x        = std::max(std::min(x, (float)(w - 1)), 0.0f);
+    y        = std::max(std::min(y, (float)(h - 1)), 0.0f);
+    int x0   = (int)x;
+    int y0   = (int)y;
+    float wx[4], wy[4];
+    bicubicWeights(x - x0, wx);
+    bicubicWeights(y - y0, wy);
+    int cols[4];
+    for (int i = 0; i < 4; ++i) {
+        cols[i] = std::max(std::min(x0 - 1 + i, w - 1), 0) * step;
+    }
+    float sum[BPP];
+    for (int c = 0; c < BPP; ++c) {
+        sum[c] = 0.0f;
+    }
+    for (int j = 0; j < 4; ++j) {
+        auto row = plane + std::max(std::min(y0 - 1 + j, h - 1), 0) * stride;
+        for (int c = 0; c < BPP; ++c) {
+            float v = 0.0f;
+            for (int i = 0; i < 4; ++i) {
+                v += row[cols[i] + c] * wx[i];
+            }
+            sum[c] += v * wy[j];
+        }
+    }
+    for (int c = 0; c < BPP; ++c) {
+        out[c] = std::max(std::min(sum[c], 255.0f), 0.0f);
+    }
+}
+
+// sum of whole pixels [x0, x1) of a row, and of pixels partly covered at x0 - 1 and x1
+template <int BPP>
+static inline void _areaLine(const unsigned char* row, int step, int x0, int x1, float wl, float wr, float weight,
+                             float* sum) {
+    int whole[BPP];
+    for (int c = 0; c < BPP; ++c) {
+        whole[c] = 0;
+    }
+    for (int sx = x0; sx < x1; ++sx) {
+        for (int c = 0; c < BPP; ++c) {
+            whole[c] += row[sx * step + c];
+        }
+    }
+    for (int c = 0; c < BPP; ++c) {
+        float line = whole[c];
+        if (wl > 0.0f) {
+            line += row[(x0 - 1) * step + c] * wl;
+        }
+        if (wr > 0.0f) {
+            line += row[x1 * step + c] * wr;
+        }
+        sum[c] += line * weight;
+    }
+}
+
+/**
+ * @brief average of a box of interleaved bytes, pixel (x, y) covering [x, x + 1) x [y, y + 1). box is at least one
+ *        pixel, which makes it bilinear on upscale, and is moved within source if beyond edge.
+ * @param plane     source, channel c of pixel (x, y) at plane[y * stride + x * step + c].
+ * @param w         width of source.
+ * @param h         height of source.
+ * @param x         left of box.
+ * @param y         top of box.
+ * @param boxW      width of box.
+ * @param boxH      height of box.
+ * @param out       BPP values.
+ */
+template <int BPP>
+static inline void sampleArea(const unsigned char* plane, size_t stride, int step, int w, int h, float x, float y,
+                              float boxW, float boxH, float* out) {
+    boxW           = std::min(std::max(boxW, 1.0f), (float)w);
+    boxH           = std::min(std::max(boxH, 1.0f), (float)h);
+    const float l  = std::max(std::min(x, w - boxW), 0.0f);
+    const float t  = std::max(std::min(y, h - boxH), 0.0f);
+    const float r  = l + boxW;
+    const float b  = t + boxH;
+    const int x0   = (int)ceilf(l);
+    const int y0   = (int)ceilf(t);
+    const int x1   = std::min((int)r, w);
+    const int y1   = std::min((int)b, h);
+    const float wl = x0 - l;
+    const float wr = x1 < w ? r - x1 : 0.0f;
+    const float wt = y0 - t;
+    const float wb = y1 < h ? b - y1 : 0.0f;
+    float sum[BPP];
+    for (int c = 0; c < BPP; ++c) {
+        sum[c] = 0.0f;
+    }
+    for (int sy = y0; sy < y1; ++sy) {
+        _areaLine<BPP>(plane + sy * stride, step, x0, x1, wl, wr, 1.0f, sum);
+    }
+    if (wt > 0.0f) {
+        _areaLine<BPP>(plane + (y0 - 1) * stride, step, x0, x1, wl, wr, wt, sum);
+    }
+    if (wb > 0.0f) {
+        _areaLine<BPP>(plane + y1 * stride, step, x0, x1, wl, wr, wb, sum);
+    }
+    const float scale = 1.0f / (boxW * boxH);
+    for (int c = 0; c < BPP; ++c) {
+        out[c] = sum[c] * scale;
+    }
+}
+
+} // namespace CV
+} // namespace MNN
+
+#endif /* ImageFilter_hpp */
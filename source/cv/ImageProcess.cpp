@@ -7,9 +7,11 @@
 //
 
 #include "ImageProcess.hpp"
+#include <math.h>
 #include <algorithm>
 #include <map>
 #include "AutoStorage.h"
+#include "Concurrency.h"
 #include "Macro.h"
 #include "TensorUtils.hpp"
 #define MNN_OPEN_TIME_TRACE
@@ -17,11 +19,18 @@
 #include "ImageBlitter.hpp"
 #include "ImageFloatBlitter.hpp"
 #include "ImageSampler.hpp"
+#include "ImageYUVSampler.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #define CACHE_SIZE 128
+// rows a thread converts at least
+#define MIN_BAND_ROWS 8
 namespace MNN {
 namespace CV {
 struct ImageProcess::Inside {
     Config config;
+    // [numThread][4 * CACHE_SIZE]
     AutoStorage<uint8_t> cacheBuffer;
     AutoStorage<uint8_t> cacheBufferRGBA;
 };
@@ -31,10 +40,11 @@ ImageProcess::~ImageProcess() {
 }
 
 ImageProcess::ImageProcess(const Config& config) {
-    mInside         = new Inside;
-    mInside->config = config;
-    mInside->cacheBuffer.reset(4 * CACHE_SIZE);
-    mInside->cacheBufferRGBA.reset(4 * CACHE_SIZE);
+    mInside                   = new Inside;
+    mInside->config           = config;
+    mInside->config.numThread = std::max(1, config.numThread);
+    mInside->cacheBuffer.reset(4 * CACHE_SIZE * mInside->config.numThread);
+    mInside->cacheBufferRGBA.reset(4 * CACHE_SIZE * mInside->config.numThread);
     for (int i = 0; i < 4; ++i) {
         mInside->config.mean[i]   = config.mean[i];
         mInside->config.normal[i] = config.normal[i];
@@ -189,11 +199,44 @@ static ImageFormat _correctImageFormat(const Tensor* tensor, ImageFormat format)
 }
 
 ErrorCode ImageProcess::convert(const uint8_t* source, int iw, int ih, int stride, Tensor* destOrigin) {
+    std::vector<Image> images(1);
+    images[0].source = source;
+    images[0].width  = iw;
+    images[0].height = ih;
+    images[0].stride = stride;
+    images[0].matrix = mTransform;
+    return convert(images, destOrigin);
+}
+
+ErrorCode ImageProcess::convert(const uint8_t* source, int iw, int ih, int stride, const std::vector<Matrix>& matrices,
+                                Tensor* destOrigin) {
+    std::vector<Image> images(matrices.size());
+    for (int i = 0; i < images.size(); ++i) {
+        images[i].source = source;
+        images[i].width  = iw;
+        images[i].height = ih;
+        images[i].stride = stride;
+        images[i].matrix = matrices[i];
+    }
+    return convert(images, destOrigin);
+}
+
+ErrorCode ImageProcess::convert(const std::vector<Image>& images, Tensor* destOrigin) {
     auto dest = destOrigin;
-    if (nullptr == dest || nullptr == source) {
+    if (nullptr == dest || images.empty()) {
         MNN_ERROR("null dest or source for image process\n");
         return INPUT_DATA_ERROR;
     }
+    for (auto& image : images) {
+        if (nullptr == image.source) {
+            MNN_ERROR("null dest or source for image process\n");
+            return INPUT_DATA_ERROR;
+        }
+    }
+    if ((int)images.size() > dest->batch()) {
+        MNN_ERROR("%d images for image process exceed batch %d\n", (int)images.size(), dest->batch());
+        return INPUT_DATA_ERROR;
+    }
     std::shared_ptr<Tensor> tempTensor;
     if (destOrigin->host<float>() == nullptr) {
         tempTensor.reset(Tensor::createHostTensorFromDevice(destOrigin, false), [destOrigin](void* p) {
@@ -216,106 +259,171 @@ ErrorCode ImageProcess::convert(const uint8_t* source, int iw, int ih, int strid
     }
 
     auto sourceBpp = _getBpp(mInside->config.sourceFormat);
-    if (0 == stride) {
-        stride = iw * sourceBpp;
-    }
+    bool isFloat   = dest->getType().code == halide_type_float;
 
     // AUTOTIME;
     auto& config      = mInside->config;
     auto sourceFormat = config.sourceFormat;
     auto destFormat   = config.destFormat;
     destFormat        = _correctImageFormat(dest, destFormat);
-    auto blitter      = ImageBlitter::choose(sourceFormat, destFormat);
-    if (nullptr == blitter) {
-        return INPUT_DATA_ERROR;
+    // YUV is sampled, converted and normalized in one pass
+    ImageYUVSampler::Param yuvParam;
+    auto yuvSampler = ImageYUVSampler::choose(sourceFormat, destFormat, config.filterType, isFloat, bpp, yuvParam);
+    yuvParam.zero   = ZERO == config.wrap;
+    yuvParam.mean   = config.mean;
+    yuvParam.normal = config.normal;
+
+    ImageBlitter::BLITTER blitter = nullptr;
+    if (nullptr == yuvSampler) {
+        blitter = ImageBlitter::choose(sourceFormat, destFormat);
+        if (nullptr == blitter) {
+            return INPUT_DATA_ERROR;
+        }
     }
-    bool identity = mTransform.isIdentity() && iw >= ow && ih >= oh; // TODO, no need for iw, ih limit
-    auto sampler  = ImageSampler::choose(sourceFormat, config.filterType, identity);
-    if (nullptr == sampler) {
-        return INPUT_DATA_ERROR;
+    const int imageNumber = (int)images.size();
+    std::vector<ImageSampler::PROC> samplers(imageNumber);
+    std::vector<Matrix> inverts(imageNumber);
+    std::vector<int> strides(imageNumber);
+    // box of source covered by one dest pixel and its left, top relative to sample, for area filter
+    std::vector<Point> boxes(2 * imageNumber);
+    for (int i = 0; i < imageNumber; ++i) {
+        auto& image = images[i];
+        // TODO, no need for iw, ih limit
+        bool identity = image.matrix.isIdentity() && image.width >= ow && image.height >= oh;
+        if (nullptr == yuvSampler) {
+            samplers[i] = ImageSampler::choose(sourceFormat, config.filterType, identity);
+            if (nullptr == samplers[i]) {
+                return INPUT_DATA_ERROR;
+            }
+        }
+        image.matrix.invert(&inverts[i]);
+        // rows of luma of YUV
+        const int packedStride = nullptr == yuvSampler ? image.width * sourceBpp : image.width;
+        strides[i]             = 0 == image.stride ? packedStride : image.stride;
+        // bounds of unit square of dest in source
+        auto& m             = image.matrix;
+        boxes[2 * i].fX     = fabsf(m[Matrix::kMScaleX]) + fabsf(m[Matrix::kMSkewX]);
+        boxes[2 * i].fY     = fabsf(m[Matrix::kMSkewY]) + fabsf(m[Matrix::kMScaleY]);
+        boxes[2 * i + 1].fX = std::min(m[Matrix::kMScaleX], 0.0f) + std::min(m[Matrix::kMSkewX], 0.0f);
+        boxes[2 * i + 1].fY = std::min(m[Matrix::kMSkewY], 0.0f) + std::min(m[Matrix::kMScaleY], 0.0f);
     }
 
-    int tileCount = UP_DIV(ow, CACHE_SIZE);
-    Point points[2];
-    auto sampleBuffer = (uint8_t*)mInside->cacheBuffer.get();
-    auto srcData      = source;
-    auto destBytes    = dest->getType().bytes();
-    auto needBlit     = sourceFormat != destFormat;
-    bool isFloat      = dest->getType().code == halide_type_float;
+    int tileCount  = UP_DIV(ow, CACHE_SIZE);
+    auto destBytes = dest->getType().bytes();
+    auto needBlit  = sourceFormat != destFormat;
+
+    // batch slots lie one after another, channels of NC4HW4 within one slice
+    auto batchBytes = (size_t)dest->size() / dest->batch();
     //            MNN_PRINT("bpp:%d, destBytes:%d, destFormat:%d, %d, %d\n",bpp, destBytes, ow, oh, dimensionFormat);
 
-    auto blitFloat = ImageFloatBlitter::choose(destFormat, dimensionFormat);
-    for (int dy = 0; dy < oh; ++dy) {
-        auto dstY = dest->host<uint8_t>() + dy * destBytes * ow * bpp;
-        for (int tIndex = 0; tIndex < tileCount; ++tIndex) {
-            int xStart    = tIndex * CACHE_SIZE;
-            int count     = std::min(CACHE_SIZE, ow - xStart);
-            auto dstStart = dstY + destBytes * bpp * xStart;
+    auto blitFloat   = ImageFloatBlitter::choose(destFormat, dimensionFormat);
+    const int rows   = imageNumber * oh;
+    int threadNumber = std::max(1, std::min(config.numThread, rows / MIN_BAND_ROWS));
+#ifdef _OPENMP
+    omp_set_dynamic(0);
+    omp_set_num_threads(threadNumber);
+#endif
+    // each thread converts a band of rows of all images with its own sample and blit buffers
+    MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+        const int rowStart = (int)((int64_t)rows * tId / threadNumber);
+        const int rowEnd   = (int)((int64_t)rows * (tId + 1) / threadNumber);
+        auto sampleBuffer  = mInside->cacheBuffer.get() + 4 * CACHE_SIZE * tId;
+        auto blitBuffer    = mInside->cacheBufferRGBA.get() + 4 * CACHE_SIZE * tId;
+        Point points[4];
+        for (int row = rowStart; row < rowEnd; ++row) {
+            const int index  = row / oh;
+            const int dy     = row % oh;
+            auto& transform  = images[index].matrix;
+            auto srcData     = images[index].source;
+            const int iw     = images[index].width;
+            const int ih     = images[index].height;
+            const int stride = strides[index];
+            auto sampler     = samplers[index];
+            auto dstY        = dest->host<uint8_t>() + index * batchBytes + dy * destBytes * ow * bpp;
+            points[2]        = boxes[2 * index];
+            points[3]        = boxes[2 * index + 1];
+            for (int tIndex = 0; tIndex < tileCount; ++tIndex) {
+                int xStart    = tIndex * CACHE_SIZE;
+                int count     = std::min(CACHE_SIZE, ow - xStart);
+                auto dstStart = dstY + destBytes * bpp * xStart;
+                if (nullptr != yuvSampler) {
+                    points[0].fX = xStart;
+                    points[0].fY = dy;
+                    points[1].fX = xStart + count;
+                    points[1].fY = dy;
+                    transform.mapPoints(points, 2);
+                    points[1].fX = (points[1].fX - points[0].fX) / (float)count;
+                    points[1].fY = (points[1].fY - points[0].fY) / (float)count;
+                    yuvSampler(srcData, dstStart, points, count, iw, ih, stride, yuvParam);
+                    continue;
+                }
 
-            auto samplerDest = sampleBuffer;
-            auto blitDest    = mInside->cacheBufferRGBA.get();
+                auto samplerDest = sampleBuffer;
+                auto blitDest    = blitBuffer;
 
-            if (!isFloat) {
-                blitDest = dstStart;
-            }
-            if (!needBlit) {
-                samplerDest = blitDest;
-            }
+                if (!isFloat) {
+                    blitDest = dstStart;
+                }
+                if (!needBlit) {
+                    samplerDest = blitDest;
+                }
 
-            // Sample
-            {
-                // Compute position
-                points[0].fX = xStart;
-                points[0].fY = dy;
-
-                points[1].fX = xStart + count;
-                points[1].fY = dy;
-
-                mTransform.mapPoints(points, 2);
-                float deltaY = points[1].fY - points[0].fY;
-                float deltaX = points[1].fX - points[0].fX;
-
-                int sta = 0;
-                int end = count;
-
-                // FUNC_PRINT(sta);
-                if (config.wrap == ZERO) {
-                    // Clip: Cohen-Sutherland
-                    auto clip    = _computeClip(points, iw, ih, mTransformInvert, xStart, count);
-                    sta          = clip.first;
-                    end          = clip.second;
-                    points[0].fX = sta + xStart;
+                // Sample
+                {
+                    // Compute position
+                    points[0].fX = xStart;
                     points[0].fY = dy;
 
-                    mTransform.mapPoints(points, 1);
-                    if (sta != 0 || end != 0) {
-                        if (sourceBpp > 0) {
-                            ::memset(samplerDest, 0, sourceBpp * sta);
-                            ::memset(samplerDest + end * sourceBpp, 0, (count - end) * sourceBpp);
-                        } else {
-                            // TODO, Only support NV12 / NV21
-                            ::memset(samplerDest, 0, count);
-                            ::memset(samplerDest + count, 128, UP_DIV(count, 2) * 2);
+                    points[1].fX = xStart + count;
+                    points[1].fY = dy;
+
+                    transform.mapPoints(points, 2);
+                    float deltaY = points[1].fY - points[0].fY;
+                    float deltaX = points[1].fX - points[0].fX;
+
+                    int sta = 0;
+                    int end = count;
+
+                    // FUNC_PRINT(sta);
+                    if (config.wrap == ZERO) {
+                        // Clip: Cohen-Sutherland
+                        auto clip    = _computeClip(points, iw, ih, inverts[index], xStart, count);
+                        sta          = clip.first;
+                        end          = clip.second;
+                        points[0].fX = sta + xStart;
+                        points[0].fY = dy;
+
+                        transform.mapPoints(points, 1);
+                        if (sta != 0 || end != 0) {
+                            if (sourceBpp > 0) {
+                                ::memset(samplerDest, 0, sourceBpp * sta);
+                                ::memset(samplerDest + end * sourceBpp, 0, (count - end) * sourceBpp);
+                            } else {
+                                // TODO, Only support NV12 / NV21
+                                ::memset(samplerDest, 0, count);
+                                ::memset(samplerDest + count, 128, UP_DIV(count, 2) * 2);
+                            }
                         }
                     }
-                }
-                points[1].fX = (deltaX) / (float)(count);
-                points[1].fY = (deltaY) / (float)(count);
+                    points[1].fX = (deltaX) / (float)(count);
+                    points[1].fY = (deltaY) / (float)(count);
 
-                sampler(srcData, samplerDest, points, sta, end - sta, count, iw, ih, stride);
-            }
-            // Convert format
-            if (needBlit) {
-                blitter(samplerDest, blitDest, count);
-            }
-            // Turn float
-            if (isFloat) {
-                auto normal = mInside->config.normal;
-                auto mean   = mInside->config.mean;
-                blitFloat(blitDest, (float*)dstStart, mean, normal, count);
+                    sampler(srcData, samplerDest, points, sta, end - sta, count, iw, ih, stride);
+                }
+                // Convert format
+                if (needBlit) {
+                    blitter(samplerDest, blitDest, count);
+                }
+                // Turn float
+                if (isFloat) {
+                    auto normal = mInside->config.normal;
+                    auto mean   = mInside->config.mean;
+                    blitFloat(blitDest, (float*)dstStart, mean, normal, count);
+                }
             }
         }
     }
+    MNN_CONCURRENCY_END();
 
     return NO_ERROR;
 }
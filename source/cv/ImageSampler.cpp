@@ -8,6 +8,7 @@
 
 #include "ImageSampler.hpp"
 #include <algorithm>
+#include "ImageFilter.hpp"
 #include "Macro.h"
 #ifdef MNN_USE_NEON
 #include <arm_neon.h>
@@ -18,6 +19,11 @@ void MNNSamplerC4BilinearOpt(const unsigned char* source, unsigned char* dest, f
 void MNNSamplerC1BilinearOpt(const unsigned char* source, unsigned char* dest, float* points, size_t count, size_t xMax,
                              size_t yMax, size_t yStride);
 
+void MNNSamplerC4BicubicOpt(const unsigned char* source, unsigned char* dest, float* points, size_t count, size_t iw,
+                            size_t ih, size_t yStride);
+void MNNSamplerC4AreaOpt(const unsigned char* source, unsigned char* dest, float* points, size_t count, size_t iw,
+                         size_t ih, size_t yStride);
+
 void MNNSamplerC4NearestOpt(const unsigned char* source, unsigned char* dest, float* points, size_t count, size_t iw,
                             size_t ih, size_t yStride);
 void MNNSamplerC1NearestOpt(const unsigned char* source, unsigned char* dest, float* points, size_t count, size_t iw,
@@ -69,7 +75,7 @@ static void _sampleBilinearCommon(const unsigned char* source, unsigned char* de
 
 static void MNNSamplerC4Bilinear(const unsigned char* source, unsigned char* dest, Point* points, size_t sta,
                                  size_t count, size_t capacity, size_t iw, size_t ih, size_t yStride) {
-#ifdef MNN_USE_NEON
+#if defined(MNN_USE_NEON) || defined(MNN_USE_SSE)
     MNNSamplerC4BilinearOpt(source, dest + 4 * sta, reinterpret_cast<float*>(points), count, iw - 1, ih - 1, yStride);
 #else
     _sampleBilinearCommon(source, dest + 4 * sta, points, count, iw, ih, yStride, 4);
@@ -81,12 +87,78 @@ static void MNNSamplerC3Bilinear(const unsigned char* source, unsigned char* des
 }
 static void MNNSamplerC1Bilinear(const unsigned char* source, unsigned char* dest, Point* points, size_t sta,
                                  size_t count, size_t capacity, size_t iw, size_t ih, size_t yStride) {
-#ifdef MNN_USE_NEON
+#if defined(MNN_USE_NEON) || defined(MNN_USE_SSE)
     MNNSamplerC1BilinearOpt(source, dest + sta, reinterpret_cast<float*>(points), count, iw - 1, ih - 1, yStride);
 #else
     _sampleBilinearCommon(source, dest + sta, points, count, iw, ih, yStride, 1);
 #endif
 }
+template <int BPP>
+static void _sampleBicubicCommon(const unsigned char* source, unsigned char* dest, Point* points, size_t count,
+                                 size_t iw, size_t ih, size_t yStride) {
+    float x = points[0].fX;
+    float y = points[0].fY;
+    float v[BPP];
+    for (int i = 0; i < count; ++i) {
+        sampleBicubic<BPP>(source, yStride, BPP, (int)iw, (int)ih, x, y, v);
+        for (int b = 0; b < BPP; ++b) {
+            dest[BPP * i + b] = (unsigned char)(v[b] + 0.5f);
+        }
+        x += points[1].fX;
+        y += points[1].fY;
+    }
+}
+
+template <int BPP>
+static void _sampleAreaCommon(const unsigned char* source, unsigned char* dest, Point* points, size_t count,
+                              size_t iw, size_t ih, size_t yStride) {
+    float x = points[0].fX + points[3].fX;
+    float y = points[0].fY + points[3].fY;
+    float v[BPP];
+    for (int i = 0; i < count; ++i) {
+        sampleArea<BPP>(source, yStride, BPP, (int)iw, (int)ih, x, y, points[2].fX, points[2].fY, v);
+        for (int b = 0; b < BPP; ++b) {
+            dest[BPP * i + b] = (unsigned char)std::min(v[b] + 0.5f, 255.0f);
+        }
+        x += points[1].fX;
+        y += points[1].fY;
+    }
+}
+
+static void MNNSamplerC4Bicubic(const unsigned char* source, unsigned char* dest, Point* points, size_t sta,
+                                size_t count, size_t capacity, size_t iw, size_t ih, size_t yStride) {
+#if defined(MNN_USE_NEON) || defined(MNN_USE_SSE)
+    MNNSamplerC4BicubicOpt(source, dest + 4 * sta, reinterpret_cast<float*>(points), count, iw, ih, yStride);
+#else
+    _sampleBicubicCommon<4>(source, dest + 4 * sta, points, count, iw, ih, yStride);
+#endif
+}
+static void MNNSamplerC3Bicubic(const unsigned char* source, unsigned char* dest, Point* points, size_t sta,
+                                size_t count, size_t capacity, size_t iw, size_t ih, size_t yStride) {
+    _sampleBicubicCommon<3>(source, dest + 3 * sta, points, count, iw, ih, yStride);
+}
+static void MNNSamplerC1Bicubic(const unsigned char* source, unsigned char* dest, Point* points, size_t sta,
+                                size_t count, size_t capacity, size_t iw, size_t ih, size_t yStride) {
+    _sampleBicubicCommon<1>(source, dest + sta, points, count, iw, ih, yStride);
+}
+
+static void MNNSamplerC4Area(const unsigned char* source, unsigned char* dest, Point* points, size_t sta, size_t count,
+                             size_t capacity, size_t iw, size_t ih, size_t yStride) {
+#if defined(MNN_USE_NEON) || defined(MNN_USE_SSE)
+    MNNSamplerC4AreaOpt(source, dest + 4 * sta, reinterpret_cast<float*>(points), count, iw, ih, yStride);
+#else
+    _sampleAreaCommon<4>(source, dest + 4 * sta, points, count, iw, ih, yStride);
+#endif
+}
+static void MNNSamplerC3Area(const unsigned char* source, unsigned char* dest, Point* points, size_t sta, size_t count,
+                             size_t capacity, size_t iw, size_t ih, size_t yStride) {
+    _sampleAreaCommon<3>(source, dest + 3 * sta, points, count, iw, ih, yStride);
+}
+static void MNNSamplerC1Area(const unsigned char* source, unsigned char* dest, Point* points, size_t sta, size_t count,
+                             size_t capacity, size_t iw, size_t ih, size_t yStride) {
+    _sampleAreaCommon<1>(source, dest + sta, points, count, iw, ih, yStride);
+}
+
 static void MNNSamplerNearest(const unsigned char* source, unsigned char* dest, Point* points, size_t sta, size_t count,
                               size_t iw, size_t ih, size_t yStride, int bpp) {
     dest = dest + bpp * sta;
@@ -229,6 +301,34 @@ ImageSampler::PROC ImageSampler::choose(ImageFormat format, Filter type, bool id
                 break;
         }
     }
+    if (BICUBIC == type) {
+        switch (format) {
+            case RGBA:
+            case BGRA:
+                return MNNSamplerC4Bicubic;
+            case GRAY:
+                return MNNSamplerC1Bicubic;
+            case RGB:
+            case BGR:
+                return MNNSamplerC3Bicubic;
+            default:
+                break;
+        }
+    }
+    if (AREA == type) {
+        switch (format) {
+            case RGBA:
+            case BGRA:
+                return MNNSamplerC4Area;
+            case GRAY:
+                return MNNSamplerC1Area;
+            case RGB:
+            case BGR:
+                return MNNSamplerC3Area;
+            default:
+                break;
+        }
+    }
 
     // Nearest
     switch (format) {
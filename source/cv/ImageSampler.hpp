@@ -13,6 +13,10 @@ namespace MNN {
 namespace CV {
 class ImageSampler {
 public:
+    /**
+     * points: first sample and step between samples in source, then width, height of box of source covered by one
+     * sample and left, top of box relative to sample, the latter two only used by area filter.
+     */
     typedef void (*PROC)(const unsigned char* source, unsigned char* dest, Point* points, size_t sta, size_t count,
                          size_t capacity, size_t iw, size_t ih, size_t yStride);
 
@@ -0,0 +1,315 @@
+//
+//  ImageYUVSampler.cpp
+//  MNN
+//
+//  Created by MNN on 2019/09/06.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "ImageYUVSampler.hpp"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <type_traits>
+#include "ImageFilter.hpp"
+#include "Macro.h"
+#include "Vec4.hpp"
+using namespace MNN::Math;
+
+// samples converted a time
+#define YUV_BLOCK 64
+
+namespace MNN {
+namespace CV {
+
+struct YUVPlanes {
+    const unsigned char* y;
+    const unsigned char* u;
+    const unsigned char* v;
+    int yStride;
+    // bytes between chroma rows, and between neighbouring chroma of a row
+    int uvStride;
+    int uvStep;
+    int uvWidth;
+    int uvHeight;
+};
+
+static YUVPlanes _planes(const unsigned char* source, int iw, int ih, int yStride, ImageFormat format) {
+    YUVPlanes planes;
+    planes.y        = source;
+    planes.yStride  = yStride;
+    planes.uvWidth  = UP_DIV(iw, 2);
+    planes.uvHeight = UP_DIV(ih, 2);
+    auto chroma     = source + (size_t)yStride * ih;
+    if (YUV_I420 == format) {
+        planes.uvStride = UP_DIV(yStride, 2);
+        planes.uvStep   = 1;
+        planes.u        = chroma;
+        planes.v        = chroma + (size_t)planes.uvStride * planes.uvHeight;
+        return planes;
+    }
+    planes.uvStride = UP_DIV(yStride, 2) * 2;
+    planes.uvStep   = 2;
+    if (YUV_NV12 == format) {
+        planes.u = chroma;
+        planes.v = chroma + 1;
+    } else {
+        planes.v = chroma;
+        planes.u = chroma + 1;
+    }
+    return planes;
+}
+
+// Y, U, V of four samples to R, G, B with same coefficients as MNNNV21ToRGB, in 1 / 64
+static inline void _yuvToRGB(const float* y, const float* u, const float* v, Vec4* rgb) {
+    Vec4 Y    = Vec4::load(y);
+    Vec4 U    = Vec4::load(u) - Vec4(128.0f);
+    Vec4 V    = Vec4::load(v) - Vec4(128.0f);
+    Vec4 minV = Vec4(0.0f);
+    Vec4 maxV = Vec4(255.0f);
+    rgb[0]    = Vec4::min(Vec4::max(Y + V * 1.140625f, minV), maxV);
+    rgb[1]    = Vec4::min(Vec4::max(Y - U * 0.390625f - V * 0.578125f, minV), maxV);
+    rgb[2]    = Vec4::min(Vec4::max(Y + U * 2.03125f, minV), maxV);
+}
+
+template <typename T>
+static inline T _cast(float v);
+template <>
+inline float _cast<float>(float v) {
+    return v;
+}
+template <>
+inline uint8_t _cast<uint8_t>(float v) {
+    return (uint8_t)v;
+}
+
+template <typename T, int FILTER, int BPP>
+static void _sampleYUV(const unsigned char* source, unsigned char* dest, Point* points, size_t count, size_t iw,
+                       size_t ih, size_t yStride, const ImageYUVSampler::Param& param) {
+    auto planes      = _planes(source, (int)iw, (int)ih, (int)yStride, param.sourceFormat);
+    auto dst         = (T*)dest;
+    const float xMax = iw - 1;
+    const float yMax = ih - 1;
+    const bool gray  = param.order[1] < 0;
+    const bool zero  = param.zero;
+    const bool norm  = std::is_same<T, float>::value;
+    // each channel from R, G, B, alpha or zero, normalized as (v - mean) * normal for float
+    int from[BPP];
+    float scale[BPP], bias[BPP];
+    for (int c = 0; c < BPP; ++c) {
+        from[c]  = 4;
+        scale[c] = 1.0f;
+        bias[c]  = 0.0f;
+    }
+    for (int i = 0; i < 4; ++i) {
+        const int c = i < 3 ? param.order[i] : param.alpha;
+        if (c < 0) {
+            continue;
+        }
+        from[c] = i;
+        if (norm) {
+            scale[c] = param.normal[c];
+            bias[c]  = -param.mean[c] * param.normal[c];
+        }
+    }
+    float x = points[0].fX;
+    float y = points[0].fY;
+    // samples of a block are gathered before converted, so that vector loads do not wait on scalar stores
+    alignas(16) float Ys[YUV_BLOCK];
+    alignas(16) float Us[YUV_BLOCK];
+    alignas(16) float Vs[YUV_BLOCK];
+    for (size_t start = 0; start < count; start += YUV_BLOCK) {
+        const int blockCount = (int)std::min((size_t)YUV_BLOCK, count - start);
+        for (int j = 0; j < blockCount; ++j, x += points[1].fX, y += points[1].fY) {
+            Us[j] = 128.0f;
+            Vs[j] = 128.0f;
+            if (zero && (x < 0.0f || x > xMax || y < 0.0f || y > yMax)) {
+                // black
+                Ys[j] = 0.0f;
+                continue;
+            }
+            if (BICUBIC == FILTER) {
+                sampleBicubic<1>(planes.y, planes.yStride, 1, (int)iw, (int)ih, x, y, Ys + j);
+                if (!gray) {
+                    const float cx = x * 0.5f - 0.25f;
+                    const float cy = y * 0.5f - 0.25f;
+                    sampleBicubic<1>(planes.u, planes.uvStride, planes.uvStep, planes.uvWidth, planes.uvHeight, cx,
+                                     cy, Us + j);
+                    sampleBicubic<1>(planes.v, planes.uvStride, planes.uvStep, planes.uvWidth, planes.uvHeight, cx,
+                                     cy, Vs + j);
+                }
+                continue;
+            }
+            if (AREA == FILTER) {
+                const float l = x + points[3].fX;
+                const float t = y + points[3].fY;
+                sampleArea<1>(planes.y, planes.yStride, 1, (int)iw, (int)ih, l, t, points[2].fX, points[2].fY, Ys + j);
+                if (!gray) {
+                    // chroma pixel covers 2x2 luma
+                    sampleArea<1>(planes.u, planes.uvStride, planes.uvStep, planes.uvWidth, planes.uvHeight, l * 0.5f,
+                                  t * 0.5f, points[2].fX * 0.5f, points[2].fY * 0.5f, Us + j);
+                    sampleArea<1>(planes.v, planes.uvStride, planes.uvStep, planes.uvWidth, planes.uvHeight, l * 0.5f,
+                                  t * 0.5f, points[2].fX * 0.5f, points[2].fY * 0.5f, Vs + j);
+                }
+                continue;
+            }
+            if (NEAREST == FILTER) {
+                // non-negative after clamp
+                const int sx = (int)(std::min(std::max(x, 0.0f), xMax) + 0.5f);
+                const int sy = (int)(std::min(std::max(y, 0.0f), yMax) + 0.5f);
+                const int o  = (sy / 2) * planes.uvStride + (sx / 2) * planes.uvStep;
+                Ys[j]        = planes.y[sy * planes.yStride + sx];
+                Us[j]        = planes.u[o];
+                Vs[j]        = planes.v[o];
+                continue;
+            }
+            const float sx = std::min(std::max(x, 0.0f), xMax);
+            const float sy = std::min(std::max(y, 0.0f), yMax);
+            const int x0   = (int)sx;
+            const int y0   = (int)sy;
+            const int x1   = std::min(x0 + 1, (int)iw - 1);
+            const int y1   = std::min(y0 + 1, (int)ih - 1);
+            const float xF = sx - x0;
+            const float yF = sy - y0;
+            auto row0      = planes.y + y0 * planes.yStride;
+            auto row1      = planes.y + y1 * planes.yStride;
+            float top      = row0[x0] + (row0[x1] - row0[x0]) * xF;
+            float bottom   = row1[x0] + (row1[x1] - row1[x0]) * xF;
+            Ys[j]          = top + (bottom - top) * yF;
+            if (gray) {
+                continue;
+            }
+            // chroma sits at center of 2x2 luma
+            const float cx = std::min(std::max(sx * 0.5f - 0.25f, 0.0f), (float)(planes.uvWidth - 1));
+            const float cy = std::min(std::max(sy * 0.5f - 0.25f, 0.0f), (float)(planes.uvHeight - 1));
+            const int cx0  = (int)cx;
+            const int cy0  = (int)cy;
+            const int cx1  = std::min(cx0 + 1, planes.uvWidth - 1);
+            const int cy1  = std::min(cy0 + 1, planes.uvHeight - 1);
+            const float w1 = cx - cx0;
+            const float h1 = cy - cy0;
+            const int o00  = cy0 * planes.uvStride + cx0 * planes.uvStep;
+            const int o01  = cy0 * planes.uvStride + cx1 * planes.uvStep;
+            const int o10  = cy1 * planes.uvStride + cx0 * planes.uvStep;
+            const int o11  = cy1 * planes.uvStride + cx1 * planes.uvStep;
+            auto u         = planes.u;
+            auto v         = planes.v;
+            top            = u[o00] + (u[o01] - u[o00]) * w1;
+            bottom         = u[o10] + (u[o11] - u[o10]) * w1;
+            Us[j]          = top + (bottom - top) * h1;
+            top            = v[o00] + (v[o01] - v[o00]) * w1;
+            bottom         = v[o10] + (v[o11] - v[o10]) * w1;
+            Vs[j]          = top + (bottom - top) * h1;
+        }
+        // tail of block is converted as well, but never written
+        for (int j = blockCount; j < ALIGN_UP4(blockCount); ++j) {
+            Ys[j] = 0.0f;
+            Us[j] = 128.0f;
+            Vs[j] = 128.0f;
+        }
+
+        for (int i = 0; i < blockCount; i += 4) {
+            // r, g, b, alpha, zero
+            Vec4 channels[5];
+            if (gray) {
+                channels[0] = Vec4::load(Ys + i);
+                channels[1] = channels[0];
+                channels[2] = channels[0];
+            } else {
+                _yuvToRGB(Ys + i, Us + i, Vs + i, channels);
+            }
+            channels[3] = Vec4(255.0f);
+            channels[4] = Vec4(0.0f);
+            alignas(16) float values[BPP][4];
+            for (int c = 0; c < BPP; ++c) {
+                Vec4::save(values[c], channels[from[c]] * scale[c] + Vec4(bias[c]));
+            }
+            const int n = std::min(4, blockCount - i);
+            auto pixel  = dst + (start + i) * BPP;
+            for (int j = 0; j < n; ++j) {
+                for (int c = 0; c < BPP; ++c) {
+                    pixel[j * BPP + c] = _cast<T>(values[c][j]);
+                }
+            }
+        }
+    }
+}
+
+template <typename T, int FILTER>
+static ImageYUVSampler::PROC _choose(int bpp) {
+    switch (bpp) {
+        case 1:
+            return _sampleYUV<T, FILTER, 1>;
+        case 3:
+            return _sampleYUV<T, FILTER, 3>;
+        case 4:
+            return _sampleYUV<T, FILTER, 4>;
+        default:
+            break;
+    }
+    return nullptr;
+}
+
+template <typename T>
+static ImageYUVSampler::PROC _choose(Filter type, int bpp) {
+    switch (type) {
+        case BILINEAR:
+            return _choose<T, BILINEAR>(bpp);
+        case BICUBIC:
+            return _choose<T, BICUBIC>(bpp);
+        case AREA:
+            return _choose<T, AREA>(bpp);
+        default:
+            break;
+    }
+    return _choose<T, NEAREST>(bpp);
+}
+
+bool ImageYUVSampler::isYUV(ImageFormat format) {
+    return YUV_NV21 == format || YUV_NV12 == format || YUV_I420 == format;
+}
+
+ImageYUVSampler::PROC ImageYUVSampler::choose(ImageFormat source, ImageFormat dest, Filter type, bool isFloat,
+                                              int bpp, Param& param) {
+    if (!isYUV(source)) {
+        return nullptr;
+    }
+    param.sourceFormat = source;
+    param.alpha        = -1;
+    param.bpp          = bpp;
+    param.zero         = false;
+
+    const int rgb[3] = {0, 1, 2};
+    const int bgr[3] = {2, 1, 0};
+    const int y[3]   = {0, -1, -1};
+    const int* order = nullptr;
+    switch (dest) {
+        case GRAY:
+            order = y;
+            break;
+        case RGB:
+        case RGBA:
+            order = rgb;
+            break;
+        case BGR:
+        case BGRA:
+            order = bgr;
+            break;
+        default:
+            return nullptr;
+    }
+    ::memcpy(param.order, order, sizeof(param.order));
+    if (RGBA == dest || BGRA == dest) {
+        param.alpha = 3;
+    }
+    if (param.alpha >= bpp || order[0] >= bpp || order[2] >= bpp) {
+        return nullptr;
+    }
+    if (isFloat) {
+        return _choose<float>(type, bpp);
+    }
+    return _choose<uint8_t>(type, bpp);
+}
+
+} // namespace CV
+} // namespace MNN
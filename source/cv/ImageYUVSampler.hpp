@@ -0,0 +1,51 @@
+//
+//  ImageYUVSampler.hpp
+//  MNN
+//
+//  Created by MNN on 2019/09/06.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef ImageYUVSampler_hpp
+#define ImageYUVSampler_hpp
+
+#include "ImageProcess.hpp"
+namespace MNN {
+namespace CV {
+/**
+ * samples YUV 420 source, converts to RGB / BGR / RGBA / BGRA / GRAY and normalizes to float in one pass, with no
+ * intermediate line of bytes.
+ */
+class ImageYUVSampler {
+public:
+    struct Param {
+        /** chroma layout of source */
+        ImageFormat sourceFormat;
+        /** output channel of R, G, B, -1 if absent; gray uses R only */
+        int order[3];
+        /** alpha channel, -1 if absent */
+        int alpha;
+        /** channels written per pixel, channels beyond format are zero */
+        int bpp;
+        /** out of source is black rather than edge */
+        bool zero;
+        const float* mean;
+        const float* normal;
+    };
+    /** points as of ImageSampler::PROC */
+    typedef void (*PROC)(const unsigned char* source, unsigned char* dest, Point* points, size_t count, size_t iw,
+                         size_t ih, size_t yStride, const Param& param);
+
+    /**
+     * @brief choose sampler for given formats.
+     * @param param     filled with layout for chosen sampler.
+     * @return sampler, null if source is not YUV or dest format is not supported.
+     */
+    static PROC choose(ImageFormat source, ImageFormat dest, Filter type, bool isFloat, int bpp, Param& param);
+
+    /** whether format is one of YUV 420 formats */
+    static bool isYUV(ImageFormat format);
+};
+} // namespace CV
+} // namespace MNN
+#endif /* ImageYUVSampler_hpp */
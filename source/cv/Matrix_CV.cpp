@@ -432,6 +432,131 @@ bool Matrix::setRectToRect(const Rect& src, const Rect& dst, ScaleToFit align) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+static inline bool checkForZero(float x) {
+    return x * x == 0;
+}
+
+// maps (0, 0) to srcPt[0] and (0, 1) to srcPt[1], with no skew and same scale of x and y
+static bool Poly2Proc(const Point srcPt[], float mat[9]) {
+    mat[Matrix::kMScaleX] = srcPt[1].fY - srcPt[0].fY;
+    mat[Matrix::kMSkewY]  = srcPt[0].fX - srcPt[1].fX;
+    mat[Matrix::kMPersp0] = 0;
+    mat[Matrix::kMSkewX]  = srcPt[1].fX - srcPt[0].fX;
+    mat[Matrix::kMScaleY] = srcPt[1].fY - srcPt[0].fY;
+    mat[Matrix::kMPersp1] = 0;
+    mat[Matrix::kMTransX] = srcPt[0].fX;
+    mat[Matrix::kMTransY] = srcPt[0].fY;
+    mat[Matrix::kMPersp2] = 1;
+    return true;
+}
+
+// maps (0, 0), (0, 1), (1, 0) to srcPt[0], srcPt[1], srcPt[2]
+static bool Poly3Proc(const Point srcPt[], float mat[9]) {
+    mat[Matrix::kMScaleX] = srcPt[2].fX - srcPt[0].fX;
+    mat[Matrix::kMSkewY]  = srcPt[2].fY - srcPt[0].fY;
+    mat[Matrix::kMPersp0] = 0;
+    mat[Matrix::kMSkewX]  = srcPt[1].fX - srcPt[0].fX;
+    mat[Matrix::kMScaleY] = srcPt[1].fY - srcPt[0].fY;
+    mat[Matrix::kMPersp1] = 0;
+    mat[Matrix::kMTransX] = srcPt[0].fX;
+    mat[Matrix::kMTransY] = srcPt[0].fY;
+    mat[Matrix::kMPersp2] = 1;
+    return true;
+}
+
+// maps (0, 0), (0, 1), (1, 1), (1, 0) to srcPt[0], srcPt[1], srcPt[2], srcPt[3]
+static bool Poly4Proc(const Point srcPt[], float mat[9]) {
+    float a1, a2;
+    float x0, y0, x1, y1, x2, y2;
+
+    x0 = srcPt[2].fX - srcPt[0].fX;
+    y0 = srcPt[2].fY - srcPt[0].fY;
+    x1 = srcPt[2].fX - srcPt[1].fX;
+    y1 = srcPt[2].fY - srcPt[1].fY;
+    x2 = srcPt[2].fX - srcPt[3].fX;
+    y2 = srcPt[2].fY - srcPt[3].fY;
+
+    /* check if abs(x2) > abs(y2) */
+    if (x2 > 0 ? y2 > 0 ? x2 > y2 : x2 > -y2 : y2 > 0 ? -x2 > y2 : x2 < y2) {
+        float denom = (x1 * y2 / x2) - y1;
+        if (checkForZero(denom)) {
+            return false;
+        }
+        a1 = (((x0 - x1) * y2 / x2) - y0 + y1) / denom;
+    } else {
+        float denom = x1 - (y1 * x2 / y2);
+        if (checkForZero(denom)) {
+            return false;
+        }
+        a1 = (x0 - x1 - ((y0 - y1) * x2 / y2)) / denom;
+    }
+
+    /* check if abs(x1) > abs(y1) */
+    if (x1 > 0 ? y1 > 0 ? x1 > y1 : x1 > -y1 : y1 > 0 ? -x1 > y1 : x1 < y1) {
+        float denom = y2 - (x2 * y1 / x1);
+        if (checkForZero(denom)) {
+            return false;
+        }
+        a2 = (y0 - y2 - ((x0 - x2) * y1 / x1)) / denom;
+    } else {
+        float denom = (y2 * x1 / y1) - x2;
+        if (checkForZero(denom)) {
+            return false;
+        }
+        a2 = (((y0 - y2) * x1 / y1) - x0 + x2) / denom;
+    }
+
+    mat[Matrix::kMScaleX] = a2 * srcPt[3].fX + srcPt[3].fX - srcPt[0].fX;
+    mat[Matrix::kMSkewY]  = a2 * srcPt[3].fY + srcPt[3].fY - srcPt[0].fY;
+    mat[Matrix::kMPersp0] = a2;
+    mat[Matrix::kMSkewX]  = a1 * srcPt[1].fX + srcPt[1].fX - srcPt[0].fX;
+    mat[Matrix::kMScaleY] = a1 * srcPt[1].fY + srcPt[1].fY - srcPt[0].fY;
+    mat[Matrix::kMPersp1] = a1;
+    mat[Matrix::kMTransX] = srcPt[0].fX;
+    mat[Matrix::kMTransY] = srcPt[0].fY;
+    mat[Matrix::kMPersp2] = 1;
+    return true;
+}
+
+typedef bool (*PolyMapProc)(const Point[], float[9]);
+
+bool Matrix::setPolyToPoly(const Point src[], const Point dst[], int count) {
+    if ((unsigned)count > 4) {
+        return false;
+    }
+
+    if (0 == count) {
+        this->reset();
+        return true;
+    }
+    if (1 == count) {
+        this->setTranslate(dst[0].fX - src[0].fX, dst[0].fY - src[0].fY);
+        return true;
+    }
+
+    const PolyMapProc gPolyMapProcs[] = {Poly2Proc, Poly3Proc, Poly4Proc};
+    PolyMapProc proc                  = gPolyMapProcs[count - 2];
+
+    // unit square to src, inverted, then unit square to dst
+    float buffer[9];
+    Matrix tempMap, result;
+    if (!proc(src, buffer)) {
+        return false;
+    }
+    tempMap.set9(buffer);
+    if (!tempMap.invert(&result)) {
+        return false;
+    }
+    if (!proc(dst, buffer)) {
+        return false;
+    }
+    tempMap.set9(buffer);
+    this->setConcat(tempMap, result);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 static inline float muladdmul(float a, float b, float c, float d) {
     return (float)((double)a * b + (double)c * d);
 }
@@ -36,6 +36,16 @@ struct Vec4 {
     static void save(float* addr, const Vec4& v) {
         vst1q_f32(addr, v.value);
     }
+    static Vec4 max(const Vec4& v1, const Vec4& v2) {
+        Vec4 dst;
+        dst.value = vmaxq_f32(v1.value, v2.value);
+        return dst;
+    }
+    static Vec4 min(const Vec4& v1, const Vec4& v2) {
+        Vec4 dst;
+        dst.value = vminq_f32(v1.value, v2.value);
+        return dst;
+    }
     Vec4 operator+(const Vec4& lr) {
         Vec4 dst;
         dst.value = value + lr.value;
@@ -121,6 +131,16 @@ struct Vec4 {
     static void save(float* addr, const Vec4& v) {
         _mm_store_ps(addr, v.value);
     }
+    static Vec4 max(const Vec4& v1, const Vec4& v2) {
+        Vec4 dst;
+        dst.value = _mm_max_ps(v1.value, v2.value);
+        return dst;
+    }
+    static Vec4 min(const Vec4& v1, const Vec4& v2) {
+        Vec4 dst;
+        dst.value = _mm_min_ps(v1.value, v2.value);
+        return dst;
+    }
 };
 #else
 struct Vec4 {
@@ -192,6 +212,20 @@ struct Vec4 {
             addr[i] = v.value[i];
         }
     }
+    static Vec4 max(const Vec4& v1, const Vec4& v2) {
+        Vec4 dst;
+        for (int i = 0; i < 4; ++i) {
+            dst.value[i] = v1.value[i] > v2.value[i] ? v1.value[i] : v2.value[i];
+        }
+        return dst;
+    }
+    static Vec4 min(const Vec4& v1, const Vec4& v2) {
+        Vec4 dst;
+        for (int i = 0; i < 4; ++i) {
+            dst.value[i] = v1.value[i] < v2.value[i] ? v1.value[i] : v2.value[i];
+        }
+        return dst;
+    }
 };
 #endif
 } // namespace Math
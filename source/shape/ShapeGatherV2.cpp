@@ -46,7 +46,16 @@ class GatherV2Computer : public SizeComputer {
             result_shape.push_back(params->buffer().dim[i].extent);
         }
 
-        for (int i = 0; i < indices->buffer().dimensions; i++) {
+        // a bag of the last dimension of indices is pooled into one row
+        int indicesDimensions = indices->buffer().dimensions;
+        auto parameter        = op->main_as_GatherV2();
+        if (nullptr != parameter && GatherCombiner_NONE != parameter->combiner()) {
+            if (indicesDimensions < 1) {
+                return false;
+            }
+            indicesDimensions -= 1;
+        }
+        for (int i = 0; i < indicesDimensions; i++) {
             result_shape.push_back(indices->buffer().dim[i].extent);
         }
 
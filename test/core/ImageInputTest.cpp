@@ -0,0 +1,163 @@
+//
+//  ImageInputTest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2019/09/11.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <math.h>
+#include "ImageProcess.hpp"
+#include "Interpreter.hpp"
+#include "MNNTestSuite.h"
+#include "MNN_generated.h"
+
+using namespace MNN;
+using namespace MNN::CV;
+
+// input of 3 channels read by one convolution
+static Interpreter* create(int kernel, int stride, int oc) {
+    flatbuffers::FlatBufferBuilder fbb;
+    std::vector<flatbuffers::Offset<Op>> vec;
+    {
+        auto dims = fbb.CreateVector(std::vector<int>({1, 3, 8, 8}));
+        InputBuilder ib(fbb);
+        ib.add_dims(dims);
+        auto input = ib.Finish();
+        auto name  = fbb.CreateString("input");
+        auto iv    = fbb.CreateVector(std::vector<int>({0}));
+        auto ov    = fbb.CreateVector(std::vector<int>({0}));
+
+        OpBuilder builder(fbb);
+        builder.add_type(OpType_Input);
+        builder.add_name(name);
+        builder.add_inputIndexes(iv);
+        builder.add_outputIndexes(ov);
+        builder.add_main_type(OpParameter_Input);
+        builder.add_main(flatbuffers::Offset<void>(input.o));
+        vec.push_back(builder.Finish());
+    }
+    {
+        auto ccb = Convolution2DCommonBuilder(fbb);
+        ccb.add_kernelX(kernel);
+        ccb.add_kernelY(kernel);
+        ccb.add_strideX(stride);
+        ccb.add_strideY(stride);
+        ccb.add_dilateX(1);
+        ccb.add_dilateY(1);
+        ccb.add_group(1);
+        ccb.add_padMode(PadMode_SAME);
+        ccb.add_outputCount(oc);
+        auto common = ccb.Finish();
+
+        std::vector<float> weight(oc * 3 * kernel * kernel);
+        for (int i = 0; i < weight.size(); ++i) {
+            weight[i] = ((i % 23) - 11) / 11.0f;
+        }
+        std::vector<float> bias(oc);
+        for (int i = 0; i < oc; ++i) {
+            bias[i] = (i % 5) * 0.25f;
+        }
+        auto weights = fbb.CreateVector(weight);
+        auto biases  = fbb.CreateVector(bias);
+        auto cb      = Convolution2DBuilder(fbb);
+        cb.add_common(common);
+        cb.add_weight(weights);
+        cb.add_bias(biases);
+        auto conv = cb.Finish();
+        auto name = fbb.CreateString("conv");
+        auto iv   = fbb.CreateVector(std::vector<int>({0}));
+        auto ov   = fbb.CreateVector(std::vector<int>({1}));
+
+        OpBuilder builder(fbb);
+        builder.add_type(OpType_Convolution);
+        builder.add_name(name);
+        builder.add_inputIndexes(iv);
+        builder.add_outputIndexes(ov);
+        builder.add_main_type(OpParameter_Convolution2D);
+        builder.add_main(flatbuffers::Offset<void>(conv.o));
+        vec.push_back(builder.Finish());
+    }
+
+    auto ops   = fbb.CreateVector(vec);
+    auto names = fbb.CreateVectorOfStrings({"input", "conv"});
+    NetBuilder net(fbb);
+    net.add_oplists(ops);
+    net.add_tensorName(names);
+    fbb.Finish(net.Finish());
+    return Interpreter::createFromBuffer((const char*)fbb.GetBufferPointer(), fbb.GetSize());
+}
+
+class ImageInputTest : public MNNTestCase {
+public:
+    virtual ~ImageInputTest() = default;
+    virtual bool run() {
+        // winograd, tiled and 1x1 convolutions
+        const int kernels[][2] = {{3, 1}, {3, 2}, {1, 1}};
+        for (auto& k : kernels) {
+            for (int thread = 1; thread <= 4; thread *= 4) {
+                if (!_check(k[0], k[1], thread)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    bool _check(int kernel, int stride, int thread) {
+        const int w = 37, h = 29, oc = 8;
+        std::unique_ptr<Interpreter> net(create(kernel, stride, oc));
+        ScheduleConfig config;
+        config.numThread    = thread;
+        auto floatSession   = net->createSession(config);
+        ScheduleConfig::ImageInput image;
+        const float mean[3]   = {123.0f, 117.0f, 104.0f};
+        const float normal[3] = {0.017f, 0.018f, 0.0175f};
+        ::memcpy(image.mean, mean, sizeof(mean));
+        ::memcpy(image.normal, normal, sizeof(normal));
+        config.imageInputs    = {image};
+        auto imageSession     = net->createSession(config);
+
+        std::vector<unsigned char> pixels(w * h * 4);
+        for (int i = 0; i < pixels.size(); ++i) {
+            pixels[i] = (i * 37 + i / (4 * w) * 11) % 256;
+        }
+        ImageProcess::Config process;
+        process.sourceFormat = RGBA;
+        process.destFormat   = RGB;
+        ::memcpy(process.mean, mean, sizeof(mean));
+        ::memcpy(process.normal, normal, sizeof(normal));
+        std::shared_ptr<ImageProcess> converter(ImageProcess::create(process));
+
+        // normalized float input against uint8 image input
+        Session* sessions[2] = {floatSession, imageSession};
+        for (auto session : sessions) {
+            auto input = net->getSessionInput(session, nullptr);
+            net->resizeTensor(input, {1, 3, h, w});
+            net->resizeSession(session);
+            converter->convert(pixels.data(), w, h, 0, input);
+            net->runSession(session);
+        }
+        if (net->getSessionInput(imageSession, nullptr)->getType() != halide_type_of<uint8_t>()) {
+            MNN_ERROR("image input is not uint8\n");
+            return false;
+        }
+        auto expect = net->getSessionOutput(floatSession, nullptr);
+        auto output = net->getSessionOutput(imageSession, nullptr);
+        std::shared_ptr<Tensor> expectHost(new Tensor(expect, Tensor::CAFFE));
+        std::shared_ptr<Tensor> outputHost(new Tensor(output, Tensor::CAFFE));
+        expect->copyToHostTensor(expectHost.get());
+        output->copyToHostTensor(outputHost.get());
+        for (int i = 0; i < expectHost->elementSize(); ++i) {
+            const float e = expectHost->host<float>()[i];
+            const float v = outputHost->host<float>()[i];
+            if (fabsf(v - e) > 1e-3f * std::max(1.0f, fabsf(e))) {
+                MNN_ERROR("kernel %d, stride %d, thread %d: %f, expect %f at %d\n", kernel, stride, thread, v, e, i);
+                return false;
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(ImageInputTest, "core/image_input");
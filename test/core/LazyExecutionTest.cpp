@@ -0,0 +1,177 @@
+//
+//  LazyExecutionTest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2019/08/23.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <math.h>
+#include "Interpreter.hpp"
+#include "MNNTestSuite.h"
+#include "MNN_generated.h"
+
+using namespace MNN;
+
+static flatbuffers::Offset<Op> _createConv(flatbuffers::FlatBufferBuilder& fbb, const char* name, int output, int oc,
+                                          int ic, int kernel, float scale) {
+    auto ccb = Convolution2DCommonBuilder(fbb);
+    ccb.add_kernelX(kernel);
+    ccb.add_kernelY(kernel);
+    ccb.add_strideX(1);
+    ccb.add_strideY(1);
+    ccb.add_dilateX(1);
+    ccb.add_dilateY(1);
+    ccb.add_group(1);
+    ccb.add_padMode(PadMode_SAME);
+    ccb.add_outputCount(oc);
+    auto common = ccb.Finish();
+
+    std::vector<float> weight(oc * ic * kernel * kernel);
+    for (int i = 0; i < weight.size(); ++i) {
+        weight[i] = scale * ((i % 17) - 8) / 8.0f;
+    }
+    auto weights = fbb.CreateVector(weight);
+    auto biases  = fbb.CreateVector(std::vector<float>(oc, scale));
+    auto cb      = Convolution2DBuilder(fbb);
+    cb.add_common(common);
+    cb.add_weight(weights);
+    cb.add_bias(biases);
+    auto conv    = cb.Finish();
+    auto opName  = fbb.CreateString(name);
+    auto iv      = fbb.CreateVector(std::vector<int>({0}));
+    auto ov      = fbb.CreateVector(std::vector<int>({output}));
+
+    OpBuilder builder(fbb);
+    builder.add_type(OpType_Convolution);
+    builder.add_name(opName);
+    builder.add_inputIndexes(iv);
+    builder.add_outputIndexes(ov);
+    builder.add_main_type(OpParameter_Convolution2D);
+    builder.add_main(flatbuffers::Offset<void>(conv.o));
+    return builder.Finish();
+}
+
+// two heads sharing one input
+static Interpreter* create(int oc, int ic, int size) {
+    flatbuffers::FlatBufferBuilder fbb;
+    std::vector<flatbuffers::Offset<Op>> vec;
+    {
+        auto dims = fbb.CreateVector(std::vector<int>({1, ic, size, size}));
+        InputBuilder ib(fbb);
+        ib.add_dims(dims);
+        auto input = ib.Finish();
+        auto name  = fbb.CreateString("input");
+        auto iv    = fbb.CreateVector(std::vector<int>({0}));
+        auto ov    = fbb.CreateVector(std::vector<int>({0}));
+
+        OpBuilder builder(fbb);
+        builder.add_type(OpType_Input);
+        builder.add_name(name);
+        builder.add_inputIndexes(iv);
+        builder.add_outputIndexes(ov);
+        builder.add_main_type(OpParameter_Input);
+        builder.add_main(flatbuffers::Offset<void>(input.o));
+        vec.push_back(builder.Finish());
+    }
+    vec.push_back(_createConv(fbb, "a", 1, oc, ic, 3, 1.0f));
+    vec.push_back(_createConv(fbb, "b", 2, oc, ic, 1, -0.5f));
+
+    auto ops   = fbb.CreateVector(vec);
+    auto names = fbb.CreateVectorOfStrings({"input", "a", "b"});
+    NetBuilder net(fbb);
+    net.add_oplists(ops);
+    net.add_tensorName(names);
+    fbb.Finish(net.Finish());
+    return Interpreter::createFromBuffer((const char*)fbb.GetBufferPointer(), fbb.GetSize());
+}
+
+static void _fillInput(Interpreter* net, Session* session) {
+    auto input = net->getSessionInput(session, nullptr);
+    std::shared_ptr<Tensor> host(Tensor::createHostTensorFromDevice(input, false));
+    for (int i = 0; i < host->elementSize(); ++i) {
+        host->host<float>()[i] = (i % 13) / 13.0f;
+    }
+    input->copyFromHostTensor(host.get());
+}
+
+static std::shared_ptr<Tensor> _copyOutput(Interpreter* net, Session* session, const char* name) {
+    auto output = net->getSessionOutput(session, name);
+    std::shared_ptr<Tensor> host(Tensor::createHostTensorFromDevice(output, true));
+    return host;
+}
+
+static bool _equal(const Tensor* a, const Tensor* b) {
+    if (a->elementSize() != b->elementSize()) {
+        return false;
+    }
+    for (int i = 0; i < a->elementSize(); ++i) {
+        if (fabsf(a->host<float>()[i] - b->host<float>()[i]) > 1e-4f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static const SessionMemoryInfo::OpMemory* _find(const SessionMemoryInfo& info, const char* name) {
+    for (auto& op : info.ops) {
+        if (op.name == name) {
+            return &op;
+        }
+    }
+    return nullptr;
+}
+
+class LazyExecutionTest : public MNNTestCase {
+public:
+    virtual ~LazyExecutionTest() = default;
+    virtual bool run() {
+        const int oc = 8, ic = 8, size = 16;
+        std::unique_ptr<Interpreter> net(create(oc, ic, size));
+        ScheduleConfig config;
+        config.numThread = 1;
+        auto eager       = net->createSession(config);
+        _fillInput(net.get(), eager);
+        net->runSession(eager);
+        auto expectA = _copyOutput(net.get(), eager, "a");
+        auto expectB = _copyOutput(net.get(), eager, "b");
+
+        config.lazyExecution = true;
+        auto lazy            = net->createSession(config);
+        _fillInput(net.get(), lazy);
+        SessionMemoryInfo info;
+        net->getSessionInfo(lazy, Interpreter::MEMORY, &info);
+        MNNTEST_ASSERT(_find(info, "a")->lazy && 0 == _find(info, "a")->weight);
+
+        // skip head b, only a is created
+        auto before = [](const std::vector<Tensor*>&, const OperatorInfo* op) { return op->name() != "b"; };
+        auto after  = [](const std::vector<Tensor*>&, const OperatorInfo*) { return true; };
+        net->runSessionWithCallBackInfo(lazy, before, after);
+        MNNTEST_ASSERT(_equal(_copyOutput(net.get(), lazy, "a").get(), expectA.get()));
+        net->getSessionInfo(lazy, Interpreter::MEMORY, &info);
+#ifndef MNN_DEBUG_MEMORY
+        MNNTEST_ASSERT(_find(info, "a")->weight > 0);
+#endif
+        MNNTEST_ASSERT(0 == _find(info, "b")->weight);
+
+        net->runSession(lazy);
+        MNNTEST_ASSERT(_equal(_copyOutput(net.get(), lazy, "a").get(), expectA.get()));
+        MNNTEST_ASSERT(_equal(_copyOutput(net.get(), lazy, "b").get(), expectB.get()));
+
+        // with a tiny budget only the last created execution is kept, evicted ones are created again
+        config.lazyMemoryBudget = 1;
+        auto budget             = net->createSession(config);
+        _fillInput(net.get(), budget);
+        for (int i = 0; i < 2; ++i) {
+            net->runSession(budget);
+            MNNTEST_ASSERT(_equal(_copyOutput(net.get(), budget, "a").get(), expectA.get()));
+            MNNTEST_ASSERT(_equal(_copyOutput(net.get(), budget, "b").get(), expectB.get()));
+        }
+#ifndef MNN_DEBUG_MEMORY
+        net->getSessionInfo(budget, Interpreter::MEMORY, &info);
+        MNNTEST_ASSERT(0 == _find(info, "a")->weight && _find(info, "b")->weight > 0);
+#endif
+        return true;
+    }
+};
+MNNTestSuiteRegister(LazyExecutionTest, "core/lazy_execution");
@@ -26,6 +26,13 @@ public:
                 MNNTEST_ASSERT(((int *)ptr)[i] == 0);
             MNNMemoryFreeAlign(ptr);
         }
+        {
+            auto before = MNNMemoryAllocatedSize();
+            void *ptr   = MNNMemoryAllocAlign(100, 64);
+            MNNTEST_ASSERT(MNNMemoryAllocatedSize() - before == 100);
+            MNNMemoryFreeAlign(ptr);
+            MNNTEST_ASSERT(MNNMemoryAllocatedSize() == before);
+        }
         return true;
     }
 };
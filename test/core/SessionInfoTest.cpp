@@ -0,0 +1,129 @@
+//
+//  SessionInfoTest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2019/08/20.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "Interpreter.hpp"
+#include "MNNMemoryUtils.h"
+#include "MNNTestSuite.h"
+#include "MNN_generated.h"
+
+using namespace MNN;
+
+static Interpreter *create(int oc, int ic, int size, int kernel) {
+    flatbuffers::FlatBufferBuilder fbb;
+    std::vector<flatbuffers::Offset<Op>> vec;
+    {
+        auto dims = fbb.CreateVector(std::vector<int>({1, ic, size, size}));
+        InputBuilder ib(fbb);
+        ib.add_dims(dims);
+        auto input = ib.Finish();
+        auto name  = fbb.CreateString("input");
+        auto iv    = fbb.CreateVector(std::vector<int>({0}));
+        auto ov    = fbb.CreateVector(std::vector<int>({0}));
+
+        OpBuilder builder(fbb);
+        builder.add_type(OpType_Input);
+        builder.add_name(name);
+        builder.add_inputIndexes(iv);
+        builder.add_outputIndexes(ov);
+        builder.add_main_type(OpParameter_Input);
+        builder.add_main(flatbuffers::Offset<void>(input.o));
+        vec.push_back(builder.Finish());
+    }
+    {
+        auto ccb = Convolution2DCommonBuilder(fbb);
+        ccb.add_kernelX(kernel);
+        ccb.add_kernelY(kernel);
+        ccb.add_strideX(1);
+        ccb.add_strideY(1);
+        ccb.add_dilateX(1);
+        ccb.add_dilateY(1);
+        ccb.add_group(1);
+        ccb.add_padMode(PadMode_SAME);
+        ccb.add_outputCount(oc);
+        auto common = ccb.Finish();
+
+        auto weights = fbb.CreateVector(std::vector<float>(oc * ic * kernel * kernel, 0.1f));
+        auto biases  = fbb.CreateVector(std::vector<float>(oc, 0.0f));
+        auto cb      = Convolution2DBuilder(fbb);
+        cb.add_common(common);
+        cb.add_weight(weights);
+        cb.add_bias(biases);
+        auto conv = cb.Finish();
+        auto name = fbb.CreateString("conv");
+        auto iv   = fbb.CreateVector(std::vector<int>({0}));
+        auto ov   = fbb.CreateVector(std::vector<int>({1}));
+
+        OpBuilder builder(fbb);
+        builder.add_type(OpType_Convolution);
+        builder.add_name(name);
+        builder.add_inputIndexes(iv);
+        builder.add_outputIndexes(ov);
+        builder.add_main_type(OpParameter_Convolution2D);
+        builder.add_main(flatbuffers::Offset<void>(conv.o));
+        vec.push_back(builder.Finish());
+    }
+
+    auto ops   = fbb.CreateVector(vec);
+    auto names = fbb.CreateVectorOfStrings({"input", "output"});
+    NetBuilder net(fbb);
+    net.add_oplists(ops);
+    net.add_tensorName(names);
+    fbb.Finish(net.Finish());
+    return Interpreter::createFromBuffer((const char *)fbb.GetBufferPointer(), fbb.GetSize());
+}
+
+#ifndef MNN_DEBUG_MEMORY
+class SessionInfoTest : public MNNTestCase {
+public:
+    virtual ~SessionInfoTest() = default;
+    virtual bool run() {
+        const int oc = 16, ic = 16, size = 32, kernel = 3;
+        std::unique_ptr<Interpreter> net(create(oc, ic, size, kernel));
+        ScheduleConfig config;
+        config.numThread = 1;
+        auto session     = net->createSession(config);
+
+        SessionMemoryInfo info;
+        MNNTEST_ASSERT(net->getSessionInfo(session, Interpreter::MEMORY, &info));
+        MNNTEST_ASSERT(info.modelBuffer > 0);
+        // input op is not executed
+        MNNTEST_ASSERT(info.ops.size() == 1);
+        MNNTEST_ASSERT(info.ops[0].name == "conv");
+        // weight is repacked by execution, so at least the size of weight in model
+        MNNTEST_ASSERT(info.ops[0].weight >= oc * ic * kernel * kernel * sizeof(float));
+        MNNTEST_ASSERT(info.weight == info.ops[0].weight);
+        // output tensor at least
+        MNNTEST_ASSERT(info.dynamic >= oc * size * size * sizeof(float));
+        MNNTEST_ASSERT(info.total == info.modelBuffer + info.weight + info.dynamic);
+
+        float flops = 0.0f;
+        MNNTEST_ASSERT(net->getSessionInfo(session, Interpreter::FLOPS, &flops));
+        MNNTEST_ASSERT(flops > 0.0f);
+        MNNTEST_ASSERT(!net->getSessionInfo(session, Interpreter::ALL, &flops));
+
+        // dynamic memory is reset on resize rather than accumulated
+        auto input = net->getSessionInput(session, nullptr);
+        net->resizeTensor(input, {1, ic, size, size + 1});
+        net->resizeSession(session);
+        net->resizeTensor(input, {1, ic, size, size});
+        net->resizeSession(session);
+        SessionMemoryInfo resized;
+        net->getSessionInfo(session, Interpreter::MEMORY, &resized);
+        MNNTEST_ASSERT(resized.weight == info.weight);
+        MNNTEST_ASSERT(resized.dynamic <= info.dynamic + (size_t)ic * size * sizeof(float) * 2);
+
+        net->releaseModel();
+        SessionMemoryInfo released;
+        net->getSessionInfo(session, Interpreter::MEMORY, &released);
+        MNNTEST_ASSERT(released.modelBuffer == 0);
+        MNNTEST_ASSERT(released.weight == info.weight);
+        return true;
+    }
+};
+MNNTestSuiteRegister(SessionInfoTest, "core/session_info");
+#endif
@@ -6,6 +6,8 @@
 //  Copyright © 2018, Alibaba Group Holding Limited
 //
 
+#include <math.h>
+#include <algorithm>
 #include <memory>
 #include "ImageProcess.hpp"
 #include "MNNTestSuite.h"
@@ -496,7 +498,7 @@ public:
         auto pixels = nv12.get();
         for (int y = 0; y < sh; ++y) {
             auto pixelY  = pixels + sw * y;
-            auto pixelUV = pixels + sw * sh + y * (sw / 2);
+            auto pixelUV = pixels + sw * sh + (y / 2) * sw;
             int magicY   = ((sh - y) * (sh - y)) % 79;
             for (int x = 0; x < sw; ++x) {
                 auto pixelX = pixelY + x;
@@ -573,7 +575,7 @@ public:
         auto pixels = nv12.get();
         for (int y = 0; y < sh; ++y) {
             auto pixelY  = pixels + sw * y;
-            auto pixelUV = pixels + sw * sh + y * (sw / 2);
+            auto pixelUV = pixels + sw * sh + (y / 2) * sw;
             int magicY   = ((sh - y) * (sh - y)) % 79;
             for (int x = 0; x < sw; ++x) {
                 auto pixelX = pixelY + x;
@@ -629,3 +631,441 @@ public:
     }
 };
 MNNTestSuiteRegister(ImageProcessNV12ToRGBATest, "cv/image_process/nv12_to_rgba");
+
+class ImageProcessThreadsTest : public MNNTestCase {
+public:
+    virtual ~ImageProcessThreadsTest() = default;
+    virtual bool run() {
+        const ImageFormat formats[] = {RGBA, GRAY};
+        for (auto format : formats) {
+            if (!_check(format)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    static float _bilinear(const unsigned char* source, int sw, int sh, int bpp, float x, float y, int b) {
+        x      = std::max(std::min(x, (float)(sw - 1)), 0.0f);
+        y      = std::max(std::min(y, (float)(sh - 1)), 0.0f);
+        int x0 = (int)x;
+        int y0 = (int)y;
+        int x1 = std::min(x0 + 1, sw - 1);
+        int y1 = std::min(y0 + 1, sh - 1);
+
+        float xF = x - x0;
+        float yF = y - y0;
+        auto c   = [&](int px, int py) { return (float)source[(py * sw + px) * bpp + b]; };
+        return (1 - xF) * (1 - yF) * c(x0, y0) + xF * (1 - yF) * c(x1, y0) + (1 - xF) * yF * c(x0, y1) +
+               xF * yF * c(x1, y1);
+    }
+    bool _check(ImageFormat format) {
+        const int bpp = GRAY == format ? 1 : 4;
+        const int sw = 1920, sh = 1080, dw = 224, dh = 224;
+        // smooth so that rounding of sample positions moves values little
+        std::vector<unsigned char> pixels(sw * sh * bpp);
+        for (int y = 0; y < sh; ++y) {
+            for (int x = 0; x < sw; ++x) {
+                for (int b = 0; b < bpp; ++b) {
+                    pixels[(y * sw + x) * bpp + b] = 128 + (int)(100 * sinf(x * 0.05f + b) * cosf(y * 0.03f));
+                }
+            }
+        }
+        Matrix tr;
+        tr.setScale(1.0f / sw, 1.0f / sh);
+        tr.postRotate(15, 0.5f, 0.5f);
+        tr.postScale(dw, dh);
+        tr.invert(&tr);
+
+        // one band or many must give same values, each close to bilinear of source
+        std::shared_ptr<Tensor> results[2];
+        for (int i = 0; i < 2; ++i) {
+            ImageProcess::Config config;
+            config.sourceFormat = format;
+            config.destFormat   = format;
+            config.filterType   = BILINEAR;
+            config.numThread    = 0 == i ? 1 : 4;
+            std::shared_ptr<ImageProcess> process(ImageProcess::create(config));
+            process->setMatrix(tr);
+            results[i].reset(Tensor::create<float>(std::vector<int>{1, dh, dw, bpp}, nullptr, Tensor::TENSORFLOW));
+            process->convert(pixels.data(), sw, sh, 0, results[i].get());
+        }
+        auto single = results[0]->host<float>();
+        auto multi  = results[1]->host<float>();
+        for (int y = 0; y < dh; ++y) {
+            for (int x = 0; x < dw; ++x) {
+                auto p = tr.mapXY(x, y);
+                for (int b = 0; b < bpp; ++b) {
+                    const int index = (y * dw + x) * bpp + b;
+                    const float ref = _bilinear(pixels.data(), sw, sh, bpp, p.fX, p.fY, b);
+                    if (single[index] != multi[index] || fabsf(single[index] - ref) >= 2.0f) {
+                        MNN_ERROR("format %d, (%d, %d, %d): %f, threads %f, expect %f\n", format, x, y, b,
+                                  single[index], multi[index], ref);
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(ImageProcessThreadsTest, "cv/image_process/threads");
+
+class ImageProcessBatchTest : public MNNTestCase {
+public:
+    virtual ~ImageProcessBatchTest() = default;
+    virtual bool run() {
+        // float NC4HW4 and uint8 NHWC destinations
+        if (!_check(Tensor::CAFFE_C4, halide_type_of<float>())) {
+            return false;
+        }
+        return _check(Tensor::TENSORFLOW, halide_type_of<uint8_t>());
+    }
+
+private:
+    static std::vector<int> _shape(Tensor::DimensionType dimensionType, int batch, int h, int w) {
+        if (Tensor::TENSORFLOW == dimensionType) {
+            return {batch, h, w, 3};
+        }
+        return {batch, 3, h, w};
+    }
+    bool _check(Tensor::DimensionType dimensionType, halide_type_t type) {
+        const int dw = 64, dh = 48, batch = 4, count = 3;
+        const int sizes[count][2] = {{320, 240}, {100, 180}, {64, 48}};
+        std::vector<std::vector<unsigned char>> pixels(count);
+        std::vector<ImageProcess::Image> images(count);
+        for (int i = 0; i < count; ++i) {
+            const int sw = sizes[i][0], sh = sizes[i][1];
+            pixels[i].resize(sw * sh * 4);
+            for (int j = 0; j < pixels[i].size(); ++j) {
+                pixels[i][j] = (j * (i + 3) + j / (sw * 4) * 7) % 255;
+            }
+            images[i].source = pixels[i].data();
+            images[i].width  = sw;
+            images[i].height = sh;
+            // crop, rotate or nothing
+            if (0 == i) {
+                images[i].matrix.setScale(0.5f, 0.5f);
+                images[i].matrix.postTranslate(100.0f, 60.0f);
+            } else if (1 == i) {
+                images[i].matrix.setScale((float)sw / dw, (float)sh / dh);
+                images[i].matrix.postRotate(20, sw / 2.0f, sh / 2.0f);
+            }
+        }
+        ImageProcess::Config config;
+        config.sourceFormat = RGBA;
+        config.destFormat   = BGR;
+        config.filterType   = BILINEAR;
+        config.numThread    = 4;
+        config.mean[0]      = 127.5f;
+        config.normal[0]    = 1.0f / 127.5f;
+        std::shared_ptr<ImageProcess> process(ImageProcess::create(config));
+        std::shared_ptr<Tensor> tensor(
+            Tensor::create(_shape(dimensionType, batch, dh, dw), type, nullptr, dimensionType));
+        ::memset(tensor->host<void>(), 0, tensor->size());
+        if (NO_ERROR != process->convert(images, tensor.get())) {
+            MNN_ERROR("batched convert failed\n");
+            return false;
+        }
+
+        // each batch as converted alone, rest untouched
+        const int batchBytes = tensor->size() / batch;
+        for (int i = 0; i < batch; ++i) {
+            auto slot = tensor->host<uint8_t>() + i * batchBytes;
+            if (i >= count) {
+                for (int j = 0; j < batchBytes; ++j) {
+                    if (0 != slot[j]) {
+                        MNN_ERROR("batch %d written without image\n", i);
+                        return false;
+                    }
+                }
+                continue;
+            }
+            std::shared_ptr<Tensor> single(
+                Tensor::create(_shape(dimensionType, 1, dh, dw), type, nullptr, dimensionType));
+            ::memset(single->host<void>(), 0, single->size());
+            process->setMatrix(images[i].matrix);
+            process->convert(images[i].source, images[i].width, images[i].height, 0, single.get());
+            if (single->size() != batchBytes || 0 != ::memcmp(single->host<void>(), slot, batchBytes)) {
+                MNN_ERROR("batch %d differs from image converted alone\n", i);
+                return false;
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(ImageProcessBatchTest, "cv/image_process/batch");
+
+class ImageProcessYUVResizeTest : public MNNTestCase {
+public:
+    virtual ~ImageProcessYUVResizeTest() = default;
+    virtual bool run() {
+        const ImageFormat formats[] = {YUV_NV21, YUV_NV12, YUV_I420};
+        for (auto format : formats) {
+            if (!_check(format)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    // smooth planes, so that sampling them is close to the functions themselves
+    static float _y(float x, float y) {
+        return 128.0f + 80.0f * sinf(x * 0.03f) * cosf(y * 0.04f);
+    }
+    static float _u(float x, float y) {
+        return 128.0f + 40.0f * sinf(y * 0.02f + x * 0.01f);
+    }
+    static float _v(float x, float y) {
+        return 128.0f + 40.0f * cosf(x * 0.025f);
+    }
+    bool _check(ImageFormat format) {
+        const int sw = 320, sh = 240, dw = 128, dh = 96;
+        std::vector<unsigned char> pixels(sw * sh * 3 / 2);
+        auto chroma = pixels.data() + sw * sh;
+        for (int y = 0; y < sh; ++y) {
+            for (int x = 0; x < sw; ++x) {
+                pixels[y * sw + x] = (unsigned char)roundf(_y(x, y));
+            }
+        }
+        for (int y = 0; y < sh / 2; ++y) {
+            for (int x = 0; x < sw / 2; ++x) {
+                // chroma at center of its 2x2 luma
+                auto u = (unsigned char)roundf(_u(2 * x + 0.5f, 2 * y + 0.5f));
+                auto v = (unsigned char)roundf(_v(2 * x + 0.5f, 2 * y + 0.5f));
+                if (YUV_I420 == format) {
+                    chroma[y * sw / 2 + x]               = u;
+                    chroma[sw * sh / 4 + y * sw / 2 + x] = v;
+                } else {
+                    chroma[y * sw + 2 * x + 0] = YUV_NV12 == format ? u : v;
+                    chroma[y * sw + 2 * x + 1] = YUV_NV12 == format ? v : u;
+                }
+            }
+        }
+
+        ImageProcess::Config config;
+        config.sourceFormat = format;
+        config.destFormat   = BGR;
+        config.filterType   = BILINEAR;
+
+        const float mean[3]   = {103.94f, 116.78f, 123.68f};
+        const float normal[3] = {0.017f, 0.017f, 0.017f};
+        ::memcpy(config.mean, mean, sizeof(mean));
+        ::memcpy(config.normal, normal, sizeof(normal));
+        std::shared_ptr<ImageProcess> process(ImageProcess::create(config));
+        Matrix tr;
+        tr.setScale((float)sw / dw, (float)sh / dh);
+        process->setMatrix(tr);
+        std::shared_ptr<Tensor> tensor(
+            Tensor::create<float>(std::vector<int>{1, 3, dh, dw}, nullptr, Tensor::CAFFE_C4));
+        process->convert(pixels.data(), sw, sh, 0, tensor.get());
+
+        auto output = tensor->host<float>();
+        for (int y = 0; y < dh; ++y) {
+            for (int x = 0; x < dw; ++x) {
+                auto p  = tr.mapXY(x, y);
+                float Y = _y(p.fX, p.fY);
+                float U = _u(p.fX, p.fY) - 128.0f;
+                float V = _v(p.fX, p.fY) - 128.0f;
+                // bgr
+                const float expects[3] = {Y + 2.03125f * U, Y - 0.390625f * U - 0.578125f * V, Y + 1.140625f * V};
+                auto pixel             = output + 4 * (y * dw + x);
+                for (int c = 0; c < 3; ++c) {
+                    const float value  = pixel[c] / normal[c] + mean[c];
+                    const float expect = std::min(std::max(expects[c], 0.0f), 255.0f);
+                    if (fabsf(value - expect) > 4.0f) {
+                        MNN_ERROR("format %d, (%d, %d, %d): %f, expect %f\n", format, x, y, c, value, expect);
+                        return false;
+                    }
+                }
+                if (0.0f != pixel[3]) {
+                    MNN_ERROR("format %d, (%d, %d): padding %f\n", format, x, y, pixel[3]);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(ImageProcessYUVResizeTest, "cv/image_process/yuv_resize");
+
+class ImageProcessFilterTest : public MNNTestCase {
+public:
+    virtual ~ImageProcessFilterTest() = default;
+    virtual bool run() {
+        const ImageFormat formats[] = {GRAY, RGB, RGBA};
+        for (auto format : formats) {
+            if (!_checkArea(format) || !_checkBicubic(format)) {
+                return false;
+            }
+        }
+        return _checkAreaYUV(GRAY) && _checkAreaYUV(RGB);
+    }
+
+private:
+    static int _bpp(ImageFormat format) {
+        return GRAY == format ? 1 : (RGB == format ? 3 : 4);
+    }
+    static std::shared_ptr<Tensor> _convert(ImageFormat source, ImageFormat dest, Filter filter, const Matrix& matrix,
+                                            const unsigned char* pixels, int sw, int sh, int dw, int dh) {
+        ImageProcess::Config config;
+        config.sourceFormat = source;
+        config.destFormat   = dest;
+        config.filterType   = filter;
+        std::shared_ptr<ImageProcess> process(ImageProcess::create(config));
+        process->setMatrix(matrix);
+        std::shared_ptr<Tensor> tensor(
+            Tensor::create<uint8_t>(std::vector<int>{1, dh, dw, _bpp(dest)}, nullptr, Tensor::TENSORFLOW));
+        process->convert(pixels, sw, sh, 0, tensor.get());
+        return tensor;
+    }
+    // constant in each 4x4 block, which downscale by 4 averages to itself
+    static int _block(int x, int y, int c) {
+        return ((x / 4) * 37 + (y / 4) * 91 + c * 53) % 256;
+    }
+    bool _checkArea(ImageFormat format) {
+        const int sw = 256, sh = 192, dw = 64, dh = 48, bpp = _bpp(format);
+        std::vector<unsigned char> pixels(sw * sh * bpp);
+        for (int y = 0; y < sh; ++y) {
+            for (int x = 0; x < sw; ++x) {
+                for (int c = 0; c < bpp; ++c) {
+                    pixels[(y * sw + x) * bpp + c] = _block(x, y, c);
+                }
+            }
+        }
+        Matrix matrix;
+        matrix.setScale(4.0f, 4.0f);
+        auto tensor = _convert(format, format, AREA, matrix, pixels.data(), sw, sh, dw, dh);
+        auto output = tensor->host<uint8_t>();
+        for (int y = 0; y < dh; ++y) {
+            for (int x = 0; x < dw; ++x) {
+                for (int c = 0; c < bpp; ++c) {
+                    const int expect = _block(4 * x, 4 * y, c);
+                    if (abs(output[(y * dw + x) * bpp + c] - expect) > 1) {
+                        MNN_ERROR("area of format %d, (%d, %d, %d): %d, expect %d\n", format, x, y, c,
+                                  output[(y * dw + x) * bpp + c], expect);
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+    // bicubic reproduces linear ramp between edges
+    bool _checkBicubic(ImageFormat format) {
+        const int sw = 100, sh = 60, dw = 80, dh = 48, bpp = _bpp(format);
+        std::vector<unsigned char> pixels(sw * sh * bpp);
+        for (int y = 0; y < sh; ++y) {
+            for (int x = 0; x < sw; ++x) {
+                for (int c = 0; c < bpp; ++c) {
+                    pixels[(y * sw + x) * bpp + c] = x + y + c * 20;
+                }
+            }
+        }
+        Matrix matrix;
+        matrix.setScale(0.7f, 0.7f);
+        matrix.postTranslate(10.3f, 5.6f);
+        auto tensor = _convert(format, format, BICUBIC, matrix, pixels.data(), sw, sh, dw, dh);
+        auto output = tensor->host<uint8_t>();
+        for (int y = 0; y < dh; ++y) {
+            for (int x = 0; x < dw; ++x) {
+                auto p = matrix.mapXY(x, y);
+                for (int c = 0; c < bpp; ++c) {
+                    const float expect = p.fX + p.fY + c * 20;
+                    if (fabsf(output[(y * dw + x) * bpp + c] - expect) > 1.0f) {
+                        MNN_ERROR("bicubic of format %d, (%d, %d, %d): %d, expect %f\n", format, x, y, c,
+                                  output[(y * dw + x) * bpp + c], expect);
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+    // luma constant in 4x4 blocks and neutral chroma, so that every channel is luma
+    bool _checkAreaYUV(ImageFormat dest) {
+        const int sw = 256, sh = 192, dw = 64, dh = 48, bpp = _bpp(dest);
+        std::vector<unsigned char> pixels(sw * sh * 3 / 2, 128);
+        for (int y = 0; y < sh; ++y) {
+            for (int x = 0; x < sw; ++x) {
+                pixels[y * sw + x] = _block(x, y, 0);
+            }
+        }
+        Matrix matrix;
+        matrix.setScale(4.0f, 4.0f);
+        auto tensor = _convert(YUV_NV21, dest, AREA, matrix, pixels.data(), sw, sh, dw, dh);
+        auto output = tensor->host<uint8_t>();
+        for (int y = 0; y < dh; ++y) {
+            for (int x = 0; x < dw; ++x) {
+                const int expect = _block(4 * x, 4 * y, 0);
+                for (int c = 0; c < bpp; ++c) {
+                    if (abs(output[(y * dw + x) * bpp + c] - expect) > 1) {
+                        MNN_ERROR("area of nv21 to %d, (%d, %d, %d): %d, expect %d\n", dest, x, y, c,
+                                  output[(y * dw + x) * bpp + c], expect);
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(ImageProcessFilterTest, "cv/image_process/filter");
+
+class ImageProcessRegionsTest : public MNNTestCase {
+public:
+    virtual ~ImageProcessRegionsTest() = default;
+    virtual bool run() {
+        const int sw = 200, sh = 150, dw = 32, dh = 24, count = 5;
+        std::vector<unsigned char> pixels(sw * sh * 4);
+        for (int i = 0; i < pixels.size(); ++i) {
+            pixels[i] = (i * 13 + i / (sw * 4) * 5) % 255;
+        }
+        // regions inside, across edge, upscaled and rotated
+        const float rects[count - 1][4] = {{10, 20, 64, 48}, {170, -10, 60, 40}, {90, 70, 16, 12}, {0, 0, 200, 150}};
+        std::vector<Matrix> matrices(count);
+        for (int i = 0; i < count - 1; ++i) {
+            auto& r = rects[i];
+            matrices[i].setRectToRect(Rect::MakeWH(dw, dh), Rect::MakeXYWH(r[0], r[1], r[2], r[3]),
+                                      Matrix::kFill_ScaleToFit);
+        }
+        const Point dst[3] = {{0, 0}, {(float)dw, 0}, {0, (float)dh}};
+        const Point src[3] = {{60, 40}, {120, 70}, {40, 80}};
+        matrices[count - 1].setPolyToPoly(dst, src, 3);
+
+        const Filter filters[] = {NEAREST, BILINEAR};
+        for (auto filter : filters) {
+            ImageProcess::Config config;
+            config.sourceFormat = RGBA;
+            config.destFormat   = RGB;
+            config.filterType   = filter;
+            config.wrap         = ZERO;
+            config.numThread    = 4;
+            config.mean[1]      = 127.5f;
+            config.normal[1]    = 1.0f / 127.5f;
+            std::shared_ptr<ImageProcess> process(ImageProcess::create(config));
+            std::shared_ptr<Tensor> tensor(
+                Tensor::create(std::vector<int>{count, 3, dh, dw}, halide_type_of<float>(), nullptr, Tensor::CAFFE_C4));
+            if (NO_ERROR != process->convert(pixels.data(), sw, sh, 0, matrices, tensor.get())) {
+                MNN_ERROR("regions convert failed\n");
+                return false;
+            }
+            // each region as converted alone
+            const int batchBytes = tensor->size() / count;
+            for (int i = 0; i < count; ++i) {
+                std::shared_ptr<Tensor> single(
+                    Tensor::create(std::vector<int>{1, 3, dh, dw}, halide_type_of<float>(), nullptr, Tensor::CAFFE_C4));
+                process->setMatrix(matrices[i]);
+                process->convert(pixels.data(), sw, sh, 0, single.get());
+                if (0 != ::memcmp(single->host<void>(), tensor->host<uint8_t>() + i * batchBytes, batchBytes)) {
+                    MNN_ERROR("region %d with filter %d differs from region converted alone\n", i, filter);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(ImageProcessRegionsTest, "cv/image_process/regions");
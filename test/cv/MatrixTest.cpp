@@ -6,6 +6,7 @@
 //  Copyright © 2018, Alibaba Group Holding Limited
 //
 
+#include <math.h>
 #include "MNNTestSuite.h"
 #include "Matrix.h"
 
@@ -27,3 +28,24 @@ public:
     }
 };
 MNNTestSuiteRegister(MatrixScaleTest, "cv/matrix/scale");
+
+class MatrixPolyToPolyTest : public MNNTestCase {
+public:
+    virtual ~MatrixPolyToPolyTest() = default;
+    virtual bool run() {
+        // affine by three points, perspective by four
+        const Point src[4] = {{0, 0}, {0, 10}, {10, 10}, {10, 0}};
+        const Point dst[4] = {{5, 3}, {1, 12}, {12, 17}, {14, 6}};
+        for (int count = 1; count <= 4; ++count) {
+            Matrix m;
+            MNNTEST_ASSERT(m.setPolyToPoly(src, dst, count));
+            for (int i = 0; i < count; ++i) {
+                Point p;
+                m.mapXY(src[i].fX, src[i].fY, &p);
+                MNNTEST_ASSERT(fabsf(p.fX - dst[i].fX) < 1e-3f && fabsf(p.fY - dst[i].fY) < 1e-3f);
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(MatrixPolyToPolyTest, "cv/matrix/poly_to_poly");
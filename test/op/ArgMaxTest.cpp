@@ -0,0 +1,117 @@
+//
+//  ArgMaxTest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2019/08/27.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <algorithm>
+#include "Interpreter.hpp"
+#include "MNNTestSuite.h"
+#include "MNN_generated.h"
+
+using namespace MNN;
+
+static Interpreter *create(int channel, int width, int topK, bool outMaxVal, bool softmaxThreshold) {
+    flatbuffers::FlatBufferBuilder fbb;
+    std::vector<flatbuffers::Offset<Op>> vec;
+    {
+        auto dims = fbb.CreateVector(std::vector<int>({1, channel, 1, width}));
+        InputBuilder ib(fbb);
+        ib.add_dims(dims);
+        auto input = ib.Finish();
+        auto name  = fbb.CreateString("input");
+        auto iv    = fbb.CreateVector(std::vector<int>({0}));
+        auto ov    = fbb.CreateVector(std::vector<int>({0}));
+
+        OpBuilder builder(fbb);
+        builder.add_type(OpType_Input);
+        builder.add_name(name);
+        builder.add_inputIndexes(iv);
+        builder.add_outputIndexes(ov);
+        builder.add_main_type(OpParameter_Input);
+        builder.add_main(flatbuffers::Offset<void>(input.o));
+        vec.push_back(builder.Finish());
+    }
+    {
+        ArgMaxBuilder ab(fbb);
+        ab.add_topK(topK);
+        ab.add_outMaxVal(outMaxVal);
+        ab.add_softmaxThreshold(softmaxThreshold);
+        auto param = ab.Finish();
+        auto name  = fbb.CreateString("argmax");
+        auto iv    = fbb.CreateVector(std::vector<int>({0}));
+        auto ov    = fbb.CreateVector(std::vector<int>({1}));
+
+        OpBuilder builder(fbb);
+        builder.add_type(OpType_ArgMax);
+        builder.add_name(name);
+        builder.add_inputIndexes(iv);
+        builder.add_outputIndexes(ov);
+        builder.add_main_type(OpParameter_ArgMax);
+        builder.add_main(flatbuffers::Offset<void>(param.o));
+        vec.push_back(builder.Finish());
+    }
+    auto ops   = fbb.CreateVector(vec);
+    auto names = fbb.CreateVectorOfStrings({"input", "output"});
+    NetBuilder net(fbb);
+    net.add_oplists(ops);
+    net.add_tensorName(names);
+    fbb.Finish(net.Finish());
+    return Interpreter::createFromBuffer((const char *)fbb.GetBufferPointer(), fbb.GetSize());
+}
+
+class ArgMaxTest : public MNNTestCase {
+public:
+    virtual ~ArgMaxTest() = default;
+    virtual bool run() {
+        const int channel = 3, width = 200;
+        for (int topK : {1, 5}) {
+            for (bool threshold : {false, true}) {
+                // repeated values, the first one goes first
+                std::vector<float> data(channel * width);
+                for (int i = 0; i < data.size(); ++i) {
+                    data[i] = (rand() % 50) / 5000.0f;
+                }
+                std::unique_ptr<Interpreter> net(create(channel, width, topK, true, threshold));
+                ScheduleConfig config;
+                auto session = net->createSession(config);
+                auto input   = net->getSessionInput(session, nullptr);
+                std::unique_ptr<Tensor> inputHost(new Tensor(input, Tensor::CAFFE));
+                ::memcpy(inputHost->host<float>(), data.data(), data.size() * sizeof(float));
+                input->copyFromHostTensor(inputHost.get());
+                net->runSession(session);
+                auto output = net->getSessionOutput(session, nullptr);
+                std::unique_ptr<Tensor> host(new Tensor(output, Tensor::CAFFE));
+                output->copyToHostTensor(host.get());
+
+                for (int c = 0; c < channel; ++c) {
+                    auto row = data.data() + c * width;
+                    std::vector<int> order;
+                    for (int i = 0; i < width; ++i) {
+                        if (!threshold || row[i] >= 1.0f / width) {
+                            order.push_back(i);
+                        }
+                    }
+                    std::stable_sort(order.begin(), order.end(), [row](int a, int b) { return row[a] > row[b]; });
+                    if (threshold && topK > 1) {
+                        // ties are not ordered with threshold, only values are checked
+                        for (int j = 0; j < topK && j < order.size(); ++j) {
+                            MNNTEST_ASSERT(host->host<float>()[c * 2 * topK + topK + j] == row[order[j]]);
+                        }
+                        continue;
+                    }
+                    for (int j = 0; j < topK; ++j) {
+                        float index = j < order.size() ? order[j] : 0.0f;
+                        float value = j < order.size() ? row[order[j]] : 0.0f;
+                        MNNTEST_ASSERT(host->host<float>()[c * 2 * topK + j] == index);
+                        MNNTEST_ASSERT(host->host<float>()[c * 2 * topK + topK + j] == value);
+                    }
+                }
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(ArgMaxTest, "op/argmax");
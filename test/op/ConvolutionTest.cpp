@@ -6,6 +6,7 @@
 //  Copyright © 2018, Alibaba Group Holding Limited
 //
 
+#include <math.h>
 #include "Interpreter.hpp"
 #include "MNNTestSuite.h"
 #include "MNN_generated.h"
@@ -632,7 +633,74 @@ public:
     }
 };
 
+class Convolution1x1StrassenTest : public MNNTestCase {
+public:
+    virtual ~Convolution1x1StrassenTest() = default;
+    virtual bool run() {
+        // input channel, output channel, size: large enough to expand a few levels, odd plane for tail column
+        const int shapes[][3] = {{256, 256, 28}, {512, 512, 14}, {1024, 256, 7}, {64, 64, 56}};
+        for (auto &shape : shapes) {
+            for (int high = 0; high <= 1; ++high) {
+                for (int thread = 1; thread <= 4; thread *= 4) {
+                    if (!_check(shape[0], shape[1], shape[2], high, thread)) {
+                        MNN_ERROR("1x1 conv %d -> %d of %d x %d, memory high %d with %d threads failed\n", shape[0],
+                                  shape[1], shape[2], shape[2], high, thread);
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    bool _check(int c, int o, int is, bool high, int thread) {
+        // non-negative and less than 6, so that random relu / relu6 changes nothing
+        std::vector<float> wt, bias;
+        for (int i = 0; i < o * c; i++) {
+            wt.push_back(rand() % 255 / 255.f / c);
+        }
+        for (int i = 0; i < o; i++) {
+            bias.push_back(rand() % 255 / 255.f);
+        }
+        std::unique_ptr<Interpreter> net(create(o, is, is, c, 1, 1, 1, 1, 1, 0, 1, wt, bias, false));
+        ScheduleConfig config;
+        BackendConfig backendConfig;
+        backendConfig.memory = high ? BackendConfig::Memory_High : BackendConfig::Memory_Normal;
+        config.numThread     = thread;
+        config.backendConfig = &backendConfig;
+        auto session         = net->createSession(config);
+        auto input           = net->getSessionInput(session, nullptr);
+        std::shared_ptr<Tensor> inputHost(new Tensor(input, Tensor::CAFFE));
+        for (int i = 0; i < inputHost->elementSize(); ++i) {
+            inputHost->host<float>()[i] = rand() % 255 / 255.f;
+        }
+        input->copyFromHostTensor(inputHost.get());
+        net->runSession(session);
+        auto output = net->getSessionOutput(session, nullptr);
+        std::shared_ptr<Tensor> outputHost(new Tensor(output, Tensor::CAFFE));
+        output->copyToHostTensor(outputHost.get());
+
+        const int plane = is * is;
+        auto src        = inputHost->host<float>();
+        for (int oz = 0; oz < o; ++oz) {
+            for (int p = 0; p < plane; ++p) {
+                float expect = bias[oz];
+                for (int sz = 0; sz < c; ++sz) {
+                    expect += src[sz * plane + p] * wt[oz * c + sz];
+                }
+                const float value = outputHost->host<float>()[oz * plane + p];
+                if (fabsf(value - expect) > 1e-4f * std::max(1.0f, fabsf(expect))) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+};
+
 MNNTestSuiteRegister(ConvolutionTest, "op/convolution/conv");
+MNNTestSuiteRegister(Convolution1x1StrassenTest, "op/convolution/conv1x1_strassen");
 MNNTestSuiteRegister(QuantizedConvolutionTest, "op/convolution/qnt_conv");
 MNNTestSuiteRegister(DepthwiseConvolutionTest, "op/convolution/depthwise_conv");
 MNNTestSuiteRegister(QuantizedDepthwiseConvolutionTest, "op/convolution/qnt_depthwise_conv");
@@ -6,6 +6,7 @@
 //  Copyright © 2018, Alibaba Group Holding Limited
 //
 
+#include <math.h>
 #include "Interpreter.hpp"
 #include "MNNTestSuite.h"
 #include "MNN_generated.h"
@@ -258,3 +259,88 @@ public:
 MNNTestSuiteRegister(DeconvolutionTest, "op/deconvolution/deconv");
 MNNTestSuiteRegister(DepthwiseDeconvolutionTest, "op/deconvolution/depthwise_deconv");
 // deconv do not support group now
+
+class DeconvolutionReferenceTest : public MNNTestCase {
+public:
+    virtual ~DeconvolutionReferenceTest() = default;
+    virtual bool run() {
+        // kernel, stride, pad: phases without taps, of 1 or 2 taps, square for Winograd, and channels not of 4
+        const int params[][3] = {{1, 2, 0}, {2, 2, 0}, {3, 2, 1}, {4, 2, 1}, {3, 1, 1}, {5, 3, 2}, {2, 1, 0}};
+        const int channels[][2] = {{3, 5}, {8, 8}, {32, 32}};
+        for (auto &param : params) {
+            for (auto &channel : channels) {
+                for (int thread = 1; thread <= 4; thread *= 3) {
+                    if (!_check(channel[0], channel[1], 2, 7, param[0], param[1], param[2], thread)) {
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    bool _check(int c, int o, int b, int is, int k, int s, int p, int thread) {
+        std::vector<float> wt, bias;
+        for (int i = 0; i < c * o * k * k; i++) {
+            wt.push_back((rand() % 1000) / 1000.0f - 0.5f);
+        }
+        for (int i = 0; i < o; i++) {
+            bias.push_back((rand() % 1000) / 1000.0f - 0.5f);
+        }
+        std::unique_ptr<Interpreter> net(create(o, is, c, b, 1, k, k, s, p, 1, wt, bias, false));
+        ScheduleConfig config;
+        config.numThread = thread;
+        auto session     = net->createSession(config);
+        auto input       = net->getSessionInput(session, nullptr);
+        std::unique_ptr<Tensor> inputHost(new Tensor(input, Tensor::CAFFE));
+        auto data = inputHost->host<float>();
+        for (int i = 0; i < b * c * is * is; ++i) {
+            data[i] = (rand() % 1000) / 1000.0f - 0.5f;
+        }
+        input->copyFromHostTensor(inputHost.get());
+        net->runSession(session);
+        auto output = net->getSessionOutput(session, nullptr);
+        std::unique_ptr<Tensor> host(new Tensor(output, Tensor::CAFFE));
+        output->copyToHostTensor(host.get());
+
+        // every input scatters its kernel, weight is [c][o][k][k]
+        const int os = output->height();
+        std::vector<float> expect(b * o * os * os);
+        for (int n = 0; n < b; ++n) {
+            for (int z = 0; z < o; ++z) {
+                for (int i = 0; i < os * os; ++i) {
+                    expect[(n * o + z) * os * os + i] = bias[z];
+                }
+                for (int i = 0; i < c; ++i) {
+                    for (int iy = 0; iy < is; ++iy) {
+                        for (int ix = 0; ix < is; ++ix) {
+                            const float v = data[((n * c + i) * is + iy) * is + ix];
+                            for (int ky = 0; ky < k; ++ky) {
+                                const int oy = iy * s - p + ky;
+                                for (int kx = 0; kx < k; ++kx) {
+                                    const int ox = ix * s - p + kx;
+                                    if (oy < 0 || oy >= os || ox < 0 || ox >= os) {
+                                        continue;
+                                    }
+                                    expect[((n * o + z) * os + oy) * os + ox] +=
+                                        v * wt[((i * o + z) * k + ky) * k + kx];
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        for (int i = 0; i < (int)expect.size(); ++i) {
+            const float value = host->host<float>()[i];
+            if (fabsf(value - expect[i]) > 1e-3f * (1.0f + fabsf(expect[i]))) {
+                MNN_ERROR("deconv %d/%d/%d of %dx%dx%dx%d to %d, thread %d: %f, expect %f at %d\n", k, s, p, b, c,
+                          is, is, o, thread, value, expect[i], i);
+                return false;
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(DeconvolutionReferenceTest, "op/deconvolution/reference");
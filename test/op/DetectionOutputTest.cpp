@@ -0,0 +1,200 @@
+//
+//  DetectionOutputTest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2019/08/26.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <math.h>
+#include <algorithm>
+#include "Interpreter.hpp"
+#include "MNNTestSuite.h"
+#include "MNN_generated.h"
+
+using namespace MNN;
+
+static flatbuffers::Offset<Op> _input(flatbuffers::FlatBufferBuilder &fbb, const char *name, int output,
+                                      const std::vector<int> &dims) {
+    auto d = fbb.CreateVector(dims);
+    InputBuilder ib(fbb);
+    ib.add_dims(d);
+    auto input = ib.Finish();
+    auto n     = fbb.CreateString(name);
+    auto iv    = fbb.CreateVector(std::vector<int>({output}));
+    auto ov    = fbb.CreateVector(std::vector<int>({output}));
+
+    OpBuilder builder(fbb);
+    builder.add_type(OpType_Input);
+    builder.add_name(n);
+    builder.add_inputIndexes(iv);
+    builder.add_outputIndexes(ov);
+    builder.add_main_type(OpParameter_Input);
+    builder.add_main(flatbuffers::Offset<void>(input.o));
+    return builder.Finish();
+}
+
+static Interpreter *create(int priorCount, int classCount, float nmsThreshold, int nmsTopK, int keepTopK,
+                           float confidenceThreshold) {
+    flatbuffers::FlatBufferBuilder fbb;
+    std::vector<flatbuffers::Offset<Op>> vec;
+    vec.push_back(_input(fbb, "location", 0, {1, 4 * priorCount, 1, 1}));
+    vec.push_back(_input(fbb, "confidence", 1, {1, priorCount * classCount, 1, 1}));
+    vec.push_back(_input(fbb, "priorbox", 2, {1, 2, 4 * priorCount, 1}));
+    {
+        DetectionOutputBuilder db(fbb);
+        db.add_classCount(classCount);
+        db.add_nmsThresholdold(nmsThreshold);
+        db.add_nmsTopK(nmsTopK);
+        db.add_keepTopK(keepTopK);
+        db.add_confidenceThreshold(confidenceThreshold);
+        auto param = db.Finish();
+        auto name  = fbb.CreateString("detection_out");
+        auto iv    = fbb.CreateVector(std::vector<int>({0, 1, 2}));
+        auto ov    = fbb.CreateVector(std::vector<int>({3}));
+
+        OpBuilder builder(fbb);
+        builder.add_type(OpType_DetectionOutput);
+        builder.add_name(name);
+        builder.add_inputIndexes(iv);
+        builder.add_outputIndexes(ov);
+        builder.add_main_type(OpParameter_DetectionOutput);
+        builder.add_main(flatbuffers::Offset<void>(param.o));
+        vec.push_back(builder.Finish());
+    }
+    auto ops   = fbb.CreateVector(vec);
+    auto names = fbb.CreateVectorOfStrings({"location", "confidence", "priorbox", "detection_out"});
+    NetBuilder net(fbb);
+    net.add_oplists(ops);
+    net.add_tensorName(names);
+    fbb.Finish(net.Finish());
+    return Interpreter::createFromBuffer((const char *)fbb.GetBufferPointer(), fbb.GetSize());
+}
+
+static void _fill(Interpreter *net, Session *session, const char *name, const std::vector<float> &data) {
+    auto input = net->getSessionInput(session, name);
+    std::unique_ptr<Tensor> host(new Tensor(input, Tensor::CAFFE));
+    ::memcpy(host->host<float>(), data.data(), data.size() * sizeof(float));
+    input->copyFromHostTensor(host.get());
+}
+
+// straightforward ssd post processing, each result is label, score, xmin, ymin, xmax, ymax
+static std::vector<std::vector<float>> _reference(const std::vector<float> &location,
+                                                  const std::vector<float> &confidence,
+                                                  const std::vector<float> &priorbox, int priorCount, int classCount,
+                                                  float nmsThreshold, int nmsTopK, int keepTopK,
+                                                  float confidenceThreshold) {
+    std::vector<std::vector<float>> boxes(priorCount);
+    for (int i = 0; i < priorCount; ++i) {
+        auto pb = priorbox.data() + 4 * i, var = priorbox.data() + 4 * priorCount + 4 * i;
+        auto loc   = location.data() + 4 * i;
+        float pbW  = pb[2] - pb[0], pbH = pb[3] - pb[1];
+        float cx   = var[0] * loc[0] * pbW + (pb[0] + pb[2]) * 0.5f;
+        float cy   = var[1] * loc[1] * pbH + (pb[1] + pb[3]) * 0.5f;
+        float w    = expf(var[2] * loc[2]) * pbW;
+        float h    = expf(var[3] * loc[3]) * pbH;
+        boxes[i] = {cx - w * 0.5f, cy - h * 0.5f, cx + w * 0.5f, cy + h * 0.5f};
+    }
+    auto iou = [&boxes](int i, int j) {
+        auto &a = boxes[i], &b = boxes[j];
+        float inter = std::max(std::min(a[2], b[2]) - std::max(a[0], b[0]), 0.0f) *
+                      std::max(std::min(a[3], b[3]) - std::max(a[1], b[1]), 0.0f);
+        float areaA = (a[2] - a[0]) * (a[3] - a[1]), areaB = (b[2] - b[0]) * (b[3] - b[1]);
+        return inter / (areaA + areaB - inter);
+    };
+
+    std::vector<std::vector<float>> results;
+    for (int c = 1; c < classCount; ++c) {
+        std::vector<int> order;
+        for (int i = 0; i < priorCount; ++i) {
+            if (confidence[i * classCount + c] > confidenceThreshold) {
+                order.push_back(i);
+            }
+        }
+        std::sort(order.begin(), order.end(), [&](int a, int b) {
+            return confidence[a * classCount + c] > confidence[b * classCount + c];
+        });
+        if (nmsTopK > 0 && order.size() > nmsTopK) {
+            order.resize(nmsTopK);
+        }
+        std::vector<int> picked;
+        for (auto index : order) {
+            bool keep = true;
+            for (auto p : picked) {
+                keep = keep && iou(index, p) <= nmsThreshold;
+            }
+            if (keep) {
+                picked.push_back(index);
+            }
+        }
+        for (auto index : picked) {
+            auto &box = boxes[index];
+            results.push_back({(float)c, confidence[index * classCount + c], box[0], box[1], box[2], box[3]});
+        }
+    }
+    std::sort(results.begin(), results.end(),
+              [](const std::vector<float> &a, const std::vector<float> &b) { return a[1] > b[1]; });
+    if (results.size() > keepTopK) {
+        results.resize(keepTopK);
+    }
+    return results;
+}
+
+class DetectionOutputTest : public MNNTestCase {
+public:
+    virtual ~DetectionOutputTest() = default;
+    virtual bool run() {
+        const int priorCount = 600, classCount = 5, keepTopK = 400;
+        const float nmsThreshold = 0.45f, confidenceThreshold = 0.3f;
+
+        // priors on a grid with overlapped sizes, scores are unique so that orders are determined
+        std::vector<float> location(4 * priorCount), confidence(priorCount * classCount), priorbox(8 * priorCount);
+        for (int i = 0; i < priorCount; ++i) {
+            float cx = (i % 20) * 0.05f, cy = ((i / 20) % 10) * 0.1f, size = 0.05f + (i / 200) * 0.05f;
+            priorbox[4 * i + 0] = cx - size;
+            priorbox[4 * i + 1] = cy - size;
+            priorbox[4 * i + 2] = cx + size;
+            priorbox[4 * i + 3] = cy + size;
+            for (int k = 0; k < 4; ++k) {
+                priorbox[4 * priorCount + 4 * i + k] = k < 2 ? 0.1f : 0.2f;
+                location[4 * i + k]                  = (rand() % 200 - 100) / 100.0f;
+            }
+        }
+        const int prime = 3001;
+        for (int i = 0; i < confidence.size(); ++i) {
+            confidence[i] = (float)((i * 1237) % prime) / prime;
+        }
+
+        for (int nmsTopK : {0, 50}) {
+            auto expect = _reference(location, confidence, priorbox, priorCount, classCount, nmsThreshold, nmsTopK,
+                                     keepTopK, confidenceThreshold);
+            std::unique_ptr<Interpreter> net(
+                create(priorCount, classCount, nmsThreshold, nmsTopK, keepTopK, confidenceThreshold));
+            for (int thread : {1, 4}) {
+                ScheduleConfig config;
+                config.numThread = thread;
+                auto session     = net->createSession(config);
+                _fill(net.get(), session, "location", location);
+                _fill(net.get(), session, "confidence", confidence);
+                _fill(net.get(), session, "priorbox", priorbox);
+                net->runSession(session);
+
+                auto output = net->getSessionOutput(session, "detection_out");
+                std::unique_ptr<Tensor> host(new Tensor(output, Tensor::CAFFE));
+                output->copyToHostTensor(host.get());
+                MNNTEST_ASSERT(host->height() == expect.size());
+                for (int i = 0; i < expect.size(); ++i) {
+                    for (int k = 0; k < 6; ++k) {
+                        if (fabsf(host->host<float>()[i * 6 + k] - expect[i][k]) > 1e-4f) {
+                            MNN_ERROR("detection mismatch at %d, %d: %f vs %f\n", i, k,
+                                      host->host<float>()[i * 6 + k], expect[i][k]);
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(DetectionOutputTest, "op/detection_output");
@@ -6,6 +6,8 @@
 //  Copyright © 2018, Alibaba Group Holding Limited
 //
 
+#include <math.h>
+#include <stdio.h>
 #include "Interpreter.hpp"
 #include "MNNTestSuite.h"
 #include "MNN_generated.h"
@@ -216,3 +218,227 @@ public:
     }
 };
 MNNTestSuiteRegister(GatherV2Test, "op/gatherv2");
+
+// table {4, 5, 6} as const, indices as input, axis as const
+static std::vector<uint8_t> _createTableNet(int axis, const std::vector<int> &indexShape, DataType indexType,
+                                            GatherCombiner combiner) {
+    flatbuffers::FlatBufferBuilder fbb;
+    std::vector<flatbuffers::Offset<Op>> vec;
+    {
+        std::vector<float> table(4 * 5 * 6);
+        for (int i = 0; i < table.size(); ++i) {
+            table[i] = (i % 23) / 7.0f - 1.0f;
+        }
+        auto dims = fbb.CreateVector(std::vector<int>({4, 5, 6}));
+        auto data = fbb.CreateVector(table);
+        BlobBuilder bb(fbb);
+        bb.add_dims(dims);
+        bb.add_dataType(DataType_DT_FLOAT);
+        bb.add_dataFormat(MNN_DATA_FORMAT_NHWC);
+        bb.add_float32s(data);
+        auto blob = bb.Finish();
+        auto name = fbb.CreateString("table");
+        auto iv   = fbb.CreateVector(std::vector<int>({}));
+        auto ov   = fbb.CreateVector(std::vector<int>({0}));
+
+        OpBuilder builder(fbb);
+        builder.add_type(OpType_Const);
+        builder.add_name(name);
+        builder.add_inputIndexes(iv);
+        builder.add_outputIndexes(ov);
+        builder.add_main_type(OpParameter_Blob);
+        builder.add_main(flatbuffers::Offset<void>(blob.o));
+        vec.push_back(builder.Finish());
+    }
+    {
+        auto dims = fbb.CreateVector(indexShape);
+        InputBuilder ib(fbb);
+        ib.add_dims(dims);
+        ib.add_dtype(indexType);
+        ib.add_dformat(MNN_DATA_FORMAT_NHWC);
+        auto input = ib.Finish();
+        auto name  = fbb.CreateString("indices");
+        auto iv    = fbb.CreateVector(std::vector<int>({}));
+        auto ov    = fbb.CreateVector(std::vector<int>({1}));
+
+        OpBuilder builder(fbb);
+        builder.add_type(OpType_Input);
+        builder.add_name(name);
+        builder.add_inputIndexes(iv);
+        builder.add_outputIndexes(ov);
+        builder.add_main_type(OpParameter_Input);
+        builder.add_main(flatbuffers::Offset<void>(input.o));
+        vec.push_back(builder.Finish());
+    }
+    {
+        auto dims = fbb.CreateVector(std::vector<int>({1}));
+        auto data = fbb.CreateVector(std::vector<int>({axis}));
+        BlobBuilder bb(fbb);
+        bb.add_dims(dims);
+        bb.add_dataType(DataType_DT_INT32);
+        bb.add_dataFormat(MNN_DATA_FORMAT_NHWC);
+        bb.add_int32s(data);
+        auto blob = bb.Finish();
+        auto name = fbb.CreateString("axis");
+        auto iv   = fbb.CreateVector(std::vector<int>({}));
+        auto ov   = fbb.CreateVector(std::vector<int>({2}));
+
+        OpBuilder builder(fbb);
+        builder.add_type(OpType_Const);
+        builder.add_name(name);
+        builder.add_inputIndexes(iv);
+        builder.add_outputIndexes(ov);
+        builder.add_main_type(OpParameter_Blob);
+        builder.add_main(flatbuffers::Offset<void>(blob.o));
+        vec.push_back(builder.Finish());
+    }
+    {
+        auto gb = GatherV2Builder(fbb);
+        gb.add_Taxis(DataType_DT_INT32);
+        gb.add_Tindices(indexType);
+        gb.add_Tparams(DataType_DT_FLOAT);
+        gb.add_combiner(combiner);
+        auto gatherV2 = gb.Finish();
+        auto name     = fbb.CreateString("GatherV2");
+        auto iv       = fbb.CreateVector(std::vector<int>({0, 1, 2}));
+        auto ov       = fbb.CreateVector(std::vector<int>({3}));
+
+        OpBuilder builder(fbb);
+        builder.add_type(OpType_GatherV2);
+        builder.add_name(name);
+        builder.add_inputIndexes(iv);
+        builder.add_outputIndexes(ov);
+        builder.add_main_type(OpParameter_GatherV2);
+        builder.add_main(flatbuffers::Offset<void>(gatherV2.o));
+        vec.push_back(builder.Finish());
+    }
+
+    BlobBuilder db(fbb);
+    db.add_dataType(DataType_DT_FLOAT);
+    db.add_dataFormat(MNN_DATA_FORMAT_NHWC);
+    auto nhwc = db.Finish();
+    std::vector<flatbuffers::Offset<TensorDescribe>> desc;
+    for (int i = 0; i < 4; ++i) {
+        TensorDescribeBuilder tdb(fbb);
+        tdb.add_index(i);
+        tdb.add_blob(flatbuffers::Offset<Blob>(nhwc.o));
+        desc.push_back(tdb.Finish());
+    }
+
+    auto ops    = fbb.CreateVector(vec);
+    auto names  = fbb.CreateVectorOfStrings({"table", "indices", "axis", "output"});
+    auto extras = fbb.CreateVector(desc);
+    NetBuilder net(fbb);
+    net.add_oplists(ops);
+    net.add_tensorName(names);
+    net.add_extraTensorDescribe(extras);
+    net.add_sourceType(NetSource_TENSORFLOW);
+    fbb.Finish(net.Finish());
+    return std::vector<uint8_t>(fbb.GetBufferPointer(), fbb.GetBufferPointer() + fbb.GetSize());
+}
+
+class GatherV2ReferenceTest : public MNNTestCase {
+public:
+    virtual ~GatherV2ReferenceTest() = default;
+    virtual bool run() {
+        const std::vector<int> indexShapes[] = {{3}, {2, 3}};
+        const DataType indexTypes[]          = {DataType_DT_INT32, DataType_DT_INT64};
+        const GatherCombiner combiners[]     = {GatherCombiner_NONE, GatherCombiner_SUM, GatherCombiner_MEAN};
+        for (int axis = -1; axis < 3; ++axis) {
+            for (auto &shape : indexShapes) {
+                for (auto type : indexTypes) {
+                    for (auto combiner : combiners) {
+                        auto buffer = _createTableNet(axis, shape, type, combiner);
+                        // from buffer and mapped, where the table is left in model
+                        std::unique_ptr<Interpreter> net(Interpreter::createFromBuffer(buffer.data(), buffer.size()));
+                        if (!_check(net.get(), axis, shape, type, combiner)) {
+                            return false;
+                        }
+                        const char *file = "gatherv2_reference.mnn";
+                        auto f           = fopen(file, "wb");
+                        if (nullptr == f) {
+                            continue;
+                        }
+                        fwrite(buffer.data(), 1, buffer.size(), f);
+                        fclose(f);
+                        net.reset(Interpreter::createFromFileMapped(file));
+                        remove(file);
+                        if (!_check(net.get(), axis, shape, type, combiner)) {
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    bool _check(Interpreter *net, int axis, const std::vector<int> &shape, DataType type, GatherCombiner combiner) {
+        const int dims[] = {4, 5, 6};
+        const int a      = axis < 0 ? axis + 3 : axis;
+        int count        = 1;
+        for (auto s : shape) {
+            count *= s;
+        }
+        const int bag  = GatherCombiner_NONE == combiner ? 1 : shape.back();
+        const int bags = count / bag;
+        int outside = 1, inside = 1;
+        for (int i = 0; i < a; ++i) {
+            outside *= dims[i];
+        }
+        for (int i = a + 1; i < 3; ++i) {
+            inside *= dims[i];
+        }
+        std::vector<int> indices(count);
+        for (int i = 0; i < count; ++i) {
+            indices[i] = (i * 7 + 3) % dims[a];
+        }
+
+        for (int thread = 1; thread <= 4; thread *= 4) {
+            ScheduleConfig config;
+            config.numThread = thread;
+            auto session     = net->createSession(config);
+            auto input       = net->getSessionInput(session, "indices");
+            std::unique_ptr<Tensor> host(new Tensor(input, Tensor::TENSORFLOW));
+            for (int i = 0; i < count; ++i) {
+                if (DataType_DT_INT64 == type) {
+                    host->host<int64_t>()[i] = indices[i];
+                } else {
+                    host->host<int32_t>()[i] = indices[i];
+                }
+            }
+            input->copyFromHostTensor(host.get());
+            net->runSession(session);
+            auto output = net->getSessionOutput(session, "output");
+            if (output->elementSize() != outside * bags * inside) {
+                MNN_ERROR("gather axis %d, combiner %d: size %d, expect %d\n", axis, combiner, output->elementSize(),
+                          outside * bags * inside);
+                return false;
+            }
+            for (int o = 0; o < outside; ++o) {
+                for (int b = 0; b < bags; ++b) {
+                    for (int i = 0; i < inside; ++i) {
+                        float expect = 0.0f;
+                        for (int j = 0; j < bag; ++j) {
+                            const int v = (o * dims[a] + indices[b * bag + j]) * inside + i;
+                            expect += (v % 23) / 7.0f - 1.0f;
+                        }
+                        if (GatherCombiner_MEAN == combiner) {
+                            expect /= bag;
+                        }
+                        const float value = output->host<float>()[(o * bags + b) * inside + i];
+                        if (fabsf(value - expect) > 1e-5f) {
+                            MNN_ERROR("gather axis %d, combiner %d, indices %d, thread %d: %f, expect %f\n", axis,
+                                      combiner, count, thread, value, expect);
+                            return false;
+                        }
+                    }
+                }
+            }
+            net->releaseSession(session);
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(GatherV2ReferenceTest, "op/gatherv2/reference");
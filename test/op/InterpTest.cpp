@@ -6,6 +6,7 @@
 //  Copyright © 2018, Alibaba Group Holding Limited
 //
 
+#include <math.h>
 #include "Interpreter.hpp"
 #include "MNNTestSuite.h"
 #include "MNN_generated.h"
@@ -203,5 +204,82 @@ public:
     }
 };
 
+class InterpCPUTest : public MNNTestCase {
+public:
+    virtual ~InterpCPUTest() = default;
+    virtual bool run() {
+        // upscale by 2, 4, a fraction and downscale
+        const int sizes[][2] = {{12, 14}, {24, 28}, {9, 10}, {3, 4}};
+        for (int type = 1; type <= 2; ++type) {
+            for (auto &size : sizes) {
+                for (int a = 0; a <= 1; ++a) {
+                    for (int thread = 1; thread <= 4; thread *= 4) {
+                        if (!_check(type, a, size[0], size[1], thread)) {
+                            MNN_ERROR("interp type %d, align %d to %d x %d with %d threads failed\n", type, a, size[0],
+                                      size[1], thread);
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    // source of x is x * (w - 1) / (ow - 1) with align corners, else x * w / ow
+    static float _reference(const float *plane, int type, bool a, int w, int h, int ow, int oh, int x, int y) {
+        const int xNum = a ? w - 1 : w, xDen = a ? ow - 1 : ow;
+        const int yNum = a ? h - 1 : h, yDen = a ? oh - 1 : oh;
+        const int x0   = x * xNum / xDen;
+        const int y0   = y * yNum / yDen;
+        auto at        = [&](int px, int py) {
+            return plane[std::min(std::max(py, 0), h - 1) * w + std::min(std::max(px, 0), w - 1)];
+        };
+        if (1 == type) {
+            return at(x0, y0);
+        }
+        const float fx = (float)(x * xNum % xDen) / xDen;
+        const float fy = (float)(y * yNum % yDen) / yDen;
+        float top      = at(x0, y0) * (1 - fx) + at(x0 + 1, y0) * fx;
+        float bottom   = at(x0, y0 + 1) * (1 - fx) + at(x0 + 1, y0 + 1) * fx;
+        return top * (1 - fy) + bottom * fy;
+    }
+    bool _check(int type, bool a, int oh, int ow, int thread) {
+        const int b = 2, c = 5, h = 6, w = 7;
+        std::unique_ptr<Interpreter> net(create(type, 0.0f, 0.0f, a, ow, oh, w, h, c, b));
+        ScheduleConfig config;
+        config.numThread = thread;
+        auto session     = net->createSession(config);
+        auto input       = net->getSessionInput(session, nullptr);
+        std::shared_ptr<Tensor> inputHost(new Tensor(input, Tensor::CAFFE));
+        for (int i = 0; i < inputHost->elementSize(); ++i) {
+            inputHost->host<float>()[i] = (i * 7 % 31) / 31.0f;
+        }
+        input->copyFromHostTensor(inputHost.get());
+        net->runSession(session);
+        auto output = net->getSessionOutput(session, nullptr);
+        std::shared_ptr<Tensor> outputHost(new Tensor(output, Tensor::CAFFE));
+        output->copyToHostTensor(outputHost.get());
+        if (outputHost->width() != ow || outputHost->height() != oh) {
+            return false;
+        }
+        for (int p = 0; p < b * c; ++p) {
+            auto plane = inputHost->host<float>() + p * h * w;
+            for (int y = 0; y < oh; ++y) {
+                for (int x = 0; x < ow; ++x) {
+                    const float expect = _reference(plane, type, a, w, h, ow, oh, x, y);
+                    const float value  = outputHost->host<float>()[(p * oh + y) * ow + x];
+                    if (fabsf(value - expect) > 1e-5f) {
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+};
+
 MNNTestSuiteRegister(InterpBilinearTest, "op/interp/bilinear");
 MNNTestSuiteRegister(InterpCubicTest, "op/interp/cubic");
+MNNTestSuiteRegister(InterpCPUTest, "op/interp/cpu");
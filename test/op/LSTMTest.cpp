@@ -6,6 +6,7 @@
 //  Copyright © 2018, Alibaba Group Holding Limited
 //
 
+#include <math.h>
 #include "Interpreter.hpp"
 #include "MNNTestSuite.h"
 #include "MNN_generated.h"
@@ -17,12 +18,12 @@
 using namespace MNN;
 
 static Interpreter *create(int cont, int w, int c, int ow, std::vector<float> hws, std::vector<float> iws,
-                           std::vector<float> bias) {
+                           std::vector<float> bias, int batch = 1) {
     flatbuffers::FlatBufferBuilder fbb;
     std::vector<flatbuffers::Offset<Op>> vec;
 
     {
-        auto dims = fbb.CreateVector(std::vector<int>({1, c, 1, w}));
+        auto dims = fbb.CreateVector(std::vector<int>({batch, c, 1, w}));
         InputBuilder ib(fbb);
         ib.add_dims(dims);
         auto input = ib.Finish();
@@ -198,3 +199,163 @@ public:
     }
 };
 MNNTestSuiteRegister(LSTMTest, "op/lstm");
+
+static std::shared_ptr<Tensor> _run(Interpreter *net, Session *session, const float *data) {
+    auto input = net->getSessionInput(session, "input");
+    std::shared_ptr<Tensor> host(new Tensor(input, Tensor::CAFFE));
+    ::memcpy(host->host<float>(), data, host->size());
+    input->copyFromHostTensor(host.get());
+    net->runSession(session);
+    auto output = net->getSessionOutput(session, "output");
+    std::shared_ptr<Tensor> result(new Tensor(output, Tensor::CAFFE));
+    output->copyToHostTensor(result.get());
+    return result;
+}
+
+static std::shared_ptr<Tensor> _run(Interpreter *net, Session *session, const float *data, const float *cont) {
+    if (nullptr != cont) {
+        auto input = net->getSessionInput(session, "cont");
+        std::shared_ptr<Tensor> host(new Tensor(input, Tensor::CAFFE));
+        ::memcpy(host->host<float>(), cont, host->size());
+        input->copyFromHostTensor(host.get());
+    }
+    return _run(net, session, data);
+}
+
+// gates are in order of I, F, O, G
+static std::vector<float> _reference(const std::vector<float> &input, const float *cont, int batch, int steps, int iw,
+                                     int ow, const std::vector<float> &H, const std::vector<float> &I,
+                                     const std::vector<float> &B) {
+    std::vector<float> output(batch * steps * ow);
+    for (int b = 0; b < batch; ++b) {
+        std::vector<float> hidden(ow, 0.0f), cell(ow, 0.0f), newHidden(ow);
+        for (int t = 0; t < steps; ++t) {
+            const bool keep = t > 0 && (nullptr == cont || cont[t] != 0.0f);
+            auto x          = input.data() + (b * steps + t) * iw;
+            for (int oc = 0; oc < ow; ++oc) {
+                float gates[4];
+                for (int g = 0; g < 4; ++g) {
+                    float sum = B[g * ow + oc];
+                    for (int i = 0; i < iw; ++i) {
+                        sum += I[(g * ow + oc) * iw + i] * x[i];
+                    }
+                    for (int i = 0; keep && i < ow; ++i) {
+                        sum += H[(g * ow + oc) * ow + i] * hidden[i];
+                    }
+                    gates[g] = sum;
+                }
+                const float in     = 1.0f / (1.0f + expf(-gates[0]));
+                const float forget = keep ? 1.0f / (1.0f + expf(-gates[1])) : 0.0f;
+                const float out    = 1.0f / (1.0f + expf(-gates[2]));
+                cell[oc]           = forget * cell[oc] + in * tanhf(gates[3]);
+                newHidden[oc]      = out * tanhf(cell[oc]);
+            }
+            hidden = newHidden;
+            ::memcpy(output.data() + (b * steps + t) * ow, hidden.data(), ow * sizeof(float));
+        }
+    }
+    return output;
+}
+
+class LSTMReferenceTest : public MNNTestCase {
+public:
+    virtual ~LSTMReferenceTest() = default;
+    virtual bool run() {
+        for (int batch = 1; batch <= 3; batch += 2) {
+            for (int steps : {1, 5, 8}) {
+                for (int ow : {3, 16, 70}) {
+                    for (int t = 0; t <= 1; t++) {
+                        for (int thread : {1, 4}) {
+                            const int iw = 7;
+                            std::vector<float> H, I, B, input, cont;
+                            for (int i = 0; i < ow * 4 * ow; i++)
+                                H.push_back((rand() % 255 / 255.f - 0.5f) / ow);
+                            for (int i = 0; i < iw * 4 * ow; i++)
+                                I.push_back(rand() % 255 / 255.f - 0.5f);
+                            for (int i = 0; i < 1 * 4 * ow; i++)
+                                B.push_back(rand() % 255 / 255.f - 0.5f);
+                            for (int i = 0; i < batch * steps * iw; i++)
+                                input.push_back(rand() % 255 / 255.f);
+                            for (int i = 0; i < steps; i++)
+                                cont.push_back(rand() % 3 ? 1.0f : 0.0f);
+                            // cont of batch 1 only
+                            if (t && batch > 1) {
+                                continue;
+                            }
+
+                            std::unique_ptr<Interpreter> net(create(t, iw, steps, ow, H, I, B, batch));
+                            ScheduleConfig config;
+                            config.numThread = thread;
+                            auto session     = net->createSession(config);
+                            auto output      = _run(net.get(), session, input.data(), t ? cont.data() : nullptr);
+                            auto expect =
+                                _reference(input, t ? cont.data() : nullptr, batch, steps, iw, ow, H, I, B);
+                            for (int i = 0; i < expect.size(); ++i) {
+                                if (fabsf(output->host<float>()[i] - expect[i]) > 1e-4f) {
+                                    MNN_ERROR("LSTM mismatch: batch %d, steps %d, units %d, cont %d\n", batch,
+                                              steps, ow, t);
+                                    return false;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(LSTMReferenceTest, "op/lstm/reference");
+
+// feeding a sequence by two chunks in stateful mode gives the same result as feeding it at once
+class LSTMStatefulTest : public MNNTestCase {
+public:
+    virtual ~LSTMStatefulTest() = default;
+    virtual bool run() {
+        const int steps = 6, iw = 5, ow = 6;
+        std::vector<float> H, I, B, input;
+        for (int i = 0; i < ow * 4 * ow; i++)
+            H.push_back(rand() % 255 / 255.f - 0.5f);
+        for (int i = 0; i < iw * 4 * ow; i++)
+            I.push_back(rand() % 255 / 255.f - 0.5f);
+        for (int i = 0; i < 1 * 4 * ow; i++)
+            B.push_back(rand() % 255 / 255.f - 0.5f);
+        for (int i = 0; i < steps * iw; i++)
+            input.push_back(rand() % 255 / 255.f);
+
+        std::unique_ptr<Interpreter> full(create(0, iw, steps, ow, H, I, B));
+        std::unique_ptr<Interpreter> chunk(create(0, iw, steps / 2, ow, H, I, B));
+        ScheduleConfig config;
+        auto fullSession  = full->createSession(config);
+        auto expect       = _run(full.get(), fullSession, input.data());
+        auto chunkSession = chunk->createSession(config);
+        chunk->setSessionStateful(chunkSession, true);
+        auto states = chunk->getSessionState(chunkSession, "lstm");
+        MNNTEST_ASSERT(states.size() == 2 && states[0]->elementSize() == ow && states[1]->elementSize() == ow);
+
+        auto compare = [&](const Tensor *output, int start) {
+            for (int i = 0; i < output->elementSize(); ++i) {
+                if (fabsf(output->host<float>()[i] - expect->host<float>()[start * ow + i]) > 1e-4f) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        for (int i = 0; i < 2; ++i) {
+            auto output = _run(chunk.get(), chunkSession, input.data() + i * (steps / 2) * iw);
+            MNNTEST_ASSERT(compare(output.get(), i * steps / 2));
+        }
+        // state is the last hidden
+        std::shared_ptr<Tensor> hidden(Tensor::createHostTensorFromDevice(states[0], true));
+        for (int i = 0; i < ow; ++i) {
+            MNNTEST_ASSERT(fabsf(hidden->host<float>()[i] - expect->host<float>()[(steps - 1) * ow + i]) < 1e-4f);
+        }
+
+        // a new stream starts from zero after reset
+        chunk->resetSessionState(chunkSession);
+        auto output = _run(chunk.get(), chunkSession, input.data());
+        MNNTEST_ASSERT(compare(output.get(), 0));
+        return true;
+    }
+};
+MNNTestSuiteRegister(LSTMStatefulTest, "op/lstm/stateful");
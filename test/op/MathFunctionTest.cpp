@@ -0,0 +1,146 @@
+//
+//  MathFunctionTest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2019/08/28.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <float.h>
+#include <math.h>
+#include <functional>
+#include <vector>
+#include "MNNTestSuite.h"
+#include "Macro.h"
+#include "MathFunction.hpp"
+#ifdef MNN_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+using namespace MNN;
+
+// executables linked with fast math flush denormals to zero, which hides them from kernels under test
+class DenormalScope {
+public:
+    DenormalScope() {
+#ifdef MNN_USE_SSE
+        mState = _mm_getcsr();
+        _mm_setcsr(mState & ~0x8040u); // FTZ and DAZ
+#elif defined(__aarch64__)
+        __asm__ volatile("mrs %0, fpcr" : "=r"(mState));
+        __asm__ volatile("msr fpcr, %0" : : "r"(mState & ~(1ull << 24))); // FZ
+#endif
+    }
+    ~DenormalScope() {
+#ifdef MNN_USE_SSE
+        _mm_setcsr(mState);
+#elif defined(__aarch64__)
+        __asm__ volatile("msr fpcr, %0" : : "r"(mState));
+#endif
+    }
+
+private:
+#ifdef __aarch64__
+    unsigned long long mState = 0;
+#else
+    unsigned int mState = 0;
+#endif
+};
+
+// distance to libm in double, in ulp of the expected float. absolute is the error counted as zero, for the
+// functions whose result cancels somewhere
+static float _maxUlp(const std::function<void(float *, const float *, int)> &function,
+                     const std::function<double(double)> &reference, float start, float end, float absolute = 0.0f) {
+    const int size = 200003;
+    std::vector<float> src(size), dst(size);
+    for (int i = 0; i < size; ++i) {
+        src[i] = start + (end - start) * i / (size - 1);
+    }
+    function(dst.data(), src.data(), size);
+    float maxUlp = 0.0f;
+    for (int i = 0; i < size; ++i) {
+        double expect = reference(src[i]);
+        // in double, denormal ulp of float are flushed to zero otherwise
+        float value  = fabsf((float)expect);
+        double ulp   = ldexp(1.0, value < FLT_MIN ? FLT_MIN_EXP - FLT_MANT_DIG : ilogbf(value) - FLT_MANT_DIG + 1);
+        double error = fabs(dst[i] - expect);
+        if (error <= absolute) {
+            continue;
+        }
+        maxUlp = fmaxf(maxUlp, (float)(error / ulp));
+    }
+    return maxUlp;
+}
+
+static double _sigmoid(double x) {
+    return 1.0 / (1.0 + ::exp(-x));
+}
+
+static double _elu(double x) {
+    return x > 0.0 ? x : 0.5 * (::exp(x) - 1.0);
+}
+
+class MathFunctionTest : public MNNTestCase {
+public:
+    virtual ~MathFunctionTest() = default;
+    virtual bool run() {
+        for (bool best : {true, false}) {
+            auto &f = MathFunction::functions(best);
+            using namespace std::placeholders;
+            struct Case {
+                const char *name;
+                float ulp;
+                float error;
+            };
+            std::vector<Case> cases = {
+                {"exp", 2.0f, _maxUlp(f.exp, [](double x) { return ::exp(x); }, -87.0f, 88.7f)},
+                {"log", 1.0f, _maxUlp(f.log, [](double x) { return ::log(x); }, 1e-30f, 1e5f)},
+                {"log near 1", 1.0f, _maxUlp(f.log, [](double x) { return ::log(x); }, 0.5f, 2.0f)},
+                {"tanh", 2.0f, _maxUlp(f.tanh, [](double x) { return ::tanh(x); }, -10.0f, 10.0f)},
+                {"sigmoid", 3.0f, _maxUlp(f.sigmoid, _sigmoid, -80.0f, 30.0f)},
+                {"erf", 8.0f, _maxUlp(f.erf, [](double x) { return ::erf(x); }, -5.0f, 5.0f, 1e-7f)},
+                {"gelu", 4.0f,
+                 _maxUlp(f.gelu, [](double x) { return 0.5 * x * (1.0 + ::erf(x / sqrt(2.0))); }, -5.0f, 5.0f,
+                         1e-6f)},
+                {"swish", 4.0f, _maxUlp(f.swish, [](double x) { return x * _sigmoid(x); }, -80.0f, 30.0f)},
+                {"hardSwish", 2.0f,
+                 _maxUlp(f.hardSwish, [](double x) { return x * fmin(fmax(x + 3.0, 0.0), 6.0) / 6.0; }, -5.0f,
+                         5.0f)},
+                {"softplus", 3.0f,
+                 _maxUlp(f.softplus, [](double x) { return fmax(x, 0.0) + log1p(::exp(-fabs(x))); }, -80.0f,
+                         30.0f)},
+                {"elu", 2.0f, _maxUlp(std::bind(f.elu, _1, _2, _3, 0.5f), _elu, -20.0f, 5.0f)},
+                {"selu", 2.0f,
+                 _maxUlp(std::bind(f.selu, _1, _2, _3, 1.5f, 0.5f), [](double x) { return 1.5 * _elu(x); }, -20.0f,
+                         5.0f)},
+            };
+            {
+                DenormalScope scope;
+                cases.push_back(
+                    {"log denormal", 1.0f, _maxUlp(f.log, [](double x) { return ::log(x); }, 1e-45f, FLT_MIN)});
+            }
+            for (auto &c : cases) {
+                if (c.error > c.ulp) {
+                    MNN_ERROR("%s of %s simd: %f ulp, expect %f\n", c.name, best ? "best" : "default", c.error,
+                              c.ulp);
+                    return false;
+                }
+            }
+
+            // special values
+            std::vector<float> src = {0.0f, -1.0f, INFINITY, -INFINITY, NAN, 100.0f, -200.0f, 1e-40f}, dst(8);
+            f.exp(dst.data(), src.data(), 8);
+            MNNTEST_ASSERT(dst[0] == 1.0f && dst[2] == INFINITY && dst[3] == 0.0f && isnan(dst[4]));
+            MNNTEST_ASSERT(dst[5] == INFINITY && dst[6] == 0.0f);
+            f.log(dst.data(), src.data(), 8);
+            MNNTEST_ASSERT(dst[0] == -INFINITY && isnan(dst[1]) && dst[2] == INFINITY && isnan(dst[3]));
+            MNNTEST_ASSERT(isnan(dst[4]));
+            f.tanh(dst.data(), src.data(), 8);
+            MNNTEST_ASSERT(dst[0] == 0.0f && dst[2] == 1.0f && dst[3] == -1.0f && dst[5] == 1.0f && dst[6] == -1.0f);
+            f.sigmoid(dst.data(), src.data(), 8);
+            MNNTEST_ASSERT(dst[0] == 0.5f && dst[2] == 1.0f && dst[3] == 0.0f && dst[5] == 1.0f && dst[6] == 0.0f);
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(MathFunctionTest, "op/math_function");
@@ -0,0 +1,173 @@
+//
+//  NonMaxSuppressionV2Test.cpp
+//  MNNTests
+//
+//  Created by MNN on 2019/08/26.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <math.h>
+#include <algorithm>
+#include "Interpreter.hpp"
+#include "MNNTestSuite.h"
+#include "MNN_generated.h"
+
+using namespace MNN;
+
+static flatbuffers::Offset<Op> _const(flatbuffers::FlatBufferBuilder &fbb, const char *name, int output,
+                                      const std::vector<int> &dims, const std::vector<float> &floats,
+                                      const std::vector<int> &ints) {
+    auto d = fbb.CreateVector(dims);
+    auto f = fbb.CreateVector(floats);
+    auto i = fbb.CreateVector(ints);
+    BlobBuilder bb(fbb);
+    bb.add_dims(d);
+    bb.add_dataFormat(MNN_DATA_FORMAT_NHWC);
+    if (ints.empty()) {
+        bb.add_dataType(DataType_DT_FLOAT);
+        bb.add_float32s(f);
+    } else {
+        bb.add_dataType(DataType_DT_INT32);
+        bb.add_int32s(i);
+    }
+    auto blob = bb.Finish();
+    auto n    = fbb.CreateString(name);
+    auto iv   = fbb.CreateVector(std::vector<int>({}));
+    auto ov   = fbb.CreateVector(std::vector<int>({output}));
+
+    OpBuilder builder(fbb);
+    builder.add_type(OpType_Const);
+    builder.add_name(n);
+    builder.add_inputIndexes(iv);
+    builder.add_outputIndexes(ov);
+    builder.add_main_type(OpParameter_Blob);
+    builder.add_main(flatbuffers::Offset<void>(blob.o));
+    return builder.Finish();
+}
+
+static Interpreter *create(const std::vector<float> &boxes, const std::vector<float> &scores, int maxOutputSize,
+                           float iouThreshold) {
+    flatbuffers::FlatBufferBuilder fbb;
+    std::vector<flatbuffers::Offset<Op>> vec;
+    const int number = (int)scores.size();
+    vec.push_back(_const(fbb, "boxes", 0, {number, 4}, boxes, {}));
+    vec.push_back(_const(fbb, "scores", 1, {number}, scores, {}));
+    vec.push_back(_const(fbb, "max_output_size", 2, {}, {}, {maxOutputSize}));
+    vec.push_back(_const(fbb, "iou_threshold", 3, {}, {iouThreshold}, {}));
+    {
+        auto name = fbb.CreateString("nms");
+        auto iv   = fbb.CreateVector(std::vector<int>({0, 1, 2, 3}));
+        auto ov   = fbb.CreateVector(std::vector<int>({4}));
+
+        OpBuilder builder(fbb);
+        builder.add_type(OpType_NonMaxSuppressionV2);
+        builder.add_name(name);
+        builder.add_inputIndexes(iv);
+        builder.add_outputIndexes(ov);
+        vec.push_back(builder.Finish());
+    }
+
+    BlobBuilder bb(fbb);
+    bb.add_dataType(DataType_DT_FLOAT);
+    bb.add_dataFormat(MNN_DATA_FORMAT_NHWC);
+    auto blob = bb.Finish();
+    std::vector<flatbuffers::Offset<TensorDescribe>> desc;
+    for (int i = 0; i < 5; ++i) {
+        TensorDescribeBuilder tdb(fbb);
+        tdb.add_index(i);
+        tdb.add_blob(blob);
+        desc.push_back(tdb.Finish());
+    }
+    auto extras = fbb.CreateVector(desc);
+    auto ops    = fbb.CreateVector(vec);
+    auto names  = fbb.CreateVectorOfStrings({"boxes", "scores", "max_output_size", "iou_threshold", "output"});
+    NetBuilder net(fbb);
+    net.add_oplists(ops);
+    net.add_tensorName(names);
+    net.add_extraTensorDescribe(extras);
+    net.add_sourceType(NetSource_TENSORFLOW);
+    fbb.Finish(net.Finish());
+    return Interpreter::createFromBuffer((const char *)fbb.GetBufferPointer(), fbb.GetSize());
+}
+
+// greedy nms as tensorflow does, corners of boxes may be flipped
+static std::vector<int> _reference(const std::vector<float> &boxes, const std::vector<float> &scores,
+                                   int maxOutputSize, float iouThreshold) {
+    auto iou = [&boxes](int i, int j) {
+        auto a = boxes.data() + 4 * i, b = boxes.data() + 4 * j;
+        float aY0 = std::min(a[0], a[2]), aX0 = std::min(a[1], a[3]), aY1 = std::max(a[0], a[2]),
+              aX1 = std::max(a[1], a[3]);
+        float bY0 = std::min(b[0], b[2]), bX0 = std::min(b[1], b[3]), bY1 = std::max(b[0], b[2]),
+              bX1 = std::max(b[1], b[3]);
+        float areaA = (aY1 - aY0) * (aX1 - aX0), areaB = (bY1 - bY0) * (bX1 - bX0);
+        if (areaA <= 0 || areaB <= 0) {
+            return 0.0f;
+        }
+        float inter = std::max(std::min(aY1, bY1) - std::max(aY0, bY0), 0.0f) *
+                      std::max(std::min(aX1, bX1) - std::max(aX0, bX0), 0.0f);
+        return inter / (areaA + areaB - inter);
+    };
+    std::vector<int> order(scores.size());
+    for (int i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&scores](int a, int b) { return scores[a] > scores[b]; });
+    std::vector<int> selected;
+    for (auto index : order) {
+        if (selected.size() >= maxOutputSize) {
+            break;
+        }
+        bool keep = true;
+        for (auto s : selected) {
+            keep = keep && iou(index, s) <= iouThreshold;
+        }
+        if (keep) {
+            selected.push_back(index);
+        }
+    }
+    return selected;
+}
+
+class NonMaxSuppressionV2Test : public MNNTestCase {
+public:
+    virtual ~NonMaxSuppressionV2Test() = default;
+    virtual bool run() {
+        // clusters of overlapped boxes, so that most of them are suppressed
+        const int number = 2000;
+        std::vector<float> boxes(number * 4), scores(number);
+        for (int i = 0; i < number; ++i) {
+            float cy = (i % 37) * 0.03f + (rand() % 100) * 0.0002f;
+            float cx = (i % 23) * 0.04f + (rand() % 100) * 0.0002f;
+            float h = 0.02f + (rand() % 100) * 0.0003f, w = 0.02f + (rand() % 100) * 0.0003f;
+            bool flip        = i % 5 == 0;
+            boxes[4 * i + 0] = flip ? cy + h : cy - h;
+            boxes[4 * i + 1] = cx - w;
+            boxes[4 * i + 2] = flip ? cy - h : cy + h;
+            boxes[4 * i + 3] = cx + w;
+            scores[i]        = (rand() % 100000) / 100000.0f;
+        }
+        for (int maxOutputSize : {10, 100, number}) {
+            for (float iouThreshold : {0.3f, 0.7f}) {
+                auto expect = _reference(boxes, scores, maxOutputSize, iouThreshold);
+                std::unique_ptr<Interpreter> net(create(boxes, scores, maxOutputSize, iouThreshold));
+                for (int thread : {1, 4}) {
+                    ScheduleConfig config;
+                    config.numThread = thread;
+                    auto session     = net->createSession(config);
+                    net->runSession(session);
+                    auto output = net->getSessionOutput(session, "output");
+                    MNNTEST_ASSERT(output->elementSize() >= (int)expect.size());
+                    for (int i = 0; i < expect.size(); ++i) {
+                        if (output->host<int32_t>()[i] != expect[i]) {
+                            MNN_ERROR("nms mismatch at %d of max %d, iou %f: %d vs %d\n", i, maxOutputSize,
+                                      iouThreshold, output->host<int32_t>()[i], expect[i]);
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(NonMaxSuppressionV2Test, "op/nms_v2");
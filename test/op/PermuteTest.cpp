@@ -131,3 +131,61 @@ public:
     }
 };
 MNNTestSuiteRegister(PermuteTest, "op/permute");
+
+class PermuteReferenceTest : public MNNTestCase {
+public:
+    virtual ~PermuteReferenceTest() = default;
+    virtual bool run() {
+        // channel moves or stays, padded quads and spatial sizes over a tile
+        std::vector<int> dims[] = {
+            {0, 1, 3, 2}, {0, 2, 1, 3}, {0, 2, 3, 1}, {0, 3, 1, 2}, {0, 3, 2, 1},
+        };
+        const int shapes[][4] = {{1, 5, 7, 3}, {2, 21, 19, 33}, {1, 64, 40, 48}};
+        for (auto &dim : dims) {
+            for (auto &shape : shapes) {
+                for (int thread : {1, 4}) {
+                    if (!_check(dim, shape[0], shape[1], shape[2], shape[3], thread)) {
+                        MNN_ERROR("permute %d%d%d%d of %dx%dx%dx%d mismatch\n", dim[0], dim[1], dim[2], dim[3],
+                                  shape[0], shape[1], shape[2], shape[3]);
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    bool _check(const std::vector<int> &dim, int b, int c, int h, int w, int thread) {
+        const int inputShape[] = {b, c, h, w};
+        const int stride[]     = {c * h * w, h * w, w, 1};
+        const int size         = b * c * h * w;
+        std::vector<float> data(size), expect(size);
+        for (int i = 0; i < size; ++i) {
+            data[i] = (float)i;
+        }
+        for (int i = 0; i < size; ++i) {
+            int offset = 0;
+            for (int d = 3, index = i; d >= 0; --d) {
+                offset += index % inputShape[dim[d]] * stride[dim[d]];
+                index /= inputShape[dim[d]];
+            }
+            expect[i] = data[offset];
+        }
+
+        std::unique_ptr<Interpreter> net(create(dim, w, h, c, b));
+        ScheduleConfig config;
+        config.numThread = thread;
+        auto session     = net->createSession(config);
+        auto input       = net->getSessionInput(session, nullptr);
+        std::unique_ptr<Tensor> inputHost(new Tensor(input, Tensor::CAFFE));
+        ::memcpy(inputHost->host<float>(), data.data(), size * sizeof(float));
+        input->copyFromHostTensor(inputHost.get());
+        net->runSession(session);
+        auto output = net->getSessionOutput(session, nullptr);
+        std::unique_ptr<Tensor> host(new Tensor(output, Tensor::CAFFE));
+        output->copyToHostTensor(host.get());
+        return 0 == ::memcmp(host->host<float>(), expect.data(), size * sizeof(float));
+    }
+};
+MNNTestSuiteRegister(PermuteReferenceTest, "op/permute/reference");
@@ -6,8 +6,12 @@
 //  Copyright © 2018, Alibaba Group Holding Limited
 //
 
+#include <float.h>
+#include <math.h>
+#include <memory>
 #include "Interpreter.hpp"
 #include "MNNTestSuite.h"
+#include "Macro.h"
 #include "MNN_generated.h"
 #include "MNN_generated.h"
 #include "Session.hpp"
@@ -208,3 +212,89 @@ public:
 };
 MNNTestSuiteRegister(PoolingMaxTest, "op/pool/max");
 MNNTestSuiteRegister(PoolingAvgTest, "op/pool/avg");
+
+class PoolingReferenceTest : public MNNTestCase {
+public:
+    virtual ~PoolingReferenceTest() = default;
+    virtual bool run() {
+        // kernel, stride, pad: unrolled windows, windows over padding, windows much wider than stride
+        const int params[][3] = {{3, 2, 1}, {2, 2, 0}, {3, 1, 1}, {7, 1, 3}, {5, 3, 4}};
+        const int shapes[][4] = {{1, 5, 7, 9}, {2, 13, 28, 28}};
+        for (auto type : {PoolType_MAXPOOL, PoolType_AVEPOOL}) {
+            for (int thread : {1, 4}) {
+                for (auto &shape : shapes) {
+                    for (auto &param : params) {
+                        if (!_check(type, shape, param[0], param[1], param[2], false, thread)) {
+                            return false;
+                        }
+                    }
+                }
+                // planes many or few against threads
+                const int globalShapes[][4] = {{2, 13, 7, 7}, {1, 3, 64, 64}};
+                for (auto &shape : globalShapes) {
+                    if (!_check(type, shape, 1, 1, 0, true, thread)) {
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    bool _check(PoolType type, const int *shape, int kernel, int stride, int pad, bool global, int thread) {
+        const int b = shape[0], c = shape[1], h = shape[2], w = shape[3];
+        std::unique_ptr<Interpreter> net(create(type, w, h, c, b, kernel, stride, pad, global));
+        ScheduleConfig config;
+        config.numThread = thread;
+        auto session     = net->createSession(config);
+        auto input       = net->getSessionInput(session, nullptr);
+        std::unique_ptr<Tensor> inputHost(new Tensor(input, Tensor::CAFFE));
+        auto data = inputHost->host<float>();
+        for (int i = 0; i < b * c * h * w; ++i) {
+            data[i] = (rand() % 1000) / 1000.0f - 0.5f;
+        }
+        input->copyFromHostTensor(inputHost.get());
+        net->runSession(session);
+        auto output = net->getSessionOutput(session, nullptr);
+        std::unique_ptr<Tensor> host(new Tensor(output, Tensor::CAFFE));
+        output->copyToHostTensor(host.get());
+
+        const int oh = output->height(), ow = output->width();
+        if (global) {
+            kernel = ALIMAX(h, w);
+            pad    = 0;
+        }
+        for (int p = 0; p < b * c; ++p) {
+            const float *src = data + p * h * w;
+            for (int y = 0; y < oh; ++y) {
+                for (int x = 0; x < ow; ++x) {
+                    // max replicates edges into padding, average counts valid cells only
+                    float maxValue = -FLT_MAX, sum = 0.0f;
+                    int count      = 0;
+                    for (int ky = 0; ky < kernel; ++ky) {
+                        for (int kx = 0; kx < kernel; ++kx) {
+                            const int iy = y * stride - pad + ky, ix = x * stride - pad + kx;
+                            const float v = src[ALIMIN(ALIMAX(iy, 0), h - 1) * w + ALIMIN(ALIMAX(ix, 0), w - 1)];
+                            maxValue      = ALIMAX(maxValue, v);
+                            if (iy >= 0 && iy < h && ix >= 0 && ix < w) {
+                                sum += v;
+                                count++;
+                            }
+                        }
+                    }
+                    const float expect = type == PoolType_MAXPOOL ? maxValue : (count > 0 ? sum / count : 0.0f);
+                    const float value  = host->host<float>()[(p * oh + y) * ow + x];
+                    if (fabsf(value - expect) > 1e-5f) {
+                        MNN_ERROR("%s pool %d/%d/%d%s of %dx%dx%dx%d, thread %d: %f, expect %f\n",
+                                  type == PoolType_MAXPOOL ? "max" : "avg", kernel, stride, pad, global ? " global" : "",
+                                  b, c, h, w, thread, value, expect);
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(PoolingReferenceTest, "op/pool/reference");
@@ -0,0 +1,333 @@
+//
+//  RNNSequenceGRUTest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2019/08/26.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <math.h>
+#include "Interpreter.hpp"
+#include "MNNTestSuite.h"
+#include "MNN_generated.h"
+
+using namespace MNN;
+
+struct GRUWeight {
+    std::vector<float> gateWeight;
+    std::vector<float> gateBias;
+    std::vector<float> candidateWeight;
+    std::vector<float> candidateBias;
+};
+
+static std::vector<float> _random(int size) {
+    std::vector<float> result(size);
+    for (int i = 0; i < size; ++i) {
+        result[i] = (rand() % 255 - 127) / 255.f;
+    }
+    return result;
+}
+
+static GRUWeight _randomWeight(int inputLength, int numUnits) {
+    GRUWeight w;
+    w.gateWeight      = _random((inputLength + numUnits) * 2 * numUnits);
+    w.gateBias        = _random(2 * numUnits);
+    w.candidateWeight = _random((inputLength + numUnits) * numUnits);
+    w.candidateBias   = _random(numUnits);
+    return w;
+}
+
+static flatbuffers::Offset<Blob> _blob(flatbuffers::FlatBufferBuilder &fbb, const std::vector<int> &dims,
+                                       const std::vector<float> &data) {
+    auto d = fbb.CreateVector(dims);
+    auto v = fbb.CreateVector(data);
+    BlobBuilder builder(fbb);
+    builder.add_dims(d);
+    builder.add_dataType(DataType_DT_FLOAT);
+    builder.add_dataFormat(MNN_DATA_FORMAT_NHWC);
+    builder.add_float32s(v);
+    return builder.Finish();
+}
+
+static Interpreter *create(int batch, int sequence, int inputLength, int numUnits, bool keepAll, bool bidirectional,
+                           const GRUWeight &fw, const GRUWeight &bw) {
+    flatbuffers::FlatBufferBuilder fbb;
+    std::vector<flatbuffers::Offset<Op>> vec;
+    {
+        auto dims = fbb.CreateVector(std::vector<int>({batch, sequence, inputLength}));
+        InputBuilder ib(fbb);
+        ib.add_dims(dims);
+        ib.add_dformat(MNN_DATA_FORMAT_NHWC);
+        auto input = ib.Finish();
+        auto name  = fbb.CreateString("input");
+        auto iv    = fbb.CreateVector(std::vector<int>({0}));
+        auto ov    = fbb.CreateVector(std::vector<int>({0}));
+
+        OpBuilder builder(fbb);
+        builder.add_type(OpType_Input);
+        builder.add_name(name);
+        builder.add_inputIndexes(iv);
+        builder.add_outputIndexes(ov);
+        builder.add_main_type(OpParameter_Input);
+        builder.add_main(flatbuffers::Offset<void>(input.o));
+        vec.push_back(builder.Finish());
+    }
+    {
+        const int rows = inputLength + numUnits;
+        auto fwGW      = _blob(fbb, {rows, 2 * numUnits}, fw.gateWeight);
+        auto fwGB      = _blob(fbb, {2 * numUnits}, fw.gateBias);
+        auto fwCW      = _blob(fbb, {rows, numUnits}, fw.candidateWeight);
+        auto fwCB      = _blob(fbb, {numUnits}, fw.candidateBias);
+        flatbuffers::Offset<Blob> bwGW, bwGB, bwCW, bwCB;
+        if (bidirectional) {
+            bwGW = _blob(fbb, {rows, 2 * numUnits}, bw.gateWeight);
+            bwGB = _blob(fbb, {2 * numUnits}, bw.gateBias);
+            bwCW = _blob(fbb, {rows, numUnits}, bw.candidateWeight);
+            bwCB = _blob(fbb, {numUnits}, bw.candidateBias);
+        }
+        RNNParamBuilder rb(fbb);
+        rb.add_numUnits(numUnits);
+        rb.add_isBidirectionalRNN(bidirectional);
+        rb.add_keepAllOutputs(keepAll);
+        rb.add_fwGateWeight(fwGW);
+        rb.add_fwGateBias(fwGB);
+        rb.add_fwCandidateWeight(fwCW);
+        rb.add_fwCandidateBias(fwCB);
+        if (bidirectional) {
+            rb.add_bwGateWeight(bwGW);
+            rb.add_bwGateBias(bwGB);
+            rb.add_bwCandidateWeight(bwCW);
+            rb.add_bwCandidateBias(bwCB);
+        }
+        auto param = rb.Finish();
+        auto name  = fbb.CreateString("gru");
+        auto iv    = fbb.CreateVector(std::vector<int>({0}));
+        auto ov    = fbb.CreateVector(bidirectional ? std::vector<int>({1, 2}) : std::vector<int>({1}));
+
+        OpBuilder builder(fbb);
+        builder.add_type(OpType_RNNSequenceGRU);
+        builder.add_name(name);
+        builder.add_inputIndexes(iv);
+        builder.add_outputIndexes(ov);
+        builder.add_main_type(OpParameter_RNNParam);
+        builder.add_main(flatbuffers::Offset<void>(param.o));
+        vec.push_back(builder.Finish());
+    }
+
+    BlobBuilder bb(fbb);
+    bb.add_dataType(DataType_DT_FLOAT);
+    bb.add_dataFormat(MNN_DATA_FORMAT_NHWC);
+    auto blob = bb.Finish();
+    std::vector<flatbuffers::Offset<TensorDescribe>> desc;
+    for (int i = 0; i < 3; ++i) {
+        TensorDescribeBuilder tdb(fbb);
+        tdb.add_index(i);
+        tdb.add_blob(blob);
+        desc.push_back(tdb.Finish());
+    }
+    auto extras = fbb.CreateVector(desc);
+    auto ops    = fbb.CreateVector(vec);
+    auto names  = fbb.CreateVectorOfStrings({"input", "output", "output_bw"});
+    NetBuilder net(fbb);
+    net.add_oplists(ops);
+    net.add_tensorName(names);
+    net.add_extraTensorDescribe(extras);
+    net.add_sourceType(NetSource_TENSORFLOW);
+    fbb.Finish(net.Finish());
+    return Interpreter::createFromBuffer((const char *)fbb.GetBufferPointer(), fbb.GetSize());
+}
+
+// straightforward GRU of each sample, outputs of backward direction are in processing order
+static std::vector<float> _reference(const std::vector<float> &input, int batch, int sequence, int inputLength,
+                                     int numUnits, bool keepAll, bool reverse, const GRUWeight &w) {
+    std::vector<float> output(batch * (keepAll ? sequence : 1) * numUnits);
+    std::vector<float> hidden(numUnits), gate(2 * numUnits), x(inputLength + numUnits);
+    for (int b = 0; b < batch; ++b) {
+        std::fill(hidden.begin(), hidden.end(), 0.0f);
+        for (int step = 0; step < sequence; ++step) {
+            const int t = reverse ? sequence - 1 - step : step;
+            for (int i = 0; i < inputLength; ++i) {
+                x[i] = input[(b * sequence + t) * inputLength + i];
+            }
+            for (int i = 0; i < numUnits; ++i) {
+                x[inputLength + i] = hidden[i];
+            }
+            for (int j = 0; j < 2 * numUnits; ++j) {
+                float sum = w.gateBias[j];
+                for (int i = 0; i < inputLength + numUnits; ++i) {
+                    sum += x[i] * w.gateWeight[i * 2 * numUnits + j];
+                }
+                gate[j] = 1.0f / (1.0f + expf(-sum));
+            }
+            for (int i = 0; i < numUnits; ++i) {
+                x[inputLength + i] = gate[i] * hidden[i];
+            }
+            for (int j = 0; j < numUnits; ++j) {
+                float sum = w.candidateBias[j];
+                for (int i = 0; i < inputLength + numUnits; ++i) {
+                    sum += x[i] * w.candidateWeight[i * numUnits + j];
+                }
+                const float u = gate[numUnits + j];
+                hidden[j]     = u * hidden[j] + (1.0f - u) * tanhf(sum);
+            }
+            if (keepAll) {
+                ::memcpy(output.data() + (b * sequence + step) * numUnits, hidden.data(), numUnits * sizeof(float));
+            }
+        }
+        if (!keepAll) {
+            ::memcpy(output.data() + b * numUnits, hidden.data(), numUnits * sizeof(float));
+        }
+    }
+    return output;
+}
+
+static bool _check(Interpreter *net, Session *session, const char *name, const std::vector<float> &expect) {
+    auto output = net->getSessionOutput(session, name);
+    std::shared_ptr<Tensor> host(Tensor::createHostTensorFromDevice(output, true));
+    if (host->elementSize() != expect.size()) {
+        return false;
+    }
+    for (int i = 0; i < expect.size(); ++i) {
+        if (fabsf(host->host<float>()[i] - expect[i]) > 1e-4f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+class RNNSequenceGRUTest : public MNNTestCase {
+public:
+    virtual ~RNNSequenceGRUTest() = default;
+    virtual bool run() {
+        const int sequence = 5;
+        for (int batch : {1, 3}) {
+            for (int inputLength : {3, 8}) {
+                for (int numUnits : {5, 16}) {
+                    for (int keepAll = 0; keepAll <= 1; ++keepAll) {
+                        for (int bidirectional = 0; bidirectional <= 1; ++bidirectional) {
+                            for (int thread : {1, 4}) {
+                                auto fw    = _randomWeight(inputLength, numUnits);
+                                auto bw    = _randomWeight(inputLength, numUnits);
+                                auto input = _random(batch * sequence * inputLength);
+                                std::unique_ptr<Interpreter> net(create(batch, sequence, inputLength, numUnits,
+                                                                        keepAll, bidirectional, fw, bw));
+                                ScheduleConfig config;
+                                config.numThread = thread;
+                                auto session     = net->createSession(config);
+                                auto inputTensor = net->getSessionInput(session, nullptr);
+                                std::shared_ptr<Tensor> inputHost(
+                                    Tensor::createHostTensorFromDevice(inputTensor, false));
+                                ::memcpy(inputHost->host<float>(), input.data(), input.size() * sizeof(float));
+                                inputTensor->copyFromHostTensor(inputHost.get());
+                                net->runSession(session);
+
+                                auto expect = _reference(input, batch, sequence, inputLength, numUnits, keepAll,
+                                                         false, fw);
+                                if (!_check(net.get(), session, "output", expect)) {
+                                    MNN_ERROR("GRU forward mismatch: %d x %d x %d, units %d, keepAll %d\n", batch,
+                                              sequence, inputLength, numUnits, keepAll);
+                                    return false;
+                                }
+                                if (bidirectional) {
+                                    expect = _reference(input, batch, sequence, inputLength, numUnits, keepAll, true,
+                                                        bw);
+                                    if (!_check(net.get(), session, "output_bw", expect)) {
+                                        MNN_ERROR("GRU backward mismatch: %d x %d x %d, units %d, keepAll %d\n",
+                                                  batch, sequence, inputLength, numUnits, keepAll);
+                                        return false;
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(RNNSequenceGRUTest, "op/rnn_gru");
+
+static void _feed(Interpreter *net, Session *session, const float *data) {
+    auto input = net->getSessionInput(session, nullptr);
+    std::shared_ptr<Tensor> host(Tensor::createHostTensorFromDevice(input, false));
+    ::memcpy(host->host<float>(), data, host->size());
+    input->copyFromHostTensor(host.get());
+}
+
+static bool _checkPart(Interpreter *net, Session *session, const char *name, const std::vector<float> &expect,
+                       int batch, int sequence, int numUnits, int start) {
+    std::vector<float> part;
+    for (int b = 0; b < batch; ++b) {
+        auto begin = expect.begin() + (b * sequence + start) * numUnits;
+        part.insert(part.end(), begin, begin + (sequence / 2) * numUnits);
+    }
+    return _check(net, session, name, part);
+}
+
+// feeding a sequence by two chunks in stateful mode gives the same result as feeding it at once
+class RNNSequenceGRUStatefulTest : public MNNTestCase {
+public:
+    virtual ~RNNSequenceGRUStatefulTest() = default;
+    virtual bool run() {
+        const int batch = 2, sequence = 6, inputLength = 5, numUnits = 7;
+        auto fw    = _randomWeight(inputLength, numUnits);
+        auto input = _random(batch * sequence * inputLength);
+        std::unique_ptr<Interpreter> net(create(batch, sequence / 2, inputLength, numUnits, true, false, fw, fw));
+        auto expect = _reference(input, batch, sequence, inputLength, numUnits, true, false, fw);
+
+        std::vector<std::vector<float>> chunks(2);
+        for (int i = 0; i < 2; ++i) {
+            for (int b = 0; b < batch; ++b) {
+                auto begin = input.begin() + (b * sequence + i * sequence / 2) * inputLength;
+                chunks[i].insert(chunks[i].end(), begin, begin + (sequence / 2) * inputLength);
+            }
+        }
+
+        ScheduleConfig config;
+        auto session = net->createSession(config);
+        net->setSessionStateful(session, true);
+        auto states = net->getSessionState(session, "gru");
+        MNNTEST_ASSERT(states.size() == 1 && states[0]->elementSize() == batch * numUnits);
+        for (int i = 0; i < 2; ++i) {
+            _feed(net.get(), session, chunks[i].data());
+            net->runSession(session);
+            MNNTEST_ASSERT(_checkPart(net.get(), session, "output", expect, batch, sequence, numUnits,
+                                      i * sequence / 2));
+        }
+
+        // state is the last hidden
+        std::shared_ptr<Tensor> last(Tensor::createHostTensorFromDevice(states[0], true));
+        for (int b = 0; b < batch; ++b) {
+            for (int j = 0; j < numUnits; ++j) {
+                MNNTEST_ASSERT(fabsf(last->host<float>()[b * numUnits + j] -
+                                     expect[(b * sequence + sequence - 1) * numUnits + j]) < 1e-4f);
+            }
+        }
+
+        // a new stream starts from zero after reset
+        net->resetSessionState(session);
+        _feed(net.get(), session, chunks[0].data());
+        net->runSession(session);
+        MNNTEST_ASSERT(_checkPart(net.get(), session, "output", expect, batch, sequence, numUnits, 0));
+
+        // restoring state of the first chunk continues the stream from there
+        std::shared_ptr<Tensor> saved(Tensor::createHostTensorFromDevice(states[0], true));
+        _feed(net.get(), session, chunks[1].data());
+        net->runSession(session);
+        MNNTEST_ASSERT(net->setSessionState(session, "gru", {saved.get()}));
+        net->runSession(session);
+        MNNTEST_ASSERT(_checkPart(net.get(), session, "output", expect, batch, sequence, numUnits, sequence / 2));
+        MNNTEST_ASSERT(!net->setSessionState(session, "gru", {}));
+
+        // back to stateless, every run starts from zero
+        net->setSessionStateful(session, false);
+        for (int i = 0; i < 2; ++i) {
+            _feed(net.get(), session, chunks[0].data());
+            net->runSession(session);
+            MNNTEST_ASSERT(_checkPart(net.get(), session, "output", expect, batch, sequence, numUnits, 0));
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(RNNSequenceGRUStatefulTest, "op/rnn_gru/stateful");
@@ -6,6 +6,7 @@
 //  Copyright © 2018, Alibaba Group Holding Limited
 //
 
+#include <math.h>
 #include "Interpreter.hpp"
 #include "MNNTestSuite.h"
 #include "MNN_generated.h"
@@ -15,7 +16,8 @@
 
 using namespace MNN;
 
-static Interpreter *create(int axis, std::vector<int> shape) {
+static Interpreter *create(int axis, std::vector<int> shape, OpType type = OpType_Softmax,
+                           MNN_DATA_FORMAT format = MNN_DATA_FORMAT_NC4HW4) {
     flatbuffers::FlatBufferBuilder fbb;
     std::vector<flatbuffers::Offset<Op>> vec;
 
@@ -23,6 +25,7 @@ static Interpreter *create(int axis, std::vector<int> shape) {
         auto dims = fbb.CreateVector(shape);
         InputBuilder ib(fbb);
         ib.add_dims(dims);
+        ib.add_dformat(format);
         auto input = ib.Finish();
         auto name  = fbb.CreateString("input");
         auto iv    = fbb.CreateVector(std::vector<int>({0}));
@@ -46,7 +49,7 @@ static Interpreter *create(int axis, std::vector<int> shape) {
         auto ov      = fbb.CreateVector(std::vector<int>({1}));
 
         OpBuilder builder(fbb);
-        builder.add_type(OpType_Softmax);
+        builder.add_type(type);
         builder.add_name(name);
         builder.add_inputIndexes(iv);
         builder.add_outputIndexes(ov);
@@ -55,11 +58,28 @@ static Interpreter *create(int axis, std::vector<int> shape) {
         vec.push_back(builder.Finish());
     }
 
-    auto ops   = fbb.CreateVector(vec);
-    auto names = fbb.CreateVectorOfStrings({"input", "output"});
+    // tensors of caffe are all NC4HW4, other formats are described as tensorflow does
+    std::vector<flatbuffers::Offset<TensorDescribe>> desc;
+    for (int i = 0; i < 2; ++i) {
+        BlobBuilder bb(fbb);
+        bb.add_dataType(DataType_DT_FLOAT);
+        bb.add_dataFormat(format);
+        auto blob = bb.Finish();
+        TensorDescribeBuilder tdb(fbb);
+        tdb.add_index(i);
+        tdb.add_blob(blob);
+        desc.push_back(tdb.Finish());
+    }
+    auto extras = fbb.CreateVector(desc);
+    auto ops    = fbb.CreateVector(vec);
+    auto names  = fbb.CreateVectorOfStrings({"input", "output"});
     NetBuilder builder(fbb);
     builder.add_oplists(ops);
     builder.add_tensorName(names);
+    if (MNN_DATA_FORMAT_NC4HW4 != format) {
+        builder.add_extraTensorDescribe(extras);
+        builder.add_sourceType(NetSource_TENSORFLOW);
+    }
     fbb.Finish(builder.Finish());
     return Interpreter::createFromBuffer((const char *)fbb.GetBufferPointer(), fbb.GetSize());
 }
@@ -230,3 +250,90 @@ public:
 MNNTestSuiteRegister(SoftmaxDim4Test, "op/softmax/dim4");
 MNNTestSuiteRegister(SoftmaxDim3Test, "op/softmax/dim3");
 MNNTestSuiteRegister(SoftmaxDim2Test, "op/softmax/dim2");
+
+// plain softmax and log softmax in double, data is in caffe order
+static std::vector<float> _reference(const std::vector<float> &data, const std::vector<int> &shape, int axis,
+                                     bool isLog) {
+    int outside = 1, inside = 1, channel = shape[axis];
+    for (int i = 0; i < axis; ++i) {
+        outside *= shape[i];
+    }
+    for (int i = axis + 1; i < shape.size(); ++i) {
+        inside *= shape[i];
+    }
+    std::vector<float> result(data.size());
+    for (int o = 0; o < outside; ++o) {
+        for (int x = 0; x < inside; ++x) {
+            auto src = data.data() + o * channel * inside + x;
+            auto dst = result.data() + o * channel * inside + x;
+            double maxValue = src[0], sum = 0.0;
+            for (int c = 1; c < channel; ++c) {
+                maxValue = std::max(maxValue, (double)src[c * inside]);
+            }
+            for (int c = 0; c < channel; ++c) {
+                sum += exp(src[c * inside] - maxValue);
+            }
+            for (int c = 0; c < channel; ++c) {
+                dst[c * inside] = isLog ? src[c * inside] - maxValue - log(sum) : exp(src[c * inside] - maxValue) / sum;
+            }
+        }
+    }
+    return result;
+}
+
+class SoftmaxReferenceTest : public MNNTestCase {
+public:
+    virtual ~SoftmaxReferenceTest() = default;
+    virtual bool run() {
+        // channel of NC4HW4 with padded lanes, other axis of NC4HW4, rows longer than a block and strided tiles
+        const std::vector<std::vector<int>> shapes = {{2, 7, 5, 3}, {1, 3, 2, 9}, {3, 1000}, {2, 21, 33, 35}};
+        for (auto &shape : shapes) {
+            for (int axis = 0; axis < shape.size(); ++axis) {
+                for (auto format : {MNN_DATA_FORMAT_NC4HW4, MNN_DATA_FORMAT_NCHW}) {
+                    for (auto type : {OpType_Softmax, OpType_LogSoftmax}) {
+                        if (!_check(shape, axis, format, type)) {
+                            MNN_ERROR("softmax of axis %d mismatch, format = %d, type = %d\n", axis, format, type);
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    bool _check(const std::vector<int> &shape, int axis, MNN_DATA_FORMAT format, OpType type) {
+        int size = 1;
+        for (auto s : shape) {
+            size *= s;
+        }
+        std::vector<float> data(size);
+        for (int i = 0; i < size; ++i) {
+            data[i] = (rand() % 2000 - 1000) / 100.0f;
+        }
+        auto expect = _reference(data, shape, axis, OpType_LogSoftmax == type);
+        std::unique_ptr<Interpreter> net(create(axis, shape, type, format));
+        for (int thread : {1, 4}) {
+            ScheduleConfig config;
+            config.numThread = thread;
+            auto session     = net->createSession(config);
+            auto input       = net->getSessionInput(session, nullptr);
+            std::unique_ptr<Tensor> inputHost(new Tensor(input, Tensor::CAFFE));
+            ::memcpy(inputHost->host<float>(), data.data(), size * sizeof(float));
+            input->copyFromHostTensor(inputHost.get());
+            net->runSession(session);
+            auto output = net->getSessionOutput(session, nullptr);
+            std::unique_ptr<Tensor> host(new Tensor(output, Tensor::CAFFE));
+            output->copyToHostTensor(host.get());
+            for (int i = 0; i < size; ++i) {
+                if (fabsf(host->host<float>()[i] - expect[i]) > 1e-3f * std::max(1.0f, fabsf(expect[i]))) {
+                    MNN_ERROR("%d: %f vs %f\n", i, host->host<float>()[i], expect[i]);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(SoftmaxReferenceTest, "op/softmax/reference");
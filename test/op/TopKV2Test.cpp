@@ -0,0 +1,173 @@
+//
+//  TopKV2Test.cpp
+//  MNNTests
+//
+//  Created by MNN on 2019/08/27.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <algorithm>
+#include "Interpreter.hpp"
+#include "MNNTestSuite.h"
+#include "MNN_generated.h"
+
+using namespace MNN;
+
+template <typename T>
+static flatbuffers::Offset<Blob> _blob(flatbuffers::FlatBufferBuilder &fbb, const std::vector<int> &dims,
+                                       const std::vector<T> &data);
+
+template <>
+flatbuffers::Offset<Blob> _blob(flatbuffers::FlatBufferBuilder &fbb, const std::vector<int> &dims,
+                                const std::vector<float> &data) {
+    auto d = fbb.CreateVector(dims);
+    auto v = fbb.CreateVector(data);
+    BlobBuilder builder(fbb);
+    builder.add_dims(d);
+    builder.add_dataType(DataType_DT_FLOAT);
+    builder.add_dataFormat(MNN_DATA_FORMAT_NHWC);
+    builder.add_float32s(v);
+    return builder.Finish();
+}
+
+template <>
+flatbuffers::Offset<Blob> _blob(flatbuffers::FlatBufferBuilder &fbb, const std::vector<int> &dims,
+                                const std::vector<int32_t> &data) {
+    auto d = fbb.CreateVector(dims);
+    auto v = fbb.CreateVector(data);
+    BlobBuilder builder(fbb);
+    builder.add_dims(d);
+    builder.add_dataType(DataType_DT_INT32);
+    builder.add_dataFormat(MNN_DATA_FORMAT_NHWC);
+    builder.add_int32s(v);
+    return builder.Finish();
+}
+
+template <>
+flatbuffers::Offset<Blob> _blob(flatbuffers::FlatBufferBuilder &fbb, const std::vector<int> &dims,
+                                const std::vector<uint8_t> &data) {
+    auto d = fbb.CreateVector(dims);
+    auto v = fbb.CreateVector(data);
+    BlobBuilder builder(fbb);
+    builder.add_dims(d);
+    builder.add_dataType(DataType_DT_UINT8);
+    builder.add_dataFormat(MNN_DATA_FORMAT_NHWC);
+    builder.add_uint8s(v);
+    return builder.Finish();
+}
+
+static flatbuffers::Offset<Op> _const(flatbuffers::FlatBufferBuilder &fbb, const char *name, int output,
+                                      flatbuffers::Offset<Blob> blob) {
+    auto n  = fbb.CreateString(name);
+    auto iv = fbb.CreateVector(std::vector<int>({}));
+    auto ov = fbb.CreateVector(std::vector<int>({output}));
+    OpBuilder builder(fbb);
+    builder.add_type(OpType_Const);
+    builder.add_name(n);
+    builder.add_inputIndexes(iv);
+    builder.add_outputIndexes(ov);
+    builder.add_main_type(OpParameter_Blob);
+    builder.add_main(flatbuffers::Offset<void>(blob.o));
+    return builder.Finish();
+}
+
+template <typename T>
+static Interpreter *create(const std::vector<int> &dims, const std::vector<T> &data, int k, DataType type) {
+    flatbuffers::FlatBufferBuilder fbb;
+    std::vector<flatbuffers::Offset<Op>> vec;
+    vec.push_back(_const(fbb, "input", 0, _blob(fbb, dims, data)));
+    vec.push_back(_const(fbb, "k", 1, _blob(fbb, {}, std::vector<int32_t>({k}))));
+    {
+        TopKV2Builder tb(fbb);
+        tb.add_T(type);
+        tb.add_sorted(true);
+        auto param = tb.Finish();
+        auto name  = fbb.CreateString("topk");
+        auto iv    = fbb.CreateVector(std::vector<int>({0, 1}));
+        auto ov    = fbb.CreateVector(std::vector<int>({2, 3}));
+
+        OpBuilder builder(fbb);
+        builder.add_type(OpType_TopKV2);
+        builder.add_name(name);
+        builder.add_inputIndexes(iv);
+        builder.add_outputIndexes(ov);
+        builder.add_main_type(OpParameter_TopKV2);
+        builder.add_main(flatbuffers::Offset<void>(param.o));
+        vec.push_back(builder.Finish());
+    }
+
+    std::vector<flatbuffers::Offset<TensorDescribe>> desc;
+    for (int i = 0; i < 4; ++i) {
+        BlobBuilder bb(fbb);
+        bb.add_dataType(i == 0 || i == 2 ? type : DataType_DT_INT32);
+        bb.add_dataFormat(MNN_DATA_FORMAT_NHWC);
+        auto blob = bb.Finish();
+        TensorDescribeBuilder tdb(fbb);
+        tdb.add_index(i);
+        tdb.add_blob(blob);
+        desc.push_back(tdb.Finish());
+    }
+    auto extras = fbb.CreateVector(desc);
+    auto ops    = fbb.CreateVector(vec);
+    auto names  = fbb.CreateVectorOfStrings({"input", "k", "values", "indices"});
+    NetBuilder net(fbb);
+    net.add_oplists(ops);
+    net.add_tensorName(names);
+    net.add_extraTensorDescribe(extras);
+    net.add_sourceType(NetSource_TENSORFLOW);
+    fbb.Finish(net.Finish());
+    return Interpreter::createFromBuffer((const char *)fbb.GetBufferPointer(), fbb.GetSize());
+}
+
+// values descending, smaller index first for equal values
+template <typename T>
+static bool _check(int rows, int rowSize, int k, DataType type, int valueRange) {
+    std::vector<T> data(rows * rowSize);
+    for (int i = 0; i < data.size(); ++i) {
+        data[i] = (T)(rand() % valueRange - (type == DataType_DT_UINT8 ? 0 : valueRange / 2));
+    }
+    std::unique_ptr<Interpreter> net(create<T>({rows, rowSize}, data, k, type));
+    for (int thread : {1, 4}) {
+        ScheduleConfig config;
+        config.numThread = thread;
+        auto session     = net->createSession(config);
+        net->runSession(session);
+        auto values  = net->getSessionOutput(session, "values");
+        auto indices = net->getSessionOutput(session, "indices");
+        for (int r = 0; r < rows; ++r) {
+            auto row = data.data() + r * rowSize;
+            std::vector<int> order(rowSize);
+            for (int i = 0; i < rowSize; ++i) {
+                order[i] = i;
+            }
+            std::stable_sort(order.begin(), order.end(), [row](int a, int b) { return row[a] > row[b]; });
+            for (int i = 0; i < k; ++i) {
+                auto index = indices->host<int32_t>()[r * k + i];
+                auto value = values->host<T>()[r * k + i];
+                if (index != order[i] || value != row[order[i]]) {
+                    MNN_ERROR("topk %dx%d, k = %d, thread = %d mismatch at (%d, %d): %d vs %d\n", rows, rowSize, k,
+                              thread, r, i, index, order[i]);
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+class TopKV2Test : public MNNTestCase {
+public:
+    virtual ~TopKV2Test() = default;
+    virtual bool run() {
+        // heap, partial sort, argmax and chunks of a wide row
+        const std::vector<std::vector<int>> shapes = {{5, 100, 3}, {3, 40, 20}, {4, 1000, 1}, {2, 60000, 8},
+                                                      {1, 60000, 1}};
+        for (auto &s : shapes) {
+            MNNTEST_ASSERT(_check<float>(s[0], s[1], s[2], DataType_DT_FLOAT, 100000));
+            MNNTEST_ASSERT(_check<int32_t>(s[0], s[1], s[2], DataType_DT_INT32, 1000));
+            MNNTEST_ASSERT(_check<uint8_t>(s[0], s[1], s[2], DataType_DT_UINT8, 256));
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(TopKV2Test, "op/topkv2");
@@ -6,8 +6,10 @@
 //  Copyright © 2018, Alibaba Group Holding Limited
 //
 
+#include "CPUTensorConvert.hpp"
 #include "Interpreter.hpp"
 #include "MNNTestSuite.h"
+#include "PermuteFunction.hpp"
 #include "Session.hpp"
 #include "TFQuantizeOp_generated.h"
 #include "TensorUtils.hpp"
@@ -194,3 +196,111 @@ public:
     }
 };
 MNNTestSuiteRegister(TransposeTest, "op/transpose");
+
+// offset of (n, c, h, w) in elements
+static int _offset(MNN_DATA_FORMAT format, int c, int h, int w, int ni, int ci, int hi, int wi) {
+    switch (format) {
+        case MNN_DATA_FORMAT_NHWC:
+            return ((ni * h + hi) * w + wi) * c + ci;
+        case MNN_DATA_FORMAT_NC4HW4:
+            return (((ni * UP_DIV(c, 4) + ci / 4) * h + hi) * w + wi) * 4 + ci % 4;
+        default:
+            return ((ni * c + ci) * h + hi) * w + wi;
+    }
+}
+
+class TransposeReferenceTest : public MNNTestCase {
+public:
+    virtual ~TransposeReferenceTest() = default;
+    virtual bool run() {
+        // tiles with remainders, coalesced axes, elements of odd bytes and over 16 bytes
+        const std::vector<std::pair<std::vector<int>, std::vector<int>>> cases = {
+            {{67, 129}, {1, 0}},
+            {{2, 37, 41, 5}, {0, 3, 1, 2}},
+            {{2, 37, 41, 5}, {0, 2, 3, 1}},
+            {{3, 1, 17, 1, 9}, {4, 2, 0, 1, 3}},
+            {{4, 6, 8, 10, 3, 2}, {5, 1, 3, 0, 2, 4}},
+            {{8, 16, 12, 33}, {0, 2, 1, 3}},
+            {{256, 300}, {1, 0}},
+            {{7}, {0}},
+        };
+        for (auto &c : cases) {
+            for (int bytes : {1, 2, 3, 4, 8, 12, 16, 20}) {
+                for (int thread : {1, 4}) {
+                    if (!_checkTranspose(c.first, c.second, bytes, thread)) {
+                        MNN_ERROR("transpose of %d bytes, %d threads mismatch\n", bytes, thread);
+                        return false;
+                    }
+                }
+            }
+        }
+        const MNN_DATA_FORMAT formats[] = {MNN_DATA_FORMAT_NCHW, MNN_DATA_FORMAT_NHWC, MNN_DATA_FORMAT_NC4HW4};
+        for (auto source : formats) {
+            for (auto dest : formats) {
+                for (int channel : {3, 8, 21}) {
+                    for (int bytes : {1, 4}) {
+                        if (!_checkConvert(source, dest, 2, channel, 13, 150, bytes)) {
+                            MNN_ERROR("convert %d to %d of %d channels, %d bytes mismatch\n", source, dest, channel,
+                                      bytes);
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    static std::vector<uint8_t> _random(int size) {
+        std::vector<uint8_t> data(size);
+        for (int i = 0; i < size; ++i) {
+            data[i] = rand() % 256;
+        }
+        return data;
+    }
+
+    bool _checkTranspose(const std::vector<int> &shape, const std::vector<int> &perm, int bytes, int thread) {
+        const int dims = (int)shape.size();
+        int size       = 1;
+        std::vector<int> srcStride(dims, 1);
+        for (int i = dims - 1; i >= 0; --i) {
+            srcStride[i] = size;
+            size *= shape[i];
+        }
+        auto src = _random(size * bytes);
+        std::vector<uint8_t> dst(size * bytes), expect(size * bytes);
+        for (int i = 0; i < size; ++i) {
+            int offset = 0;
+            for (int d = dims - 1, index = i; d >= 0; --d) {
+                offset += index % shape[perm[d]] * srcStride[perm[d]];
+                index /= shape[perm[d]];
+            }
+            ::memcpy(expect.data() + i * bytes, src.data() + offset * bytes, bytes);
+        }
+        PermuteFunction::transpose(dst.data(), src.data(), shape, perm, bytes, thread);
+        return dst == expect;
+    }
+
+    bool _checkConvert(MNN_DATA_FORMAT source, MNN_DATA_FORMAT dest, int b, int c, int h, int w, int bytes) {
+        const int size = b * ALIGN_UP4(c) * h * w;
+        auto src       = _random(size * bytes);
+        auto dst       = _random(size * bytes);
+        std::vector<uint8_t> expect(size * bytes, 0);
+        for (int ni = 0; ni < b; ++ni) {
+            for (int ci = 0; ci < c; ++ci) {
+                for (int hi = 0; hi < h; ++hi) {
+                    for (int wi = 0; wi < w; ++wi) {
+                        ::memcpy(expect.data() + _offset(dest, c, h, w, ni, ci, hi, wi) * bytes,
+                                 src.data() + _offset(source, c, h, w, ni, ci, hi, wi) * bytes, bytes);
+                    }
+                }
+            }
+        }
+        CPUTensorConverter::convert(src.data(), dst.data(), source, dest, b, c, h, w, bytes, 4);
+        // padding of NC4HW4 is zeroed, bytes beyond other formats are not touched
+        const int count = (MNN_DATA_FORMAT_NC4HW4 == dest ? ALIGN_UP4(c) : c) * b * h * w * bytes;
+        return 0 == ::memcmp(dst.data(), expect.data(), count);
+    }
+};
+MNNTestSuiteRegister(TransposeReferenceTest, "op/transpose/reference");
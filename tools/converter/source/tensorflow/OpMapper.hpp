@@ -37,6 +37,7 @@ const std::unordered_map<std::string, MNN::OpType> tfOp2MNNOp{
     {"Max", MNN::OpType_Reduction},
     {"Sigmoid", MNN::OpType_Sigmoid},
     {"Softmax", MNN::OpType_Softmax},
+    {"LogSoftmax", MNN::OpType_LogSoftmax},
     {"Pad", MNN::OpType_Padding},
     {"MatMul", MNN::OpType_MatMul},
     {"ResizeBilinear", MNN::OpType_Interp},
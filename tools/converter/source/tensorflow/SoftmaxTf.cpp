@@ -32,3 +32,21 @@ void SoftmaxTf::run(MNN::OpT *dstOp, TmpNode *srcNode, TmpGraph *tempGraph) {
 }
 
 REGISTER_CONVERTER(SoftmaxTf, Softmax);
+
+DECLARE_OP_CONVERTER(LogSoftmaxTf);
+
+MNN::OpType LogSoftmaxTf::opType() {
+    return MNN::OpType_LogSoftmax;
+}
+MNN::OpParameter LogSoftmaxTf::type() {
+    return MNN::OpParameter_Axis;
+}
+
+// LogSoftmax of tensorflow always works on the last axis
+void LogSoftmaxTf::run(MNN::OpT *dstOp, TmpNode *srcNode, TmpGraph *tempGraph) {
+    auto axisT        = new MNN::AxisT;
+    axisT->axis       = -1;
+    dstOp->main.value = axisT;
+}
+
+REGISTER_CONVERTER(LogSoftmaxTf, LogSoftmax);